@@ -0,0 +1,19 @@
+'''
+A suite that measures the speed of the simulator, so that changes to its performance can be tracked.
+
+Several reference configurations are built and run over fixed synthetic workloads. The throughput, the peak memory use, and
+the host time spent in each kind of component are compared against a stored baseline.
+'''
+#    Copyright 2023 The ChampSim Contributors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
@@ -0,0 +1,83 @@
+#    Copyright 2023 The ChampSim Contributors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import argparse
+import json
+import os
+import sys
+
+from . import suite
+
+parser = argparse.ArgumentParser(prog='python3 -m benchmark', description='Measure the speed of ChampSim over a set of reference configurations')
+
+parser.add_argument('--configs', default=suite.default_configs,
+        help='A JSON file with a list of configurations to build and measure')
+parser.add_argument('--build-dir', default=os.path.join(suite.champsim_root, '_benchmark'),
+        help='The directory in which to configure and build the reference configurations')
+parser.add_argument('--no-build', action='store_false', dest='build',
+        help='Measure the executables already in the build directory, without rebuilding them')
+parser.add_argument('--workload', action='append', choices=list(suite.workloads), dest='workloads',
+        help='A workload to run. May be given more than once. If not given, all workloads are run.')
+parser.add_argument('--warmup-instructions', type=int, default=200000,
+        help='The number of warmup instructions of each core')
+parser.add_argument('--simulation-instructions', type=int, default=2000000,
+        help='The number of measured instructions of each core')
+parser.add_argument('--repeat', type=int, default=3,
+        help='The number of runs of each measurement, of which the fastest is kept')
+parser.add_argument('--no-profile', action='store_false', dest='profile',
+        help='Do not measure the host time of each kind of component')
+parser.add_argument('--output',
+        help='The name of the file to receive the results as JSON')
+parser.add_argument('--baseline', default=suite.default_baseline,
+        help='The file of results against which to compare')
+parser.add_argument('--update-baseline', action='store_true',
+        help='Write the results to the baseline file, instead of comparing against it')
+parser.add_argument('--tolerance', type=float, default=0.1,
+        help='The fraction by which a measurement may worsen before it is reported as a regression')
+
+args = parser.parse_args()
+build_dir = os.path.abspath(args.build_dir)
+
+if args.build:
+    suite.build(os.path.abspath(args.configs), build_dir)
+
+results = []
+for config in suite.load_configs(args.configs):
+    executable = os.path.join(build_dir, 'bin', config['executable_name'])
+    for workload in (args.workloads or suite.workloads):
+        print(f'Measuring {config["name"]} with {workload}', file=sys.stderr)
+        traces = [suite.workloads[workload]] * config.get('num_cores', 1)
+        result = suite.measure(executable, traces, args.warmup_instructions, args.simulation_instructions, repeat=args.repeat, profile=args.profile)
+        results.append({ 'configuration': config['name'], 'workload': workload, **result })
+
+print(suite.format_table(results))
+
+if args.output:
+    with open(args.output, 'wt') as wfp:
+        json.dump(results, wfp, indent=2)
+
+if args.update_baseline:
+    with open(args.baseline, 'wt') as wfp:
+        json.dump(results, wfp, indent=2)
+    print(f'Wrote the baseline to {args.baseline}')
+elif os.path.exists(args.baseline):
+    with open(args.baseline) as rfp:
+        regressions = suite.compare(json.load(rfp), results, tolerance=args.tolerance)
+    for regression in regressions:
+        print(f'REGRESSION: {regression}')
+    if regressions:
+        sys.exit(1)
+    print(f'No regressions beyond {args.tolerance:.0%} of {args.baseline}')
+else:
+    print(f'No baseline at {args.baseline}. Use --update-baseline to record one.')
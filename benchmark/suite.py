@@ -0,0 +1,159 @@
+#    Copyright 2023 The ChampSim Contributors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import collections
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+champsim_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+default_configs = os.path.join(champsim_root, 'benchmark', 'configs.json')
+default_baseline = os.path.join(champsim_root, 'benchmark', 'baseline.json')
+
+# Each workload is run on every core of every configuration
+workloads = {
+    'stream': 'synthetic:stream,footprint=64M',
+    'pointer_chase': 'synthetic:pointer_chase,footprint=64M',
+    'gups': 'synthetic:gups,footprint=256M',
+    'mix': 'synthetic:mix,footprint=16M,mispredict=0.05'
+}
+
+def load_configs(fname):
+    '''
+    Read the reference configurations, which are given to ``config.sh`` as a single file.
+    '''
+    with open(fname) as rfp:
+        return json.load(rfp)
+
+def build(configs_fname, build_dir, jobs=None):
+    '''
+    Configure and build the reference configurations in their own directory, so that the configuration in the
+    repository root is undisturbed.
+    '''
+    subprocess.run([os.path.join(champsim_root, 'config.sh'), '--prefix', build_dir, '--makedir', build_dir, configs_fname], cwd=champsim_root, check=True)
+    subprocess.run(['make', '-I', build_dir, f'OBJ_ROOT={os.path.join(build_dir, ".csconfig")}', f'-j{jobs or os.cpu_count()}', 'all'],
+            cwd=champsim_root, check=True)
+
+def run_once(executable, traces, warmup, simulation, profile=False):
+    '''
+    Run an executable to completion, and return its JSON statistics and its peak resident set size in KiB.
+    '''
+    with tempfile.TemporaryDirectory() as tmpdir:
+        json_fname = os.path.join(tmpdir, 'stats.json')
+        cmd = [executable, '--hide-heartbeat', '--warmup-instructions', str(warmup), '--simulation-instructions', str(simulation), '--json', json_fname]
+        if profile:
+            cmd.append('--profile-host-time')
+        cmd.extend(traces)
+
+        # os.wait4() gives the resource usage of this child alone, rather than the maximum over all children
+        proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL)
+        _, status, usage = os.wait4(proc.pid, 0)
+        proc.returncode = os.waitstatus_to_exitcode(status)
+        if proc.returncode != 0:
+            raise subprocess.CalledProcessError(proc.returncode, cmd)
+
+        with open(json_fname) as rfp:
+            stats = json.load(rfp)
+
+    # Linux reports the maximum resident set size in KiB, but macOS reports it in bytes
+    peak_rss = usage.ru_maxrss // 1024 if sys.platform == 'darwin' else usage.ru_maxrss
+    return stats, peak_rss
+
+def summarize(stats, peak_rss):
+    '''
+    Reduce the JSON statistics of one run to the measurements that the suite tracks.
+    The instructions of every core are counted, and the host time of the components is given per instruction.
+    '''
+    phase = stats[-1]
+    instructions = sum(core['instructions'] for core in phase['roi']['cores'])
+    seconds = phase['host time']['elapsed']
+
+    host_time = collections.Counter()
+    for component in phase['host time'].get('components', []):
+        host_time[component['kind']] += component['seconds']
+
+    return {
+        'instructions': instructions,
+        'seconds': seconds,
+        'kips': instructions / seconds / 1000 if seconds > 0 else 0,
+        'peak_rss_kib': peak_rss,
+        'host_ns_per_instruction': { k: 1e9 * v / instructions for k,v in host_time.items() } if instructions > 0 else {}
+    }
+
+def measure(executable, traces, warmup, simulation, repeat=3, profile=True):
+    '''
+    Measure the throughput of an executable over the best of several runs, to reduce the effect of noise on the host.
+    Profiling slows the simulator, so the host time of each component is measured in a separate run.
+    '''
+    runs = [summarize(*run_once(executable, traces, warmup, simulation)) for _ in range(max(repeat, 1))]
+    retval = max(runs, key=lambda r: r['kips'])
+    retval['peak_rss_kib'] = max(r['peak_rss_kib'] for r in runs)
+
+    if profile:
+        retval['host_ns_per_instruction'] = summarize(*run_once(executable, traces, warmup, simulation, profile=True))['host_ns_per_instruction']
+    return retval
+
+def result_key(result):
+    return (result['configuration'], result['workload'])
+
+def compare(baseline, results, tolerance=0.1, min_share=0.05):
+    '''
+    Compare results against a baseline, and return a description of each regression.
+
+    A regression is a throughput that falls, or a peak memory use or a per-instruction host time that rises, by more than
+    the given fraction. Components whose share of the baseline host time is less than ``min_share`` are ignored, since their
+    time is dominated by noise. Results that have no counterpart in the baseline are not compared.
+
+    :param baseline: a list of results from an earlier run
+    :param results: a list of results from this run
+    :param tolerance: the fraction by which a measurement may worsen before it is a regression
+    :param min_share: the smallest fraction of the host time for which a component is compared
+    '''
+    baseline_by_key = { result_key(r): r for r in baseline }
+    regressions = []
+    for result in results:
+        base = baseline_by_key.get(result_key(result))
+        if base is None:
+            continue
+
+        name = '{}/{}'.format(*result_key(result))
+        if result['kips'] < base['kips'] * (1 - tolerance):
+            regressions.append(f'{name}: throughput fell from {base["kips"]:.1f} to {result["kips"]:.1f} KIPS')
+        if result['peak_rss_kib'] > base['peak_rss_kib'] * (1 + tolerance):
+            regressions.append(f'{name}: peak RSS rose from {base["peak_rss_kib"]} to {result["peak_rss_kib"]} KiB')
+
+        base_host_time = base.get('host_ns_per_instruction', {})
+        base_total = sum(base_host_time.values())
+        for kind, value in result.get('host_ns_per_instruction', {}).items():
+            base_value = base_host_time.get(kind)
+            if base_value is None or base_value < base_total * min_share:
+                continue
+            if value > base_value * (1 + tolerance):
+                regressions.append(f'{name}: {kind} host time rose from {base_value:.1f} to {value:.1f} ns per instruction')
+
+    return regressions
+
+def format_table(results):
+    '''
+    Format the results as a table for the terminal.
+    '''
+    kinds = sorted(set(k for r in results for k in r.get('host_ns_per_instruction', {})))
+    header = ['configuration', 'workload', 'KIPS', 'peak RSS (KiB)', *(f'{k} (ns/instr)' for k in kinds)]
+    rows = [[r['configuration'], r['workload'], f'{r["kips"]:.1f}', str(r['peak_rss_kib']),
+        *(f'{r.get("host_ns_per_instruction", {}).get(k, 0):.1f}' for k in kinds)] for r in results]
+    widths = [max(len(row[i]) for row in (header, *rows)) for i in range(len(header))]
+    return '\n'.join('  '.join(field.ljust(w) for field,w in zip(row, widths)).rstrip() for row in (header, *rows))
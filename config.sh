@@ -65,6 +65,12 @@ if __name__ == '__main__':
     parser.add_argument('--join', choices=['chain','product'], default='product',
             help='The joining method when multiple files are specified. A "chain" join concatenates the files, building the union of all specifications. A "product" join merges each possible combination of the specified builds. In the case of "product", the last file specified has the highest priority.')
 
+    parser.add_argument('--batch', metavar='NAME',
+            help='Additionally build an executable with the given name that simulates all of the specified configurations in parallel, decoding each trace only once. The configurations must agree on the number of cores, the block size, and the page size.')
+
+    parser.add_argument('--emit-runtime', action='store_true',
+            help='Instead of generating build files, write each resolved configuration as a JSON file in the binary directory. These may be passed to an existing executable with `--config`, without recompiling, as long as the modules they name were compiled into it and they agree on the number of cores, the block size, and the page size.')
+
     parser.add_argument('files', nargs='*',
             help='A sequence of JSON files describing the configuration.')
 
@@ -97,6 +103,11 @@ if __name__ == '__main__':
 
     with config.filewrite.FileWriter(bindir_name=bindir_name, objdir_name=objdir_name, makedir_name=args.makedir, verbose=args.verbose) as wr:
         for c in parsed_configs:
-            wr.write_files(c)
+            if args.emit_runtime:
+                wr.write_runtime(c)
+            else:
+                wr.write_files(c)
+        if args.batch:
+            wr.write_batch(args.batch)
 
 # vim: set filetype=python:
@@ -16,6 +16,9 @@ import itertools
 
 from . import util
 
+# The number of sets per upper level in champsim::defaults::default_llc
+llc_sets_factor = 2048
+
 def cache_core_defaults(cpu):
     ''' Generate the lower levels that a default core would expect for each of its caches '''
     yield { 'name': cpu.get('L1I'), 'lower_level': cpu.get('L2C') }
@@ -21,8 +21,12 @@ import json
 import pathlib
 
 from .makefile import get_makefile_lines
+from .makefile import get_batch_makefile_lines
 from .instantiation_file import get_instantiation_lines
 from .instantiation_file import get_instantiation_header
+from .instantiation_file import get_module_registry_lines
+from .instantiation_file import get_cache_operate_lines
+from .runtime import get_runtime_description
 from . import util
 
 warning_text = (
@@ -89,6 +93,10 @@ def try_int(val):
     except Exception as exc:
         raise TypeError from exc
 
+def get_build_id(parsed_config):
+    ''' Produce a unique identifier for the result of parse.parse_config() '''
+    return hashlib.shake_128(json.dumps(parsed_config, sort_keys=True, default=try_int).encode('utf-8')).hexdigest(8)
+
 class Fragment:
     '''
     Examines the given config and prepares to write the needed files.
@@ -143,7 +151,7 @@ class Fragment:
             print('Object directory:', objdir_name)
             print('Makefile directory:', makedir_name)
 
-        build_id = hashlib.shake_128(json.dumps(parsed_config, sort_keys=True, default=try_int).encode('utf-8')).hexdigest(8)
+        build_id = get_build_id(parsed_config)
 
         executable_basename, elements, modules_to_compile, module_info, config_file = parsed_config
 
@@ -175,6 +183,79 @@ class Fragment:
         ]
         return Fragment(list(util.collect(fileparts, operator.itemgetter(0), Fragment.__part_joiner))) # hoist the parts
 
+    @staticmethod
+    def from_batch(build_ids, executable_basename, bindir_name=None, makedir_name=None):
+        '''
+        Produce a Fragment for an executable that simulates several configurations side by side.
+
+        :param build_ids: the build IDs of the configurations to combine
+        :param executable_basename: the name of the combined executable
+        :param bindir_name: the directory in which to place the binary
+        :param makedir_name: the directory to place makefiles
+        '''
+        champsim_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        bindir_name = bindir_name or os.path.join(champsim_root, 'bin')
+        makedir_name = makedir_name or champsim_root
+
+        batch_id = hashlib.shake_128(json.dumps(list(build_ids)).encode('utf-8')).hexdigest(8)
+        executable = os.path.join(bindir_name, executable_basename)
+
+        return Fragment([
+            (os.path.join(makedir_name, '_configuration.mk'), (
+                *make_generated_warning(),
+                *get_batch_makefile_lines(batch_id, executable, build_ids)
+            ))
+        ])
+
+    @staticmethod
+    def from_registry(module_info, objdir_name=None):
+        '''
+        Produce a Fragment that lists every compiled module, so that they may be selected at run time.
+
+        :param module_info: a dictionary from module kinds to sequences of module data
+        :param objdir_name: the directory to place object files
+        '''
+        champsim_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        objdir_name = objdir_name or os.path.join(champsim_root, '.csconfig')
+
+        return Fragment([
+            (os.path.join(objdir_name, 'module_registry.inc'), cxx_file(get_module_registry_lines(module_info)))
+        ])
+
+    @staticmethod
+    def from_cache_operate(module_pairs, objdir_name=None):
+        '''
+        Produce a Fragment that instantiates the cache's operate loop for the modules of every configured cache.
+
+        :param module_pairs: a sequence of pairs of sequences of module data, the prefetchers and the replacement policies of a cache
+        :param objdir_name: the directory to place object files
+        '''
+        champsim_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        objdir_name = objdir_name or os.path.join(champsim_root, '.csconfig')
+
+        return Fragment([
+            (os.path.join(objdir_name, 'cache_operate.inc'), cxx_file(get_cache_operate_lines(module_pairs)))
+        ])
+
+    @staticmethod
+    def from_runtime(parsed_config, bindir_name=None):
+        '''
+        Produce a Fragment that describes the configuration for an executable that is configured at run time.
+        The description is written next to where the executable would have been, with the extension ``.json``.
+
+        :param parsed_config: the result of parsing a configuration file
+        :param bindir_name: the directory in which to place the description
+        '''
+        champsim_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        bindir_name = bindir_name or os.path.join(champsim_root, 'bin')
+
+        executable_basename, elements, _, _, config_file = parsed_config
+        description = get_runtime_description(**elements, config_file=config_file)
+
+        return Fragment([
+            (os.path.join(bindir_name, executable_basename+'.json'), tuple(json.dumps(description, indent=2).splitlines()))
+        ])
+
     def write(self, verbose=False):
         ''' Write the internal series of fragments to file. '''
         for fname, fcontents in self.fileparts:
@@ -197,6 +278,9 @@ class FileWriter:
     '''
     def __init__(self, bindir_name=None, objdir_name=None, makedir_name=None, verbose=False):
         self.fragments = []
+        self.build_ids = []
+        self.registries = {}
+        self.cache_modules = {}
         self.bindir_name = bindir_name
         self.objdir_name = objdir_name
         self.makedir_name = makedir_name
@@ -205,6 +289,9 @@ class FileWriter:
     def __enter__(self):
         ''' This function forms one half of the context manager interface '''
         self.fragments = []
+        self.build_ids = []
+        self.registries = {}
+        self.cache_modules = {}
         return self
 
     def write_files(self, parsed_config, bindir_name=None, srcdir_names=None, objdir_name=None, makedir_name=None):
@@ -217,15 +304,50 @@ class FileWriter:
         :param srcdir_name: the directory to search for source files
         :param objdir_name: the directory to place object files
         '''
+        local_objdir_name = os.path.abspath(objdir_name or self.objdir_name)
+        self.build_ids.append(get_build_id(parsed_config))
         self.fragments.append(Fragment.from_config(
             parsed_config,
             bindir_name=bindir_name or self.bindir_name,
             srcdir_names=srcdir_names or [],
-            objdir_name=os.path.abspath(objdir_name or self.objdir_name),
+            objdir_name=local_objdir_name,
             makedir_name=makedir_name or self.makedir_name,
             verbose=self.verbose
         ))
 
+        # Every module compiled into the executables is available to the runtime configuration
+        _, elements, modules_to_compile, module_info, _ = parsed_config
+        registry = self.registries.setdefault(local_objdir_name, {})
+        for kind, modules in module_info.items():
+            registry.setdefault(kind, {}).update(util.subdict(modules, modules_to_compile))
+
+        # The cache's operate loop is instantiated for the modules of each cache
+        self.cache_modules.setdefault(local_objdir_name, []).extend((c['_prefetcher_data'], c['_replacement_data']) for c in elements['caches'])
+
+    def write_runtime(self, parsed_config, bindir_name=None):
+        '''
+        Accumulate the description of a configuration for an executable that is configured at run time.
+        No build files are written for this configuration.
+
+        :param parsed_config: the result of parsing a configuration file
+        :param bindir_name: the directory in which to place the description
+        '''
+        self.fragments.append(Fragment.from_runtime(parsed_config, bindir_name=bindir_name or self.bindir_name))
+
+    def write_batch(self, executable_basename, bindir_name=None, makedir_name=None):
+        '''
+        Add an executable that simulates every configuration written so far, sharing a single decode of each trace.
+
+        :param executable_basename: the name of the combined executable
+        :param bindir_name: the directory in which to place the binary
+        '''
+        self.fragments.append(Fragment.from_batch(
+            self.build_ids,
+            executable_basename,
+            bindir_name=bindir_name or self.bindir_name,
+            makedir_name=makedir_name or self.makedir_name
+        ))
+
     @staticmethod
     def write_fragments(*fragments):
         ''' Write out a set of prepared fragments. '''
@@ -235,7 +357,9 @@ class FileWriter:
 
     def finish(self):
         ''' Write all accumulated configurations to their files. '''
-        FileWriter.write_fragments(*self.fragments)
+        registry_fragments = (Fragment.from_registry({k: v.values() for k,v in modules.items()}, objdir_name=objdir) for objdir, modules in self.registries.items())
+        operate_fragments = (Fragment.from_cache_operate(pairs, objdir_name=objdir) for objdir, pairs in self.cache_modules.items())
+        FileWriter.write_fragments(*self.fragments, *registry_fragments, *operate_fragments)
 
     def __exit__(self, exc_type, exc_value, traceback):
         ''' This function terminates the context manager and calls :meth:`finish()`. '''
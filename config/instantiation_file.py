@@ -23,7 +23,7 @@ from . import util
 from . import cxx
 
 pmem_fmtstr = 'champsim::chrono::picoseconds{{{clock_period_dbus}}}, champsim::chrono::picoseconds{{{clock_period_mc}}}, std::size_t{{{_tRP}}}, std::size_t{{{_tRCD}}}, std::size_t{{{_tCAS}}}, std::size_t{{{_tRAS}}}, champsim::chrono::microseconds{{{_refresh_period}}}, {{{_ulptr}}}, {rq_size}, {wq_size}, {channels}, champsim::data::bytes{{{channel_width}}}, {_bank_rows}, {_bank_columns}, {ranks}, {bankgroups}, {banks}, {_refreshes_per_period}'
-vmem_fmtstr = 'champsim::data::bytes{{{pte_page_size}}}, {num_levels}, champsim::chrono::picoseconds{{{clock_period}*{minor_fault_penalty}}}, {dram_name}, {_randomization}'
+vmem_fmtstr = 'champsim::data::bytes{{{pte_page_size}}}, {num_levels}, champsim::chrono::picoseconds{{{clock_period}*{minor_fault_penalty}}}, {dram_name}, {_randomization}{_shared}'
 
 queue_fmtstr = '{rq_size}, {pq_size}, {wq_size}, champsim::data::bits{{{_offset_bits}}}, {_queue_check_full_addr:b}'
 
@@ -51,6 +51,14 @@ core_builder_parts = {
     'dib_set': '  .dib_set({dib_set})',
     'dib_way': '  .dib_way({dib_way})',
     'dib_window': '  .dib_window({dib_window})',
+    'ftq_size': '.ftq_size({ftq_size})',
+    'runahead_width': '.runahead_width(champsim::bandwidth::maximum_type{{{runahead_width}}})',
+    'threads': '.threads({threads})',
+    'smt_fetch_policy': '.smt_fetch(champsim::smt_fetch_policy::{smt_fetch_policy})',
+    'smt_partitioning': '.smt_partition(champsim::smt_partitioning::{smt_partitioning})',
+    'memory_dependence': '.memory_dependence(champsim::memory_dependence_policy::{memory_dependence})',
+    'execution_ports': '.execution_ports({^execution_ports_string})',
+    'fp_registers': '.fp_registers({fp_registers[0]}, {fp_registers[1]})',
     'L1I': ['.l1i(&{^l1i_ptr})', '.l1i_bandwidth({^l1i_ptr}.MAX_TAG)', '.fetch_queues(&{^fetch_queues})'],
     'L1D': ['.l1d_bandwidth({^l1d_ptr}.MAX_TAG)', '.data_queues(&{^data_queues})'],
     '_branch_predictor_data': '.branch_predictor<{^branch_predictor_string}>()',
@@ -85,7 +93,12 @@ cache_builder_parts = {
     '_prefetcher_data': '.prefetcher<{^prefetcher_string}>()',
     'lower_translate': '.lower_translate(&{^lower_translate_queues})',
     'lower_level': '.lower_level(&{^lower_level_queues})',
-    'frequency': '.clock_period(champsim::chrono::picoseconds{{{^clock_period}}})'
+    'frequency': '.clock_period(champsim::chrono::picoseconds{{{^clock_period}}})',
+    'mrc_sets': '.stack_distance_sets({{{^mrc_sets_string}}})',
+    'mrc_ways': '.stack_distance_ways({mrc_ways})',
+    'inclusion': '.inclusion(champsim::inclusion_policy::{inclusion})',
+    'coherence': '.coherence(champsim::coherence_protocol::{coherence})',
+    'prefetch_throttle': '.prefetch_throttle(champsim::prefetch_throttle_policy::{prefetch_throttle})'
 }
 
 ptw_builder_parts = {
@@ -105,6 +118,13 @@ def vector_string(iterable):
         return hoisted[0]
     return '{'+', '.join(hoisted)+'}'
 
+def execution_port_string(i, port):
+    ''' Produce the initializer of a champsim::execution_port '''
+    ops = ', '.join(f'champsim::op_class::{op}' for op in port['ops'])
+    name = port.get('name', f'port{i}')
+    pipelined = 'true' if port.get('pipelined', True) else 'false'
+    return f'champsim::execution_port{{"{name}", {port.get("count", 1)}, {{{ops}}}, {port.get("latency", 1)}, {pipelined}}}'
+
 def get_cpu_builder(cpu, caches, ul_pairs):
     '''
     Generate a champsim::core_builder
@@ -121,16 +141,25 @@ def get_cpu_builder(cpu, caches, ul_pairs):
         '^fetch_queues': f'channels.at({ul_pairs.index((cpu.get("L1I"), cpu.get("name")))})',
         '^data_queues': f'channels.at({ul_pairs.index((cpu.get("L1D"), cpu.get("name")))})',
         '^l1i_ptr': f'(*std::next(std::begin(caches), {cache_index(cpu.get("L1I"))}))',
-        '^l1d_ptr': f'(*std::next(std::begin(caches), {cache_index(cpu.get("L1D"))}))'
+        '^l1d_ptr': f'(*std::next(std::begin(caches), {cache_index(cpu.get("L1D"))}))',
+        '^execution_ports_string': '{'+', '.join(itertools.starmap(execution_port_string, enumerate(cpu.get('execution_ports', [])))) + '}'
     }
     if 'frequency' in cpu:
         local_params['^clock_period'] = int(1000000/cpu['frequency'])
 
+    local_core_builder_parts = {
+        ('wrong_path', True): '.set_wrong_path()',
+        ('wrong_path', False): '.reset_wrong_path()',
+        ('shared_address_space', True): '.set_shared_address_space()',
+        ('shared_address_space', False): '.reset_shared_address_space()'
+    }
+
     builder_parts = itertools.chain(util.multiline(itertools.chain(
         ('champsim::core_builder{{ champsim::defaults::default_core }}',),
         required_parts,
         *(util.wrap_list(v) for k,v in core_builder_parts.items() if k in cpu),
-        (v for k,v in dib_builder_parts.items() if k in cpu.get('DIB',{}))
+        (v for k,v in dib_builder_parts.items() if k in cpu.get('DIB',{})),
+        (v for k,v in local_core_builder_parts.items() if k[0] in cpu and k[1] == cpu[k[0]])
     ), indent=1, line_end=''))
     yield from (part.format(**cpu, **local_params) for part in builder_parts)
 
@@ -159,6 +188,7 @@ def get_cache_builder(elem, ul_pairs):
         '^prefetch_activate_string': ', '.join('access_type::'+t for t in elem.get('prefetch_activate',[])),
         '^replacement_string': ', '.join(f'class {k["class"]}' for k in elem.get('_replacement_data',[])),
         '^prefetcher_string': ', '.join(f'class {k["class"]}' for k in elem.get('_prefetcher_data',[])),
+        '^mrc_sets_string': ', '.join(str(s) for s in util.wrap_list(elem.get('mrc_sets',[]))),
         '^lower_level_queues': f'channels.at({ul_pairs.index((elem.get("lower_level"), elem.get("name")))})'
     }
     if 'frequency' in elem:
@@ -209,6 +239,32 @@ def get_ptw_builder(ptw, ul_pairs):
     ), indent=1, line_end=''))
     yield from (part.format(**ptw, **local_params) for part in builder_parts)
 
+def interconnect_port(noc_name, upper_name):
+    ''' The name of the upper end of the channel that carries requests from an upper level of an interconnect to each of its slices '''
+    return f'{noc_name}.{upper_name}'
+
+def get_interconnect_instantiation(noc, ul_pairs):
+    '''
+    Generate a champsim::interconnect
+    '''
+    def channel_ptr(lower, upper):
+        return f'&channels.at({ul_pairs.index((lower, upper))})'
+
+    lower_levels = (', '.join(channel_ptr(s, interconnect_port(noc['name'], u)) for s in noc['_slices']) for u in noc['_uppers'])
+    yield 'champsim::interconnect{'
+    yield from util.append_except_last((
+        f'  "{noc["name"]}"',
+        f'  champsim::chrono::picoseconds{{{int(1000000/noc["frequency"])}}}',
+        f'  champsim::interconnect::topology_type::{noc["topology"]}',
+        f'  {int(noc["mesh_width"])}',
+        f'  {int(noc["hop_latency"])}',
+        f'  champsim::bandwidth::maximum_type{{{int(noc["link_bandwidth"])}}}',
+        f'  {int(noc["buffer_size"])}',
+        '  {'+', '.join(channel_ptr(noc['name'], u) for u in noc['_uppers'])+'}',
+        '  {'+', '.join('{'+l+'}' for l in lower_levels)+'}'
+    ), ',')
+    yield '}'
+
 def get_ref_vector_function(rtype, func_name, basename):
     '''
     Generate a C++ function with the given name whose return type is a
@@ -264,8 +320,11 @@ def ptw_queue_defaults(ptw):
         '_queue_check_full_addr': False
     }
 
-def get_upper_levels(cores, caches, ptws):
-    ''' Get a sequence of (lower_name, upper_name) for the given elements. '''
+def get_upper_levels(cores, caches, ptws, interconnects=()):
+    '''
+    Get a sequence of (lower_name, upper_name) for the given elements.
+    Each slice behind an interconnect has one upper level for each upper level of the interconnect.
+    '''
     def named_selector(elem, key):
         return elem.get(key), elem.get('name')
 
@@ -274,7 +333,8 @@ def get_upper_levels(cores, caches, ptws):
         map(functools.partial(named_selector, key='lower_level'), caches),
         map(functools.partial(named_selector, key='lower_translate'), caches),
         map(functools.partial(named_selector, key='L1I'), cores),
-        map(functools.partial(named_selector, key='L1D'), cores)
+        map(functools.partial(named_selector, key='L1D'), cores),
+        ((s, interconnect_port(noc['name'], u)) for noc in interconnects for u in noc['_uppers'] for s in noc['_slices'])
     )))
 
 def module_include_files(datas):
@@ -295,9 +355,53 @@ def module_include_files(datas):
 
     yield from (f'#include "{f}"' for _,f in candidates)
 
-def decorate_queues(caches, ptws, pmem):
+registry_adders = {
+    'pref': 'add_prefetcher',
+    'repl': 'add_replacement',
+    'branch': 'add_branch_predictor',
+    'btb': 'add_btb'
+}
+
+def get_module_registry_lines(module_info):
+    '''
+    Generate the lines for a C++ file that adds every compiled module to a ``champsim::modules::registry``.
+
+    :param module_info: a dictionary from module kinds to sequences of module data
+    '''
+    hoisted = {k: sorted(v, key=operator.itemgetter('class')) for k,v in module_info.items()}
+
+    yield from sorted(module_include_files(itertools.filterfalse(operator.methodcaller('get', 'legacy', False), itertools.chain(*hoisted.values()))))
+    yield from cxx.function('champsim::modules::register_compiled_modules', (
+        f'reg.{registry_adders[kind]}<class {data["class"]}>("{data["class"]}");' for kind,datas in hoisted.items() for data in datas
+    ), args=(('champsim::modules::registry&', 'reg'),), rtype='void')
+
+def get_cache_operate_lines(module_pairs):
+    '''
+    Generate the lines for a C++ file that instantiates the cache's operate loop for each pair of prefetchers and replacement policies.
+
+    :param module_pairs: a sequence of pairs of sequences of module data, the prefetchers and the replacement policies of a cache
+    '''
+    hoisted = sorted({(tuple(p['class'] for p in prefs), tuple(r['class'] for r in repls)): (prefs, repls) for prefs,repls in module_pairs}.items())
+
+    datas = itertools.chain.from_iterable(itertools.chain(prefs, repls) for _,(prefs,repls) in hoisted)
+    yield from sorted(module_include_files(itertools.filterfalse(operator.methodcaller('get', 'legacy', False), datas)))
+
+    def model_pair(pref_classes, repl_classes):
+        pref_string = ', '.join(f'class {c}' for c in pref_classes)
+        repl_string = ', '.join(f'class {c}' for c in repl_classes)
+        return f'CACHE::prefetcher_module_model<{pref_string}>, CACHE::replacement_module_model<{repl_string}>'
+
+    yield from (f'template long CACHE::operate_as<{model_pair(*k)}>(CACHE& cache);' for k,_ in hoisted)
+    yield from cxx.function('CACHE::configured_operate', (
+        'return {',
+        *(f'  {{typeid(CACHE::module_refs<{model_pair(*k)}>), &CACHE::operate_as<{model_pair(*k)}>}},' for k,_ in hoisted),
+        '};'
+    ), rtype='std::map<std::type_index, operate_type>')
+
+def decorate_queues(caches, ptws, pmem, interconnects=()):
     return util.chain(
             *({c['name']: cache_queue_defaults(c)} for c in caches),
+            *({n['name']: cache_queue_defaults(n)} for n in interconnects),
             *({p['name']: ptw_queue_defaults(p)} for p in ptws),
             {pmem['name']: {
                     'rq_size':'std::numeric_limits<std::size_t>::max()',
@@ -312,13 +416,13 @@ def decorate_queues(caches, ptws, pmem):
 def get_queue_info(ul_pairs, decoration):
     return [decoration.get(ll) for ll,_ in ul_pairs]
 
-def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
+def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id, interconnects=()):
     '''
     Generate the lines for a C++ file that instantiates a configuration.
     '''
     classname = f'champsim::configured::generated_environment<0x{build_id}>'
-    ul_pairs = get_upper_levels(cores, caches, ptws)
-    queues = get_queue_info(ul_pairs, decorate_queues(caches, ptws, pmem))
+    ul_pairs = get_upper_levels(cores, caches, ptws, interconnects)
+    queues = get_queue_info(ul_pairs, decorate_queues(caches, ptws, pmem, interconnects))
 
     datas = itertools.filterfalse(operator.methodcaller('get', 'legacy', False), itertools.chain(
         *(c['_branch_predictor_data'] for c in cores),
@@ -329,7 +433,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
     yield from module_include_files(datas)
 
     # Get fastest clock period in picoseconds
-    global_clock_period = int(1000000/max(x['frequency'] for x in itertools.chain(cores, caches, ptws, (pmem,))))
+    global_clock_period = int(1000000/max(x['frequency'] for x in itertools.chain(cores, caches, interconnects, ptws, (pmem,))))
 
     channels_head, channels_tail = util.cut((f'champsim::channel{{{queue_fmtstr.format(**v)}}}' for v in queues), n=-1)
     channel_instantiation_body = ('channels{', *(v+',' for v in channels_head), *channels_tail, '},')
@@ -358,6 +462,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
             dram_name=pmem['name'], 
             clock_period=global_clock_period,
             _randomization= '{}' if (isinstance(vmem['randomization'],bool) and vmem['randomization'] == False) else int(vmem['randomization']),
+            _shared=', true' if vmem.get('shared_address_space', False) else '',
             **vmem),
         '},',
     )
@@ -374,6 +479,13 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
         '},'
     )
 
+    interconnect_instantiation_body = (
+        'interconnects {',
+        *get_builder_function_call('champsim::interconnect',
+                                   map(functools.partial(get_interconnect_instantiation, ul_pairs=ul_pairs), interconnects)),
+        '},'
+    )
+
     core_instantiation_body = (
         'cores {',
         *get_builder_function_call('O3_CPU',
@@ -389,6 +501,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
     yield from vmem_instantiation_body
     yield from ptw_instantiation_body
     yield from cache_instantiation_body
+    yield from interconnect_instantiation_body
     yield from core_instantiation_body
     yield '{'
     yield '}'
@@ -408,6 +521,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
         'auto make_ref = [](auto& x){ return std::ref<champsim::operable>(x); };',
         'std::transform(std::begin(cores), std::end(cores), std::back_inserter(retval), make_ref);',
         'std::transform(std::begin(caches), std::end(caches), std::back_inserter(retval), make_ref);',
+        'std::transform(std::begin(interconnects), std::end(interconnects), std::back_inserter(retval), make_ref);',
         'std::transform(std::begin(ptws), std::end(ptws), std::back_inserter(retval), make_ref);',
         'retval.push_back(std::ref<champsim::operable>(DRAM));',
         'return retval;'
@@ -419,6 +533,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem, build_id):
 
 def get_instantiation_header(num_cpus, env, build_id):
     yield '#include "environment.h"'
+    yield '#include "interconnect.h"'
     yield '#include "vmem.h"'
     yield '#include <forward_list>'
     yield 'template <>'
@@ -429,6 +544,7 @@ def get_instantiation_header(num_cpus, env, build_id):
         'VirtualMemory vmem;',
         'std::forward_list<PageTableWalker> ptws;',
         'std::forward_list<CACHE> caches;',
+        'std::forward_list<champsim::interconnect> interconnects;',
         'std::forward_list<O3_CPU> cores;',
 
         'public:',
@@ -87,3 +87,23 @@ def get_makefile_lines(build_id, executable, module_info):
     yield from append_variable('executable_name', exe_basename)
 
     yield ''
+
+def get_batch_makefile_lines(batch_id, executable, build_ids):
+    ''' Generate the lines for an executable that simulates several configurations over a single pass of the traces '''
+    yield from header({
+        'Batch ID': batch_id,
+        'Executable': executable,
+        'Build IDs': tuple(build_ids)
+    })
+    yield ''
+    exe_dirname, exe_basename = os.path.split(os.path.normpath(executable))
+    exe_basename = os.path.join('$(BIN_ROOT)', exe_basename)
+    yield from hard_assign_variable('BIN_ROOT', exe_dirname)
+    yield from hard_assign_variable('build_id', batch_id, targets=[exe_basename])
+
+    batch_flag = '-DCHAMPSIM_BATCH_BUILDS=' + ','.join('0x'+b for b in build_ids)
+    yield from append_variable('override CPPFLAGS', batch_flag, targets=[f'$(OBJ_ROOT)/{batch_id}_main.o', f'$(DEP_ROOT)/{batch_id}_main.d'])
+
+    yield from append_variable('executable_name', exe_basename)
+
+    yield ''
@@ -215,6 +215,140 @@ def extract_element(key, *parents):
 
     return util.chain(*local_elements)
 
+def check_inclusion(caches):
+    '''
+    Ensure that each cache that specifies an inclusion policy names a known one.
+
+    :param caches: an iterable of parsed caches
+    '''
+    for cache in caches:
+        if cache.get('inclusion', 'nine') not in ('nine', 'inclusive', 'exclusive'):
+            raise ValueError(f'Cache {cache["name"]} has unknown inclusion policy "{cache["inclusion"]}"')
+
+def check_coherence(caches):
+    '''
+    Ensure that each cache that specifies a coherence protocol names a known one.
+
+    :param caches: an iterable of parsed caches
+    '''
+    for cache in caches:
+        if cache.get('coherence', 'none') not in ('none', 'mesi', 'moesi'):
+            raise ValueError(f'Cache {cache["name"]} has unknown coherence protocol "{cache["coherence"]}"')
+
+def check_prefetch_throttle(caches):
+    '''
+    Ensure that each cache that specifies a prefetch throttle names a known policy.
+
+    :param caches: an iterable of parsed caches
+    '''
+    for cache in caches:
+        if cache.get('prefetch_throttle', 'none') not in ('none', 'fdp', 'bandwidth'):
+            raise ValueError(f'Cache {cache["name"]} has unknown prefetch throttle "{cache["prefetch_throttle"]}"')
+
+def check_smt(cores):
+    '''
+    Ensure that each core that specifies hardware threads gives a usable number of them, and names known policies.
+
+    :param cores: an iterable of parsed cores
+    '''
+    for core in cores:
+        if not 1 <= core.get('threads', 1) <= 4:
+            raise ValueError(f'Core {core["name"]} must have between 1 and 4 threads')
+        if core.get('smt_fetch_policy', 'icount') not in ('icount', 'round_robin'):
+            raise ValueError(f'Core {core["name"]} has unknown fetch policy "{core["smt_fetch_policy"]}"')
+        if core.get('smt_partitioning', 'shared') not in ('shared', 'partitioned'):
+            raise ValueError(f'Core {core["name"]} has unknown partitioning "{core["smt_partitioning"]}"')
+
+def check_memory_dependence(cores):
+    '''
+    Ensure that each core that specifies a memory dependence policy names a known one.
+
+    :param cores: an iterable of parsed cores
+    '''
+    for core in cores:
+        if core.get('memory_dependence', 'oracle') not in ('oracle', 'wait_all', 'store_sets'):
+            raise ValueError(f'Core {core["name"]} has unknown memory dependence policy "{core["memory_dependence"]}"')
+
+def check_execution_ports(cores):
+    '''
+    Ensure that the execution ports of each core accept known classes of instruction, and that there is at least one port in each group.
+
+    :param cores: an iterable of parsed cores
+    '''
+    op_classes = ('alu', 'fp', 'load', 'store', 'branch')
+    for core in cores:
+        for i, port in enumerate(core.get('execution_ports', [])):
+            name = port.get('name', f'port{i}')
+            if not port.get('ops'):
+                raise ValueError(f'Execution port {name} of core {core["name"]} accepts no instructions')
+            for op in port['ops']:
+                if op not in op_classes:
+                    raise ValueError(f'Execution port {name} of core {core["name"]} accepts unknown class "{op}"')
+            if port.get('count', 1) < 1 or port.get('latency', 1) < 1:
+                raise ValueError(f'Execution port {name} of core {core["name"]} must have a positive count and latency')
+        if 'fp_registers' in core and len(core['fp_registers']) != 2:
+            raise ValueError(f'Core {core["name"]} must give the first and last floating-point registers')
+
+def slice_caches(caches, ptws=None):
+    '''
+    Divide each cache that specifies a number of slices into that many caches, and connect the slices to the upper levels of the
+    original cache through an interconnect. The upper levels may be caches or page table walkers.
+
+    The capacity of the original cache is divided evenly between the slices. All other parameters apply to each slice.
+    The number of slices must be a power of two, so that each slice holds exactly its share of the sets. Otherwise, the sets of
+    each slice would be rounded up to a power of two, and the slices together would be larger than the original cache.
+
+    :param caches: a dictionary of parsed caches, keyed by name
+    :param ptws: a dictionary of parsed page table walkers, keyed by name
+    :returns: the dictionary of caches, with sliced caches replaced, the dictionary of page table walkers, and a list of interconnects
+    '''
+    ptws = ptws or {}
+    sliced = [c for c in caches.values() if 'slices' in c]
+    interconnects = []
+    for cache in sliced:
+        num_slices = int(cache['slices'])
+        if num_slices < 1:
+            raise ValueError(f'Cache {cache["name"]} must have at least one slice')
+        if num_slices & (num_slices - 1) != 0:
+            raise ValueError(f'Cache {cache["name"]} must have a power of two slices, not {num_slices}')
+
+        noc = util.chain(cache.get('interconnect', {}), {'name': f'{cache["name"]}_NOC'})
+        uppers = [c['name'] for c in itertools.chain(caches.values(), ptws.values()) if c.get('lower_level') == cache['name']]
+
+        if 'sets' in cache:
+            sizing = {'sets': max(1, int(cache['sets']) // num_slices)}
+        elif 'log2_sets' in cache:
+            sizing = {'sets': max(1, (1 << int(cache['log2_sets'])) // num_slices)}
+        elif 'size' in cache:
+            sizing = {'size': int(cache['size']) // num_slices}
+        elif 'log2_size' in cache:
+            sizing = {'size': (1 << int(cache['log2_size'])) // num_slices}
+        else:
+            sizing = {'sets': max(1, defaults.llc_sets_factor * len(uppers) // num_slices)}
+
+        slice_keys = util.subdict(cache, ('name', 'slices', 'interconnect', 'sets', 'log2_sets', 'size', 'log2_size'), invert=True)
+        slices = [{'name': f'{cache["name"]}_{i}', **sizing, **slice_keys} for i in range(num_slices)]
+
+        interconnects.append({
+            'topology': 'ring', 'mesh_width': 0, 'hop_latency': 1, 'link_bandwidth': 1, 'buffer_size': 32,
+            **util.subdict(cache, ('frequency', 'rq_size', 'wq_size', 'pq_size', '_queue_factor', '_offset_bits', '_queue_check_full_addr')),
+            **noc,
+            '_uppers': uppers,
+            '_slices': [s['name'] for s in slices]
+        })
+
+        caches = {
+            **{k: (util.chain({'lower_level': noc['name']}, v) if k in uppers else v) for k,v in caches.items() if k != cache['name']},
+            **{s['name']: s for s in slices}
+        }
+        ptws = {k: (util.chain({'lower_level': noc['name']}, v) if k in uppers else v) for k,v in ptws.items()}
+
+    for noc in interconnects:
+        if noc['topology'] not in ('ring', 'mesh'):
+            raise ValueError(f'Interconnect {noc["name"]} has unknown topology "{noc["topology"]}"')
+
+    return caches, ptws, interconnects
+
 class NormalizedConfiguration:
     '''
     The internal representation of a JSON configuration.
@@ -234,7 +368,8 @@ class NormalizedConfiguration:
                 'frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'register_file_size', 'rob_size', 'lq_size',
                 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width',
                 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency',
-                'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB'
+                'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB', 'threads', 'smt_fetch_policy', 'smt_partitioning',
+                'wrong_path', 'ftq_size', 'runahead_width', 'memory_dependence', 'execution_ports', 'fp_registers'
             )
         )
         self.cores = [util.chain(cpu, core_from_config, {'name': f'cpu{i}'}) for i,cpu in enumerate(self.cores)]
@@ -424,14 +559,26 @@ class NormalizedConfiguration:
                 '_branch_predictor_data':
                     [*map(branch_parse, util.wrap_list(c.get('branch_predictor', 'hashed_perceptron')))],
                 '_btb_data':
-                    [*map(btb_parse, util.wrap_list(c.get('btb', 'basic_btb')))]
+                    [*map(btb_parse, util.wrap_list(c.get('btb', 'basic_btb')))],
+
+                # The hardware threads of a core have their own address spaces, unless the address space is shared
+                **({'shared_address_space': True} if vmem.get('shared_address_space', False) else {})
              } for c in cores),
             ).values()
         )
 
+        check_smt(cores)
+        check_memory_dependence(cores)
+        check_execution_ports(cores)
+        check_inclusion(caches.values())
+        check_coherence(caches.values())
+        check_prefetch_throttle(caches.values())
+        caches, ptws, interconnects = slice_caches(caches, ptws)
+
         elements = {
             'cores': cores,
             'caches': tuple(caches.values()),
+            'interconnects': tuple(interconnects),
             'ptws': tuple(ptws.values()),
             'pmem': pmem,
             'vmem': vmem
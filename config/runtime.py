@@ -0,0 +1,257 @@
+#    Copyright 2023 The ChampSim Contributors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+'''
+Resolve a parsed configuration into the description consumed by ``champsim::runtime_environment``.
+
+The description mirrors the generated instantiation file: the same defaults are applied and the same channels are numbered,
+but the values are written as JSON, so that a single executable can simulate it without being recompiled.
+'''
+
+import itertools
+import math
+import re
+
+from . import util
+from .instantiation_file import get_upper_levels, decorate_queues, get_queue_info, interconnect_port
+
+# Keys that are copied unchanged from a parsed element, mapped to their names in the description
+cache_copied_keys = {
+    'size': 'size',
+    'log2_size': 'log2_size',
+    'sets': 'sets',
+    'log2_sets': 'log2_sets',
+    'ways': 'ways',
+    'log2_ways': 'log2_ways',
+    'pq_size': 'pq_size',
+    'mshr_size': 'mshr_size',
+    'latency': 'latency',
+    'hit_latency': 'hit_latency',
+    'fill_latency': 'fill_latency',
+    'max_tag_check': 'tag_bandwidth',
+    'max_fill': 'fill_bandwidth',
+    'prefetch_activate': 'prefetch_activate',
+    'prefetch_as_load': 'prefetch_as_load',
+    'wq_check_full_addr': 'wq_checks_full_addr',
+    'virtual_prefetch': 'virtual_prefetch',
+    'mrc_ways': 'stack_distance_ways',
+    'inclusion': 'inclusion',
+    'coherence': 'coherence',
+    'prefetch_throttle': 'prefetch_throttle'
+}
+
+core_copied_keys = {
+    'ifetch_buffer_size': 'ifetch_buffer_size',
+    'decode_buffer_size': 'decode_buffer_size',
+    'dispatch_buffer_size': 'dispatch_buffer_size',
+    'register_file_size': 'register_file_size',
+    'rob_size': 'rob_size',
+    'lq_size': 'lq_size',
+    'sq_size': 'sq_size',
+    'fetch_width': 'fetch_width',
+    'decode_width': 'decode_width',
+    'dispatch_width': 'dispatch_width',
+    'scheduler_size': 'schedule_width',
+    'execute_width': 'execute_width',
+    'lq_width': 'lq_width',
+    'sq_width': 'sq_width',
+    'retire_width': 'retire_width',
+    'mispredict_penalty': 'mispredict_penalty',
+    'decode_latency': 'decode_latency',
+    'dispatch_latency': 'dispatch_latency',
+    'schedule_latency': 'schedule_latency',
+    'execute_latency': 'execute_latency',
+    'dib_set': 'dib_set',
+    'dib_way': 'dib_way',
+    'dib_window': 'dib_window',
+    'threads': 'threads',
+    'smt_fetch_policy': 'smt_fetch_policy',
+    'smt_partitioning': 'smt_partitioning',
+    'wrong_path': 'wrong_path',
+    'shared_address_space': 'shared_address_space',
+    'ftq_size': 'ftq_size',
+    'runahead_width': 'runahead_width',
+    'memory_dependence': 'memory_dependence',
+    'execution_ports': 'execution_ports',
+    'fp_registers': 'fp_registers'
+}
+
+dib_copied_keys = {
+    'sets': 'dib_set',
+    'ways': 'dib_way',
+    'window_size': 'dib_window'
+}
+
+ptw_copied_keys = {
+    'mshr_size': 'mshr_size',
+    'max_read': 'tag_bandwidth',
+    'max_write': 'fill_bandwidth'
+}
+
+def copied(elem, keys):
+    ''' Select the given keys from the element, renaming them. '''
+    return {v: elem[k] for k,v in keys.items() if k in elem}
+
+def clock_period(elem):
+    ''' The clock period of the element, in picoseconds, if it has a frequency. '''
+    if 'frequency' in elem:
+        return {'clock_period': int(1000000/elem['frequency'])}
+    return {}
+
+def offset_bits(expr, block_size, page_size):
+    '''
+    Evaluate an offset width as written in the generated instantiation file.
+    These are of the form ``champsim::lg2(N)``, where ``N`` may be a number or one of the size constants.
+    '''
+    match = re.fullmatch(r'champsim::lg2\((\w+)\)', str(expr))
+    if match is None:
+        return int(expr)
+    size = {'BLOCK_SIZE': block_size, 'PAGE_SIZE': page_size}.get(match[1], match[1])
+    return int(math.log2(int(size)))
+
+def queue_size(val):
+    ''' Unbounded queues are written as null. '''
+    try:
+        return int(val)
+    except ValueError:
+        return None
+
+def class_names(datas):
+    return [d['class'] for d in datas]
+
+def get_runtime_description(cores, caches, ptws, pmem, vmem, config_file, interconnects=()):
+    '''
+    Produce the description of a configuration, as a JSON-compatible dictionary.
+
+    :param cores, caches, ptws, pmem, vmem, interconnects: the elements of the result of parse.parse_config()
+    :param config_file: the environment of the result of parse.parse_config()
+    '''
+    block_size, page_size = config_file['block_size'], config_file['page_size']
+
+    ul_pairs = get_upper_levels(cores, caches, ptws, interconnects)
+    queues = get_queue_info(ul_pairs, decorate_queues(caches, ptws, pmem, interconnects))
+
+    def upper_levels(name):
+        return [i for i,v in enumerate(ul_pairs) if v[0] == name]
+
+    def channel_to(lower, upper):
+        return ul_pairs.index((lower, upper))
+
+    global_clock_period = int(1000000/max(x['frequency'] for x in itertools.chain(cores, caches, interconnects, ptws, (pmem,))))
+
+    channels = [{
+        'rq_size': queue_size(q['rq_size']),
+        'pq_size': queue_size(q['pq_size']),
+        'wq_size': queue_size(q['wq_size']),
+        'offset_bits': offset_bits(q['_offset_bits'], block_size, page_size),
+        'match_offset_bits': bool(q['_queue_check_full_addr'])
+    } for q in queues]
+
+    dram = {
+        'dbus_period': int(1000000/pmem['data_rate']),
+        'mc_period': int(1000000/pmem['frequency']),
+        'tRP': int(pmem['tRP']),
+        'tRCD': int(pmem['tRCD']),
+        'tCAS': int(pmem['tCAS']),
+        'tRAS': int(pmem['tRAS']),
+        'refresh_period': int(1000*pmem['refresh_period']),
+        'upper_levels': upper_levels(pmem['name']),
+        'rq_size': queue_size(pmem['rq_size']),
+        'wq_size': queue_size(pmem['wq_size']),
+        'channels': int(pmem['channels']),
+        'channel_width': int(pmem['channel_width']),
+        'bank_rows': int(pmem['bank_rows']),
+        'bank_columns': int(pmem['columns']*8 if 'columns' in pmem else pmem['bank_columns']),
+        'ranks': int(pmem['ranks']),
+        'bankgroups': int(pmem['bankgroups']),
+        'banks': int(pmem['banks']),
+        'refreshes_per_period': int(pmem['refreshes_per_period'])
+    }
+
+    randomization = vmem['randomization']
+    vmem_desc = {
+        'pte_page_size': int(vmem['pte_page_size']),
+        'num_levels': int(vmem['num_levels']),
+        'minor_fault_penalty': global_clock_period*int(vmem['minor_fault_penalty']),
+        'randomization': None if (isinstance(randomization, bool) and not randomization) else int(randomization),
+        'shared_address_space': bool(vmem.get('shared_address_space', False))
+    }
+
+    ptw_descs = [{
+        'name': ptw['name'],
+        'cpu': ptw['cpu'],
+        'upper_levels': upper_levels(ptw['name']),
+        'lower_level': channel_to(ptw['lower_level'], ptw['name']),
+        'pscl': [[lvl, ptw[f'pscl{lvl}_set'], ptw[f'pscl{lvl}_way']] for lvl in (5,4,3,2) if f'pscl{lvl}_set' in ptw and f'pscl{lvl}_way' in ptw],
+        **copied(ptw, ptw_copied_keys),
+        **clock_period(ptw)
+    } for ptw in ptws]
+
+    def cache_desc(cache):
+        retval = {
+            'name': cache['name'],
+            'upper_levels': upper_levels(cache['name']),
+            'lower_level': channel_to(cache['lower_level'], cache['name']),
+            'prefetcher': class_names(cache.get('_prefetcher_data', [])),
+            'replacement': class_names(cache.get('_replacement_data', [])),
+            **copied(cache, cache_copied_keys),
+            **clock_period(cache)
+        }
+        if '_defaults' in cache:
+            retval['defaults'] = cache['_defaults'].rpartition('::default_')[2]
+        if '_offset_bits' in cache:
+            retval['offset_bits'] = offset_bits(cache['_offset_bits'], block_size, page_size)
+        if 'lower_translate' in cache:
+            retval['lower_translate'] = channel_to(cache['lower_translate'], cache['name'])
+        if 'mrc_sets' in cache:
+            retval['stack_distance_sets'] = util.wrap_list(cache['mrc_sets'])
+        return retval
+
+    interconnect_descs = [{
+        'name': noc['name'],
+        'topology': noc['topology'],
+        'mesh_width': int(noc['mesh_width']),
+        'hop_latency': int(noc['hop_latency']),
+        'link_bandwidth': int(noc['link_bandwidth']),
+        'buffer_size': int(noc['buffer_size']),
+        'upper_levels': [channel_to(noc['name'], u) for u in noc['_uppers']],
+        'lower_levels': [[channel_to(s, interconnect_port(noc['name'], u)) for s in noc['_slices']] for u in noc['_uppers']],
+        **clock_period(noc)
+    } for noc in interconnects]
+
+    core_descs = [{
+        'index': cpu['_index'],
+        'l1i': cpu['L1I'],
+        'l1d': cpu['L1D'],
+        'fetch_queues': channel_to(cpu['L1I'], cpu['name']),
+        'data_queues': channel_to(cpu['L1D'], cpu['name']),
+        'branch_predictor': class_names(cpu.get('_branch_predictor_data', [])),
+        'btb': class_names(cpu.get('_btb_data', [])),
+        **copied(cpu, core_copied_keys),
+        **copied(cpu.get('DIB', {}), dib_copied_keys),
+        **clock_period(cpu)
+    } for cpu in cores]
+
+    return {
+        'num_cpus': len(cores),
+        'block_size': block_size,
+        'page_size': page_size,
+        'channels': channels,
+        'dram': dram,
+        'vmem': vmem_desc,
+        'ptws': ptw_descs,
+        'caches': [cache_desc(c) for c in caches],
+        'interconnects': interconnect_descs,
+        'cores': core_descs
+    }
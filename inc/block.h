@@ -25,6 +25,7 @@ struct cache_block {
   bool valid = false;
   bool prefetch = false;
   bool dirty = false;
+  bool shared = false; // Other caches may hold the block, so it may not be written without first gaining ownership
 
   champsim::address address{};
   champsim::address v_address{};
@@ -26,12 +26,18 @@
 #include <cstddef> // for size_t
 #include <cstdint> // for uint64_t, uint32_t, uint8_t
 #include <deque>
+#include <functional>
 #include <iterator> // for size
 #include <limits>   // for numeric_limits
+#include <list>
+#include <map>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
+#include <typeindex>
+#include <typeinfo>
 #include <vector>
 
 #include "address.h"
@@ -43,7 +49,10 @@
 #include "channel.h"
 #include "chrono.h"
 #include "modules.h"
+#include "msl/arena.h"
 #include "operable.h"
+#include "prefetch_throttle.h"
+#include "stack_distance.h"
 #include "util/to_underlying.h" // for to_underlying
 #include "waitable.h"
 
@@ -56,6 +65,7 @@ class CACHE : public champsim::operable
   using channel_type = champsim::channel;
   using request_type = typename channel_type::request_type;
   using response_type = typename channel_type::response_type;
+  using snoop_type = typename channel_type::snoop_type;
 
   struct tag_lookup_type {
     champsim::address address;
@@ -70,8 +80,13 @@ class CACHE : public champsim::operable
     access_type type;
     bool prefetch_from_this;
     bool skip_fill;
+    bool clean_victim;
+    bool answers_snoop;
     bool is_translated;
     bool translate_issued = false;
+    bool stashed = false;
+
+    uint64_t sequence = 0; // Orders the entry within the queue that holds it
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
 
@@ -94,12 +109,14 @@ public:
     struct returned_value {
       champsim::address data;
       uint32_t pf_metadata;
+      bool shared = false;
     };
     champsim::waitable<returned_value> data_promise{};
     uint32_t cpu;
 
     access_type type;
     bool prefetch_from_this;
+    bool clean_victim;
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
 
@@ -113,10 +130,16 @@ public:
   };
 
 private:
-  bool try_hit(const tag_lookup_type& handle_pkt);
-  bool handle_fill(const mshr_type& fill_mshr);
+  template <typename Modules>
+  bool try_hit(const tag_lookup_type& handle_pkt, Modules modules);
+  template <typename Modules>
+  bool handle_fill(const mshr_type& fill_mshr, Modules modules);
   bool handle_miss(const tag_lookup_type& handle_pkt);
   bool handle_write(const tag_lookup_type& handle_pkt);
+  bool back_invalidate(champsim::address address);
+  bool handle_snoop(const snoop_type& snoop);
+  bool write_back(const champsim::cache_block& blk, uint32_t triggering_cpu, bool answers_snoop = false);
+  [[nodiscard]] bool hit_must_write_back(const tag_lookup_type& handle_pkt) const;
   void finish_packet(const response_type& packet);
   void finish_translation(const response_type& packet);
 
@@ -127,7 +150,7 @@ public:
 
 private:
   static BLOCK fill_block(mshr_type mshr, uint32_t metadata);
-  using set_type = std::vector<BLOCK>;
+  using set_type = std::vector<BLOCK, champsim::msl::arena_allocator<BLOCK>>;
 
   std::pair<set_type::iterator, set_type::iterator> get_set_span(champsim::address address);
   [[nodiscard]] std::pair<set_type::const_iterator, set_type::const_iterator> get_set_span(champsim::address address) const;
@@ -136,6 +159,25 @@ private:
   template <typename T>
   bool should_activate_prefetcher(const T& pkt) const;
 
+  template <typename T>
+  bool passes_to_upper_level(const T& pkt) const;
+
+  template <typename T>
+  bool requires_ownership(const T& pkt) const;
+
+  // Blocks that an upper level writes are tracked by a directory, with an entry for each block of the cache.
+  // The upper levels are numbered in the order they were given, since the order of upper_levels changes as the cache operates.
+  struct directory_entry {
+    uint64_t sharers = 0; // The upper levels that may hold the block
+    uint64_t owner = 0;   // The upper level that may write the block without asking, if any
+  };
+  std::vector<directory_entry> directory{};
+  std::vector<channel_type*> directory_uppers{};
+
+  [[nodiscard]] uint64_t requesters(const std::vector<std::deque<response_type>*>& to_return) const;
+  bool track_sharers(std::size_t index, champsim::address address, access_type type, uint64_t requested_by);
+  void send_snoops(uint64_t targets, const snoop_type& snoop);
+
   template <bool>
   auto initiate_tag_check(champsim::channel* ul = nullptr);
 
@@ -145,9 +187,24 @@ private:
   auto matches_address(champsim::address address) const;
   std::pair<mshr_type, request_type> mshr_and_forward_packet(const tag_lookup_type& handle_pkt);
 
+  using tag_queue_type = std::list<tag_lookup_type>;
+
   std::deque<tag_lookup_type> internal_PQ{};
-  std::deque<tag_lookup_type> inflight_tag_check{};
-  std::deque<tag_lookup_type> translation_stash{};
+  tag_queue_type inflight_tag_check{};
+  tag_queue_type translation_stash{};
+
+  // Untranslated entries are indexed so that each is visited only when its tag check is ready or its translation returns.
+  // The entries of inflight_tag_check are ordered by the time their tag check would be ready, the entries of both queues by virtual page,
+  // and those whose translation has not been issued by their position in their queue.
+  uint64_t tag_queue_sequence = 0;
+  std::multimap<champsim::chrono::clock::time_point, tag_queue_type::iterator> untranslated_by_ready_time{};
+  std::map<champsim::page_number, std::vector<tag_queue_type::iterator>> awaiting_translation{};
+  std::vector<tag_queue_type::iterator> unissued_inflight{};
+  std::vector<tag_queue_type::iterator> unissued_stash{};
+
+  void index_tag_checks(tag_queue_type::iterator first);
+  void issue_translations();
+  long stash_untranslated();
 
 public:
   std::vector<channel_type*> upper_levels;
@@ -166,8 +223,16 @@ public:
   bool prefetch_as_load;
   bool match_offset_bits;
   bool virtual_prefetch;
+  champsim::inclusion_policy inclusion;
+  champsim::coherence_protocol coherence;
   std::vector<access_type> pref_activate_mask;
 
+  // If present, every tag check is also applied to an LRU stack model of each geometry
+  std::optional<champsim::stack_distance_profiler> stack_distance;
+
+  // If present, the prefetcher is throttled by the feedback of its prefetches
+  std::optional<champsim::prefetch_throttle> throttle;
+
   using stats_type = cache_stats;
 
   stats_type sim_stats, roi_stats;
@@ -252,7 +317,7 @@ public:
   };
 
   template <typename... Ps>
-  struct prefetcher_module_model final : prefetcher_module_concept {
+  struct prefetcher_module_model final : prefetcher_module_concept, champsim::msl::arena_allocated {
     std::tuple<Ps...> intern_;
     explicit prefetcher_module_model(CACHE* cache) : intern_(Ps{cache}...) { (void)cache; /* silence -Wunused-but-set-parameter when sizeof...(Ps) == 0 */ }
     void bind(CACHE* cache)
@@ -271,7 +336,7 @@ public:
   };
 
   template <typename... Rs>
-  struct replacement_module_model final : replacement_module_concept {
+  struct replacement_module_model final : replacement_module_concept, champsim::msl::arena_allocated {
     // Assert that at least one has an update state
     // static_assert(std::disjunction<champsim::is_detected<has_update_state, Rs>...>::value, "At least one replacement policy must update its state");
 
@@ -295,6 +360,36 @@ public:
   std::unique_ptr<prefetcher_module_concept> pref_module_pimpl;
   std::unique_ptr<replacement_module_concept> repl_module_pimpl;
 
+private:
+  /*
+   * The modules invoked by a tag check, a fill, or a cycle.
+   * If the modules are selected at run time, these are the abstract concepts. If they are known at compile time, these are the concrete models,
+   * which are final, so that their hooks may be inlined into the operate loop.
+   */
+  template <typename P, typename R>
+  struct module_refs {
+    P& pref;
+    R& repl;
+  };
+
+  /*
+   * The operate loop is defined in cache.cc, where it is instantiated for the abstract concepts and for each pair of models that the
+   * configurations name. A cache built with any other models calls them through the concepts.
+   */
+  template <typename Modules>
+  long operate_with(Modules modules);
+
+  template <typename P, typename R>
+  static long operate_as(CACHE& cache);
+
+  using operate_type = long (*)(CACHE&);
+  static operate_type find_operate(const std::type_info& modules);
+  static std::map<std::type_index, operate_type> configured_operate();
+
+  operate_type operate_dispatch = &operate_as<prefetcher_module_concept, replacement_module_concept>;
+
+public:
+
   // NOLINTBEGIN(readability-make-member-function-const): legacy modules use non-const hooks
   void impl_prefetcher_initialize() const;
   [[nodiscard]] uint32_t impl_prefetcher_cache_operate(champsim::address addr, champsim::address ip, bool cache_hit, bool useful_prefetch, access_type type,
@@ -315,14 +410,23 @@ public:
   void impl_replacement_final_stats() const;
   // NOLINTEND(readability-make-member-function-const)
 
+  using prefetcher_factory = std::function<std::unique_ptr<prefetcher_module_concept>(CACHE*)>;
+  using replacement_factory = std::function<std::unique_ptr<replacement_module_concept>(CACHE*)>;
+
+  /**
+   * Construct a cache whose modules are selected at run time.
+   * The factories are invoked after the rest of the cache is initialized, so the modules may inspect its geometry.
+   */
+  CACHE(champsim::cache_builder<> b, prefetcher_factory make_prefetcher, replacement_factory make_replacement);
+
   template <typename... Ps, typename... Rs>
   explicit CACHE(champsim::cache_builder<champsim::cache_builder_module_type_holder<Ps...>, champsim::cache_builder_module_type_holder<Rs...>> b)
-      : champsim::operable(b.m_clock_period), upper_levels(b.m_uls), lower_level(b.m_ll), lower_translate(b.m_lt), NAME(b.m_name), NUM_SET(b.get_num_sets()),
-        NUM_WAY(b.get_num_ways()), MSHR_SIZE(b.get_num_mshrs()), PQ_SIZE(b.m_pq_size), HIT_LATENCY(b.get_hit_latency() * b.m_clock_period),
-        FILL_LATENCY(b.get_fill_latency() * b.m_clock_period), OFFSET_BITS(b.m_offset_bits), MAX_TAG(b.get_tag_bandwidth()), MAX_FILL(b.get_fill_bandwidth()),
-        prefetch_as_load(b.m_pref_load), match_offset_bits(b.m_wq_full_addr), virtual_prefetch(b.m_va_pref), pref_activate_mask(b.m_pref_act_mask),
-        pref_module_pimpl(std::make_unique<prefetcher_module_model<Ps...>>(this)), repl_module_pimpl(std::make_unique<replacement_module_model<Rs...>>(this))
+      : CACHE(
+            champsim::cache_builder<>{b},
+            [](CACHE* cache) -> std::unique_ptr<prefetcher_module_concept> { return std::make_unique<prefetcher_module_model<Ps...>>(cache); },
+            [](CACHE* cache) -> std::unique_ptr<replacement_module_concept> { return std::make_unique<replacement_module_model<Rs...>>(cache); })
   {
+    operate_dispatch = find_operate(typeid(module_refs<prefetcher_module_model<Ps...>, replacement_module_model<Rs...>>));
   }
 
   CACHE(const CACHE&) = delete;
@@ -530,6 +634,13 @@ void CACHE::replacement_module_model<Rs...>::impl_replacement_final_stats()
   std::apply([&](auto&... r) { (..., process_one(r)); }, intern_);
 }
 
+inline auto CACHE::matches_address(champsim::address addr) const
+{
+  return [match = addr.slice_upper(OFFSET_BITS), shamt = OFFSET_BITS](const auto& entry) {
+    return entry.address.slice_upper(shamt) == match;
+  };
+}
+
 #ifdef SET_ASIDE_CHAMPSIM_MODULE
 #undef SET_ASIDE_CHAMPSIM_MODULE
 #define CHAMPSIM_MODULE
@@ -22,10 +22,14 @@
 #include <cstdint>
 #include <limits>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include "champsim.h"
 #include "channel.h"
 #include "chrono.h"
+#include "prefetch_throttle.h"
+#include "stack_distance.h"
 #include "util/bits.h"
 #include "util/to_underlying.h"
 
@@ -37,6 +41,26 @@ template <typename... Ts>
 class cache_builder_module_type_holder
 {
 };
+
+/**
+ * The relationship between the contents of a cache and the contents of the caches above it.
+ *
+ * A non-inclusive, non-exclusive (NINE) cache places no constraint on the levels above it. An inclusive cache holds every block held above it,
+ * and it invalidates a block in the levels above it when it evicts that block. An exclusive cache holds only blocks that are not held above it:
+ * it does not fill the blocks that it returns to an upper level, it gives up the blocks that an upper level hits on, and it is filled by the
+ * victims that the upper levels evict.
+ */
+enum class inclusion_policy { nine, inclusive, exclusive };
+
+/**
+ * The protocol by which a shared cache keeps the private caches above it coherent.
+ *
+ * A cache with a protocol holds a directory of the upper levels that may hold each of its blocks. An upper level that writes a block first
+ * gains ownership of it, which invalidates the copies of the other upper levels, and an upper level that reads a block owned by another
+ * takes that ownership away. Under MESI, the former owner writes back its dirty copy. Under MOESI, it keeps the dirty copy in the owned state.
+ */
+enum class coherence_protocol { none, mesi, moesi };
+
 namespace detail
 {
 struct cache_builder_base {
@@ -57,6 +81,12 @@ struct cache_builder_base {
   bool m_pref_load{};
   bool m_wq_full_addr{};
   bool m_va_pref{};
+  inclusion_policy m_inclusion{inclusion_policy::nine};
+  coherence_protocol m_coherence{coherence_protocol::none};
+  prefetch_throttle_policy m_pf_throttle{prefetch_throttle_policy::none};
+
+  std::vector<uint64_t> m_sd_sets{};
+  std::optional<std::size_t> m_sd_ways{};
 
   std::vector<access_type> m_pref_act_mask{access_type::LOAD, access_type::PREFETCH};
   std::vector<champsim::channel*> m_uls{};
@@ -87,6 +117,8 @@ class cache_builder : public detail::cache_builder_base
   uint64_t get_hit_latency() const;
   uint64_t get_fill_latency() const;
   uint64_t get_total_latency() const;
+  std::optional<champsim::stack_distance_profiler> get_stack_distance_profiler() const;
+  std::optional<champsim::prefetch_throttle> get_prefetch_throttle() const;
 
 public:
   cache_builder() = default;
@@ -212,12 +244,44 @@ public:
    */
   self_type& reset_virtual_prefetch();
 
+  /**
+   * Specify the relationship between the contents of this cache and the contents of its upper levels.
+   */
+  self_type& inclusion(inclusion_policy inclusion_);
+
+  /**
+   * Specify the protocol by which this cache keeps its upper levels coherent.
+   */
+  self_type& coherence(coherence_protocol coherence_);
+
+  /**
+   * Specify the policy by which this cache adjusts the aggressiveness of its prefetcher from the feedback of its prefetches.
+   */
+  self_type& prefetch_throttle(prefetch_throttle_policy policy_);
+
   /**
    * Specify the ``access_type`` values that should activate the prefetcher.
    */
   template <typename... Elems>
   self_type& prefetch_activate(Elems... pref_act_elems);
 
+  /**
+   * Specify the ``access_type`` values that should activate the prefetcher, as a list determined at run time.
+   */
+  self_type& prefetch_activate(std::vector<access_type> pref_act_mask_);
+
+  /**
+   * Specify the numbers of sets for which to compute stack distance histograms.
+   * If only the associativity is specified, the cache's own number of sets will be used.
+   */
+  self_type& stack_distance_sets(std::vector<uint64_t>&& sets_);
+
+  /**
+   * Specify the largest associativity to resolve in the stack distance histograms.
+   * If only the numbers of sets are specified, this defaults to four times the cache's own associativity.
+   */
+  self_type& stack_distance_ways(std::size_t ways_);
+
   /**
    * Specify the upper levels to this cache.
    */
@@ -318,6 +382,29 @@ auto champsim::cache_builder<P, R>::get_total_latency() const -> uint64_t
   return std::max(latency, uint64_t{2});
 }
 
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::get_stack_distance_profiler() const -> std::optional<champsim::stack_distance_profiler>
+{
+  if (std::empty(m_sd_sets) && !m_sd_ways.has_value())
+    return std::nullopt;
+
+  std::vector<uint64_t> sets{m_sd_sets};
+  if (std::empty(sets))
+    sets.push_back(get_num_sets());
+  std::transform(std::begin(sets), std::end(sets), std::begin(sets), [](auto x) { return champsim::next_pow2(x); });
+
+  return champsim::stack_distance_profiler{sets, m_sd_ways.value_or(4 * get_num_ways())};
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::get_prefetch_throttle() const -> std::optional<champsim::prefetch_throttle>
+{
+  if (m_pf_throttle == prefetch_throttle_policy::none)
+    return std::nullopt;
+
+  return champsim::prefetch_throttle{m_pf_throttle, std::size_t{get_num_sets()} * get_num_ways()};
+}
+
 template <typename P, typename R>
 auto champsim::cache_builder<P, R>::name(std::string name_) -> self_type&
 {
@@ -485,6 +572,27 @@ auto champsim::cache_builder<P, R>::reset_virtual_prefetch() -> self_type&
   return *this;
 }
 
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::inclusion(inclusion_policy inclusion_) -> self_type&
+{
+  m_inclusion = inclusion_;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::coherence(coherence_protocol coherence_) -> self_type&
+{
+  m_coherence = coherence_;
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::prefetch_throttle(prefetch_throttle_policy policy_) -> self_type&
+{
+  m_pf_throttle = policy_;
+  return *this;
+}
+
 template <typename P, typename R>
 template <typename... Elems>
 auto champsim::cache_builder<P, R>::prefetch_activate(Elems... pref_act_elems) -> self_type&
@@ -493,6 +601,27 @@ auto champsim::cache_builder<P, R>::prefetch_activate(Elems... pref_act_elems) -
   return *this;
 }
 
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::prefetch_activate(std::vector<access_type> pref_act_mask_) -> self_type&
+{
+  m_pref_act_mask = std::move(pref_act_mask_);
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::stack_distance_sets(std::vector<uint64_t>&& sets_) -> self_type&
+{
+  m_sd_sets = std::move(sets_);
+  return *this;
+}
+
+template <typename P, typename R>
+auto champsim::cache_builder<P, R>::stack_distance_ways(std::size_t ways_) -> self_type&
+{
+  m_sd_ways = ways_;
+  return *this;
+}
+
 template <typename P, typename R>
 auto champsim::cache_builder<P, R>::upper_levels(std::vector<champsim::channel*>&& uls_) -> self_type&
 {
@@ -5,9 +5,11 @@
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "channel.h"
 #include "event_counter.h"
+#include "stack_distance.h"
 
 struct cache_stats {
   std::string name;
@@ -17,6 +19,15 @@ struct cache_stats {
   uint64_t pf_useful = 0;
   uint64_t pf_useless = 0;
   uint64_t pf_fill = 0;
+  uint64_t pf_late = 0;      // demands that found their block still being prefetched
+  uint64_t pf_throttled = 0; // prefetches dropped because the prefetcher exceeded the degree its throttle allowed
+
+  // blocks removed because an inclusive lower level evicted them
+  uint64_t back_invalidations = 0;
+
+  // misses on blocks that another upper level has taken or shares, and the snoops that a coherence directory sent
+  uint64_t coherence_misses = 0;
+  uint64_t coherence_snoops = 0;
 
   champsim::stats::event_counter<std::pair<access_type, std::remove_cv_t<decltype(NUM_CPUS)>>> hits = {};
   champsim::stats::event_counter<std::pair<access_type, std::remove_cv_t<decltype(NUM_CPUS)>>> misses = {};
@@ -24,6 +35,8 @@ struct cache_stats {
   champsim::stats::event_counter<std::pair<access_type, std::remove_cv_t<decltype(NUM_CPUS)>>> mshr_return = {};
 
   long total_miss_latency_cycles{};
+
+  std::vector<champsim::stack_distance_histogram> stack_distances{};
 };
 
 cache_stats operator-(cache_stats lhs, cache_stats rhs);
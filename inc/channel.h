@@ -53,6 +53,8 @@ class channel
     bool forward_checked = false;
     bool is_translated = true;
     bool response_requested = true;
+    bool clean_victim = false;  // A write that carries an unmodified block evicted by the upper level
+    bool answers_snoop = false; // A write of a dirty block given up to a snoop, which the lower level may have given up to the same snoop
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
     access_type type{access_type::LOAD};
@@ -74,6 +76,7 @@ class channel
     champsim::address v_address{};
     champsim::address data{};
     uint32_t pf_metadata = 0;
+    bool shared = false; // Other upper levels may hold the block
     std::vector<uint64_t> instr_depend_on_me{};
 
     response(champsim::address addr, champsim::address v_addr, champsim::address data_, uint32_t pf_meta, std::vector<uint64_t> deps)
@@ -83,6 +86,12 @@ class channel
     explicit response(request req) : response(req.address, req.v_address, req.data, req.pf_metadata, req.instr_depend_on_me) {}
   };
 
+  struct snoop {
+    champsim::address address{};
+    bool exclusive = false; // Give up the block, rather than only the ownership of it
+    bool owned = false;     // A dirty block whose ownership is given up may be kept, rather than written back
+  };
+
   template <typename R>
   bool do_add_queue(R& queue, std::size_t queue_size, const typename R::value_type& packet);
 
@@ -95,11 +104,27 @@ class channel
 public:
   using response_type = response;
   using request_type = request;
+  using snoop_type = snoop;
   using stats_type = cache_queue_stats;
 
   std::deque<request_type> RQ{}, PQ{}, WQ{};
   std::deque<response_type> returned{};
 
+  // Blocks that the lower level has evicted and that must be removed from the upper level
+  std::deque<champsim::address> invalidations{};
+
+  // Requests from a coherence directory on behalf of other upper levels
+  std::deque<snoop_type> snoops{};
+
+  // Whether the upper level removes the blocks named in the invalidations and answers the snoops
+  bool invalidations_accepted = false;
+
+  // Whether the lower level should also be written the clean blocks that the upper level evicts
+  bool victims_requested = false;
+
+  // The fraction of the memory data bus that was busy over the last interval that memory measured, passed up from level to level
+  double memory_utilization = 0;
+
   stats_type sim_stats{}, roi_stats{};
 
   channel() = default;
@@ -0,0 +1,82 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CLOCK_SCHEDULE_H
+#define CLOCK_SCHEDULE_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "chrono.h"
+#include "operable.h"
+
+namespace champsim
+{
+/**
+ * The order in which operables are operated as the global clock advances.
+ *
+ * Operables are grouped into clock domains, which share a clock period and are in phase with each other.
+ * On each tick of the global clock, the operables whose time has fallen behind the clock are operated, earliest first,
+ * with ties broken by the order in which the operables were given. Because the periods are fixed, this pattern repeats
+ * after the least common multiple of the periods, and it is computed once when the schedule is constructed.
+ * If that multiple is too long to store, the domains (rather than every operable) are inspected on each tick.
+ *
+ * The global clock must advance by exactly ``time_quantum()`` between calls to ``operate_on()``.
+ */
+class clock_schedule
+{
+public:
+  constexpr static std::size_t max_pattern_length = std::size_t{1} << 16;
+
+  clock_schedule(std::vector<std::reference_wrapper<operable>> operables, chrono::clock::time_point now);
+
+  /**
+   * The smallest clock period among the operables, by which the global clock should advance.
+   */
+  [[nodiscard]] chrono::clock::duration time_quantum() const;
+
+  /**
+   * Operate each operable that is due at the current time of the clock, and return the total progress.
+   */
+  long operate_on(const chrono::clock& clock);
+
+  [[nodiscard]] std::size_t num_domains() const;
+
+  /**
+   * The number of ticks after which the schedule repeats, or zero if the schedule is computed on each tick.
+   */
+  [[nodiscard]] std::size_t pattern_length() const;
+
+private:
+  struct domain {
+    chrono::clock::duration period;
+    chrono::clock::time_point next;
+    std::vector<std::size_t> members;
+  };
+
+  std::vector<std::reference_wrapper<operable>> operables;
+  std::vector<domain> domains{};
+  chrono::clock::duration quantum{chrono::clock::duration::max()};
+
+  std::vector<std::vector<std::size_t>> pattern{};
+  std::size_t pattern_index = 0;
+
+  static std::vector<std::size_t> advance(std::vector<domain>& doms, chrono::clock::time_point now);
+};
+} // namespace champsim
+
+#endif
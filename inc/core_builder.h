@@ -19,14 +19,52 @@
 
 #include <cstdint>
 #include <limits>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "chrono.h"
+#include "instruction.h"
 
 class CACHE;
 class O3_CPU;
 namespace champsim
 {
 class channel;
+
+/**
+ * How a core with several hardware threads chooses the thread to fetch from in each cycle.
+ * Round-robin rotates among the threads that can fetch. ICOUNT favors the thread with the fewest instructions
+ * in the front end and waiting to execute, so that a thread that is stalled does not fill the core.
+ */
+enum class smt_fetch_policy { round_robin, icount };
+
+/**
+ * How the hardware threads of a core divide its reorder buffer, load and store queues, and physical registers.
+ * Shared structures may be filled by any thread. Partitioned structures give each thread an equal share.
+ */
+enum class smt_partitioning { shared, partitioned };
+
+/**
+ * How a core decides when a load may issue ahead of older stores whose addresses are not yet known.
+ * The oracle knows the addresses of all stores when the load is dispatched, and so never violates memory order.
+ * Wait-all holds each load until every older store has executed. Store sets predict which stores a load depends on,
+ * and let the load issue speculatively otherwise.
+ */
+enum class memory_dependence_policy { oracle, wait_all, store_sets };
+
+/**
+ * A group of identical execution ports, each of which accepts instructions of the given classes.
+ * A pipelined port accepts an instruction in every cycle. Otherwise, the port is busy until its instruction finishes.
+ */
+struct execution_port {
+  std::string name{};
+  std::size_t count = 1;
+  std::vector<op_class> ops{};
+  unsigned latency = 1;
+  bool pipelined = true;
+};
+
 template <typename...>
 class core_builder_module_type_holder
 {
@@ -60,6 +98,22 @@ struct core_builder_base {
   champsim::bandwidth::maximum_type m_retire_width{1};
   champsim::bandwidth::maximum_type m_dib_inorder_width{1};
 
+  std::size_t m_ftq_size{};
+  champsim::bandwidth::maximum_type m_runahead_width{1};
+
+  std::size_t m_threads{1};
+  smt_fetch_policy m_smt_fetch{smt_fetch_policy::icount};
+  smt_partitioning m_smt_partitioning{smt_partitioning::shared};
+  bool m_shared_address_space{};
+
+  bool m_wrong_path{};
+
+  memory_dependence_policy m_memory_dependence{memory_dependence_policy::oracle};
+
+  std::vector<execution_port> m_execution_ports{};
+  unsigned m_fp_register_first{1};
+  unsigned m_fp_register_last{0};
+
   unsigned m_dib_hit_latency{};
 
   unsigned m_mispredict_penalty{};
@@ -198,6 +252,69 @@ public:
    */
   self_type& dib_inorder_width(champsim::bandwidth::maximum_type dib_inorder_width_);
 
+  /**
+   * Specify the number of fetch targets that the branch predictor may queue ahead of fetch.
+   * If this is zero, the branch predictor fills the fetch buffer directly.
+   */
+  self_type& ftq_size(std::size_t ftq_size_);
+
+  /**
+   * Specify the number of fetch targets that the branch predictor may add to the fetch target queue in each cycle.
+   */
+  self_type& runahead_width(champsim::bandwidth::maximum_type runahead_width_);
+
+  /**
+   * Specify the number of hardware threads, each of which reads its own trace.
+   */
+  self_type& threads(std::size_t threads_);
+
+  /**
+   * Specify how the hardware threads take turns to fetch.
+   */
+  self_type& smt_fetch(smt_fetch_policy smt_fetch_);
+
+  /**
+   * Specify whether the hardware threads share or partition the reorder buffer, load and store queues, and physical registers.
+   */
+  self_type& smt_partition(smt_partitioning smt_partitioning_);
+
+  /**
+   * Let the hardware threads translate through one address space, as the threads of one process do.
+   */
+  self_type& set_shared_address_space();
+
+  /**
+   * Give each hardware thread its own address space, as if it ran a separate program.
+   */
+  self_type& reset_shared_address_space();
+
+  /**
+   * Fetch and execute down the predicted path after a mispredicted branch, until the branch is resolved.
+   */
+  self_type& set_wrong_path();
+
+  /**
+   * Stall fetch after a mispredicted branch, until the branch is resolved.
+   */
+  self_type& reset_wrong_path();
+
+  /**
+   * Specify how loads are ordered against older stores whose addresses are not yet known.
+   */
+  self_type& memory_dependence(memory_dependence_policy memory_dependence_);
+
+  /**
+   * Specify the execution ports of the core.
+   * If none are given, any ready instructions up to the execute width are executed with the execute latency.
+   */
+  self_type& execution_ports(std::vector<execution_port> execution_ports_);
+
+  /**
+   * Specify the range of trace register numbers that name floating-point and SIMD registers.
+   * Instructions that read or write them, and do not access memory or branch, are classified as floating-point.
+   */
+  self_type& fp_registers(unsigned first, unsigned last);
+
   /**
    * Specify the reset penalty, in cycles, that follows a misprediction.
    * Note that this value is in addition to the cost of restarting the pipeline, which will depend on the number of instructions inflight at the time when the
@@ -423,6 +540,91 @@ auto champsim::core_builder<B, T>::dib_inorder_width(champsim::bandwidth::maximu
   return *this;
 }
 
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::ftq_size(std::size_t ftq_size_) -> self_type&
+{
+  m_ftq_size = ftq_size_;
+  return *this;
+}
+
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::runahead_width(champsim::bandwidth::maximum_type runahead_width_) -> self_type&
+{
+  m_runahead_width = runahead_width_;
+  return *this;
+}
+
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::threads(std::size_t threads_) -> self_type&
+{
+  m_threads = threads_;
+  return *this;
+}
+
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::smt_fetch(smt_fetch_policy smt_fetch_) -> self_type&
+{
+  m_smt_fetch = smt_fetch_;
+  return *this;
+}
+
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::smt_partition(smt_partitioning smt_partitioning_) -> self_type&
+{
+  m_smt_partitioning = smt_partitioning_;
+  return *this;
+}
+
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::set_shared_address_space() -> self_type&
+{
+  m_shared_address_space = true;
+  return *this;
+}
+
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::reset_shared_address_space() -> self_type&
+{
+  m_shared_address_space = false;
+  return *this;
+}
+
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::set_wrong_path() -> self_type&
+{
+  m_wrong_path = true;
+  return *this;
+}
+
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::reset_wrong_path() -> self_type&
+{
+  m_wrong_path = false;
+  return *this;
+}
+
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::memory_dependence(memory_dependence_policy memory_dependence_) -> self_type&
+{
+  m_memory_dependence = memory_dependence_;
+  return *this;
+}
+
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::execution_ports(std::vector<execution_port> execution_ports_) -> self_type&
+{
+  m_execution_ports = std::move(execution_ports_);
+  return *this;
+}
+
+template <typename B, typename T>
+auto champsim::core_builder<B, T>::fp_registers(unsigned first, unsigned last) -> self_type&
+{
+  m_fp_register_first = first;
+  m_fp_register_last = last;
+  return *this;
+}
+
 template <typename B, typename T>
 auto champsim::core_builder<B, T>::mispredict_penalty(unsigned mispredict_penalty_) -> self_type&
 {
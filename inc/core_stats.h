@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "event_counter.h"
 #include "instruction.h"
@@ -14,10 +15,35 @@ struct cpu_stats {
   long long end_instrs = 0;
   long long end_cycles = 0;
   uint64_t total_rob_occupancy_at_branch_mispredict = 0;
+  uint64_t wrong_path_fetched = 0;
+  uint64_t wrong_path_executed = 0;
+  uint64_t memory_order_violations = 0;
+  uint64_t memory_order_replayed = 0;
 
   champsim::stats::event_counter<branch_type> total_branch_types = {};
   champsim::stats::event_counter<branch_type> branch_type_misses = {};
 
+  // The progress of each hardware thread of the core
+  struct thread_stats {
+    long long begin_instrs = 0;
+    long long end_instrs = 0;
+    uint64_t branches = 0;
+    uint64_t branch_misses = 0;
+
+    [[nodiscard]] auto instrs() const { return end_instrs - begin_instrs; }
+  };
+  std::vector<thread_stats> threads = {};
+
+  // The use of each group of execution ports
+  struct port_stats {
+    std::string name;
+    std::size_t count = 0;
+    uint64_t issued = 0;
+    uint64_t busy_cycles = 0; // summed over the ports of the group
+    uint64_t conflicts = 0;   // ready instructions that found every port of the group busy
+  };
+  std::vector<port_stats> ports = {};
+
   [[nodiscard]] auto instrs() const { return end_instrs - begin_instrs; }
   [[nodiscard]] auto cycles() const { return end_cycles - begin_cycles; }
 };
@@ -48,6 +48,7 @@ const auto default_core =
         .sq_width(champsim::bandwidth::maximum_type{2})
         .retire_width(champsim::bandwidth::maximum_type{5})
         .dib_inorder_width(champsim::bandwidth::maximum_type{5}) // assumed
+        .runahead_width(champsim::bandwidth::maximum_type{2})
         .mispredict_penalty(1)
         .schedule_width(champsim::bandwidth::maximum_type{128})
         .decode_latency(1)
@@ -149,6 +149,9 @@ struct DRAM_CHANNEL final : public champsim::operable {
   bool write_mode = false;
   champsim::chrono::clock::time_point dbus_cycle_available{};
 
+  // The time the data bus has carried requests since the memory controller last measured its utilization
+  champsim::chrono::clock::duration dbus_busy{};
+
   std::size_t refresh_row = 0;
   champsim::chrono::clock::time_point last_refresh{};
   std::size_t DRAM_ROWS_PER_REFRESH;
@@ -203,6 +206,11 @@ class MEMORY_CONTROLLER : public champsim::operable
   // data bus period
   champsim::chrono::picoseconds data_bus_period{};
 
+  // The utilization of the data buses is measured over windows of this many data bus periods, and passed to the upper levels
+  constexpr static long UTILIZATION_WINDOW = 1024;
+  champsim::chrono::clock::time_point utilization_measured{};
+  void measure_utilization();
+
 public:
   std::vector<DRAM_CHANNEL> channels;
 
@@ -18,10 +18,13 @@
 #define ENVIRONMENT_H
 
 #include <functional>
+#include <optional>
+#include <tuple>
 #include <vector>
 
 #include "cache.h"
 #include "dram_controller.h"
+#include "msl/arena.h"
 #include "ooo_cpu.h"
 #include "operable.h"
 #include "ptw.h"
@@ -40,7 +43,43 @@ namespace configured
 {
 template <unsigned long long ID>
 struct generated_environment;
-}
+
+/**
+ * A generated environment whose structures are built in an arena of its own.
+ */
+template <typename Env>
+struct in_own_arena {
+  std::optional<msl::huge_page_arena::scope> building{std::in_place, msl::huge_page_arena::make_persistent()};
+  Env env{};
+
+  in_own_arena() { building.reset(); }
+};
+
+/**
+ * A set of generated environments that are simulated side by side over the same traces.
+ * The configurations may differ in any respect except those that are fixed for the whole program.
+ * Each is simulated on a thread of its own, so each takes its memory from an arena of its own.
+ */
+template <unsigned long long... IDs>
+struct batch_environment {
+  static_assert(sizeof...(IDs) > 0);
+
+  constexpr static std::size_t num_cpus = std::get<0>(std::tuple{generated_environment<IDs>::num_cpus...});
+  constexpr static std::size_t block_size = std::get<0>(std::tuple{generated_environment<IDs>::block_size...});
+  constexpr static std::size_t page_size = std::get<0>(std::tuple{generated_environment<IDs>::page_size...});
+
+  static_assert(((generated_environment<IDs>::num_cpus == num_cpus) && ...), "All configurations in a batch must have the same number of cores");
+  static_assert(((generated_environment<IDs>::block_size == block_size) && ...), "All configurations in a batch must have the same block size");
+  static_assert(((generated_environment<IDs>::page_size == page_size) && ...), "All configurations in a batch must have the same page size");
+
+  std::tuple<in_own_arena<generated_environment<IDs>>...> members{};
+
+  std::vector<std::reference_wrapper<environment>> environments()
+  {
+    return std::apply([](auto&... members_) { return std::vector<std::reference_wrapper<environment>>{members_.env...}; }, members);
+  }
+};
+} // namespace configured
 } // namespace champsim
 
 #endif
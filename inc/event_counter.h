@@ -4,12 +4,15 @@
 #include <algorithm>
 #include <cstdint>
 #include <numeric>
+#include <memory>
 #include <type_traits>
 #include <vector>
 
+#include "msl/arena.h"
+
 namespace champsim::stats
 {
-template <typename Key>
+template <typename Key, typename Allocator = champsim::msl::arena_allocator<std::remove_cv_t<Key>>>
 class event_counter
 {
 public:
@@ -17,8 +20,11 @@ public:
   using value_type = long;
 
 private:
-  std::vector<key_type> keys{};
-  std::vector<value_type> values{};
+  template <typename T>
+  using vector_type = std::vector<T, typename std::allocator_traits<Allocator>::template rebind_alloc<T>>;
+
+  vector_type<key_type> keys{};
+  vector_type<value_type> values{};
 
   auto get_iter(key_type key)
   {
@@ -82,29 +88,29 @@ public:
 
   auto total() const { return std::accumulate(std::begin(values), std::end(values), value_type{}); }
 
-  std::vector<key_type> get_keys() const { return keys; }
+  std::vector<key_type> get_keys() const { return {std::begin(keys), std::end(keys)}; }
 
-  event_counter<key_type>& operator+=(const event_counter<key_type>& rhs)
+  event_counter& operator+=(const event_counter& rhs)
   {
     std::transform(std::begin(values), std::end(values), std::cbegin(keys), std::begin(values),
                    [&rhs](auto val, auto key) { return val + rhs.value_or(key, value_type{}); });
     return *this;
   }
 
-  friend auto operator+(event_counter<key_type> lhs, const event_counter<key_type>& rhs)
+  friend auto operator+(event_counter lhs, const event_counter& rhs)
   {
     lhs += rhs;
     return lhs;
   }
 
-  event_counter<key_type>& operator-=(const event_counter<key_type>& rhs)
+  event_counter& operator-=(const event_counter& rhs)
   {
     std::transform(std::begin(values), std::end(values), std::cbegin(keys), std::begin(values),
                    [&rhs](auto val, auto key) { return val - rhs.value_or(key, value_type{}); });
     return *this;
   }
 
-  friend auto operator-(event_counter<key_type> lhs, const event_counter<key_type>& rhs)
+  friend auto operator-(event_counter lhs, const event_counter& rhs)
   {
     lhs -= rhs;
     return lhs;
@@ -17,12 +17,19 @@
 #ifndef INF_STREAM_H
 #define INF_STREAM_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <bzlib.h>
 #include <cassert>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <lzma.h>
 #include <memory>
 #include <zlib.h>
+#include <zstd.h>
 
 namespace champsim
 {
@@ -40,6 +47,39 @@ struct end_deleter {
     delete s;
   }
 };
+
+/*
+ * zstd passes its buffers to each call rather than keeping them in its context.
+ * This adapts a context to the interface of the other libraries, so that the stream buffer can treat them alike.
+ */
+template <typename Ctx>
+struct zstd_stream {
+  Ctx* ctx = nullptr;
+  const uint8_t* next_in = nullptr;
+  std::size_t avail_in = 0;
+  uint8_t* next_out = nullptr;
+  std::size_t avail_out = 0;
+  uint64_t total_in = 0;
+  uint64_t total_out = 0;
+
+  template <typename F>
+  std::size_t step(F&& f)
+  {
+    ZSTD_inBuffer in{next_in, avail_in, 0};
+    ZSTD_outBuffer out{next_out, avail_out, 0};
+    auto ret = f(ctx, &out, &in);
+    next_in += in.pos;
+    avail_in -= in.pos;
+    total_in += in.pos;
+    next_out += out.pos;
+    avail_out -= out.pos;
+    total_out += out.pos;
+    return ret;
+  }
+};
+
+inline std::size_t zstd_free(zstd_stream<ZSTD_CCtx>* s) { return ::ZSTD_freeCCtx(s->ctx); }
+inline std::size_t zstd_free(zstd_stream<ZSTD_DCtx>* s) { return ::ZSTD_freeDCtx(s->ctx); }
 } // namespace detail
 
 struct bzip2_tag_t {
@@ -180,6 +220,96 @@ struct lzma_tag_t {
     return state;
   }
 };
+
+/**
+ * Decompress xz streams on several threads.
+ *
+ * The blocks of a stream are decoded in parallel if the stream records their sizes, as ``xz -T`` does.
+ * Streams of a single block are decoded on the calling thread, as with ``lzma_tag_t``.
+ * liblzma added the threaded decoder in version 5.4, and older versions decode on a single thread.
+ */
+template <uint32_t flags = 0>
+struct lzma_mt_tag_t : lzma_tag_t<flags> {
+  using typename lzma_tag_t<flags>::state_type;
+  using typename lzma_tag_t<flags>::inflate_state_type;
+
+  // The number of threads that each decoder may use. Decoders that are already open keep the number they were given.
+  static inline std::atomic<uint32_t> threads{4}; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+  static inflate_state_type new_inflate_state()
+  {
+#if LZMA_VERSION >= UINT32_C(50040002)
+    inflate_state_type state{new state_type};
+    *state = LZMA_STREAM_INIT;
+    lzma_mt options{};
+    options.flags = flags;
+    options.threads = std::max<uint32_t>(threads, 1);
+    options.memlimit_threading = ::lzma_physmem() / 4;
+    options.memlimit_stop = std::numeric_limits<uint64_t>::max();
+    auto ret = ::lzma_stream_decoder_mt(state.get(), &options);
+    assert(ret == LZMA_OK);
+    return state;
+#else
+    return lzma_tag_t<flags>::new_inflate_state();
+#endif
+  }
+};
+
+/**
+ * Decompress zstd streams.
+ *
+ * A stream may hold several frames, which are decoded in turn. Skippable frames, such as the seek table of a seekable stream, are ignored,
+ * so a reader may begin at the start of any frame.
+ */
+template <int compression = ZSTD_CLEVEL_DEFAULT>
+struct zstd_tag_t {
+  using state_type = detail::zstd_stream<ZSTD_DCtx>;
+  using in_char_type = std::remove_const_t<std::remove_pointer_t<decltype(state_type::next_in)>>;
+  using out_char_type = std::remove_pointer_t<decltype(state_type::next_out)>;
+  using deflate_state_type = std::unique_ptr<detail::zstd_stream<ZSTD_CCtx>,
+                                             detail::end_deleter<detail::zstd_stream<ZSTD_CCtx>, std::size_t, detail::zstd_free>>;
+  using inflate_state_type = std::unique_ptr<state_type, detail::end_deleter<state_type, std::size_t, detail::zstd_free>>;
+  using status_type = status_t;
+
+  static status_type deflate(deflate_state_type& x, bool flush)
+  {
+    auto ret = x->step([flush](auto ctx, auto out, auto in) { return ::ZSTD_compressStream2(ctx, out, in, flush ? ZSTD_e_end : ZSTD_e_continue); });
+    if (::ZSTD_isError(ret)) {
+      return status_type::ERROR;
+    }
+    if (flush && ret == 0) {
+      return status_type::END;
+    }
+    return status_type::CAN_CONTINUE;
+  }
+
+  static status_type inflate(inflate_state_type& x)
+  {
+    auto ret = x->step([](auto ctx, auto out, auto in) { return ::ZSTD_decompressStream(ctx, out, in); });
+    if (::ZSTD_isError(ret)) {
+      return status_type::ERROR;
+    }
+    if (ret == 0) {
+      return status_type::END;
+    }
+    return status_type::CAN_CONTINUE;
+  }
+
+  static deflate_state_type new_deflate_state()
+  {
+    deflate_state_type state{new detail::zstd_stream<ZSTD_CCtx>};
+    state->ctx = ::ZSTD_createCCtx();
+    ::ZSTD_CCtx_setParameter(state->ctx, ZSTD_c_compressionLevel, compression);
+    return state;
+  }
+
+  static inflate_state_type new_inflate_state()
+  {
+    inflate_state_type state{new state_type};
+    state->ctx = ::ZSTD_createDCtx();
+    return state;
+  }
+};
 } // namespace decomp_tags
 
 template <typename Tag, typename StreamType = std::ifstream>
@@ -198,8 +328,10 @@ struct inf_istream {
 
     std::array<strm_in_buf_type, CHUNK> in_buf;
     std::array<char_type, CHUNK> out_buf;
+    std::array<strm_out_buf_type, CHUNK> uns_out_buf; // The decompressor keeps the address of its output, so this must outlive each call
     typename Tag::inflate_state_type strm = Tag::new_inflate_state();
     typename std::add_pointer<IStrm>::type src;
+    bool output_pending = false;
 
   public:
     explicit inf_streambuf(IStrm* in) : src(in) {}
@@ -236,19 +368,11 @@ template <typename T, typename S>
 template <typename I>
 auto inf_istream<T, S>::inf_streambuf<I>::underflow() -> int_type
 {
-  std::array<strm_out_buf_type, std::tuple_size<decltype(out_buf)>::value> uns_out_buf;
-
-  strm->avail_out = uns_out_buf.size();
+  strm->avail_out = CHUNK;
   strm->next_out = uns_out_buf.data();
   do {
-    // Check to see if we have consumed all available input
-    if (strm->avail_in == 0) {
-      // Check to see if the input stream is sane
-      if (src->fail()) {
-        this->setg(this->out_buf.data(), this->out_buf.data(), this->out_buf.data());
-        return base_type::underflow();
-      }
-
+    // Check to see if we have consumed all available input, and if the input stream is sane
+    if (strm->avail_in == 0 && !src->fail()) {
       // Read data from the stream and convert to zlib-appropriate format
       std::array<char_type, std::tuple_size<decltype(in_buf)>::value> sig_in_buf;
       src->read(sig_in_buf.data(), sig_in_buf.size());
@@ -259,17 +383,18 @@ auto inf_istream<T, S>::inf_streambuf<I>::underflow() -> int_type
       // Record that bytes are available in in_buf
       strm->avail_in = static_cast<unsigned>(src->gcount());
       strm->next_in = in_buf.data();
+    }
 
-      // If we failed to get any data
-      if (strm->avail_in == 0) {
-        this->setg(this->out_buf.data(), this->out_buf.data(), this->out_buf.data());
-        return base_type::underflow();
-      }
+    // If we failed to get any data, and the decompressor holds no output for input it has already consumed
+    if (strm->avail_in == 0 && !output_pending) {
+      this->setg(this->out_buf.data(), this->out_buf.data(), this->out_buf.data());
+      return base_type::underflow();
     }
 
     // Perform inflation
     auto result = T::inflate(strm);
     assert(result == T::status_type::CAN_CONTINUE || result == T::status_type::END);
+    output_pending = (strm->avail_out == 0);
   }
   // Repeat until we actually get new output
   while (strm->avail_out == uns_out_buf.size());
@@ -50,6 +50,10 @@ inline constexpr std::array branch_type_names{"BRANCH_DIRECT_JUMP"sv, "BRANCH_IN
 
 namespace champsim
 {
+// The kinds of execution unit an instruction may need. The traces record no opcodes, so the class is inferred from the operands.
+enum class op_class { alu, fp, load, store, branch };
+inline constexpr std::array op_class_names{"alu"sv, "fp"sv, "load"sv, "store"sv, "branch"sv};
+
 template <typename T>
 struct program_ordered {
   using id_type = uint64_t;
@@ -104,9 +108,12 @@ struct ooo_model_instr : champsim::program_ordered<ooo_model_instr> {
   bool branch_mispredicted = false; // A branch can be mispredicted even if the direction prediction is correct when the predicted target is not correct
 
   std::array<uint8_t, 2> asid = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
+  std::size_t thread = 0; // the hardware thread that fetched this instruction
+  bool wrong_path = false; // fetched down the predicted path of a mispredicted branch, and squashed when the branch is resolved
 
   branch_type branch{NOT_BRANCH};
   champsim::address branch_target{};
+  champsim::op_class op{champsim::op_class::alu};
 
   bool dib_checked = false;
   bool fetch_issued = false;
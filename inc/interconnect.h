@@ -0,0 +1,124 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INTERCONNECT_H
+#define INTERCONNECT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "address.h"
+#include "bandwidth.h"
+#include "channel.h"
+#include "chrono.h"
+#include "operable.h"
+
+namespace champsim
+{
+/**
+ * An on-chip network that connects a set of upper levels to the slices of a sliced cache.
+ *
+ * Each upper level and each slice is attached to a stop on a ring or on a two-dimensional mesh. A request from an upper level
+ * travels to the stop of the slice that its block hashes to, and the response travels back. Crossing a link takes a fixed
+ * number of cycles, and each directed link carries a fixed number of messages per cycle, so that messages that share a link
+ * contend for it.
+ *
+ * The slices see one channel for each upper level, and they return responses on the channel that the request arrived on.
+ * The number of requests that each upper level may have in the network is bounded by the buffer size. Back-invalidations from
+ * inclusive slices and snoops from coherence directories travel to the upper levels like responses.
+ */
+class interconnect : public champsim::operable
+{
+public:
+  enum class topology_type { ring, mesh };
+
+  std::string NAME;
+
+  interconnect(std::string name, champsim::chrono::picoseconds clock_period, topology_type topology, std::size_t mesh_width, uint64_t hop_latency,
+               champsim::bandwidth::maximum_type link_bandwidth, std::size_t buffer_size, std::vector<champsim::channel*> upper_levels,
+               std::vector<std::vector<champsim::channel*>> lower_levels);
+
+  void initialize() final;
+  long operate() final;
+  void print_deadlock() final;
+
+  /**
+   * The slice that holds the block of the given address.
+   */
+  [[nodiscard]] std::size_t slice_of(champsim::address addr) const;
+
+  [[nodiscard]] std::size_t num_stops() const;
+  [[nodiscard]] std::size_t upper_stop(std::size_t upper) const;
+  [[nodiscard]] std::size_t slice_stop(std::size_t slice) const;
+
+  /**
+   * The number of links that a message crosses between the given stops.
+   */
+  [[nodiscard]] std::size_t hops(std::size_t from, std::size_t to) const;
+
+private:
+  enum class message_kind { read, write, prefetch, response, invalidation, snoop };
+
+  struct message {
+    message_kind kind;
+    std::size_t upper;
+    std::size_t slice;
+    std::optional<champsim::channel::request_type> request{};
+    std::optional<champsim::channel::response_type> response{};
+    std::size_t destination;
+    champsim::chrono::clock::time_point ready_time{};
+    std::optional<champsim::channel::snoop_type> snoop{};
+  };
+
+  constexpr static std::size_t num_directions = 4;
+
+  const topology_type topology;
+  const std::size_t width;
+  const std::size_t stops;
+  const uint64_t HOP_LATENCY;
+  const champsim::bandwidth::maximum_type LINK_BANDWIDTH;
+  const std::size_t BUFFER_SIZE;
+
+  std::vector<champsim::channel*> upper_levels;
+  std::vector<std::vector<champsim::channel*>> lower_levels;
+
+  std::vector<std::deque<message>> links;
+  std::deque<message> ejecting{};
+  std::vector<std::size_t> in_flight;
+
+  [[nodiscard]] std::size_t num_slices() const;
+
+  /**
+   * The index of the link that leaves the given stop towards the destination
+   */
+  [[nodiscard]] std::size_t next_link(std::size_t from, std::size_t to) const;
+  [[nodiscard]] std::size_t link_end(std::size_t link) const;
+
+  void route(message msg, std::size_t from, champsim::chrono::clock::time_point ready_time);
+  bool deliver(const message& msg);
+
+  long eject();
+  long traverse();
+  long collect_responses();
+  long inject();
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_REGISTRY_H
+#define MODULE_REGISTRY_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "ooo_cpu.h"
+
+namespace champsim::modules
+{
+/**
+ * A table of the modules compiled into this executable, indexed by their class names.
+ *
+ * Each entry produces the same ``*_module_model`` that a generated configuration would instantiate for that module alone,
+ * so a module selected through the registry behaves exactly as one selected at compile time.
+ */
+class registry
+{
+  std::map<std::string, CACHE::prefetcher_factory, std::less<>> prefetchers{};
+  std::map<std::string, CACHE::replacement_factory, std::less<>> replacements{};
+  std::map<std::string, O3_CPU::branch_factory, std::less<>> branch_predictors{};
+  std::map<std::string, O3_CPU::btb_factory, std::less<>> btbs{};
+
+public:
+  template <typename P>
+  void add_prefetcher(std::string name);
+  template <typename R>
+  void add_replacement(std::string name);
+  template <typename B>
+  void add_branch_predictor(std::string name);
+  template <typename T>
+  void add_btb(std::string name);
+
+  /**
+   * Look up the factory for the named modules.
+   * An empty list selects no module. At most one module may be named.
+   *
+   * :throws std::invalid_argument: if a module is not in the registry
+   */
+  [[nodiscard]] CACHE::prefetcher_factory prefetcher(const std::vector<std::string>& names) const;
+  [[nodiscard]] CACHE::replacement_factory replacement(const std::vector<std::string>& names) const;
+  [[nodiscard]] O3_CPU::branch_factory branch_predictor(const std::vector<std::string>& names) const;
+  [[nodiscard]] O3_CPU::btb_factory btb(const std::vector<std::string>& names) const;
+
+  /**
+   * The registry of all modules that were compiled into this executable.
+   */
+  static const registry& compiled();
+};
+
+/**
+ * Add every module compiled into this executable to the registry.
+ * The definition of this function is generated by the configuration script.
+ */
+void register_compiled_modules(registry& reg);
+} // namespace champsim::modules
+
+template <typename P>
+void champsim::modules::registry::add_prefetcher(std::string name)
+{
+  prefetchers.try_emplace(std::move(name),
+                          [](CACHE* cache) -> std::unique_ptr<CACHE::prefetcher_module_concept> { return std::make_unique<CACHE::prefetcher_module_model<P>>(cache); });
+}
+
+template <typename R>
+void champsim::modules::registry::add_replacement(std::string name)
+{
+  replacements.try_emplace(std::move(name), [](CACHE* cache) -> std::unique_ptr<CACHE::replacement_module_concept> {
+    return std::make_unique<CACHE::replacement_module_model<R>>(cache);
+  });
+}
+
+template <typename B>
+void champsim::modules::registry::add_branch_predictor(std::string name)
+{
+  branch_predictors.try_emplace(std::move(name),
+                                [](O3_CPU* cpu) -> std::unique_ptr<O3_CPU::branch_module_concept> { return std::make_unique<O3_CPU::branch_module_model<B>>(cpu); });
+}
+
+template <typename T>
+void champsim::modules::registry::add_btb(std::string name)
+{
+  btbs.try_emplace(std::move(name), [](O3_CPU* cpu) -> std::unique_ptr<O3_CPU::btb_module_concept> { return std::make_unique<O3_CPU::btb_module_model<T>>(cpu); });
+}
+
+#endif
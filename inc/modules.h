@@ -104,6 +104,17 @@ struct prefetcher : public bound_to<CACHE> {
   bool prefetch_line(champsim::address pf_addr, bool fill_this_level, uint32_t prefetch_metadata) const;
   [[deprecated]] bool prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata) const;
 
+  /**
+   * The aggressiveness that the cache's prefetch throttle has chosen, from 1 (the most conservative) to ``champsim::prefetch_throttle::max_level``.
+   * If the cache does not throttle its prefetcher, this is always the greatest level.
+   */
+  [[nodiscard]] unsigned prefetch_aggressiveness() const;
+
+  /**
+   * The prefetcher's own degree, scaled by the aggressiveness that the cache's prefetch throttle has chosen, and no less than 1.
+   */
+  [[nodiscard]] unsigned prefetch_degree(unsigned max_degree) const;
+
   template <typename T, typename... Args>
   static auto initiailize_memory_impl(int) -> decltype(std::declval<T>().prefetcher_initialize(std::declval<Args>()...), std::true_type{});
   template <typename, typename...>
@@ -0,0 +1,181 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MSL_ARENA_H
+#define MSL_ARENA_H
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace champsim::msl
+{
+/**
+ * A region of memory for the long-lived structures of the simulation, such as cache blocks and predictor tables.
+ *
+ * Memory is reserved in chunks that are aligned to, and a multiple of, the size of a huge page on the host.
+ * The chunks are mapped with huge pages if the host has reserved them, and otherwise the host is advised that it may back them with transparent huge pages.
+ * Placing the simulated structures together in this way reduces the number of TLB misses that the host takes while simulating large structures.
+ *
+ * Allocations are carved sequentially from the current chunk. Freed memory is kept for later allocations of the same size and alignment,
+ * but it is neither coalesced nor returned to the host until the arena is destroyed.
+ * The memory reserved is therefore bounded by the sum, over each size and alignment, of the most bytes of that size live at once,
+ * plus the unused tail of each chunk. This suits structures that are built once and live for the whole simulation,
+ * but a workload that frees blocks of one size and allocates blocks of another only grows.
+ *
+ * The arena may be shared between threads, but each allocation takes its lock.
+ * The simulations of a batch each build their structures in an arena of their own (see ``scope``), so that they do not contend for one.
+ */
+class huge_page_arena
+{
+public:
+  constexpr static std::size_t huge_page_size = std::size_t{1} << 21;
+  constexpr static std::size_t default_chunk_size = 32 * huge_page_size;
+
+  explicit huge_page_arena(std::size_t chunk_size = default_chunk_size);
+  ~huge_page_arena();
+
+  huge_page_arena(const huge_page_arena&) = delete;
+  huge_page_arena& operator=(const huge_page_arena&) = delete;
+
+  void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+  void deallocate(void* ptr, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * The number of bytes that have been reserved from the host
+   */
+  [[nodiscard]] std::size_t reserved() const;
+
+  /**
+   * The number of reserved bytes that are backed by pages that the host reserved as huge pages
+   */
+  [[nodiscard]] std::size_t reserved_huge() const;
+
+  /**
+   * The arena used by default for the structures of the simulation.
+   * This is the arena of the innermost ``scope`` on the calling thread, or else the thread's own arena, which is never destroyed.
+   */
+  static huge_page_arena& global();
+
+  /**
+   * Create an arena that, like those of the threads, is never destroyed, so that memory taken from it remains valid wherever it is freed.
+   */
+  static huge_page_arena& make_persistent();
+
+  /**
+   * While an object of this type lives, ``global()`` on the thread that created it gives the arena it was created with.
+   * Allocators remember their arena, so the structures built in its lifetime continue to use that arena on whichever thread runs them.
+   * Scopes must be destroyed in the reverse of the order they were created.
+   */
+  class scope
+  {
+    huge_page_arena* previous;
+
+  public:
+    explicit scope(huge_page_arena& arena);
+    ~scope();
+
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+    scope(scope&&) = delete;
+    scope& operator=(scope&&) = delete;
+  };
+
+private:
+  struct chunk {
+    std::byte* base;
+    std::size_t size;
+    bool mapped;
+    bool huge;
+  };
+
+  const std::size_t chunk_size;
+
+  mutable std::mutex mutex{};
+  std::vector<chunk> chunks{};
+  std::byte* cursor = nullptr;
+  std::byte* chunk_end = nullptr;
+  std::map<std::pair<std::size_t, std::size_t>, std::vector<void*>> free_blocks{};
+
+  static chunk reserve(std::size_t bytes);
+  static void release(const chunk& c);
+  static huge_page_arena*& current(); // The arena of the innermost scope on this thread, if any
+};
+
+/**
+ * An allocator that takes its memory from a huge_page_arena.
+ * Containers that use it keep their contents with the other structures of the simulation.
+ */
+template <typename T>
+class arena_allocator
+{
+  huge_page_arena* arena;
+
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  arena_allocator() noexcept : arena_allocator(huge_page_arena::global()) {}
+  explicit arena_allocator(huge_page_arena& arena_) noexcept : arena(&arena_) {}
+
+  template <typename U>
+  arena_allocator(const arena_allocator<U>& other) noexcept : arena(other.resource()) // NOLINT(google-explicit-constructor): allocators must convert implicitly
+  {
+  }
+
+  [[nodiscard]] huge_page_arena* resource() const noexcept { return arena; }
+
+  T* allocate(std::size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+  void deallocate(T* ptr, std::size_t n) noexcept { arena->deallocate(ptr, n * sizeof(T), alignof(T)); }
+
+  template <typename U>
+  friend bool operator==(const arena_allocator& lhs, const arena_allocator<U>& rhs) noexcept
+  {
+    return lhs.resource() == rhs.resource();
+  }
+
+  template <typename U>
+  friend bool operator!=(const arena_allocator& lhs, const arena_allocator<U>& rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+};
+
+/**
+ * Derive from this class to allocate objects of the derived type in the global arena when they are created with ``new`` (or ``std::make_unique``).
+ * An object deleted where another arena is global leaves its memory to that arena.
+ */
+struct arena_allocated {
+  static void* operator new(std::size_t bytes) { return huge_page_arena::global().allocate(bytes); }
+  static void* operator new(std::size_t bytes, std::align_val_t alignment)
+  {
+    return huge_page_arena::global().allocate(bytes, static_cast<std::size_t>(alignment));
+  }
+  static void operator delete(void* ptr, std::size_t bytes) noexcept { huge_page_arena::global().deallocate(ptr, bytes); }
+  static void operator delete(void* ptr, std::size_t bytes, std::align_val_t alignment) noexcept
+  {
+    huge_page_arena::global().deallocate(ptr, bytes, static_cast<std::size_t>(alignment));
+  }
+};
+} // namespace champsim::msl
+
+#endif
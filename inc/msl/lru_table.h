@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <stdexcept>
 #include <type_traits>
@@ -27,6 +28,7 @@
 #include <vector>
 
 #include "extent.h"
+#include "msl/arena.h"
 #include "msl/bits.h"
 #include "util/detect.h"
 #include "util/span.h"
@@ -66,7 +68,7 @@ constexpr bool cmp_equal(T t, U u) noexcept
 }
 } // namespace detail
 
-template <typename T, typename SetProj = detail::table_indexer<T>, typename TagProj = detail::table_tagger<T>>
+template <typename T, typename SetProj = detail::table_indexer<T>, typename TagProj = detail::table_tagger<T>, typename Allocator = arena_allocator<T>>
 class lru_table
 {
 public:
@@ -77,7 +79,7 @@ private:
     uint64_t last_used = 0;
     value_type data;
   };
-  using block_vec_type = std::vector<block_t>;
+  using block_vec_type = std::vector<block_t, typename std::allocator_traits<Allocator>::template rebind_alloc<block_t>>;
   using diff_type = typename block_vec_type::difference_type;
 
   SetProj set_projection;
@@ -22,9 +22,11 @@
 #undef CHAMPSIM_MODULE
 #endif
 
+#include <algorithm>
 #include <array>
 #include <bitset>
 #include <deque>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -40,8 +42,10 @@
 #include "core_stats.h"
 #include "instruction.h"
 #include "modules.h"
+#include "msl/arena.h"
 #include "operable.h"
 #include "register_allocator.h"
+#include "store_sets.h"
 #include "util/lru_table.h"
 #include "util/to_underlying.h"
 
@@ -69,6 +73,7 @@ struct LSQ_ENTRY : champsim::program_ordered<LSQ_ENTRY> {
   champsim::chrono::clock::time_point ready_time{champsim::chrono::clock::time_point::max()};
 
   std::array<uint8_t, 2> asid = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
+  std::size_t thread = 0;
   bool fetch_issued = false;
 
   uint64_t producer_id = std::numeric_limits<uint64_t>::max();
@@ -110,6 +115,18 @@ public:
   using dib_type = champsim::lru_table<champsim::address, dib_shift, dib_shift>;
   dib_type DIB;
 
+  /**
+   * A run of instructions on the predicted path that lie in one block, waiting to be fetched.
+   * A target ends at the end of its block, or at a branch that is predicted taken.
+   */
+  struct fetch_target {
+    std::size_t thread = 0;
+    champsim::block_number block{};
+    std::deque<ooo_model_instr> instrs{};
+    bool closed = false;
+  };
+  std::deque<fetch_target> FTQ;
+
   // reorder buffer, load/store queue, register file
   std::deque<ooo_model_instr> IFETCH_BUFFER;
   std::deque<ooo_model_instr> DISPATCH_BUFFER;
@@ -134,13 +151,54 @@ public:
 
   champsim::bandwidth::maximum_type L1I_BANDWIDTH, L1D_BANDWIDTH;
 
-  RegisterAllocator reg_allocator{REGISTER_FILE_SIZE};
+  // decoupled front end
+  const std::size_t FTQ_SIZE;
+  champsim::bandwidth::maximum_type RUNAHEAD_WIDTH;
+
+  // simultaneous multithreading
+  const champsim::smt_fetch_policy SMT_FETCH_POLICY;
+  const champsim::smt_partitioning SMT_PARTITIONING;
+
+  // Unless the threads share an address space, the virtual addresses of each thread are told apart by bits above those of any canonical address
+  const bool SHARED_ADDRESS_SPACE;
+  constexpr static unsigned THREAD_ADDRESS_SHIFT = 57;
+
+  // fetch down the predicted path of mispredicted branches
+  const bool WRONG_PATH;
 
-  // branch
-  champsim::chrono::clock::time_point fetch_resume_time{};
+  // order loads against older stores whose addresses are not yet known
+  const champsim::memory_dependence_policy MEMORY_DEPENDENCE;
+  champsim::store_set_predictor store_sets;
+
+  // execution ports, and the time at which each port of each group may next accept an instruction
+  const std::vector<champsim::execution_port> EXECUTION_PORTS;
+  std::vector<std::vector<champsim::chrono::clock::time_point>> port_free_time;
+  const unsigned FP_REGISTER_FIRST, FP_REGISTER_LAST;
+
+  RegisterAllocator reg_allocator;
 
   const long IN_QUEUE_SIZE;
-  std::deque<ooo_model_instr> input_queue;
+
+  /**
+   * The architectural state of one hardware thread.
+   * Each thread reads its own trace into its input queue, and fetch stalls independently on its mispredicted branches.
+   */
+  struct hardware_thread {
+    std::deque<ooo_model_instr> input_queue;
+    champsim::chrono::clock::time_point fetch_resume_time{};
+    long long num_retired = 0;
+    long long begin_phase_instr = 0;
+
+    // While a mispredicted branch is unresolved, the thread fetches down its predicted path
+    bool on_wrong_path = false;
+    champsim::address wrong_path_ip{};
+    std::optional<uint64_t> squash_after{};
+  };
+  std::vector<hardware_thread> threads;
+
+  // Instructions are renumbered in fetch order when several threads share the core, or when the core fetches down the wrong path
+  uint64_t next_instr_id = 0;
+  std::size_t next_fetch_thread = 0;
 
   CacheBus L1I_bus, L1D_bus;
   CACHE* l1i;
@@ -150,7 +208,10 @@ public:
   void begin_phase() final;
   void end_phase(unsigned cpu) final;
 
-  void initialize_instruction();
+  template <typename Modules>
+  void initialize_instruction(Modules modules);
+  std::optional<std::size_t> choose_fetch_thread();
+  long promote_to_ifetch();
   long check_dib();
   long fetch_instruction();
   long promote_to_decode();
@@ -162,25 +223,43 @@ public:
   long complete_inflight_instruction();
   long handle_memory_return();
   long retire_rob();
-
-  bool do_init_instruction(ooo_model_instr& instr);
-  bool do_predict_branch(ooo_model_instr& instr);
+  long retire_threads();
+  long squash_wrong_path();
+
+  void do_init_instruction(ooo_model_instr& instr);
+  template <typename Modules>
+  bool do_predict_branch(ooo_model_instr& instr, Modules modules);
+  bool do_check_branch_prediction(ooo_model_instr& instr, champsim::address predicted_branch_target);
+  [[nodiscard]] champsim::address thread_address(champsim::address vaddr, std::size_t thread) const;
+  [[nodiscard]] bool can_enqueue_fetch(std::size_t thread, champsim::address ip, const champsim::bandwidth& bw) const;
+  void do_enqueue_fetch(ooo_model_instr&& instr, bool ends_target, champsim::bandwidth& bw);
+  ooo_model_instr do_synthesize_wrong_path(std::size_t thread);
+  void do_resolve_branch(const ooo_model_instr& instr);
+  void do_squash(std::size_t thread, uint64_t last_kept);
   void do_check_dib(ooo_model_instr& instr);
   bool do_fetch_instruction(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end);
   void do_dib_update(const ooo_model_instr& instr);
   void do_scheduling(ooo_model_instr& instr);
-  void do_execution(ooo_model_instr& instr);
+  bool do_issue_to_port(ooo_model_instr& instr);
+  void do_execution(ooo_model_instr& instr, champsim::chrono::clock::duration latency);
   void do_memory_scheduling(ooo_model_instr& instr);
   void do_complete_execution(ooo_model_instr& instr);
   void do_sq_forward_to_lq(LSQ_ENTRY& sq_entry, LSQ_ENTRY& lq_entry);
 
+  [[nodiscard]] bool can_issue_load(const LSQ_ENTRY& lq_entry) const;
+  void do_check_memory_order(const LSQ_ENTRY& sq_entry);
+  void do_replay(std::size_t thread, uint64_t first_replayed);
+
   void do_finish_store(const LSQ_ENTRY& sq_entry);
   bool do_complete_store(const LSQ_ENTRY& sq_entry);
   bool execute_load(const LSQ_ENTRY& lq_entry);
+  void do_retire(const ooo_model_instr& instr);
 
   [[nodiscard]] auto roi_instr() const { return roi_stats.instrs(); }
   [[nodiscard]] auto roi_cycle() const { return roi_stats.cycles(); }
   [[nodiscard]] auto sim_instr() const { return num_retired - begin_phase_instr; }
+  [[nodiscard]] auto sim_thread_instr(std::size_t thread) const { return threads.at(thread).num_retired - threads.at(thread).begin_phase_instr; }
+  [[nodiscard]] std::size_t num_threads() const { return std::size(threads); }
   [[nodiscard]] auto sim_cycle() const { return (current_time.time_since_epoch() / clock_period) - sim_stats.begin_cycles; }
 
   void print_deadlock() final;
@@ -204,7 +283,7 @@ public:
   };
 
   template <typename... Bs>
-  struct branch_module_model final : branch_module_concept {
+  struct branch_module_model final : branch_module_concept, champsim::msl::arena_allocated {
     std::tuple<Bs...> intern_;
     explicit branch_module_model(O3_CPU* cpu) : intern_(Bs{cpu}...) { (void)cpu; /* silence -Wunused-but-set-parameter when sizeof...(Bs) == 0 */ }
 
@@ -214,7 +293,7 @@ public:
   };
 
   template <typename... Ts>
-  struct btb_module_model final : btb_module_concept {
+  struct btb_module_model final : btb_module_concept, champsim::msl::arena_allocated {
     std::tuple<Ts...> intern_;
     explicit btb_module_model(O3_CPU* cpu) : intern_(Ts{cpu}...) { (void)cpu; /* silence -Wunused-but-set-parameter when sizeof...(Ts) == 0 */ }
 
@@ -226,6 +305,27 @@ public:
   std::unique_ptr<branch_module_concept> branch_module_pimpl;
   std::unique_ptr<btb_module_concept> btb_module_pimpl;
 
+private:
+  /*
+   * The modules invoked as instructions enter the core.
+   * As in CACHE, these are the abstract concepts when the modules are selected at run time, and the concrete, final models otherwise.
+   */
+  template <typename B, typename T>
+  struct module_refs {
+    B& branch;
+    T& btb;
+  };
+
+  template <typename B, typename T>
+  static void initialize_instruction_as(O3_CPU& core)
+  {
+    core.initialize_instruction(module_refs<B, T>{static_cast<B&>(*core.branch_module_pimpl), static_cast<T&>(*core.btb_module_pimpl)});
+  }
+
+  void (*initialize_instruction_dispatch)(O3_CPU&) = &initialize_instruction_as<branch_module_concept, btb_module_concept>;
+
+public:
+
   // NOLINTBEGIN(readability-make-member-function-const): legacy modules use non-const hooks
   void impl_initialize_branch_predictor() const;
   void impl_last_branch_result(champsim::address ip, champsim::address target, bool taken, uint8_t branch_type) const;
@@ -236,21 +336,23 @@ public:
   [[nodiscard]] std::pair<champsim::address, bool> impl_btb_prediction(champsim::address ip, uint8_t branch_type) const;
   // NOLINTEND(readability-make-member-function-const)
 
+  using branch_factory = std::function<std::unique_ptr<branch_module_concept>(O3_CPU*)>;
+  using btb_factory = std::function<std::unique_ptr<btb_module_concept>(O3_CPU*)>;
+
+  /**
+   * Construct a core whose modules are selected at run time.
+   * The factories are invoked after the rest of the core is initialized.
+   */
+  O3_CPU(champsim::core_builder<> b, branch_factory make_branch_predictor, btb_factory make_btb);
+
   template <typename... Bs, typename... Ts>
   explicit O3_CPU(champsim::core_builder<champsim::core_builder_module_type_holder<Bs...>, champsim::core_builder_module_type_holder<Ts...>> b)
-      : champsim::operable(b.m_clock_period), cpu(b.m_cpu),
-        DIB(b.m_dib_set, b.m_dib_way, {champsim::data::bits{champsim::lg2(b.m_dib_window)}}, {champsim::data::bits{champsim::lg2(b.m_dib_window)}}),
-        LQ(b.m_lq_size), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size), DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
-        REGISTER_FILE_SIZE(b.m_register_file_size), ROB_SIZE(b.m_rob_size), SQ_SIZE(b.m_sq_size), DIB_HIT_BUFFER_SIZE(b.m_dib_hit_buffer_size),
-        FETCH_WIDTH(b.m_fetch_width), DECODE_WIDTH(b.m_decode_width), DISPATCH_WIDTH(b.m_dispatch_width), SCHEDULER_SIZE(b.m_schedule_width),
-        EXEC_WIDTH(b.m_execute_width), DIB_INORDER_WIDTH(b.m_dib_inorder_width), LQ_WIDTH(b.m_lq_width), SQ_WIDTH(b.m_sq_width), RETIRE_WIDTH(b.m_retire_width),
-        BRANCH_MISPREDICT_PENALTY(b.m_mispredict_penalty * b.m_clock_period), DISPATCH_LATENCY(b.m_dispatch_latency * b.m_clock_period),
-        DECODE_LATENCY(b.m_decode_latency * b.m_clock_period), SCHEDULING_LATENCY(b.m_schedule_latency * b.m_clock_period),
-        EXEC_LATENCY(b.m_execute_latency * b.m_clock_period), DIB_HIT_LATENCY(b.m_dib_hit_latency * b.m_clock_period), L1I_BANDWIDTH(b.m_l1i_bw),
-        L1D_BANDWIDTH(b.m_l1d_bw), IN_QUEUE_SIZE(2 * champsim::to_underlying(b.m_fetch_width)), L1I_bus(b.m_cpu, b.m_fetch_queues),
-        L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), branch_module_pimpl(std::make_unique<branch_module_model<Bs...>>(this)),
-        btb_module_pimpl(std::make_unique<btb_module_model<Ts...>>(this))
+      : O3_CPU(
+            champsim::core_builder<>{b},
+            [](O3_CPU* core) -> std::unique_ptr<branch_module_concept> { return std::make_unique<branch_module_model<Bs...>>(core); },
+            [](O3_CPU* core) -> std::unique_ptr<btb_module_concept> { return std::make_unique<btb_module_model<Ts...>>(core); })
   {
+    initialize_instruction_dispatch = &initialize_instruction_as<branch_module_model<Bs...>, btb_module_model<Ts...>>;
   }
 };
 
@@ -369,6 +471,69 @@ std::pair<champsim::address, bool> O3_CPU::btb_module_model<Ts...>::impl_btb_pre
   return return_type{};
 }
 
+template <typename Modules>
+void O3_CPU::initialize_instruction(Modules modules)
+{
+  // Without a fetch target queue, the instructions enter the fetch buffer directly
+  champsim::bandwidth enqueue_bw{
+      FTQ_SIZE > 0 ? RUNAHEAD_WIDTH
+                   : std::min(FETCH_WIDTH, champsim::bandwidth::maximum_type{static_cast<long>(IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER))})};
+
+  // Only one thread fetches in each cycle
+  auto fetch_thread = choose_fetch_thread();
+  if (!fetch_thread.has_value()) {
+    return;
+  }
+
+  auto& thread = threads.at(*fetch_thread);
+  auto& input_queue = thread.input_queue;
+  bool stop_fetch = false;
+  while (current_time >= thread.fetch_resume_time && !stop_fetch && (thread.on_wrong_path || !std::empty(input_queue))
+         && can_enqueue_fetch(*fetch_thread, thread.on_wrong_path ? thread.wrong_path_ip : input_queue.front().ip, enqueue_bw)) {
+    if (thread.on_wrong_path) {
+      auto instr = do_synthesize_wrong_path(*fetch_thread);
+      stop_fetch = instr.branch_prediction; // if predicted taken, then we can't fetch anymore instructions this cycle
+      do_enqueue_fetch(std::move(instr), stop_fetch, enqueue_bw);
+      continue;
+    }
+
+    input_queue.front().thread = *fetch_thread;
+    if (std::size(threads) > 1 || WRONG_PATH) {
+      input_queue.front().instr_id = next_instr_id++;
+    }
+
+    do_init_instruction(input_queue.front());
+    stop_fetch = do_predict_branch(input_queue.front(), modules);
+
+    // Add to IFETCH_BUFFER, or to the fetch target queue
+    do_enqueue_fetch(std::move(input_queue.front()), stop_fetch, enqueue_bw);
+    input_queue.pop_front();
+  }
+}
+
+template <typename Modules>
+bool O3_CPU::do_predict_branch(ooo_model_instr& arch_instr, Modules modules)
+{
+  // handle branch prediction for all instructions as at this point we do not know if the instruction is a branch
+  sim_stats.total_branch_types.increment(arch_instr.branch);
+  auto [predicted_branch_target, always_taken] = modules.btb.impl_btb_prediction(arch_instr.ip, arch_instr.branch);
+  arch_instr.branch_prediction = modules.branch.impl_predict_branch(arch_instr.ip, predicted_branch_target, always_taken, arch_instr.branch) || always_taken;
+  if (!arch_instr.branch_prediction) {
+    predicted_branch_target = champsim::address{};
+  }
+
+  bool stop_fetch = false;
+  if (arch_instr.is_branch) {
+    ++sim_stats.threads.at(arch_instr.thread).branches;
+    stop_fetch = do_check_branch_prediction(arch_instr, predicted_branch_target);
+
+    modules.btb.impl_update_btb(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch);
+    modules.branch.impl_last_branch_result(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch);
+  }
+
+  return stop_fetch;
+}
+
 #ifdef SET_ASIDE_CHAMPSIM_MODULE
 #undef SET_ASIDE_CHAMPSIM_MODULE
 #define CHAMPSIM_MODULE
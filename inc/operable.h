@@ -17,6 +17,8 @@
 #ifndef OPERABLE_H
 #define OPERABLE_H
 
+#include <chrono>
+
 #include "chrono.h"
 
 namespace champsim
@@ -28,6 +30,10 @@ public:
   champsim::chrono::clock::time_point current_time{};
   bool warmup = true;
 
+  // If set, the host time spent operating is accumulated in host_time
+  bool profile_host_time = false;
+  std::chrono::steady_clock::duration host_time{};
+
   operable();
   virtual ~operable() = default;
   explicit operable(champsim::chrono::picoseconds clock_period);
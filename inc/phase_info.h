@@ -17,6 +17,7 @@
 #ifndef PHASE_INFO_H
 #define PHASE_INFO_H
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -38,12 +39,22 @@ struct phase_info {
   std::vector<std::string> trace_names;
 };
 
+struct host_time_stats {
+  std::string name;
+  std::string kind; // The class of the component, or "other" for the components that are not otherwise named
+  std::chrono::nanoseconds time;
+};
+
 struct phase_stats {
   std::string name;
   std::vector<std::string> trace_names;
   std::vector<O3_CPU::stats_type> roi_cpu_stats, sim_cpu_stats;
   std::vector<CACHE::stats_type> roi_cache_stats, sim_cache_stats;
   std::vector<DRAM_CHANNEL::stats_type> roi_dram_stats, sim_dram_stats;
+
+  // The host time taken by the phase, and by each component if their host time was profiled
+  std::chrono::nanoseconds host_elapsed{};
+  std::vector<host_time_stats> host_time{};
 };
 
 } // namespace champsim
@@ -0,0 +1,118 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PREFETCH_THROTTLE_H
+#define PREFETCH_THROTTLE_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * The policies by which a cache adjusts the aggressiveness of its prefetcher.
+ *
+ * ``fdp`` follows Feedback Directed Prefetching (Srinath et al., HPCA 2007), using only the accuracy, lateness, and pollution of the cache's own
+ * prefetches. ``bandwidth`` also consults the utilization of the memory data bus, which every cache in the system sees alike, so that the least
+ * accurate prefetchers give way when memory is saturated and any reasonably accurate prefetcher may grow while memory is idle.
+ */
+enum class prefetch_throttle_policy { none, fdp, bandwidth };
+
+/**
+ * Measures the prefetches of a cache over intervals and chooses the aggressiveness of its prefetcher from them.
+ *
+ * An interval ends when the cache has filled half as many blocks as it holds. Each measurement is the average of the counts of the last
+ * interval and the measurement before it, so that old intervals decay.
+ *
+ * - The accuracy is the fraction of issued prefetches that were used by a demand.
+ * - The lateness is the fraction of useful prefetches that were still in flight when the demand arrived.
+ * - The pollution is the fraction of demand misses to blocks that a prefetch had evicted. Evicted blocks are remembered in a filter of one bit
+ *   per block of the cache.
+ *
+ * The aggressiveness is a level from 1 (the most conservative) to ``max_level``. The cache allows its prefetcher ``2^(level-1)`` prefetches for
+ * each access that activates it, except at the greatest level, which is unlimited. Prefetchers may also scale their own degree by the level.
+ */
+class prefetch_throttle
+{
+public:
+  constexpr static unsigned max_level = 5;
+
+  constexpr static double accuracy_high = 0.75;
+  constexpr static double accuracy_low = 0.40;
+  constexpr static double lateness_threshold = 0.01;
+  constexpr static double pollution_threshold = 0.005;
+  constexpr static double utilization_high = 0.75;
+  constexpr static double utilization_low = 0.40;
+
+  struct counts {
+    double issued = 0;
+    double useful = 0;
+    double late = 0;
+    double polluting = 0;
+    double demand_misses = 0;
+  };
+
+private:
+  prefetch_throttle_policy policy;
+  uint64_t interval_length;
+  uint64_t interval_fills = 0;
+  counts interval{};
+  counts measured{};
+  std::vector<bool> pollution_filter;
+  unsigned m_level = max_level;
+  uint64_t remaining_budget = std::numeric_limits<uint64_t>::max();
+  double m_utilization = 0;
+
+  [[nodiscard]] std::size_t filter_index(uint64_t block) const;
+  void end_interval();
+
+public:
+  /**
+   * :param policy: The policy by which to choose the aggressiveness. This should not be ``none``.
+   * :param blocks: The number of blocks that the cache holds.
+   */
+  prefetch_throttle(prefetch_throttle_policy policy, std::size_t blocks);
+
+  void prefetch_issued();
+  void prefetch_useful();
+  void prefetch_late();
+  void demand_miss(uint64_t block);
+  void evicted_by_prefetch(uint64_t block);
+  void block_filled();
+  void observe_utilization(double utilization);
+
+  /**
+   * Begin the allowance of prefetches for an access that activates the prefetcher.
+   */
+  void activate();
+
+  /**
+   * Take one prefetch from the allowance, if any remains.
+   */
+  bool permit();
+
+  [[nodiscard]] unsigned level() const;
+  [[nodiscard]] unsigned degree(unsigned max_degree) const;
+
+  [[nodiscard]] double accuracy() const;
+  [[nodiscard]] double lateness() const;
+  [[nodiscard]] double pollution() const;
+  [[nodiscard]] double utilization() const;
+};
+} // namespace champsim
+
+#endif
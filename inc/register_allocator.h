@@ -3,6 +3,7 @@
 #include <list>
 #include <optional>
 #include <queue>
+#include <vector>
 
 #ifndef REG_ALLOC_H
 #define REG_ALLOC_H
@@ -14,27 +15,39 @@ struct physical_register {
   uint64_t producing_instruction_id;
   bool valid; // has the producing instruction committed yet?
   bool busy;  // is this register in use anywhere in the pipeline?
+  std::size_t thread = 0; // the hardware thread that holds this register
 };
 
 class RegisterAllocator
 {
 private:
-  std::array<PHYSICAL_REGISTER_ID, std::numeric_limits<uint8_t>::max() + 1> frontend_RAT, backend_RAT;
+  using rat_type = std::array<PHYSICAL_REGISTER_ID, std::numeric_limits<uint8_t>::max() + 1>;
+
+  // Each hardware thread renames through its own tables
+  std::vector<rat_type> frontend_RAT, backend_RAT;
   std::queue<PHYSICAL_REGISTER_ID> free_registers;
   std::vector<physical_register> physical_register_file;
 
+  // The number of registers each thread may hold, and the number it holds
+  unsigned long thread_quota;
+  std::vector<unsigned long> held;
+
+  PHYSICAL_REGISTER_ID allocate(int16_t reg, std::size_t thread);
+
 public:
-  RegisterAllocator(size_t num_physical_registers);
-  PHYSICAL_REGISTER_ID rename_dest_register(int16_t reg, champsim::program_ordered<ooo_model_instr>::id_type producer_id);
-  PHYSICAL_REGISTER_ID rename_src_register(int16_t reg);
+  explicit RegisterAllocator(size_t num_physical_registers, std::size_t num_threads = 1, bool partitioned = false);
+  PHYSICAL_REGISTER_ID rename_dest_register(int16_t reg, champsim::program_ordered<ooo_model_instr>::id_type producer_id, std::size_t thread = 0);
+  PHYSICAL_REGISTER_ID rename_src_register(int16_t reg, std::size_t thread = 0);
   void complete_dest_register(PHYSICAL_REGISTER_ID physreg);
+  void replay_dest_register(PHYSICAL_REGISTER_ID physreg);
   void retire_dest_register(PHYSICAL_REGISTER_ID physreg);
   void free_register(PHYSICAL_REGISTER_ID physreg);
   bool isValid(PHYSICAL_REGISTER_ID physreg) const;
-  bool isAllocated(PHYSICAL_REGISTER_ID archreg) const;
-  unsigned long count_free_registers() const;
+  bool isAllocated(PHYSICAL_REGISTER_ID archreg, std::size_t thread = 0) const;
+  unsigned long count_free_registers(std::size_t thread = 0) const;
   int count_reg_dependencies(const ooo_model_instr& instr) const;
   void reset_frontend_RAT();
+  void squash(champsim::program_ordered<ooo_model_instr>::id_type last_kept, std::size_t thread = 0);
   void print_deadlock();
 };
 #endif
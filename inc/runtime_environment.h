@@ -0,0 +1,80 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RUNTIME_ENVIRONMENT_H
+#define RUNTIME_ENVIRONMENT_H
+
+#include <forward_list>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json_fwd.hpp>
+
+#include "cache.h"
+#include "channel.h"
+#include "dram_controller.h"
+#include "environment.h"
+#include "interconnect.h"
+#include "module_registry.h"
+#include "ooo_cpu.h"
+#include "ptw.h"
+#include "vmem.h"
+
+namespace champsim
+{
+/**
+ * An environment that is assembled when the program starts, rather than generated when the program is configured.
+ *
+ * The description is a configuration that has already been resolved by ``config.sh --emit-runtime``:
+ * every default has been applied and every connection between elements has been numbered.
+ * Modules are looked up by class name in the given registry.
+ *
+ * The number of cores, the block size, and the page size are fixed for the whole program, and the description must agree with them.
+ */
+class runtime_environment final : public environment
+{
+  std::vector<champsim::channel> channels;
+  MEMORY_CONTROLLER DRAM;
+  VirtualMemory vmem;
+  std::forward_list<PageTableWalker> ptws;
+  std::forward_list<CACHE> caches;
+  std::forward_list<champsim::interconnect> interconnects;
+  std::forward_list<O3_CPU> cores;
+
+public:
+  /**
+   * :throws std::invalid_argument: if the description does not agree with this executable, or names a module that is not compiled in
+   */
+  explicit runtime_environment(const nlohmann::json& description, const modules::registry& registry = modules::registry::compiled());
+
+  std::vector<std::reference_wrapper<O3_CPU>> cpu_view() final;
+  std::vector<std::reference_wrapper<CACHE>> cache_view() final;
+  std::vector<std::reference_wrapper<PageTableWalker>> ptw_view() final;
+  MEMORY_CONTROLLER& dram_view() final;
+  std::vector<std::reference_wrapper<operable>> operable_view() final;
+};
+
+/**
+ * Assemble an environment from the resolved configuration description in the given file.
+ *
+ * :throws std::invalid_argument: if the file cannot be read, or the description cannot be assembled
+ */
+std::unique_ptr<runtime_environment> load_runtime_environment(const std::string& filename,
+                                                              const modules::registry& registry = modules::registry::compiled());
+} // namespace champsim
+
+#endif
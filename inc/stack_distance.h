@@ -0,0 +1,107 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * The distribution of LRU stack distances observed by a cache with a given number of sets.
+ *
+ * By the inclusion property of LRU, an access with stack distance ``d`` hits in every cache of that set count with more than ``d`` ways.
+ * The histogram therefore yields the miss ratio for every associativity up to ``size(distances)``.
+ */
+struct stack_distance_histogram {
+  uint64_t sets = 0;
+  std::vector<uint64_t> distances{}; // distances[d] is the number of accesses with stack distance d
+  uint64_t beyond = 0;               // accesses whose stack distance is at least size(distances)
+  uint64_t cold = 0;                 // first accesses to a block
+
+  [[nodiscard]] uint64_t accesses() const;
+  [[nodiscard]] uint64_t hits(std::size_t ways) const;
+  [[nodiscard]] uint64_t misses(std::size_t ways) const;
+};
+
+stack_distance_histogram operator-(stack_distance_histogram lhs, const stack_distance_histogram& rhs);
+
+/**
+ * A single LRU stack of unbounded depth.
+ *
+ * Each block is stamped with the position of its most recent access, and a Fenwick tree over the positions counts the live stamps.
+ * The stack distance of an access is then the number of live stamps newer than the block's own, found in logarithmic time.
+ * Positions are renumbered when they are exhausted, so the tree stays proportional to the number of distinct blocks.
+ */
+class lru_stack
+{
+  std::unordered_map<uint64_t, std::size_t> last_position{};
+  std::vector<long> tree{};
+  std::size_t next_position = 0;
+
+  void mark(std::size_t position, long delta);
+  [[nodiscard]] long count_through(std::size_t position) const;
+  void compact();
+
+public:
+  /**
+   * Access the given block, moving it to the top of the stack.
+   *
+   * :return: The number of distinct blocks accessed since the previous access to this block, or ``std::nullopt`` if it was never accessed before.
+   */
+  std::optional<std::size_t> access(uint64_t block);
+
+  [[nodiscard]] std::size_t size() const;
+};
+
+/**
+ * Computes stack distance histograms for several cache geometries in a single pass over an access stream.
+ */
+class stack_distance_profiler
+{
+  struct geometry {
+    uint64_t sets;
+    std::vector<lru_stack> stacks;
+  };
+
+  std::vector<geometry> geometries{};
+  std::size_t max_ways;
+
+public:
+  /**
+   * :param set_counts: The numbers of sets to model. Each must be a power of two.
+   * :param max_ways: The largest associativity to resolve
+   */
+  stack_distance_profiler(const std::vector<uint64_t>& set_counts, std::size_t max_ways);
+
+  /**
+   * Produce a set of empty histograms, one for each modeled geometry.
+   */
+  [[nodiscard]] std::vector<stack_distance_histogram> empty_histograms() const;
+
+  /**
+   * Record an access to the given block number.
+   * The histograms must have been produced by ``empty_histograms()``.
+   */
+  void access(uint64_t block, std::vector<stack_distance_histogram>& histograms);
+};
+} // namespace champsim
+
+#endif
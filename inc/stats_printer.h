@@ -47,5 +47,6 @@ class json_printer
 public:
   json_printer(std::ostream& str) : stream(str) {}
   void print(std::vector<phase_stats>& stats);
+  void print(std::vector<std::vector<phase_stats>>& stats);
 };
 } // namespace champsim
@@ -0,0 +1,80 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STORE_SETS_H
+#define STORE_SETS_H
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "address.h"
+
+namespace champsim
+{
+/**
+ * A store-set memory dependence predictor, after Chrysos and Emer (ISCA 1998).
+ *
+ * The store set identifier table (SSIT) maps the address of each load and store to the store set it belongs to, and the last fetched
+ * store table (LFST) holds the youngest store of each set that has not yet executed. A load waits for the store of its set, and a load
+ * and a store that violate memory order are placed in the same set. The SSIT is cleared periodically, so that sets do not grow without bound.
+ */
+class store_set_predictor
+{
+public:
+  using id_type = uint64_t;
+
+  store_set_predictor(std::size_t ssit_size, std::size_t lfst_size, uint64_t clear_interval);
+
+  /**
+   * Look up a load as it is dispatched.
+   *
+   * :return: The instruction ID of the store that the load should wait for, if any.
+   */
+  std::optional<id_type> dispatch_load(champsim::address ip);
+
+  /**
+   * Record a store as it is dispatched, so that later loads of its set wait for it.
+   */
+  void dispatch_store(champsim::address ip, id_type instr_id);
+
+  /**
+   * Record that a store has executed, so that later loads of its set need not wait for it.
+   */
+  void execute_store(champsim::address ip, id_type instr_id);
+
+  /**
+   * Place a load and a store that violated memory order in the same set.
+   */
+  void violation(champsim::address load_ip, champsim::address store_ip);
+
+  [[nodiscard]] std::optional<std::size_t> set_of(champsim::address ip) const;
+
+private:
+  static constexpr std::size_t no_set = std::numeric_limits<std::size_t>::max();
+
+  std::vector<std::size_t> ssit;
+  std::vector<std::optional<id_type>> lfst;
+  uint64_t clear_interval;
+  uint64_t accesses = 0;
+
+  [[nodiscard]] std::size_t index(champsim::address ip) const;
+  void count_access();
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYNTHETIC_TRACE_H
+#define SYNTHETIC_TRACE_H
+
+#include <cstdint>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "instruction.h"
+
+namespace champsim::synthetic
+{
+enum class pattern { stream, stride, pointer_chase, gups, branchy, mix };
+
+/**
+ * The parameters of a synthetic workload.
+ *
+ * Every memory access falls within ``footprint`` bytes, so the working set is known exactly.
+ */
+struct parameters {
+  pattern kind = pattern::stream;
+  uint64_t footprint = 1 << 20;
+  uint64_t stride = 0; // The distance between successive accesses of the stream and stride patterns, or 0 for the pattern's default
+  double mispredict = 0; // The fraction of conditional branches that go against their bias
+  double loads = 0.25;   // The fractions of the mix pattern's instructions that are loads, stores, and branches
+  double stores = 0.1;
+  double branches = 0.15;
+  uint64_t length = 0; // The number of instructions before the workload ends, or 0 if it never ends
+  uint64_t seed = 1;
+};
+
+/**
+ * The prefix that names a synthetic workload in place of a trace path.
+ */
+constexpr std::string_view prefix{"synthetic:"};
+
+[[nodiscard]] bool is_synthetic(std::string_view name);
+
+/**
+ * Parse a workload of the form ``synthetic:<pattern>[,<key>=<value>]...``.
+ *
+ * The keys are the names of the members of ``parameters``. Sizes may have a suffix of ``k``, ``M``, or ``G``, which are powers of two.
+ */
+parameters parse(std::string_view name);
+
+/**
+ * Generates the instructions of a synthetic workload.
+ *
+ * The workload is a loop whose body is fixed when the generator is constructed, so that each instruction address always holds the same kind
+ * of instruction. The addresses of memory accesses and the directions of conditional branches vary from one iteration to the next.
+ * This type satisfies the requirements of ``champsim::tracereader``.
+ */
+class generator
+{
+public:
+  enum class slot_kind { alu, load, store, branch, loop };
+
+  constexpr static uint64_t code_base = 0x400000;
+  constexpr static uint64_t data_base = 0x10000000;
+
+private:
+  uint8_t cpu;
+  parameters params;
+  std::vector<slot_kind> program;
+  std::vector<uint64_t> chase_next{}; // The successor of each block in the pointer chase, a single cycle through the footprint
+  std::mt19937_64 rng;
+
+  std::size_t pc = 0;
+  uint64_t next_address = 0;
+  uint64_t emitted = 0;
+
+  uint64_t address_for(slot_kind kind);
+
+public:
+  generator(uint8_t cpu_idx, parameters params_);
+
+  ooo_model_instr operator()();
+  [[nodiscard]] bool eof() const;
+
+  [[nodiscard]] const std::vector<slot_kind>& body() const { return program; }
+};
+} // namespace champsim::synthetic
+
+#endif
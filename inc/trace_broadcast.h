@@ -0,0 +1,175 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRACE_BROADCAST_H
+#define TRACE_BROADCAST_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "instruction.h"
+#include "tracereader.h"
+
+namespace champsim
+{
+/**
+ * Decodes a single trace once and distributes the instruction stream to several consumers.
+ *
+ * A producer thread reads the source in batches and appends them to a bounded buffer.
+ * Each subscriber keeps its own cursor into the buffer, and a batch is released once every subscriber has moved past it.
+ * The producer stalls when the buffer is full, so the slowest subscriber bounds the memory in use.
+ *
+ * Subscribers that are consumed on the same thread, such as the cores of one simulation that run the same trace, cannot wait for each other.
+ * When one of them would wait on a full buffer, a broadcaster that can reopen its trace grows the buffer instead, up to its pinned capacity,
+ * so that the batches the others have not yet taken are kept for them.
+ * Beyond that, it evicts the subscribers furthest behind. An evicted subscriber finishes the batch it holds,
+ * then continues on a private reader of its own, which decodes the trace again on the subscriber's thread.
+ */
+class trace_broadcaster
+{
+public:
+  using batch_type = std::vector<ooo_model_instr>;
+
+  constexpr static std::size_t default_batch_size = 1024;
+  constexpr static std::size_t default_capacity = 64;
+  constexpr static std::size_t default_pinned_capacity = 4 * default_capacity;
+
+private:
+  constexpr static uint64_t detached = std::numeric_limits<uint64_t>::max();
+  constexpr static uint64_t evicted = detached - 1;
+
+  struct shared_state {
+    std::mutex mtx{};
+    std::condition_variable produced{};
+    std::condition_variable consumed{};
+
+    std::deque<std::shared_ptr<const batch_type>> batches{};
+    uint64_t first_batch = 0;        // The sequence number of batches.front()
+    uint64_t first_instr = 0;        // The number of instructions in the batches before batches.front()
+    std::vector<uint64_t> cursors{}; // The sequence number of the next batch each subscriber will take
+    std::size_t capacity;
+    std::size_t pinned_capacity; // The size to which the buffer may grow before a subscriber is evicted
+    std::size_t evictions = 0;
+    std::function<tracereader()> reopen;
+    bool source_eof = false;
+    bool stopping = false;
+
+    shared_state(std::size_t cap, std::size_t pinned_cap, std::function<tracereader()> reopen_)
+        : capacity(cap), pinned_capacity(pinned_cap), reopen(std::move(reopen_))
+    {
+    }
+
+    void release_consumed(); // requires mtx to be held
+    void evict_oldest();     // requires mtx to be held
+  };
+
+  std::shared_ptr<shared_state> state;
+  std::thread producer{};
+
+  void stop(); // Stop the producer and wait for it to finish
+
+public:
+  /**
+   * A consumer's view of the broadcast stream.
+   * This type satisfies the requirements of ``champsim::tracereader``.
+   */
+  class subscriber
+  {
+    std::shared_ptr<shared_state> state;
+    std::size_t id;
+
+    mutable std::shared_ptr<const batch_type> current{};
+    mutable std::size_t position = 0;
+    mutable uint64_t to_skip = 0;
+    mutable uint64_t taken = 0; // The number of instructions in the batches taken so far
+    mutable std::optional<tracereader> private_source{};
+
+    bool fetch() const;
+    bool fetch_private() const;
+
+  public:
+    subscriber(std::shared_ptr<shared_state> state_, std::size_t id_, uint64_t offset);
+    subscriber(const subscriber&) = delete;
+    subscriber& operator=(const subscriber&) = delete;
+    subscriber(subscriber&& other) noexcept;
+    subscriber& operator=(subscriber&& other) noexcept;
+    ~subscriber();
+
+    ooo_model_instr operator()();
+    [[nodiscard]] bool eof() const;
+  };
+
+  /**
+   * Begin decoding the given trace.
+   * All subscribers must be created before the first instruction is consumed.
+   *
+   * :param source: The reader to decode from
+   * :param batch_size: The number of instructions the producer reads at a time
+   * :param capacity: The maximum number of batches held in the buffer
+   */
+  explicit trace_broadcaster(tracereader&& source, std::size_t batch_size = default_batch_size, std::size_t capacity = default_capacity);
+
+  /**
+   * Begin decoding the trace given by a function that opens it.
+   * The function is called again for each subscriber that is evicted.
+   *
+   * :param open: A function that opens the trace from its beginning
+   * :param batch_size: The number of instructions the producer reads at a time
+   * :param capacity: The number of batches the producer reads ahead of the subscribers
+   * :param pinned_capacity: The number of batches held for the subscribers furthest behind before they are evicted
+   */
+  explicit trace_broadcaster(std::function<tracereader()> open, std::size_t batch_size = default_batch_size, std::size_t capacity = default_capacity,
+                             std::size_t pinned_capacity = default_pinned_capacity);
+  trace_broadcaster(trace_broadcaster&&) = default;
+  trace_broadcaster& operator=(trace_broadcaster&& other) noexcept;
+  ~trace_broadcaster();
+
+  /**
+   * Create a new cursor into the stream, starting from the oldest batch still held.
+   *
+   * :param offset: The number of instructions to skip, so that subscribers that run alongside each other need not run in lockstep
+   */
+  subscriber subscribe(uint64_t offset = 0);
+
+  /**
+   * The number of subscribers that have been evicted and decode the trace on their own.
+   */
+  [[nodiscard]] std::size_t evictions() const;
+};
+
+/**
+ * The source of one hardware thread's trace, and the number of instructions it skips.
+ */
+struct trace_subscription {
+  std::size_t source;
+  uint64_t offset = 0;
+};
+
+/**
+ * Subscribe once to the given sources for each entry of the plan.
+ */
+std::vector<tracereader> subscribe(std::vector<trace_broadcaster>& sources, const std::vector<trace_subscription>& plan);
+} // namespace champsim
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRACE_PROFILE_H
+#define TRACE_PROFILE_H
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "instruction.h"
+#include "stack_distance.h"
+#include "tracereader.h"
+
+namespace champsim::trace_profile
+{
+/**
+ * A histogram of reuse distances, in buckets of powers of two.
+ *
+ * The reuse distance of an access is the number of distinct blocks accessed since the previous access to the same block, so an access hits in
+ * a fully-associative LRU cache of more than that many blocks.
+ */
+struct reuse_histogram {
+  std::vector<uint64_t> buckets{}; // buckets[0] counts distance 0, and buckets[k] counts distances in [2^(k-1), 2^k)
+  uint64_t cold = 0;               // first accesses to a block
+
+  void add(std::optional<std::size_t> distance, uint64_t weight = 1);
+  [[nodiscard]] uint64_t accesses() const;
+
+  /**
+   * The number of accesses that would hit in a fully-associative LRU cache of the given number of blocks, counting only whole buckets.
+   */
+  [[nodiscard]] uint64_t hits(std::size_t blocks) const;
+};
+
+/**
+ * Computes the reuse distances of an access stream at the granularity of a block or a page.
+ *
+ * Distances are found with an ``lru_stack``, in logarithmic time. If the sample rate is less than 1, only the blocks whose hash falls below the
+ * rate are tracked, and their distances and counts are scaled by the inverse of the rate, as in SHARDS (Waldspurger et al., FAST 2015).
+ */
+class reuse_profiler
+{
+  constexpr static uint64_t hash_modulus = 1 << 24;
+
+  lru_stack stack{};
+  unsigned shift;
+  uint64_t threshold;
+  uint64_t weight;
+
+public:
+  reuse_histogram histogram{};
+
+  /**
+   * :param granularity: The size of a block, in bytes. This must be a power of two.
+   * :param sample_rate: The fraction of blocks to track
+   */
+  explicit reuse_profiler(uint64_t granularity, double sample_rate = 1.0);
+  void access(uint64_t address);
+};
+
+/**
+ * The footprint of a trace up to some point.
+ */
+struct footprint_sample {
+  uint64_t instructions = 0;
+  uint64_t code_blocks = 0; // distinct instruction blocks since the start of the trace
+  uint64_t data_blocks = 0; // distinct data blocks since the start of the trace
+  uint64_t data_pages = 0;  // distinct data pages since the start of the trace
+  uint64_t working_set = 0; // distinct data blocks in the interval that ends here
+};
+
+/**
+ * Samples the footprint of a trace at fixed intervals of instructions.
+ */
+class footprint_profiler
+{
+  uint64_t interval;
+  unsigned block_shift;
+  unsigned page_shift;
+  uint64_t instructions = 0;
+  std::unordered_set<uint64_t> code_blocks{};
+  std::unordered_set<uint64_t> data_blocks{};
+  std::unordered_set<uint64_t> data_pages{};
+  std::unordered_set<uint64_t> interval_blocks{};
+
+  void sample();
+
+public:
+  std::vector<footprint_sample> samples{};
+
+  footprint_profiler(uint64_t interval, uint64_t block_size, uint64_t page_size);
+  void operator()(const ooo_model_instr& instr);
+
+  /**
+   * Record the footprint at the end of the trace, if it does not fall at the end of an interval.
+   */
+  void finish();
+};
+
+/**
+ * The distribution of strides between successive data accesses of one instruction.
+ */
+struct ip_strides {
+  uint64_t ip = 0;
+  uint64_t accesses = 0;
+  std::map<int64_t, uint64_t> strides{};
+};
+
+/**
+ * Finds the strides, in bytes, between successive data accesses of each instruction.
+ */
+class stride_profiler
+{
+  struct history {
+    uint64_t last_address = 0;
+    ip_strides strides{};
+  };
+
+  std::unordered_map<uint64_t, history> by_ip{};
+
+public:
+  std::map<int64_t, uint64_t> overall{};
+
+  void operator()(const ooo_model_instr& instr);
+
+  /**
+   * The instructions with the most data accesses, each with its most common strides.
+   */
+  [[nodiscard]] std::vector<ip_strides> top(std::size_t num_ips, std::size_t num_strides) const;
+};
+
+/**
+ * The counts of the branches of a trace, by type.
+ */
+struct branch_stats {
+  std::array<uint64_t, NOT_BRANCH> count{};
+  std::array<uint64_t, NOT_BRANCH> taken{};
+  uint64_t static_branches = 0;
+  uint64_t biased_conditional = 0; // executions of conditional branches that go the same way at least 99% of the time
+};
+
+class branch_profiler
+{
+  struct direction_count {
+    uint64_t taken = 0;
+    uint64_t not_taken = 0;
+  };
+
+  branch_stats stats{};
+  std::unordered_map<uint64_t, direction_count> by_ip{};
+
+public:
+  void operator()(const ooo_model_instr& instr);
+  [[nodiscard]] branch_stats result() const;
+};
+
+struct options {
+  uint64_t block_size = 64;
+  uint64_t page_size = 4096;
+  double sample_rate = 1.0;
+  uint64_t footprint_interval = 1000000;
+  uint64_t max_instructions = 0; // stop after this many instructions, or 0 to read the whole trace
+  std::size_t top_ips = 32;
+  std::size_t top_strides = 8;
+};
+
+struct profile {
+  uint64_t instructions = 0;
+  uint64_t loads = 0;
+  uint64_t stores = 0;
+  reuse_histogram block_reuse{};
+  reuse_histogram page_reuse{};
+  std::vector<footprint_sample> footprint{};
+  std::map<int64_t, uint64_t> strides{};
+  std::vector<ip_strides> strides_by_ip{};
+  branch_stats branches{};
+};
+
+/**
+ * Profile a trace without simulating it.
+ *
+ * The trace is decoded once, on its own thread, and its instructions are given to three analysis threads: one for the reuse distances of
+ * blocks, one for the reuse distances of pages and the footprint, and one for the strides and branches.
+ */
+profile run(tracereader&& source, const options& opts);
+} // namespace champsim::trace_profile
+
+#endif
@@ -31,7 +31,9 @@ namespace champsim
 {
 class tracereader
 {
-  static uint64_t instr_unique_id; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+  // Each simulation thread numbers the instructions that its cores consume, so that concurrent environments do not interfere.
+  // Readers that feed another reader, such as a trace broadcast, must use next_unnumbered() so that only the consumer's reads are counted.
+  static thread_local uint64_t instr_unique_id; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
   struct reader_concept {
     virtual ~reader_concept() = default;
     virtual ooo_model_instr operator()() = 0;
@@ -71,6 +73,12 @@ public:
     return retval;
   }
 
+  /**
+   * Read the next instruction without giving it an ID.
+   * The ID is given by the reader that finally passes the instruction to a core.
+   */
+  auto next_unnumbered() { return (*pimpl_)(); }
+
   [[nodiscard]] auto eof() const { return pimpl_->eof(); }
 };
 
@@ -143,4 +151,9 @@ std::string get_fptr_cmd(std::string_view fname);
 
 champsim::tracereader get_tracereader(const std::string& fname, uint8_t cpu, bool is_cloudsuite, bool repeat);
 
+/**
+ * Set the number of threads that each trace opened after this may use to decompress itself, where its format allows it.
+ */
+void set_decoder_threads(std::size_t threads);
+
 #endif
@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <deque>
+#include <functional>
 #include <map>
 #include <optional>
 #include <random>
@@ -26,6 +27,7 @@
 #include "address.h"
 #include "champsim.h"
 #include "chrono.h"
+#include "msl/arena.h"
 
 class MEMORY_CONTROLLER;
 
@@ -34,10 +36,16 @@ using pte_entry = champsim::data::size<long long, std::ratio<8>>;
 class VirtualMemory
 {
 private:
-  std::map<std::pair<uint32_t, champsim::page_number>, champsim::page_number> vpage_to_ppage_map;
-  std::map<std::tuple<uint32_t, uint32_t, champsim::address_slice<champsim::dynamic_extent>>, champsim::address> page_table;
+  template <typename K, typename V>
+  using map_type = std::map<K, V, std::less<K>, champsim::msl::arena_allocator<std::pair<const K, V>>>;
+
+  map_type<std::pair<uint32_t, champsim::page_number>, champsim::page_number> vpage_to_ppage_map;
+  map_type<std::tuple<uint32_t, uint32_t, champsim::address_slice<champsim::dynamic_extent>>, champsim::address> page_table;
   std::optional<uint64_t> randomization_seed;
   MEMORY_CONTROLLER& dram;
+  bool shared_address_space = false;
+
+  [[nodiscard]] uint32_t address_space_of(uint32_t cpu_num) const;
 
 public:
   const champsim::chrono::clock::duration minor_fault_penalty;
@@ -45,7 +53,7 @@ public:
   const pte_entry pte_page_size; // Size of a PTE page
 
 private:
-  std::deque<champsim::page_number> ppage_free_list;
+  std::deque<champsim::page_number, champsim::msl::arena_allocator<champsim::page_number>> ppage_free_list;
   champsim::page_number active_pte_page{};
   champsim::address_slice<champsim::dynamic_extent> next_pte_page;
 
@@ -69,11 +77,15 @@ public:
    * :param dram: The physical memory of the system.
    *   This is currently only used to issue a warning if the physical memory is smaller than the virtual memory.
    *   Future versions may perform major page faults through this reference.
+   * :param randomization_seed: If given, the physical pages are handed out in a random order drawn from this seed.
+   * :param shared_address_space: If true, every core translates through the same page table, as the threads of one process do.
    */
   VirtualMemory(champsim::data::bytes page_table_page_size, std::size_t page_table_levels, champsim::chrono::clock::duration minor_penalty,
                 MEMORY_CONTROLLER& dram_);
   VirtualMemory(champsim::data::bytes page_table_page_size, std::size_t page_table_levels, champsim::chrono::clock::duration minor_penalty,
                 MEMORY_CONTROLLER& dram_, std::optional<uint64_t> randomization_seed_);
+  VirtualMemory(champsim::data::bytes page_table_page_size, std::size_t page_table_levels, champsim::chrono::clock::duration minor_penalty,
+                MEMORY_CONTROLLER& dram_, std::optional<uint64_t> randomization_seed_, bool shared_address_space_);
 
   /**
    * Find the bit location of the lowest bit for the given page table level.
@@ -100,7 +112,7 @@ public:
    * Translate the given address from the virtual space to the physical space.
    * If a page translation does not already exist, one will be created and the minor fault penalty will be applied.
    *
-   * :param cpu_num: The cpu index of the core making the request. This is currently used as an address space ID.
+   * :param cpu_num: The cpu index of the core making the request. This is used as an address space ID, unless the address space is shared.
    * :param vaddr: The address to translate.
    *
    * :returns: A pair of the physical address and the latency to be applied to the translation.
@@ -111,7 +123,7 @@ public:
    * Find the address for the page table page for the given virtual address (under translation), and the given level.
    * If a page table page does not already exist, one will be created and the minor fault penalty will be applied.
    *
-   * :param cpu_num: The cpu index of the core making the request. This is currently used as an address space ID.
+   * :param cpu_num: The cpu index of the core making the request. This is used as an address space ID, unless the address space is shared.
    * :param vaddr: The address to translate.
    * :param level: The current level being translated.
    *
@@ -0,0 +1,148 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ZSTD_SEEKABLE_H
+#define ZSTD_SEEKABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace champsim::zstd_seekable
+{
+/**
+ * The location of one frame of a seekable zstd stream.
+ *
+ * A seekable stream is a sequence of independent frames followed by a skippable frame that holds the size of each, as in the seekable
+ * format of the zstd contributions. Each frame can be decoded without the others, so a reader can begin at any frame, and several frames
+ * can be decoded at once.
+ */
+struct frame {
+  uint64_t compressed_offset;
+  uint64_t decompressed_offset;
+  uint32_t compressed_size;
+  uint32_t decompressed_size;
+};
+
+/**
+ * Read the seek table from the end of a stream. The position of the stream is unspecified afterward.
+ *
+ * :return: The frames of the stream, or an empty table if the stream is not seekable.
+ */
+std::vector<frame> read_seek_table(std::istream& in);
+
+/**
+ * Check whether a file is a seekable zstd stream of more than one frame.
+ */
+bool is_multiframe(const std::string& fname);
+
+/**
+ * Find the frame that holds the given offset into the decompressed stream.
+ *
+ * :return: An iterator to the frame, or the end of the table if the offset is past the end of the stream.
+ */
+std::vector<frame>::const_iterator frame_containing(const std::vector<frame>& table, uint64_t decompressed_offset);
+
+/**
+ * Compress one frame of a seekable stream.
+ *
+ * Frames are independent, so they may be compressed on several threads, then given in order to ``writer::append_frame()``.
+ */
+std::vector<char> compress_frame(const char* s, std::size_t count, int compression_level);
+
+/**
+ * Compress a stream into independent frames and append a seek table.
+ *
+ * The seek table is written when the writer is closed or destroyed.
+ */
+class writer
+{
+  std::ostream* dest;
+  int level;
+  std::vector<char> pending{};
+  std::vector<frame> table{};
+  uint64_t compressed_offset = 0;
+  uint64_t decompressed_offset = 0;
+  bool closed = false;
+
+  void write_frame();
+
+public:
+  constexpr static std::size_t default_frame_size = 4 << 20;
+
+  const std::size_t frame_size;
+
+  explicit writer(std::ostream& out, int compression_level = 3, std::size_t max_frame_size = default_frame_size);
+  writer(const writer&) = delete;
+  writer& operator=(const writer&) = delete;
+  ~writer();
+
+  writer& write(const char* s, std::streamsize count);
+
+  /**
+   * Append a frame that was compressed by ``compress_frame()``, after any data that was written before it.
+   */
+  void append_frame(const std::vector<char>& compressed, std::size_t decompressed_size);
+
+  void close();
+};
+
+/**
+ * A stream that decodes the frames of a seekable zstd stream on several threads.
+ *
+ * Frames are read in order and decoded ahead of the reader, so that the reader waits only when the decoders fall behind.
+ * This satisfies the interface of ``champsim::bulk_tracereader``.
+ */
+class parallel_istream
+{
+  std::unique_ptr<std::istream> underlying;
+  std::vector<frame> table;
+  std::size_t threads;
+  std::size_t next_frame = 0;
+  std::deque<std::future<std::vector<char>>> decoding{};
+  std::vector<char> current{};
+  std::size_t current_pos = 0;
+  std::streamsize gcount_ = 0;
+  bool eof_ = false;
+
+  void fill();
+
+public:
+  // The number of threads that each stream may use, unless it is given a number
+  static inline std::atomic<std::size_t> default_threads{4}; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+  explicit parallel_istream(std::string fname, std::size_t num_threads = default_threads);
+  explicit parallel_istream(std::unique_ptr<std::istream> in, std::size_t num_threads = default_threads);
+
+  /**
+   * Begin reading at the start of the given frame.
+   */
+  void seek_frame(std::vector<frame>::const_iterator first);
+
+  parallel_istream& read(char* s, std::streamsize count);
+
+  [[nodiscard]] bool eof() const { return eof_; }
+  [[nodiscard]] std::streamsize gcount() const { return gcount_; }
+  [[nodiscard]] const std::vector<frame>& frames() const { return table; }
+};
+} // namespace champsim::zstd_seekable
+
+#endif
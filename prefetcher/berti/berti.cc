@@ -0,0 +1,162 @@
+#include "berti.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <tuple>
+
+#include "cache.h"
+
+uint64_t berti::current_cycle() const { return static_cast<uint64_t>(intern_->current_time.time_since_epoch() / intern_->clock_period); }
+
+void berti::record(champsim::address ip, champsim::block_number block, uint64_t cycle)
+{
+  auto entry = history.check_hit({{ip}}).value_or(history_entry{{ip}});
+  entry.records.at(entry.head) = {block, cycle, true};
+  entry.head = (entry.head + 1) % HISTORY_LENGTH;
+  history.fill(entry);
+}
+
+void berti::learn(champsim::address ip, champsim::block_number block, uint64_t demand_cycle, uint64_t latency)
+{
+  auto hist = history.check_hit({{ip}});
+  if (!hist.has_value()) {
+    return;
+  }
+
+  auto table = deltas.check_hit({{ip}}).value_or(delta_table_entry{{ip}});
+
+  // A prefetch issued by an access at least one latency before the demand would have arrived in time
+  std::array<delta_type, HISTORY_LENGTH> timely{};
+  auto timely_end = std::begin(timely);
+  for (const auto& rec : hist->records) {
+    if (rec.valid && rec.cycle + latency <= demand_cycle) {
+      const auto delta = champsim::offset(rec.block, block);
+      if (delta != 0 && std::abs(delta) <= MAX_DELTA && std::find(std::begin(timely), timely_end, delta) == timely_end) {
+        *(timely_end++) = delta;
+      }
+    }
+  }
+
+  std::for_each(std::begin(timely), timely_end, [&table](auto delta) {
+    auto found = std::find_if(std::begin(table.deltas), std::end(table.deltas), [delta](const auto& x) { return x.delta == delta; });
+    if (found == std::end(table.deltas)) {
+      // Replace an empty entry, or else the least covered delta that is not prefetching
+      found = std::min_element(std::begin(table.deltas), std::end(table.deltas), [](const auto& x, const auto& y) {
+        auto x_key = std::tuple{x.delta != 0, x.status != delta_status::none, x.coverage};
+        auto y_key = std::tuple{y.delta != 0, y.status != delta_status::none, y.coverage};
+        return x_key < y_key;
+      });
+      if (found->status != delta_status::none) {
+        return;
+      }
+      *found = {delta, 0, delta_status::none};
+    }
+    ++found->coverage;
+  });
+
+  // At the end of the learning period, judge each delta by the fraction of searches for which it was timely
+  if (++table.searches >= LEARN_PERIOD) {
+    for (auto& entry : table.deltas) {
+      if (entry.coverage >= THIS_LEVEL_COVERAGE) {
+        entry.status = delta_status::this_level;
+      } else if (entry.coverage >= NEXT_LEVEL_COVERAGE) {
+        entry.status = delta_status::next_level;
+      } else {
+        entry.status = delta_status::none;
+      }
+      entry.coverage = 0;
+    }
+    table.searches = 0;
+  }
+
+  deltas.fill(table);
+}
+
+void berti::issue_prefetches(champsim::address ip, champsim::block_number block)
+{
+  auto table = deltas.check_hit({{ip}});
+  if (!table.has_value()) {
+    return;
+  }
+
+  // Prefetch the deltas that fill this level first
+  std::stable_sort(std::begin(table->deltas), std::end(table->deltas), [](const auto& x, const auto& y) { return x.status > y.status; });
+
+  const bool mshr_under_light_load = intern_->get_mshr_occupancy_ratio() < THIS_LEVEL_MSHR_THRESHOLD;
+  const auto degree = prefetch_degree(PREFETCH_DEGREE);
+  const auto now = current_cycle();
+  unsigned issued = 0;
+  for (auto it = std::begin(table->deltas); it != std::end(table->deltas) && it->status != delta_status::none && issued < degree; ++it) {
+    const champsim::block_number pf_block = block + it->delta;
+    if (!intern_->virtual_prefetch && champsim::page_number{pf_block} != champsim::page_number{block}) {
+      continue;
+    }
+
+    const bool fill_this_level = (it->status == delta_status::this_level) && mshr_under_light_load;
+    if (prefetch_line(champsim::address{pf_block}, fill_this_level, 0)) {
+      ++issued;
+
+      // Time the fill of the prefetch, unless the block is already being timed
+      if (fill_this_level && !latencies.check_hit({pf_block}).has_value()) {
+        latencies.fill({pf_block, ip, now, 0, 0, false});
+      }
+    }
+  }
+}
+
+uint32_t berti::prefetcher_cache_operate(champsim::address addr, champsim::address ip, uint8_t cache_hit, bool useful_prefetch, access_type type,
+                                         uint32_t metadata_in)
+{
+  if (type != access_type::LOAD && type != access_type::RFO) {
+    return metadata_in;
+  }
+
+  const champsim::block_number block{addr};
+  const auto now = current_cycle();
+
+  if (!cache_hit) {
+    auto inflight = latencies.check_hit({block});
+    if (!inflight.has_value() || inflight->latency != 0) {
+      latencies.fill({block, ip, now, now, 0, true});
+    } else if (!inflight->demanded) {
+      // The demand found a prefetch in flight. Learn from it when it fills, as a late prefetch.
+      inflight->ip = ip;
+      inflight->demand_cycle = now;
+      inflight->demanded = true;
+      latencies.fill(inflight.value());
+    }
+  } else if (useful_prefetch) {
+    auto filled = latencies.invalidate({block});
+    if (filled.has_value() && filled->latency != 0) {
+      learn(ip, block, now, filled->latency);
+    }
+  } else {
+    // Hits to blocks that were not prefetched do not train
+    return metadata_in;
+  }
+
+  record(ip, block, now);
+  issue_prefetches(ip, block);
+
+  return metadata_in;
+}
+
+uint32_t berti::prefetcher_cache_fill(champsim::address addr, long set, long way, uint8_t prefetch, champsim::address evicted_addr, uint32_t metadata_in)
+{
+  const champsim::block_number block{addr};
+  auto entry = latencies.check_hit({block});
+  if (!entry.has_value() || entry->latency != 0) {
+    return metadata_in;
+  }
+
+  entry->latency = std::max<uint64_t>(current_cycle() - entry->issue_cycle, 1);
+  if (entry->demanded) {
+    latencies.invalidate(entry.value());
+    learn(entry->ip, block, entry->demand_cycle, entry->latency);
+  } else {
+    // Keep the latency of the prefetch until a demand hits the block
+    latencies.fill(entry.value());
+  }
+
+  return metadata_in;
+}
@@ -0,0 +1,112 @@
+#ifndef BERTI_H
+#define BERTI_H
+
+#include <array>
+#include <cstdint>
+
+#include "address.h"
+#include "champsim.h"
+#include "modules.h"
+#include "msl/lru_table.h"
+
+/*
+ * A local-delta prefetcher after Berti (Navarro-Torres et al., MICRO 2022).
+ *
+ * For each IP, Berti remembers the recent misses and hits to prefetched blocks, and the time at which they happened. When a demand miss fills, or
+ * when a demand hits a prefetched block, the latency of that fill tells which of the earlier accesses of the same IP happened early enough that a
+ * prefetch issued then would have arrived in time. The deltas from those accesses are timely, and each is counted. After a learning period, the
+ * deltas that were timely for most of the searches prefetch into this cache, and those that were timely for fewer prefetch into the next level.
+ */
+struct berti : public champsim::modules::prefetcher {
+  using delta_type = champsim::block_number::difference_type;
+
+  enum class delta_status : uint8_t { none, next_level, this_level };
+
+  struct history_record {
+    champsim::block_number block{};
+    uint64_t cycle = 0;
+    bool valid = false;
+  };
+
+  constexpr static std::size_t HISTORY_SETS = 16;
+  constexpr static std::size_t HISTORY_WAYS = 8;
+  constexpr static std::size_t HISTORY_LENGTH = 8;
+
+  constexpr static std::size_t DELTA_SETS = 4;
+  constexpr static std::size_t DELTA_WAYS = 4;
+  constexpr static std::size_t DELTAS_PER_IP = 16;
+
+  constexpr static std::size_t LATENCY_SETS = 32;
+  constexpr static std::size_t LATENCY_WAYS = 4;
+
+  constexpr static unsigned LEARN_PERIOD = 16;              // searches before the deltas are judged
+  constexpr static unsigned THIS_LEVEL_COVERAGE = 10;       // of LEARN_PERIOD, to fill this level
+  constexpr static unsigned NEXT_LEVEL_COVERAGE = 5;        // of LEARN_PERIOD, to fill the next level
+  constexpr static delta_type MAX_DELTA = 64;               // in blocks
+  constexpr static unsigned PREFETCH_DEGREE = 8;            // the most deltas prefetched for each access
+  constexpr static double THIS_LEVEL_MSHR_THRESHOLD = 0.7;  // above this occupancy, all prefetches go to the next level
+
+  struct ip_indexed {
+    champsim::address ip{};
+
+    auto index() const
+    {
+      using namespace champsim::data::data_literals;
+      return ip.slice_upper<2_b>();
+    }
+    auto tag() const
+    {
+      using namespace champsim::data::data_literals;
+      return ip.slice_upper<2_b>();
+    }
+  };
+
+  // The recent accesses of one IP, as a ring
+  struct history_entry : ip_indexed {
+    std::array<history_record, HISTORY_LENGTH> records{};
+    std::size_t head = 0;
+  };
+
+  struct delta_entry {
+    delta_type delta = 0; // zero marks an empty entry
+    unsigned coverage = 0;
+    delta_status status = delta_status::none;
+  };
+
+  // The deltas that were timely for one IP
+  struct delta_table_entry : ip_indexed {
+    std::array<delta_entry, DELTAS_PER_IP> deltas{};
+    unsigned searches = 0;
+  };
+
+  // A block that is being filled, or that was filled by a prefetch and has not yet been demanded
+  struct latency_entry {
+    champsim::block_number block{};
+    champsim::address ip{};
+    uint64_t issue_cycle = 0;
+    uint64_t demand_cycle = 0;
+    uint64_t latency = 0; // zero while the fill is outstanding
+    bool demanded = false;
+
+    auto index() const { return block.to<uint64_t>(); }
+    auto tag() const { return block.to<uint64_t>(); }
+  };
+
+  champsim::msl::lru_table<history_entry> history{HISTORY_SETS, HISTORY_WAYS};
+  champsim::msl::lru_table<delta_table_entry> deltas{DELTA_SETS, DELTA_WAYS};
+  champsim::msl::lru_table<latency_entry> latencies{LATENCY_SETS, LATENCY_WAYS};
+
+  [[nodiscard]] uint64_t current_cycle() const;
+  void record(champsim::address ip, champsim::block_number block, uint64_t cycle);
+  void learn(champsim::address ip, champsim::block_number block, uint64_t demand_cycle, uint64_t latency);
+  void issue_prefetches(champsim::address ip, champsim::block_number block);
+
+public:
+  using champsim::modules::prefetcher::prefetcher;
+
+  uint32_t prefetcher_cache_operate(champsim::address addr, champsim::address ip, uint8_t cache_hit, bool useful_prefetch, access_type type,
+                                    uint32_t metadata_in);
+  uint32_t prefetcher_cache_fill(champsim::address addr, long set, long way, uint8_t prefetch, champsim::address evicted_addr, uint32_t metadata_in);
+};
+
+#endif
@@ -0,0 +1,152 @@
+#include "ipcp.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fmt/core.h>
+
+#include "cache.h"
+
+unsigned ipcp::next_signature(unsigned signature, stride_type stride)
+{
+  return ((signature << 1) ^ static_cast<unsigned>(stride)) & (CSPT_SIZE - 1);
+}
+
+std::optional<bool> ipcp::train_region(champsim::block_number block)
+{
+  const auto region = block.to<uint64_t>() / REGION_BLOCKS;
+  const auto offset = static_cast<std::size_t>(block.to<uint64_t>() % REGION_BLOCKS);
+
+  auto found = regions.check_hit({region});
+  if (!found.has_value()) {
+    // A region that continues a dense neighbor is taken to be dense, so that streams cross into it
+    region_entry new_region{region};
+    auto prev = regions.check_hit({region - 1});
+    auto next = regions.check_hit({region + 1});
+    if (prev.has_value() && prev->dense && prev->direction > 0) {
+      new_region.dense = true;
+      new_region.direction = 1;
+    } else if (next.has_value() && next->dense && next->direction < 0) {
+      new_region.dense = true;
+      new_region.direction = -1;
+    }
+    new_region.accessed.set(offset);
+    new_region.last_offset = offset;
+    found = new_region;
+  } else if (!found->accessed.test(offset)) {
+    found->accessed.set(offset);
+    found->direction += (offset > found->last_offset) ? 1 : -1;
+    found->direction = std::clamp<int>(found->direction, -static_cast<int>(REGION_BLOCKS), static_cast<int>(REGION_BLOCKS));
+    found->last_offset = offset;
+    found->dense = found->dense || found->accessed.count() >= DENSE_THRESHOLD;
+  }
+
+  regions.fill(found.value());
+  if (!found->dense) {
+    return std::nullopt;
+  }
+  return found->direction >= 0;
+}
+
+bool ipcp::issue(champsim::block_number trigger, champsim::block_number pf_block, ip_class cls)
+{
+  if (!intern_->virtual_prefetch && champsim::page_number{pf_block} != champsim::page_number{trigger}) {
+    return false;
+  }
+
+  const bool mshr_under_light_load = intern_->get_mshr_occupancy_ratio() < MSHR_THRESHOLD;
+  const bool success = prefetch_line(champsim::address{pf_block}, mshr_under_light_load, static_cast<uint32_t>(cls));
+  if (success && !intern_->warmup) {
+    ++issued_by_class.at(champsim::to_underlying(cls));
+  }
+  return success;
+}
+
+uint32_t ipcp::prefetcher_cache_operate(champsim::address addr, champsim::address ip, uint8_t cache_hit, bool useful_prefetch, access_type type,
+                                        uint32_t metadata_in)
+{
+  if (type != access_type::LOAD && type != access_type::RFO) {
+    return metadata_in;
+  }
+
+  const champsim::block_number block{addr};
+  const auto stream_forward = train_region(block);
+
+  auto found = ip_table.check_hit({ip});
+  auto entry = found.value_or(ip_entry{ip, block});
+  if (found.has_value()) {
+    const auto stride = champsim::offset(entry.last_block, block);
+    if (stride != 0 && std::abs(stride) <= MAX_STRIDE) {
+      // Constant stride: gain confidence while the stride repeats
+      if (stride == entry.last_stride) {
+        entry.confidence = std::min(entry.confidence + 1, MAX_CONFIDENCE);
+      } else {
+        entry.confidence = std::max(entry.confidence - 1, 0);
+      }
+
+      // Complex stride: the signature before this stride predicts it
+      auto& prediction = cspt.at(entry.signature);
+      if (prediction.stride == stride) {
+        prediction.confidence = std::min(prediction.confidence + 1, MAX_CONFIDENCE);
+      } else if (prediction.confidence > 0) {
+        --prediction.confidence;
+      } else {
+        prediction.stride = stride;
+      }
+
+      entry.signature = next_signature(entry.signature, stride);
+      entry.last_stride = stride;
+    }
+  }
+  entry.last_block = block;
+  entry.stream = stream_forward.has_value();
+  entry.stream_forward = stream_forward.value_or(true);
+  ip_table.fill(entry);
+
+  if (entry.stream) {
+    const stride_type direction = entry.stream_forward ? 1 : -1;
+    const auto degree = static_cast<stride_type>(prefetch_degree(GS_DEGREE));
+    for (stride_type i = 1; i <= degree; ++i) {
+      if (!issue(block, block + direction * i, ip_class::global_stream)) {
+        break;
+      }
+    }
+  } else if (entry.confidence >= 2) {
+    const auto degree = static_cast<stride_type>(prefetch_degree(CS_DEGREE));
+    for (stride_type i = 1; i <= degree; ++i) {
+      if (!issue(block, block + entry.last_stride * i, ip_class::constant_stride)) {
+        break;
+      }
+    }
+  } else if (cspt.at(entry.signature).confidence > 0) {
+    // Follow the chain of predicted strides
+    auto signature = entry.signature;
+    auto pf_block = block;
+    for (unsigned i = 0; i < prefetch_degree(CPLX_DEGREE); ++i) {
+      const auto prediction = cspt.at(signature);
+      if (prediction.confidence == 0 || prediction.stride == 0) {
+        break;
+      }
+      pf_block = pf_block + prediction.stride;
+      if (!issue(block, pf_block, ip_class::complex_stride)) {
+        break;
+      }
+      signature = next_signature(signature, prediction.stride);
+    }
+  } else if (!cache_hit && intern_->get_mshr_occupancy_ratio() < MSHR_THRESHOLD) {
+    issue(block, block + 1, ip_class::next_line);
+  }
+
+  return metadata_in;
+}
+
+uint32_t ipcp::prefetcher_cache_fill(champsim::address addr, long set, long way, uint8_t prefetch, champsim::address evicted_addr, uint32_t metadata_in)
+{
+  return metadata_in;
+}
+
+void ipcp::prefetcher_final_stats()
+{
+  fmt::print("{} IPCP ISSUED GS: {} CS: {} CPLX: {} NL: {}\n", intern_->NAME, issued_by_class.at(champsim::to_underlying(ip_class::global_stream)),
+             issued_by_class.at(champsim::to_underlying(ip_class::constant_stride)), issued_by_class.at(champsim::to_underlying(ip_class::complex_stride)),
+             issued_by_class.at(champsim::to_underlying(ip_class::next_line)));
+}
@@ -0,0 +1,106 @@
+#ifndef IPCP_H
+#define IPCP_H
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <optional>
+
+#include "address.h"
+#include "champsim.h"
+#include "modules.h"
+#include "msl/lru_table.h"
+
+/*
+ * An IP-classifying prefetcher after IPCP (Pakalapati and Panda, ISCA 2020).
+ *
+ * Each IP is placed in the first of these classes that it fits, and prefetches by the rules of that class:
+ *
+ * - A global stream (GS) IP touches regions that are densely accessed, and prefetches the next blocks in the direction of the stream.
+ * - A constant stride (CS) IP repeats one stride, and prefetches along it.
+ * - A complex stride (CPLX) IP has a signature of its recent strides that predicts the next stride, and prefetches by following the predictions.
+ * - Any other IP prefetches the next line, but only while the MSHR is lightly loaded.
+ *
+ * The class of each prefetch is passed to the next level as its metadata.
+ */
+struct ipcp : public champsim::modules::prefetcher {
+  using stride_type = champsim::block_number::difference_type;
+
+  enum class ip_class : uint8_t { none, global_stream, constant_stride, complex_stride, next_line };
+
+  constexpr static std::size_t IP_SETS = 64;
+  constexpr static std::size_t IP_WAYS = 2;
+
+  constexpr static std::size_t REGION_SETS = 1;
+  constexpr static std::size_t REGION_WAYS = 8;
+  constexpr static std::size_t REGION_BLOCKS = 32; // 2 KiB regions
+  constexpr static std::size_t DENSE_THRESHOLD = 24;
+
+  constexpr static unsigned SIGNATURE_BITS = 7;
+  constexpr static std::size_t CSPT_SIZE = std::size_t{1} << SIGNATURE_BITS;
+  constexpr static stride_type MAX_STRIDE = 63; // strides are kept in 7 bits
+
+  constexpr static int MAX_CONFIDENCE = 3;
+  constexpr static unsigned GS_DEGREE = 6;
+  constexpr static unsigned CS_DEGREE = 3;
+  constexpr static unsigned CPLX_DEGREE = 3;
+  constexpr static double MSHR_THRESHOLD = 0.5; // above this occupancy, prefetches go to the next level and next-line prefetching stops
+
+  struct ip_entry {
+    champsim::address ip{};
+    champsim::block_number last_block{};
+    stride_type last_stride = 0;
+    int confidence = 0;         // of the constant stride
+    unsigned signature = 0;     // of the recent strides
+    bool stream = false;        // the IP has touched a dense region
+    bool stream_forward = true; // the direction of that region
+
+    auto index() const
+    {
+      using namespace champsim::data::data_literals;
+      return ip.slice_upper<2_b>();
+    }
+    auto tag() const
+    {
+      using namespace champsim::data::data_literals;
+      return ip.slice_upper<2_b>();
+    }
+  };
+
+  // The complex stride prediction table, indexed by signature
+  struct cspt_entry {
+    stride_type stride = 0;
+    int confidence = 0;
+  };
+
+  struct region_entry {
+    uint64_t region = 0;
+    std::bitset<REGION_BLOCKS> accessed{};
+    int direction = 0; // positive while the accesses ascend
+    std::size_t last_offset = 0;
+    bool dense = false;
+
+    auto index() const { return region; }
+    auto tag() const { return region; }
+  };
+
+  std::array<uint64_t, 5> issued_by_class{}; // indexed by ip_class
+
+  champsim::msl::lru_table<ip_entry> ip_table{IP_SETS, IP_WAYS};
+  champsim::msl::lru_table<region_entry> regions{REGION_SETS, REGION_WAYS};
+  std::array<cspt_entry, CSPT_SIZE> cspt{};
+
+  static unsigned next_signature(unsigned signature, stride_type stride);
+  std::optional<bool> train_region(champsim::block_number block);
+  bool issue(champsim::block_number trigger, champsim::block_number pf_block, ip_class cls);
+
+public:
+  using champsim::modules::prefetcher::prefetcher;
+
+  uint32_t prefetcher_cache_operate(champsim::address addr, champsim::address ip, uint8_t cache_hit, bool useful_prefetch, access_type type,
+                                    uint32_t metadata_in);
+  uint32_t prefetcher_cache_fill(champsim::address addr, long set, long way, uint8_t prefetch, champsim::address evicted_addr, uint32_t metadata_in);
+  void prefetcher_final_stats();
+};
+
+#endif
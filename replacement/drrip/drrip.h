@@ -6,6 +6,7 @@
 
 #include "cache.h"
 #include "modules.h"
+#include "msl/arena.h"
 #include "msl/fwcounter.h"
 
 struct drrip : public champsim::modules::replacement {
@@ -24,7 +25,7 @@ public:
   unsigned bip_counter;
   std::vector<std::size_t> rand_sets;
   std::vector<champsim::msl::fwcounter<PSEL_WIDTH>> PSEL;
-  std::vector<unsigned> rrpv;
+  std::vector<unsigned, champsim::msl::arena_allocator<unsigned>> rrpv;
 
   drrip(CACHE* cache);
 
@@ -5,11 +5,12 @@
 
 #include "cache.h"
 #include "modules.h"
+#include "msl/arena.h"
 
 class lru : public champsim::modules::replacement
 {
   long NUM_WAY;
-  std::vector<uint64_t> last_used_cycles;
+  std::vector<uint64_t, champsim::msl::arena_allocator<uint64_t>> last_used_cycles;
   uint64_t cycle = 0;
 
 public:
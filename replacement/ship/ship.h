@@ -6,6 +6,7 @@
 
 #include "cache.h"
 #include "modules.h"
+#include "msl/arena.h"
 #include "msl/bits.h"
 #include "msl/fwcounter.h"
 
@@ -35,12 +36,13 @@ public:
   uint64_t access_count = 0;
 
   // sampler
-  std::vector<std::size_t> rand_sets;
-  std::vector<SAMPLER_class> sampler;
-  std::vector<int> rrpv_values;
+  std::vector<std::size_t, champsim::msl::arena_allocator<std::size_t>> rand_sets;
+  std::vector<SAMPLER_class, champsim::msl::arena_allocator<SAMPLER_class>> sampler;
+  std::vector<int, champsim::msl::arena_allocator<int>> rrpv_values;
 
   // prediction table structure
-  std::vector<std::array<champsim::msl::fwcounter<champsim::msl::lg2(SHCT_MAX + 1)>, SHCT_SIZE>> SHCT;
+  using shct_type = std::array<champsim::msl::fwcounter<champsim::msl::lg2(SHCT_MAX + 1)>, SHCT_SIZE>;
+  std::vector<shct_type, champsim::msl::arena_allocator<shct_type>> SHCT;
 
   explicit ship(CACHE* cache);
 
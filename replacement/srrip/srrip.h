@@ -6,12 +6,13 @@
 
 #include "cache.h"
 #include "modules.h"
+#include "msl/arena.h"
 
 struct srrip_set_helper {
   using rrpv_type = int;
   static constexpr rrpv_type maxRRPV = 3;
 
-  std::vector<rrpv_type> rrpv_values;
+  std::vector<rrpv_type, champsim::msl::arena_allocator<rrpv_type>> rrpv_values;
   rrpv_type& get_rrpv(long way);
 
   explicit srrip_set_helper(long ways);
@@ -22,7 +23,7 @@ struct srrip_set_helper {
 
 struct srrip : public champsim::modules::replacement {
 
-  std::vector<srrip_set_helper> sets;
+  std::vector<srrip_set_helper, champsim::msl::arena_allocator<srrip_set_helper>> sets;
 
   explicit srrip(CACHE* cache);
   srrip(CACHE* cache, long sets_, long ways_);
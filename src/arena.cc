@@ -0,0 +1,167 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "msl/arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#define CHAMPSIM_ARENA_HAS_MMAN
+#endif
+
+namespace
+{
+std::size_t round_up(std::size_t value, std::size_t multiple) { return ((value + multiple - 1) / multiple) * multiple; }
+} // namespace
+
+champsim::msl::huge_page_arena::huge_page_arena(std::size_t chunk_size_) : chunk_size(round_up(std::max<std::size_t>(chunk_size_, 1), huge_page_size)) {}
+
+champsim::msl::huge_page_arena::~huge_page_arena()
+{
+  for (const auto& c : chunks) {
+    release(c);
+  }
+}
+
+auto champsim::msl::huge_page_arena::reserve(std::size_t bytes) -> chunk
+{
+#ifdef CHAMPSIM_ARENA_HAS_MMAN
+#ifdef MAP_HUGETLB
+  // Pages that the host has set aside as huge pages
+  if (void* huge = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0); huge != MAP_FAILED) {
+    return {static_cast<std::byte*>(huge), bytes, true, true};
+  }
+#endif
+
+  // Otherwise, over-reserve so that the chunk can be aligned to a huge page, then trim the excess
+  if (void* raw = ::mmap(nullptr, bytes + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); raw != MAP_FAILED) {
+    auto raw_addr = reinterpret_cast<std::uintptr_t>(raw);
+    auto aligned_addr = round_up(raw_addr, huge_page_size);
+    auto head = aligned_addr - raw_addr;
+    if (head > 0) {
+      ::munmap(raw, head);
+    }
+    if (auto tail = huge_page_size - head; tail > 0) {
+      ::munmap(reinterpret_cast<void*>(aligned_addr + bytes), tail);
+    }
+
+    auto* base = reinterpret_cast<std::byte*>(aligned_addr);
+#ifdef MADV_HUGEPAGE
+    ::madvise(base, bytes, MADV_HUGEPAGE);
+#endif
+    return {base, bytes, true, false};
+  }
+#endif
+
+  return {static_cast<std::byte*>(::operator new(bytes, std::align_val_t{huge_page_size})), bytes, false, false};
+}
+
+void champsim::msl::huge_page_arena::release(const chunk& c)
+{
+#ifdef CHAMPSIM_ARENA_HAS_MMAN
+  if (c.mapped) {
+    ::munmap(c.base, c.size);
+    return;
+  }
+#endif
+  ::operator delete(c.base, std::align_val_t{huge_page_size});
+}
+
+void* champsim::msl::huge_page_arena::allocate(std::size_t bytes, std::size_t alignment)
+{
+  alignment = std::max(alignment, alignof(std::max_align_t));
+  bytes = round_up(std::max<std::size_t>(bytes, 1), alignment);
+
+  std::lock_guard lock{mutex};
+
+  if (auto found = free_blocks.find({bytes, alignment}); found != std::end(free_blocks) && !std::empty(found->second)) {
+    auto* retval = found->second.back();
+    found->second.pop_back();
+    return retval;
+  }
+
+  auto* aligned_cursor = reinterpret_cast<std::byte*>(round_up(reinterpret_cast<std::uintptr_t>(cursor), alignment));
+  if (cursor == nullptr || aligned_cursor + bytes > chunk_end) {
+    // Structures larger than a chunk get a chunk of their own, and the current chunk continues to be used
+    if (bytes > chunk_size / 2) {
+      return chunks.emplace_back(reserve(round_up(bytes, huge_page_size))).base;
+    }
+
+    const auto& fresh = chunks.emplace_back(reserve(chunk_size));
+    cursor = fresh.base;
+    chunk_end = fresh.base + fresh.size;
+    aligned_cursor = cursor;
+  }
+
+  cursor = aligned_cursor + bytes;
+  return aligned_cursor;
+}
+
+void champsim::msl::huge_page_arena::deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+{
+  if (ptr == nullptr) {
+    return;
+  }
+
+  alignment = std::max(alignment, alignof(std::max_align_t));
+  bytes = round_up(std::max<std::size_t>(bytes, 1), alignment);
+
+  std::lock_guard lock{mutex};
+  free_blocks[{bytes, alignment}].push_back(ptr);
+}
+
+std::size_t champsim::msl::huge_page_arena::reserved() const
+{
+  std::lock_guard lock{mutex};
+  return std::accumulate(std::begin(chunks), std::end(chunks), std::size_t{0}, [](auto acc, const auto& c) { return acc + c.size; });
+}
+
+std::size_t champsim::msl::huge_page_arena::reserved_huge() const
+{
+  std::lock_guard lock{mutex};
+  return std::accumulate(std::begin(chunks), std::end(chunks), std::size_t{0}, [](auto acc, const auto& c) { return acc + (c.huge ? c.size : 0); });
+}
+
+auto champsim::msl::huge_page_arena::current() -> huge_page_arena*&
+{
+  thread_local huge_page_arena* instance = nullptr;
+  return instance;
+}
+
+auto champsim::msl::huge_page_arena::global() -> huge_page_arena&
+{
+  if (current() != nullptr) {
+    return *current();
+  }
+
+  // The arenas of the threads are intentionally leaked, so that structures with static storage duration may be destroyed in any order,
+  // and so that memory freed on another thread remains valid to reuse there.
+  thread_local auto* instance = &make_persistent();
+  return *instance;
+}
+
+auto champsim::msl::huge_page_arena::make_persistent() -> huge_page_arena&
+{
+  return *(new huge_page_arena{});
+}
+
+champsim::msl::huge_page_arena::scope::scope(huge_page_arena& arena) : previous(std::exchange(current(), &arena)) {}
+
+champsim::msl::huge_page_arena::scope::~scope() { current() = previous; }
@@ -17,6 +17,7 @@
 #include "cache.h"
 
 #include <algorithm>
+#include <bitset>
 #include <cassert>
 #include <cmath>
 #include <iomanip>
@@ -32,19 +33,53 @@
 #include "util/bits.h"
 #include "util/span.h"
 
+#if __has_include("legacy_bridge.h")
+#include "legacy_bridge.h"
+#endif
+
+CACHE::CACHE(champsim::cache_builder<> b, prefetcher_factory make_prefetcher, replacement_factory make_replacement)
+    : champsim::operable(b.m_clock_period), upper_levels(b.m_uls), lower_level(b.m_ll), lower_translate(b.m_lt), NAME(b.m_name), NUM_SET(b.get_num_sets()),
+      NUM_WAY(b.get_num_ways()), MSHR_SIZE(b.get_num_mshrs()), PQ_SIZE(b.m_pq_size), HIT_LATENCY(b.get_hit_latency() * b.m_clock_period),
+      FILL_LATENCY(b.get_fill_latency() * b.m_clock_period), OFFSET_BITS(b.m_offset_bits), MAX_TAG(b.get_tag_bandwidth()), MAX_FILL(b.get_fill_bandwidth()),
+      prefetch_as_load(b.m_pref_load), match_offset_bits(b.m_wq_full_addr), virtual_prefetch(b.m_va_pref), inclusion(b.m_inclusion),
+      coherence(b.m_coherence), pref_activate_mask(b.m_pref_act_mask), stack_distance(b.get_stack_distance_profiler()), throttle(b.get_prefetch_throttle()),
+      pref_module_pimpl(make_prefetcher(this)),
+      repl_module_pimpl(make_replacement(this))
+{
+  if (lower_level != nullptr) {
+    lower_level->invalidations_accepted = true;
+  }
+
+  if (inclusion == champsim::inclusion_policy::exclusive) {
+    for (auto* ul : upper_levels) {
+      ul->victims_requested = true;
+    }
+  }
+
+  if (coherence != champsim::coherence_protocol::none) {
+    assert(std::size(upper_levels) <= std::numeric_limits<uint64_t>::digits);
+    directory.resize(std::size(block));
+    directory_uppers = upper_levels;
+  }
+}
+
 CACHE::CACHE(CACHE&& other)
     : operable(other),
 
+      directory(std::move(other.directory)), directory_uppers(std::move(other.directory_uppers)),
+
       upper_levels(std::move(other.upper_levels)), lower_level(std::move(other.lower_level)), lower_translate(std::move(other.lower_translate)),
 
       cpu(other.cpu), NAME(std::move(other.NAME)), NUM_SET(other.NUM_SET), NUM_WAY(other.NUM_WAY), MSHR_SIZE(other.MSHR_SIZE), PQ_SIZE(other.PQ_SIZE),
       HIT_LATENCY(other.HIT_LATENCY), FILL_LATENCY(other.FILL_LATENCY), OFFSET_BITS(other.OFFSET_BITS), block(std::move(other.block)), MAX_TAG(other.MAX_TAG),
       MAX_FILL(other.MAX_FILL), prefetch_as_load(other.prefetch_as_load), match_offset_bits(other.match_offset_bits), virtual_prefetch(other.virtual_prefetch),
-      pref_activate_mask(std::move(other.pref_activate_mask)),
+      inclusion(other.inclusion), coherence(other.coherence), pref_activate_mask(std::move(other.pref_activate_mask)), stack_distance(std::move(other.stack_distance)),
+      throttle(std::move(other.throttle)),
 
       sim_stats(std::move(other.sim_stats)), roi_stats(std::move(other.roi_stats)),
 
-      pref_module_pimpl(std::move(other.pref_module_pimpl)), repl_module_pimpl(std::move(other.repl_module_pimpl))
+      pref_module_pimpl(std::move(other.pref_module_pimpl)), repl_module_pimpl(std::move(other.repl_module_pimpl)),
+      operate_dispatch(other.operate_dispatch)
 {
   pref_module_pimpl->bind(this);
   repl_module_pimpl->bind(this);
@@ -78,13 +113,20 @@ auto CACHE::operator=(CACHE&& other) -> CACHE&
   this->prefetch_as_load = other.prefetch_as_load;
   this->match_offset_bits = other.match_offset_bits;
   this->virtual_prefetch = other.virtual_prefetch;
+  this->inclusion = other.inclusion;
+  this->coherence = other.coherence;
+  this->directory = std::move(other.directory);
+  this->directory_uppers = std::move(other.directory_uppers);
   this->pref_activate_mask = std::move(other.pref_activate_mask);
+  this->stack_distance = std::move(other.stack_distance);
+  this->throttle = std::move(other.throttle);
 
   this->sim_stats = std::move(other.sim_stats);
   this->roi_stats = std::move(other.roi_stats);
 
   this->pref_module_pimpl = std::move(other.pref_module_pimpl);
   this->repl_module_pimpl = std::move(other.repl_module_pimpl);
+  this->operate_dispatch = other.operate_dispatch;
 
   pref_module_pimpl->bind(this);
   repl_module_pimpl->bind(this);
@@ -94,13 +136,14 @@ auto CACHE::operator=(CACHE&& other) -> CACHE&
 
 CACHE::tag_lookup_type::tag_lookup_type(const request_type& req, bool local_pref, bool skip)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
-      type(req.type), prefetch_from_this(local_pref), skip_fill(skip), is_translated(req.is_translated), instr_depend_on_me(req.instr_depend_on_me)
+      type(req.type), prefetch_from_this(local_pref), skip_fill(skip), clean_victim(req.clean_victim),
+      answers_snoop(req.answers_snoop), is_translated(req.is_translated), instr_depend_on_me(req.instr_depend_on_me)
 {
 }
 
 CACHE::mshr_type::mshr_type(const tag_lookup_type& req, champsim::chrono::clock::time_point _time_enqueued)
     : address(req.address), v_address(req.v_address), ip(req.ip), instr_id(req.instr_id), cpu(req.cpu), type(req.type),
-      prefetch_from_this(req.prefetch_from_this), time_enqueued(_time_enqueued), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return)
+      prefetch_from_this(req.prefetch_from_this), clean_victim(req.clean_victim), time_enqueued(_time_enqueued), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return)
 {
 }
 
@@ -143,7 +186,8 @@ auto CACHE::fill_block(mshr_type mshr, uint32_t metadata) -> BLOCK
   CACHE::BLOCK to_fill;
   to_fill.valid = true;
   to_fill.prefetch = mshr.prefetch_from_this;
-  to_fill.dirty = (mshr.type == access_type::WRITE);
+  to_fill.dirty = (mshr.type == access_type::WRITE && !mshr.clean_victim);
+  to_fill.shared = mshr.data_promise->shared;
   to_fill.address = mshr.address;
   to_fill.v_address = mshr.v_address;
   to_fill.data = mshr.data_promise->data;
@@ -152,13 +196,6 @@ auto CACHE::fill_block(mshr_type mshr, uint32_t metadata) -> BLOCK
   return to_fill;
 }
 
-auto CACHE::matches_address(champsim::address addr) const
-{
-  return [match = addr.slice_upper(OFFSET_BITS), shamt = OFFSET_BITS](const auto& entry) {
-    return entry.address.slice_upper(shamt) == match;
-  };
-}
-
 template <typename T>
 champsim::address CACHE::module_address(const T& element) const
 {
@@ -166,16 +203,77 @@ champsim::address CACHE::module_address(const T& element) const
   return champsim::address{address.slice_upper(match_offset_bits ? champsim::data::bits{} : OFFSET_BITS)};
 }
 
-bool CACHE::handle_fill(const mshr_type& fill_mshr)
+template <typename T>
+bool CACHE::should_activate_prefetcher(const T& pkt) const
+{
+  return !pkt.prefetch_from_this && std::count(std::begin(pref_activate_mask), std::end(pref_activate_mask), pkt.type) > 0;
+}
+
+/*
+ * Whether an exclusive cache gives up the block of this packet, because it is returned to an upper level that will fill it
+ */
+template <typename T>
+bool CACHE::passes_to_upper_level(const T& pkt) const
+{
+  return inclusion == champsim::inclusion_policy::exclusive && pkt.type != access_type::WRITE && !std::empty(pkt.to_return);
+}
+
+/*
+ * Whether the packet writes its block, so that a cache may not complete it with a copy that other caches share
+ */
+template <typename T>
+bool CACHE::requires_ownership(const T& pkt) const
+{
+  return pkt.type == access_type::RFO || (pkt.type == access_type::WRITE && match_offset_bits);
+}
+
+template <bool UpdateRequest>
+auto CACHE::initiate_tag_check(champsim::channel* ul)
+{
+  return [time = current_time + (warmup ? champsim::chrono::clock::duration{} : HIT_LATENCY), ul](const auto& entry) {
+    CACHE::tag_lookup_type retval{entry};
+    retval.event_cycle = time;
+
+    if constexpr (UpdateRequest) {
+      if (entry.response_requested) {
+        retval.to_return = {&ul->returned};
+      }
+    } else {
+      (void)ul; // supress warning about ul being unused
+    }
+
+    if constexpr (champsim::debug_print) {
+      fmt::print("[TAG] initiate_tag_check instr_id: {} address: {} v_address: {} type: {} response_requested: {}\n", retval.instr_id, retval.address,
+                 retval.v_address, access_type_names.at(champsim::to_underlying(retval.type)), !std::empty(retval.to_return));
+    }
+
+    return retval;
+  };
+}
+
+template <typename Modules>
+bool CACHE::handle_fill(const mshr_type& fill_mshr, Modules modules)
 {
   cpu = fill_mshr.cpu;
 
   // find victim
+  // An exclusive cache does not fill the blocks that it returns to an upper level
+  const bool allocate = !passes_to_upper_level(fill_mshr);
+
   auto [set_begin, set_end] = get_set_span(fill_mshr.address);
-  auto way = std::find_if_not(set_begin, set_end, [](auto x) { return x.valid; });
-  if (way == set_end) {
-    way = std::next(set_begin, impl_find_victim(fill_mshr.cpu, fill_mshr.instr_id, get_set_index(fill_mshr.address), &*set_begin, fill_mshr.ip,
-                                                fill_mshr.address, fill_mshr.type));
+
+  // A block that is already held, but could not be written because other caches share it, is filled in place.
+  // Only a coherence directory marks blocks as shared, so without one, fills replace a victim as usual.
+  auto way = std::find_if(set_begin, set_end, [matcher = matches_address(fill_mshr.address)](const auto& x) { return x.valid && matcher(x); });
+  const bool refill = allocate && way != set_end && way->shared;
+  if (!refill) {
+    // Forget that an earlier copy of the block was taken by another cache
+    std::for_each(set_begin, set_end, [matcher = matches_address(fill_mshr.address)](auto& x) { x.shared = x.shared && (x.valid || !matcher(x)); });
+    way = allocate ? std::find_if_not(set_begin, set_end, [](auto x) { return x.valid; }) : set_end;
+  }
+  if (way == set_end && allocate) {
+    way = std::next(set_begin, modules.repl.impl_find_victim(fill_mshr.cpu, fill_mshr.instr_id, get_set_index(fill_mshr.address), &*set_begin, fill_mshr.ip,
+                                                             fill_mshr.address, fill_mshr.type));
   }
   assert(set_begin <= way);
   assert(way <= set_end);
@@ -189,7 +287,8 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
                (fill_mshr.time_enqueued.time_since_epoch()) / clock_period, (current_time.time_since_epoch()) / clock_period);
   }
 
-  if (way != set_end && way->valid && way->dirty) {
+  // A lower level that is filled by victims is written every valid block, not only the dirty ones
+  if (!refill && way != set_end && way->valid && (way->dirty || lower_level->victims_requested)) {
     request_type writeback_packet;
 
     writeback_packet.cpu = fill_mshr.cpu;
@@ -200,6 +299,7 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
     writeback_packet.type = access_type::WRITE;
     writeback_packet.pf_metadata = way->pf_metadata;
     writeback_packet.response_requested = false;
+    writeback_packet.clean_victim = !way->dirty;
 
     if constexpr (champsim::debug_print) {
       fmt::print("[{}] {} evict address: {:#x} v_address: {:#x} prefetch_metadata: {}\n", NAME, __func__, writeback_packet.address, writeback_packet.v_address,
@@ -213,25 +313,62 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
   }
 
   champsim::address evicting_address{};
-  if (way != set_end && way->valid) {
+  if (!refill && way != set_end && way->valid) {
     evicting_address = module_address(*way);
+
+    if (!std::empty(directory)) {
+      // The directory does not outlive the block, so the block must leave the upper levels that may hold it
+      const auto sharers = directory.at(static_cast<std::size_t>(std::distance(std::begin(block), way))).sharers;
+      for (std::size_t i = 0; i < std::size(directory_uppers); ++i) {
+        if (((sharers >> i) & 1) != 0 && directory_uppers[i]->invalidations_accepted) {
+          directory_uppers[i]->invalidations.push_back(way->address);
+        }
+      }
+    } else if (inclusion == champsim::inclusion_policy::inclusive) {
+      for (auto* ul : upper_levels) {
+        if (ul->invalidations_accepted) {
+          ul->invalidations.push_back(way->address);
+        }
+      }
+    }
   }
 
-  auto metadata_thru = impl_prefetcher_cache_fill(module_address(fill_mshr), get_set_index(fill_mshr.address), way_idx,
-                                                  (fill_mshr.type == access_type::PREFETCH), evicting_address, fill_mshr.data_promise->pf_metadata);
-  impl_replacement_cache_fill(fill_mshr.cpu, get_set_index(fill_mshr.address), way_idx, module_address(fill_mshr), fill_mshr.ip, evicting_address,
-                              fill_mshr.type);
+  auto metadata_thru = fill_mshr.data_promise->pf_metadata;
+  if (allocate) {
+    metadata_thru = modules.pref.impl_prefetcher_cache_fill(module_address(fill_mshr), get_set_index(fill_mshr.address), way_idx,
+                                                            (fill_mshr.type == access_type::PREFETCH), evicting_address, metadata_thru);
+    modules.repl.impl_replacement_cache_fill(fill_mshr.cpu, get_set_index(fill_mshr.address), way_idx, module_address(fill_mshr), fill_mshr.ip,
+                                             evicting_address, fill_mshr.type);
+  }
 
+  bool shared = fill_mshr.data_promise->shared;
   if (way != set_end) {
-    if (way->valid && way->prefetch) {
+    if (!refill && way->valid && way->prefetch) {
       ++sim_stats.pf_useless;
     }
 
+    if (throttle.has_value()) {
+      if (!refill && way->valid && fill_mshr.prefetch_from_this) {
+        throttle->evicted_by_prefetch(way->address.slice_upper(OFFSET_BITS).template to<uint64_t>());
+      }
+      throttle->block_filled();
+    }
+
     if (fill_mshr.type == access_type::PREFETCH) {
       ++sim_stats.pf_fill;
     }
 
+    const bool was_dirty = refill && way->dirty;
     *way = fill_block(fill_mshr, metadata_thru);
+    way->dirty |= was_dirty;
+
+    if (!std::empty(directory)) {
+      const auto index = static_cast<std::size_t>(std::distance(std::begin(block), way));
+      if (!refill) {
+        directory.at(index) = directory_entry{};
+      }
+      shared = track_sharers(index, fill_mshr.address, fill_mshr.type, requesters(fill_mshr.to_return));
+    }
   }
 
   // COLLECT STATS
@@ -240,6 +377,7 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
   sim_stats.mshr_return.increment(std::pair{fill_mshr.type, fill_mshr.cpu});
 
   response_type response{fill_mshr.address, fill_mshr.v_address, fill_mshr.data_promise->data, metadata_thru, fill_mshr.instr_depend_on_me};
+  response.shared = shared;
   for (auto* ret : fill_mshr.to_return) {
     ret->push_back(response);
   }
@@ -247,16 +385,24 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
   return true;
 }
 
-bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
+template <typename Modules>
+bool CACHE::try_hit(const tag_lookup_type& handle_pkt, Modules modules)
 {
   cpu = handle_pkt.cpu;
 
   // access cache
   auto [set_begin, set_end] = get_set_span(handle_pkt.address);
   auto way = std::find_if(set_begin, set_end, [matcher = matches_address(handle_pkt.address)](const auto& x) { return x.valid && matcher(x); });
-  const auto hit = (way != set_end);
+  const auto hit = (way != set_end) && !(way->shared && requires_ownership(handle_pkt)); // Writing a shared block first requires ownership of it
   const auto useful_prefetch = (hit && way->prefetch && !handle_pkt.prefetch_from_this);
 
+  // The upper level does not know that the block is dirty, so it is written back before it is given up.
+  // Until the lower level accepts the writeback, the block stays here and the hit is retried, so that the block is never at two levels.
+  const auto gives_up_block = hit && passes_to_upper_level(handle_pkt);
+  if (gives_up_block && way->dirty && !write_back(*way, handle_pkt.cpu)) {
+    return false;
+  }
+
   if constexpr (champsim::debug_print) {
     fmt::print("[{}] {} instr_id: {} address: {} v_address: {} data: {} set: {} way: {} ({}) type: {} cycle: {}\n", NAME, __func__, handle_pkt.instr_id,
                handle_pkt.address, handle_pkt.v_address, handle_pkt.data, get_set_index(handle_pkt.address), std::distance(set_begin, way),
@@ -265,34 +411,189 @@ bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
 
   auto metadata_thru = handle_pkt.pf_metadata;
   if (should_activate_prefetcher(handle_pkt)) {
-    metadata_thru = impl_prefetcher_cache_operate(module_address(handle_pkt), handle_pkt.ip, hit, useful_prefetch, handle_pkt.type, metadata_thru);
+    if (throttle.has_value()) {
+      throttle->activate();
+    }
+    metadata_thru = modules.pref.impl_prefetcher_cache_operate(module_address(handle_pkt), handle_pkt.ip, hit, useful_prefetch, handle_pkt.type, metadata_thru);
   }
 
   // update replacement policy
   const auto way_idx = std::distance(set_begin, way);
-  impl_update_replacement_state(handle_pkt.cpu, get_set_index(handle_pkt.address), way_idx, module_address(handle_pkt), handle_pkt.ip, {}, handle_pkt.type,
-                                hit);
+  modules.repl.impl_update_replacement_state(handle_pkt.cpu, get_set_index(handle_pkt.address), way_idx, module_address(handle_pkt), handle_pkt.ip, {},
+                                             handle_pkt.type, hit);
 
   if (hit) {
     sim_stats.hits.increment(std::pair{handle_pkt.type, handle_pkt.cpu});
 
     response_type response{handle_pkt.address, handle_pkt.v_address, way->data, metadata_thru, handle_pkt.instr_depend_on_me};
+    response.shared = way->shared;
+    if (!std::empty(directory) && !std::empty(handle_pkt.to_return)) {
+      response.shared = track_sharers(static_cast<std::size_t>(std::distance(std::begin(block), way)), handle_pkt.address, handle_pkt.type,
+                                      requesters(handle_pkt.to_return));
+    }
     for (auto* ret : handle_pkt.to_return) {
       ret->push_back(response);
     }
 
-    way->dirty |= (handle_pkt.type == access_type::WRITE);
+    way->dirty |= (handle_pkt.type == access_type::WRITE && !handle_pkt.clean_victim);
 
     // update prefetch stats and reset prefetch bit
     if (useful_prefetch) {
       ++sim_stats.pf_useful;
       way->prefetch = false;
+      if (throttle.has_value()) {
+        throttle->prefetch_useful();
+      }
+    }
+
+    if (gives_up_block) {
+      way->valid = false;
     }
   }
 
   return hit;
 }
 
+template <typename Modules>
+long CACHE::operate_with(Modules modules)
+{
+  long progress{0};
+
+  auto is_ready = [time = current_time](const auto& entry) {
+    return entry.event_cycle <= time;
+  };
+  auto is_translated = [](const auto& entry) {
+    return entry.is_translated;
+  };
+
+  for (auto* ul : upper_levels) {
+    ul->check_collision();
+    ul->memory_utilization = lower_level->memory_utilization;
+  }
+
+  if (throttle.has_value()) {
+    throttle->observe_utilization(lower_level->memory_utilization);
+  }
+
+  // Finish returns
+  std::for_each(std::cbegin(lower_level->returned), std::cend(lower_level->returned), [this](const auto& pkt) { this->finish_packet(pkt); });
+  progress += std::distance(std::cbegin(lower_level->returned), std::cend(lower_level->returned));
+  lower_level->returned.clear();
+
+  // Remove the blocks that an inclusive lower level has evicted
+  while (!std::empty(lower_level->invalidations) && back_invalidate(lower_level->invalidations.front())) {
+    lower_level->invalidations.pop_front();
+    ++progress;
+  }
+
+  // Answer the coherence directory below
+  while (!std::empty(lower_level->snoops) && handle_snoop(lower_level->snoops.front())) {
+    lower_level->snoops.pop_front();
+    ++progress;
+  }
+
+  // Finish translations
+  if (lower_translate != nullptr) {
+    std::for_each(std::cbegin(lower_translate->returned), std::cend(lower_translate->returned), [this](const auto& pkt) { this->finish_translation(pkt); });
+    progress += std::distance(std::cbegin(lower_translate->returned), std::cend(lower_translate->returned));
+    lower_translate->returned.clear();
+  }
+
+  // Perform fills
+  champsim::bandwidth fill_bw{MAX_FILL};
+  for (auto q : {std::ref(MSHR), std::ref(inflight_writes)}) {
+    auto [fill_begin, fill_end] = champsim::get_span_p(std::cbegin(q.get()), std::cend(q.get()), fill_bw,
+                                                       [time = current_time](const auto& x) { return x.data_promise.is_ready_at(time); });
+    auto complete_end = std::find_if_not(fill_begin, fill_end, [this, modules](const auto& x) { return this->handle_fill(x, modules); });
+    fill_bw.consume(std::distance(fill_begin, complete_end));
+    q.get().erase(fill_begin, complete_end);
+  }
+
+  // Initiate tag checks
+  const champsim::bandwidth::maximum_type bandwidth_from_tag_checks{champsim::to_underlying(MAX_TAG) * (long)(HIT_LATENCY / clock_period)
+                                                                    - (long)std::size(inflight_tag_check)};
+  champsim::bandwidth initiate_tag_bw{std::clamp(bandwidth_from_tag_checks, champsim::bandwidth::maximum_type{0}, MAX_TAG)};
+  auto can_translate = [avail = (std::size(translation_stash) < static_cast<std::size_t>(MSHR_SIZE))](const auto& entry) {
+    return avail || entry.is_translated;
+  };
+  const auto last_inflight = std::empty(inflight_tag_check) ? std::end(inflight_tag_check) : std::prev(std::end(inflight_tag_check));
+  auto stash_bandwidth_consumed =
+      champsim::transform_while_n(translation_stash, std::back_inserter(inflight_tag_check), initiate_tag_bw, is_translated, initiate_tag_check<false>());
+  initiate_tag_bw.consume(stash_bandwidth_consumed);
+  std::vector<long long> channels_bandwidth_consumed{};
+
+  if (std::size(upper_levels) > 1) {
+    std::rotate(upper_levels.begin(), upper_levels.begin() + 1, upper_levels.end());
+  }
+
+  // upper levels get an equal portion of the remaining bandwidth
+  champsim::bandwidth::maximum_type per_upper_bandwidth =
+      std::size(upper_levels) >= 1
+          ? (champsim::bandwidth::maximum_type)std::max((size_t)initiate_tag_bw.amount_remaining() / std::size(upper_levels), size_t{1})
+          : champsim::bandwidth::maximum_type{};
+
+  for (auto* ul : upper_levels) {
+    for (auto q : {std::ref(ul->WQ), std::ref(ul->RQ), std::ref(ul->PQ)}) {
+      // this needs to be in this loop, we need to ensure that for cases where bandwidth doesn't divide nicely across upstreams,
+      // we don't accidentally consume more bandwidth than expected
+      champsim::bandwidth per_upper_tag_bw{std::min(per_upper_bandwidth, champsim::bandwidth::maximum_type{initiate_tag_bw.amount_remaining()})};
+      auto bandwidth_consumed =
+          champsim::transform_while_n(q.get(), std::back_inserter(inflight_tag_check), per_upper_tag_bw, can_translate, initiate_tag_check<true>(ul));
+      channels_bandwidth_consumed.push_back(bandwidth_consumed);
+      initiate_tag_bw.consume(bandwidth_consumed);
+    }
+  }
+
+  auto pq_bandwidth_consumed =
+      champsim::transform_while_n(internal_PQ, std::back_inserter(inflight_tag_check), initiate_tag_bw, can_translate, initiate_tag_check<false>());
+  initiate_tag_bw.consume(pq_bandwidth_consumed);
+
+  index_tag_checks(last_inflight == std::end(inflight_tag_check) ? std::begin(inflight_tag_check) : std::next(last_inflight));
+
+  // Issue translations
+  issue_translations();
+
+  // Find entries that would be ready except that they have not finished translation, move them to the stash
+  progress += stash_untranslated();
+
+  // Perform tag checks
+  auto do_handle_miss = [this](const auto& pkt) {
+    if (this->hit_must_write_back(pkt)) {
+      return false; // A hit that waits to write back its block is retried, not treated as a miss
+    }
+    if (pkt.type == access_type::WRITE && !this->match_offset_bits) {
+      return this->handle_write(pkt); // Treat writes (that is, writebacks) like fills
+    }
+    return this->handle_miss(pkt); // Treat writes (that is, stores) like reads
+  };
+  champsim::bandwidth tag_check_bw{MAX_TAG};
+  auto [tag_check_ready_begin, tag_check_ready_end] =
+      champsim::get_span_p(std::begin(inflight_tag_check), std::end(inflight_tag_check), tag_check_bw,
+                           [is_ready, is_translated](const auto& pkt) { return is_ready(pkt) && is_translated(pkt); });
+  auto hits_end = std::stable_partition(tag_check_ready_begin, tag_check_ready_end, [this, modules](const auto& pkt) { return this->try_hit(pkt, modules); });
+  auto finish_tag_check_end = std::stable_partition(hits_end, tag_check_ready_end, do_handle_miss);
+  tag_check_bw.consume(std::distance(tag_check_ready_begin, finish_tag_check_end));
+
+  // Tag checks that must be retried are not recorded until they complete
+  if (stack_distance.has_value()) {
+    std::for_each(tag_check_ready_begin, finish_tag_check_end,
+                  [this](const auto& pkt) { this->stack_distance->access(pkt.address.slice_upper(OFFSET_BITS).template to<uint64_t>(), sim_stats.stack_distances); });
+  }
+
+  inflight_tag_check.erase(tag_check_ready_begin, finish_tag_check_end);
+
+  modules.pref.impl_prefetcher_cycle_operate();
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} cycle completed: {} tags checked: {} remaining: {} stash consumed: {} remaining: {} channel consumed: {} pq consumed {} unused consume "
+               "bw {}\n",
+               NAME, __func__, current_time.time_since_epoch() / clock_period, tag_check_bw.amount_consumed(), std::size(inflight_tag_check),
+               stash_bandwidth_consumed, std::size(translation_stash), channels_bandwidth_consumed, pq_bandwidth_consumed, initiate_tag_bw.amount_remaining());
+  }
+
+  return progress + fill_bw.amount_consumed() + initiate_tag_bw.amount_consumed() + tag_check_bw.amount_consumed();
+}
+
 auto CACHE::mshr_and_forward_packet(const tag_lookup_type& handle_pkt) -> std::pair<mshr_type, request_type>
 {
   mshr_type to_allocate{handle_pkt, current_time};
@@ -338,9 +639,14 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
   if (mshr_entry != MSHR.end()) // miss already inflight
   {
     if (mshr_entry->type == access_type::PREFETCH && handle_pkt.type != access_type::PREFETCH) {
-      // Mark the prefetch as useful
+      // Mark the prefetch as useful, but late
       if (mshr_entry->prefetch_from_this) {
         ++sim_stats.pf_useful;
+        ++sim_stats.pf_late;
+        if (throttle.has_value()) {
+          throttle->prefetch_useful();
+          throttle->prefetch_late();
+        }
       }
     }
 
@@ -363,11 +669,24 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
     // Allocate an MSHR
     if (mshr_pkt.second.response_requested) {
       MSHR.emplace_back(std::move(mshr_pkt.first));
+      if (throttle.has_value() && handle_pkt.prefetch_from_this) {
+        throttle->prefetch_issued();
+      }
     }
   }
 
   sim_stats.misses.increment(std::pair{handle_pkt.type, handle_pkt.cpu});
 
+  if (throttle.has_value() && handle_pkt.type != access_type::PREFETCH) {
+    throttle->demand_miss(handle_pkt.address.slice_upper(OFFSET_BITS).to<uint64_t>());
+  }
+
+  // The block was taken by another cache's write, or is held but shared with other caches
+  auto [set_begin, set_end] = get_set_span(handle_pkt.address);
+  if (std::any_of(set_begin, set_end, [matcher = matches_address(handle_pkt.address)](const auto& x) { return x.shared && matcher(x); })) {
+    ++sim_stats.coherence_misses;
+  }
+
   return true;
 }
 
@@ -379,6 +698,23 @@ bool CACHE::handle_write(const tag_lookup_type& handle_pkt)
                current_time.time_since_epoch() / clock_period);
   }
 
+  // Under inclusion, a writeback misses only if its block was evicted, and so invalidated above, while the writeback was in flight.
+  // It is passed on rather than filled, so that it does not evict another block.
+  // Likewise, a writeback that answers a snoop misses only if this cache gave up its own copy to the snoop before passing it up.
+  // It is passed on toward the directory that sent the snoop, so that this cache does not take back a block that the directory believes it gave up.
+  if (inclusion == champsim::inclusion_policy::inclusive || handle_pkt.answers_snoop) {
+    BLOCK written;
+    written.address = handle_pkt.address;
+    written.data = handle_pkt.data;
+    written.pf_metadata = handle_pkt.pf_metadata;
+    if (!write_back(written, handle_pkt.cpu)) {
+      return false;
+    }
+
+    sim_stats.misses.increment(std::pair{handle_pkt.type, handle_pkt.cpu});
+    return true;
+  }
+
   mshr_type to_allocate{handle_pkt, current_time};
   to_allocate.data_promise.ready_at(current_time + (warmup ? champsim::chrono::clock::duration{} : FILL_LATENCY));
   inflight_writes.push_back(to_allocate);
@@ -388,143 +724,152 @@ bool CACHE::handle_write(const tag_lookup_type& handle_pkt)
   return true;
 }
 
-template <bool UpdateRequest>
-auto CACHE::initiate_tag_check(champsim::channel* ul)
+bool CACHE::write_back(const champsim::cache_block& blk, uint32_t triggering_cpu, bool answers_snoop)
 {
-  return [time = current_time + (warmup ? champsim::chrono::clock::duration{} : HIT_LATENCY), ul](const auto& entry) {
-    CACHE::tag_lookup_type retval{entry};
-    retval.event_cycle = time;
+  request_type writeback_packet;
 
-    if constexpr (UpdateRequest) {
-      if (entry.response_requested) {
-        retval.to_return = {&ul->returned};
-      }
-    } else {
-      (void)ul; // supress warning about ul being unused
-    }
-
-    if constexpr (champsim::debug_print) {
-      fmt::print("[TAG] initiate_tag_check instr_id: {} address: {} v_address: {} type: {} response_requested: {}\n", retval.instr_id, retval.address,
-                 retval.v_address, access_type_names.at(champsim::to_underlying(retval.type)), !std::empty(retval.to_return));
-    }
+  writeback_packet.cpu = triggering_cpu;
+  writeback_packet.address = blk.address;
+  writeback_packet.data = blk.data;
+  writeback_packet.type = access_type::WRITE;
+  writeback_packet.pf_metadata = blk.pf_metadata;
+  writeback_packet.response_requested = false;
+  writeback_packet.answers_snoop = answers_snoop;
 
-    return retval;
-  };
+  return lower_level->add_wq(writeback_packet);
 }
 
-long CACHE::operate()
+bool CACHE::hit_must_write_back(const tag_lookup_type& handle_pkt) const
 {
-  long progress{0};
+  auto [set_begin, set_end] = get_set_span(handle_pkt.address);
+  auto way = std::find_if(set_begin, set_end, [matcher = matches_address(handle_pkt.address)](const auto& x) { return x.valid && matcher(x); });
+  return way != set_end && !(way->shared && requires_ownership(handle_pkt)) && way->dirty && passes_to_upper_level(handle_pkt);
+}
 
-  auto is_ready = [time = current_time](const auto& entry) {
-    return entry.event_cycle <= time;
-  };
-  auto is_translated = [](const auto& entry) {
-    return entry.is_translated;
-  };
+bool CACHE::back_invalidate(champsim::address address)
+{
+  auto [set_begin, set_end] = get_set_span(address);
+  auto way = std::find_if(set_begin, set_end, [matcher = matches_address(address)](const auto& x) { return x.valid && matcher(x); });
 
-  for (auto* ul : upper_levels) {
-    ul->check_collision();
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} address: {} set: {} way: {} cycle: {}\n", NAME, __func__, address, get_set_index(address), std::distance(set_begin, way),
+               current_time.time_since_epoch() / clock_period);
   }
 
-  // Finish returns
-  std::for_each(std::cbegin(lower_level->returned), std::cend(lower_level->returned), [this](const auto& pkt) { this->finish_packet(pkt); });
-  progress += std::distance(std::cbegin(lower_level->returned), std::cend(lower_level->returned));
-  lower_level->returned.clear();
+  if (way != set_end) {
+    if (way->dirty && !write_back(*way, cpu)) {
+      return false;
+    }
 
-  // Finish translations
-  if (lower_translate != nullptr) {
-    std::for_each(std::cbegin(lower_translate->returned), std::cend(lower_translate->returned), [this](const auto& pkt) { this->finish_translation(pkt); });
-    progress += std::distance(std::cbegin(lower_translate->returned), std::cend(lower_translate->returned));
-    lower_translate->returned.clear();
+    way->valid = false;
+    way->shared = false;
+    ++sim_stats.back_invalidations;
   }
 
-  // Perform fills
-  champsim::bandwidth fill_bw{MAX_FILL};
-  for (auto q : {std::ref(MSHR), std::ref(inflight_writes)}) {
-    auto [fill_begin, fill_end] = champsim::get_span_p(std::cbegin(q.get()), std::cend(q.get()), fill_bw,
-                                                       [time = current_time](const auto& x) { return x.data_promise.is_ready_at(time); });
-    auto complete_end = std::find_if_not(fill_begin, fill_end, [this](const auto& x) { return this->handle_fill(x); });
-    fill_bw.consume(std::distance(fill_begin, complete_end));
-    q.get().erase(fill_begin, complete_end);
+  // The block must also leave every level above this one
+  for (auto* ul : upper_levels) {
+    if (ul->invalidations_accepted) {
+      ul->invalidations.push_back(address);
+    }
   }
 
-  // Initiate tag checks
-  const champsim::bandwidth::maximum_type bandwidth_from_tag_checks{champsim::to_underlying(MAX_TAG) * (long)(HIT_LATENCY / clock_period)
-                                                                    - (long)std::size(inflight_tag_check)};
-  champsim::bandwidth initiate_tag_bw{std::clamp(bandwidth_from_tag_checks, champsim::bandwidth::maximum_type{0}, MAX_TAG)};
-  auto can_translate = [avail = (std::size(translation_stash) < static_cast<std::size_t>(MSHR_SIZE))](const auto& entry) {
-    return avail || entry.is_translated;
-  };
-  auto stash_bandwidth_consumed =
-      champsim::transform_while_n(translation_stash, std::back_inserter(inflight_tag_check), initiate_tag_bw, is_translated, initiate_tag_check<false>());
-  initiate_tag_bw.consume(stash_bandwidth_consumed);
-  std::vector<long long> channels_bandwidth_consumed{};
+  return true;
+}
 
-  if (std::size(upper_levels) > 1) {
-    std::rotate(upper_levels.begin(), upper_levels.begin() + 1, upper_levels.end());
+bool CACHE::handle_snoop(const snoop_type& snoop)
+{
+  auto [set_begin, set_end] = get_set_span(snoop.address);
+  auto way = std::find_if(set_begin, set_end, [matcher = matches_address(snoop.address)](const auto& x) { return x.valid && matcher(x); });
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} address: {} exclusive: {} set: {} way: {} cycle: {}\n", NAME, __func__, snoop.address, snoop.exclusive, get_set_index(snoop.address),
+               std::distance(set_begin, way), current_time.time_since_epoch() / clock_period);
   }
 
-  // upper levels get an equal portion of the remaining bandwidth
-  champsim::bandwidth::maximum_type per_upper_bandwidth =
-      std::size(upper_levels) >= 1
-          ? (champsim::bandwidth::maximum_type)std::max((size_t)initiate_tag_bw.amount_remaining() / std::size(upper_levels), size_t{1})
-          : champsim::bandwidth::maximum_type{};
+  if (way != set_end) {
+    const bool keep_dirty = snoop.owned && !snoop.exclusive;
+    if (way->dirty && !keep_dirty && !write_back(*way, cpu, true)) {
+      return false;
+    }
+
+    // An invalid block that remains marked as shared was taken by another cache
+    way->valid = way->valid && !snoop.exclusive;
+    way->dirty = way->dirty && keep_dirty;
+    way->shared = true;
+  }
 
   for (auto* ul : upper_levels) {
-    for (auto q : {std::ref(ul->WQ), std::ref(ul->RQ), std::ref(ul->PQ)}) {
-      // this needs to be in this loop, we need to ensure that for cases where bandwidth doesn't divide nicely across upstreams,
-      // we don't accidentally consume more bandwidth than expected
-      champsim::bandwidth per_upper_tag_bw{std::min(per_upper_bandwidth, champsim::bandwidth::maximum_type{initiate_tag_bw.amount_remaining()})};
-      auto bandwidth_consumed =
-          champsim::transform_while_n(q.get(), std::back_inserter(inflight_tag_check), per_upper_tag_bw, can_translate, initiate_tag_check<true>(ul));
-      channels_bandwidth_consumed.push_back(bandwidth_consumed);
-      initiate_tag_bw.consume(bandwidth_consumed);
+    if (ul->invalidations_accepted) {
+      ul->snoops.push_back(snoop);
     }
   }
 
-  auto pq_bandwidth_consumed =
-      champsim::transform_while_n(internal_PQ, std::back_inserter(inflight_tag_check), initiate_tag_bw, can_translate, initiate_tag_check<false>());
-  initiate_tag_bw.consume(pq_bandwidth_consumed);
-
-  // Issue translations
-  std::for_each(std::begin(inflight_tag_check), std::end(inflight_tag_check), [this](auto& x) { this->issue_translation(x); });
-  std::for_each(std::begin(translation_stash), std::end(translation_stash), [this](auto& x) { this->issue_translation(x); });
+  return true;
+}
 
-  // Find entries that would be ready except that they have not finished translation, move them to the stash
-  auto [last_not_missed, stash_end] = champsim::extract_if(std::begin(inflight_tag_check), std::end(inflight_tag_check), std::back_inserter(translation_stash),
-                                                           [is_ready, is_translated](const auto& x) { return is_ready(x) && !is_translated(x); });
-  progress += std::distance(last_not_missed, std::end(inflight_tag_check));
-  inflight_tag_check.erase(last_not_missed, std::end(inflight_tag_check));
+uint64_t CACHE::requesters(const std::vector<std::deque<response_type>*>& to_return) const
+{
+  uint64_t retval = 0;
+  for (std::size_t i = 0; i < std::size(directory_uppers); ++i) {
+    if (std::find(std::begin(to_return), std::end(to_return), &directory_uppers[i]->returned) != std::end(to_return)) {
+      retval |= uint64_t{1} << i;
+    }
+  }
+  return retval;
+}
 
-  // Perform tag checks
-  auto do_handle_miss = [this](const auto& pkt) {
-    if (pkt.type == access_type::WRITE && !this->match_offset_bits) {
-      return this->handle_write(pkt); // Treat writes (that is, writebacks) like fills
+void CACHE::send_snoops(uint64_t targets, const snoop_type& snoop)
+{
+  for (std::size_t i = 0; i < std::size(directory_uppers); ++i) {
+    if (((targets >> i) & 1) != 0 && directory_uppers[i]->invalidations_accepted) {
+      directory_uppers[i]->snoops.push_back(snoop);
+      ++sim_stats.coherence_snoops;
     }
-    return this->handle_miss(pkt); // Treat writes (that is, stores) like reads
-  };
-  champsim::bandwidth tag_check_bw{MAX_TAG};
-  auto [tag_check_ready_begin, tag_check_ready_end] =
-      champsim::get_span_p(std::begin(inflight_tag_check), std::end(inflight_tag_check), tag_check_bw,
-                           [is_ready, is_translated](const auto& pkt) { return is_ready(pkt) && is_translated(pkt); });
-  auto hits_end = std::stable_partition(tag_check_ready_begin, tag_check_ready_end, [this](const auto& pkt) { return this->try_hit(pkt); });
-  auto finish_tag_check_end = std::stable_partition(hits_end, tag_check_ready_end, do_handle_miss);
-  tag_check_bw.consume(std::distance(tag_check_ready_begin, finish_tag_check_end));
-  inflight_tag_check.erase(tag_check_ready_begin, finish_tag_check_end);
+  }
+}
 
-  impl_prefetcher_cycle_operate();
+/*
+ * Record that the requesters hold the block at the given index, and take the block or its ownership from the other upper levels as the access requires.
+ * Returns whether the requesters must treat their copies as shared.
+ */
+bool CACHE::track_sharers(std::size_t index, champsim::address address, access_type type, uint64_t requested_by)
+{
+  auto& entry = directory.at(index);
+  const bool moesi = (coherence == champsim::coherence_protocol::moesi);
 
-  if constexpr (champsim::debug_print) {
-    fmt::print("[{}] {} cycle completed: {} tags checked: {} remaining: {} stash consumed: {} remaining: {} channel consumed: {} pq consumed {} unused consume "
-               "bw {}\n",
-               NAME, __func__, current_time.time_since_epoch() / clock_period, tag_check_bw.amount_consumed(), std::size(inflight_tag_check),
-               stash_bandwidth_consumed, std::size(translation_stash), channels_bandwidth_consumed, pq_bandwidth_consumed, initiate_tag_bw.amount_remaining());
+  if (type == access_type::RFO) {
+    send_snoops(entry.sharers & ~requested_by, snoop_type{address, true, moesi});
+    entry.sharers = requested_by;
+  } else {
+    send_snoops(entry.owner & ~requested_by, snoop_type{address, false, moesi});
+    entry.sharers |= requested_by;
   }
 
-  return progress + fill_bw.amount_consumed() + initiate_tag_bw.amount_consumed() + tag_check_bw.amount_consumed();
+  // A single holder owns the block, whether or not it has written it yet
+  const bool shared = (std::bitset<std::numeric_limits<uint64_t>::digits>{entry.sharers}.count() > 1);
+  entry.owner = shared ? 0 : entry.sharers;
+  return shared;
+}
+
+template <typename P, typename R>
+long CACHE::operate_as(CACHE& cache)
+{
+  return cache.operate_with(module_refs<P, R>{static_cast<P&>(*cache.pref_module_pimpl), static_cast<R&>(*cache.repl_module_pimpl)});
 }
 
+template long CACHE::operate_as<CACHE::prefetcher_module_concept, CACHE::replacement_module_concept>(CACHE& cache);
+
+auto CACHE::find_operate(const std::type_info& modules) -> operate_type
+{
+  static const auto configured = configured_operate();
+  if (auto found = configured.find(std::type_index{modules}); found != std::end(configured)) {
+    return found->second;
+  }
+  return &operate_as<prefetcher_module_concept, replacement_module_concept>;
+}
+
+long CACHE::operate() { return operate_dispatch(*this); }
+
 // LCOV_EXCL_START exclude deprecated function
 uint64_t CACHE::get_set(uint64_t address) const { return static_cast<uint64_t>(get_set_index(champsim::address{address})); }
 // LCOV_EXCL_STOP
@@ -581,6 +926,11 @@ bool CACHE::prefetch_line(champsim::address pf_addr, bool fill_this_level, uint3
     return false;
   }
 
+  if (throttle.has_value() && !throttle->permit()) {
+    ++sim_stats.pf_throttled;
+    return false;
+  }
+
   request_type pf_packet;
   pf_packet.type = access_type::PREFETCH;
   pf_packet.pf_metadata = prefetch_metadata;
@@ -620,7 +970,7 @@ void CACHE::finish_packet(const response_type& packet)
   }
 
   // MSHR holds the most updated information about this request
-  mshr_type::returned_value finished_value{packet.data, packet.pf_metadata};
+  mshr_type::returned_value finished_value{packet.data, packet.pf_metadata, packet.shared};
   mshr_entry->data_promise = champsim::waitable{finished_value, current_time + (warmup ? champsim::chrono::clock::duration{} : FILL_LATENCY)};
   if constexpr (champsim::debug_print) {
     fmt::print("[{}_MSHR] finish_packet instr_id: {} address: {} data: {} type: {} current: {}\n", this->NAME, mshr_entry->instr_id, mshr_entry->address,
@@ -634,9 +984,13 @@ void CACHE::finish_packet(const response_type& packet)
 
 void CACHE::finish_translation(const response_type& packet)
 {
-  auto matches_vpage = [page_num = champsim::page_number{packet.v_address}](const auto& entry) {
-    return (champsim::page_number{entry.v_address} == page_num) && !entry.is_translated;
-  };
+  auto waiting = awaiting_translation.find(champsim::page_number{packet.v_address});
+  if (waiting == std::end(awaiting_translation)) {
+    return;
+  }
+  auto matches = std::move(waiting->second);
+  awaiting_translation.erase(waiting);
+
   auto mark_translated = [p_page = champsim::page_number{packet.data}, this](auto& entry) {
     [[maybe_unused]] auto old_address = entry.address;
     entry.address = champsim::address{champsim::splice(p_page, champsim::page_offset{entry.v_address})}; // translated address
@@ -648,17 +1002,71 @@ void CACHE::finish_translation(const response_type& packet)
     }
   };
 
-  // Restart stashed translations
-  auto finish_begin = std::find_if_not(std::begin(translation_stash), std::end(translation_stash), [](const auto& x) { return x.is_translated; });
-  auto finish_end = std::stable_partition(finish_begin, std::end(translation_stash), matches_vpage);
-  std::for_each(finish_begin, finish_end, mark_translated);
+  auto stashed_end = std::stable_partition(std::begin(matches), std::end(matches), [](auto it) { return it->stashed; });
+  auto by_sequence = [](auto lhs, auto rhs) { return lhs->sequence < rhs->sequence; };
+  std::sort(std::begin(matches), stashed_end, by_sequence);
+  std::sort(stashed_end, std::end(matches), by_sequence);
+
+  // Restart stashed translations, ahead of the stashed entries that remain untranslated
+  std::for_each(std::begin(matches), stashed_end, [mark_translated](auto it) { mark_translated(*it); });
+  auto first_untranslated = std::find_if_not(std::begin(translation_stash), std::end(translation_stash), [](const auto& x) { return x.is_translated; });
+  std::for_each(std::begin(matches), stashed_end, [this, first_untranslated](auto it) { translation_stash.splice(first_untranslated, translation_stash, it); });
+
+  // Packets in the tag check queue that match the page of the returned packet no longer wait for their translation
+  std::for_each(stashed_end, std::end(matches), [mark_translated, this](auto it) {
+    mark_translated(*it);
+    auto [first, last] = untranslated_by_ready_time.equal_range(it->event_cycle);
+    untranslated_by_ready_time.erase(std::find_if(first, last, [it](const auto& x) { return x.second == it; }));
+  });
+
+  for (auto* unissued : {&unissued_inflight, &unissued_stash}) {
+    unissued->erase(std::remove_if(std::begin(*unissued), std::end(*unissued), [](auto it) { return it->is_translated; }), std::end(*unissued));
+  }
+}
+
+void CACHE::index_tag_checks(tag_queue_type::iterator first)
+{
+  for (auto it = first; it != std::end(inflight_tag_check); ++it) {
+    it->sequence = tag_queue_sequence++;
+    if (!it->is_translated) {
+      untranslated_by_ready_time.emplace(it->event_cycle, it);
+      awaiting_translation[champsim::page_number{it->v_address}].push_back(it);
+      if (!it->translate_issued) {
+        unissued_inflight.push_back(it);
+      }
+    }
+  }
+}
+
+void CACHE::issue_translations()
+{
+  for (auto* unissued : {&unissued_inflight, &unissued_stash}) {
+    std::for_each(std::begin(*unissued), std::end(*unissued), [this](auto it) { this->issue_translation(*it); });
+    unissued->erase(std::remove_if(std::begin(*unissued), std::end(*unissued), [](auto it) { return it->translate_issued; }), std::end(*unissued));
+  }
+}
 
-  // Find all packets that match the page of the returned packet
-  for (auto& entry : inflight_tag_check) {
-    if (matches_vpage(entry)) {
-      mark_translated(entry);
+long CACHE::stash_untranslated()
+{
+  // The ready entries are stashed in the order of the tag check queue
+  auto ready_end = untranslated_by_ready_time.upper_bound(current_time);
+  std::vector<tag_queue_type::iterator> ready;
+  std::transform(std::begin(untranslated_by_ready_time), ready_end, std::back_inserter(ready), [](const auto& x) { return x.second; });
+  untranslated_by_ready_time.erase(std::begin(untranslated_by_ready_time), ready_end);
+  std::sort(std::begin(ready), std::end(ready), [](auto lhs, auto rhs) { return lhs->sequence < rhs->sequence; });
+
+  for (auto it : ready) {
+    it->stashed = true;
+    it->sequence = tag_queue_sequence++;
+    translation_stash.splice(std::end(translation_stash), inflight_tag_check, it);
+
+    if (!it->translate_issued) {
+      unissued_inflight.erase(std::find(std::begin(unissued_inflight), std::end(unissued_inflight), it));
+      unissued_stash.push_back(it);
     }
   }
+
+  return static_cast<long>(std::size(ready));
 }
 
 void CACHE::issue_translation(tag_lookup_type& q_entry) const
@@ -851,6 +1259,11 @@ void CACHE::begin_phase()
   new_roi_stats.name = NAME;
   new_sim_stats.name = NAME;
 
+  if (stack_distance.has_value()) {
+    new_roi_stats.stack_distances = stack_distance->empty_histograms();
+    new_sim_stats.stack_distances = stack_distance->empty_histograms();
+  }
+
   roi_stats = new_roi_stats;
   sim_stats = new_sim_stats;
 
@@ -877,6 +1290,13 @@ void CACHE::end_phase(unsigned finished_cpu)
   roi_stats.pf_useful = sim_stats.pf_useful;
   roi_stats.pf_useless = sim_stats.pf_useless;
   roi_stats.pf_fill = sim_stats.pf_fill;
+  roi_stats.pf_late = sim_stats.pf_late;
+  roi_stats.pf_throttled = sim_stats.pf_throttled;
+  roi_stats.back_invalidations = sim_stats.back_invalidations;
+  roi_stats.coherence_misses = sim_stats.coherence_misses;
+  roi_stats.coherence_snoops = sim_stats.coherence_snoops;
+
+  roi_stats.stack_distances = sim_stats.stack_distances;
 
   for (auto* ul : upper_levels) {
     ul->roi_stats.RQ_ACCESS = ul->sim_stats.RQ_ACCESS;
@@ -897,12 +1317,6 @@ void CACHE::end_phase(unsigned finished_cpu)
   }
 }
 
-template <typename T>
-bool CACHE::should_activate_prefetcher(const T& pkt) const
-{
-  return !pkt.prefetch_from_this && std::count(std::begin(pref_activate_mask), std::end(pref_activate_mask), pkt.type) > 0;
-}
-
 // LCOV_EXCL_START Exclude the following function from LCOV
 void CACHE::print_deadlock()
 {
@@ -934,3 +1348,9 @@ void CACHE::print_deadlock()
   }
 }
 // LCOV_EXCL_STOP
+
+#if __has_include("cache_operate.inc")
+#include "cache_operate.inc"
+#else
+auto CACHE::configured_operate() -> std::map<std::type_index, operate_type> { return {}; }
+#endif
@@ -1,5 +1,8 @@
 #include "cache_stats.h"
 
+#include <algorithm>
+#include <iterator>
+
 cache_stats operator-(cache_stats lhs, cache_stats rhs)
 {
   cache_stats result;
@@ -8,10 +11,20 @@ cache_stats operator-(cache_stats lhs, cache_stats rhs)
   result.pf_useful = lhs.pf_useful - rhs.pf_useful;
   result.pf_useless = lhs.pf_useless - rhs.pf_useless;
   result.pf_fill = lhs.pf_fill - rhs.pf_fill;
+  result.pf_late = lhs.pf_late - rhs.pf_late;
+  result.pf_throttled = lhs.pf_throttled - rhs.pf_throttled;
+  result.back_invalidations = lhs.back_invalidations - rhs.back_invalidations;
+  result.coherence_misses = lhs.coherence_misses - rhs.coherence_misses;
+  result.coherence_snoops = lhs.coherence_snoops - rhs.coherence_snoops;
 
   result.hits = lhs.hits - rhs.hits;
   result.misses = lhs.misses - rhs.misses;
 
   result.total_miss_latency_cycles = lhs.total_miss_latency_cycles - rhs.total_miss_latency_cycles;
+
+  if (std::size(lhs.stack_distances) == std::size(rhs.stack_distances)) {
+    std::transform(std::begin(lhs.stack_distances), std::end(lhs.stack_distances), std::begin(rhs.stack_distances),
+                   std::back_inserter(result.stack_distances), [](const auto& x, const auto& y) { return x - y; });
+  }
   return result;
 }
@@ -19,14 +19,19 @@
 #include <algorithm>
 #include <chrono>
 #include <numeric>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 #include <fmt/chrono.h>
 #include <fmt/core.h>
 
+#include "clock_schedule.h"
 #include "environment.h"
 #include "ooo_cpu.h"
 #include "operable.h"
 #include "phase_info.h"
+#include "trace_broadcast.h"
 #include "tracereader.h"
 
 constexpr int DEADLOCK_CYCLE{500};
@@ -37,29 +42,56 @@ std::chrono::seconds elapsed_time() { return std::chrono::duration_cast<std::chr
 
 namespace champsim
 {
-long do_cycle(environment& env, std::vector<tracereader>& traces, std::vector<std::size_t> trace_index, champsim::chrono::clock& global_clock)
+long do_cycle(environment& env, clock_schedule& schedule, std::vector<tracereader>& traces, const std::vector<std::vector<std::size_t>>& thread_traces,
+              champsim::chrono::clock& global_clock)
 {
-  auto operables = env.operable_view();
-  std::sort(std::begin(operables), std::end(operables),
-            [](const champsim::operable& lhs, const champsim::operable& rhs) { return lhs.current_time < rhs.current_time; });
-
   // Operate
-  long progress{0};
-  for (champsim::operable& op : operables) {
-    progress += op.operate_on(global_clock);
-  }
+  long progress = schedule.operate_on(global_clock);
 
-  // Read from trace
+  // Read from trace, with one trace for each hardware thread of each core
   for (O3_CPU& cpu : env.cpu_view()) {
-    auto& trace = traces.at(trace_index.at(cpu.cpu));
-    for (auto pkt_count = cpu.IN_QUEUE_SIZE - static_cast<long>(std::size(cpu.input_queue)); !trace.eof() && pkt_count > 0; --pkt_count) {
-      cpu.input_queue.push_back(trace());
+    for (std::size_t i = 0; i < cpu.num_threads(); ++i) {
+      auto& thread = cpu.threads[i];
+      auto& trace = traces.at(thread_traces.at(cpu.cpu).at(i));
+      for (auto pkt_count = cpu.IN_QUEUE_SIZE - static_cast<long>(std::size(thread.input_queue)); !trace.eof() && pkt_count > 0; --pkt_count) {
+        thread.input_queue.push_back(trace());
+      }
     }
   }
 
   return progress;
 }
 
+std::vector<host_time_stats> host_time_by_component(environment& env)
+{
+  std::vector<host_time_stats> retval;
+  auto record = [&retval](std::string name, std::string kind, const champsim::operable& op) {
+    retval.push_back({std::move(name), std::move(kind), std::chrono::duration_cast<std::chrono::nanoseconds>(op.host_time)});
+  };
+
+  for (const O3_CPU& cpu : env.cpu_view()) {
+    record(fmt::format("cpu{}", cpu.cpu), "O3_CPU", cpu);
+  }
+  for (const CACHE& cache : env.cache_view()) {
+    record(cache.NAME, "CACHE", cache);
+  }
+  for (const PageTableWalker& ptw : env.ptw_view()) {
+    record(ptw.NAME, "PageTableWalker", ptw);
+  }
+  record("DRAM", "MEMORY_CONTROLLER", env.dram_view());
+
+  // Operables that are not in any view, such as the interconnects, are counted together
+  auto named = std::accumulate(std::begin(retval), std::end(retval), std::chrono::nanoseconds{}, [](auto acc, const auto& x) { return acc + x.time; });
+  auto operables = env.operable_view();
+  auto total = std::accumulate(std::begin(operables), std::end(operables), std::chrono::nanoseconds{}, [](auto acc, const champsim::operable& op) {
+    return acc + std::chrono::duration_cast<std::chrono::nanoseconds>(op.host_time);
+  });
+  if (total > named) {
+    retval.push_back({"other", "other", total - named});
+  }
+  return retval;
+}
+
 phase_stats do_phase(const phase_info& phase, environment& env, std::vector<tracereader>& traces, champsim::chrono::clock& global_clock)
 {
   auto operables = env.operable_view();
@@ -68,11 +100,25 @@ phase_stats do_phase(const phase_info& phase, environment& env, std::vector<trac
   // Initialize phase
   for (champsim::operable& op : operables) {
     op.warmup = is_warmup;
+    op.host_time = {};
     op.begin_phase();
   }
+  const auto phase_start = std::chrono::steady_clock::now();
 
-  const auto time_quantum = std::accumulate(std::cbegin(operables), std::cend(operables), champsim::chrono::clock::duration::max(),
-                                            [](const auto acc, const operable& y) { return std::min(acc, y.clock_period); });
+  // The traces are assigned to the threads in the order of the cores, then of their threads
+  std::vector<std::vector<std::size_t>> thread_traces(std::size(env.cpu_view()));
+  for (O3_CPU& cpu : env.cpu_view()) {
+    thread_traces.at(cpu.cpu).resize(cpu.num_threads());
+  }
+  std::size_t context = 0;
+  for (auto& cpu_traces : thread_traces) {
+    for (auto& trace : cpu_traces) {
+      trace = trace_index.at(context++);
+    }
+  }
+
+  clock_schedule schedule{operables, global_clock.now()};
+  const auto time_quantum = schedule.time_quantum();
 
   bool livelock_trigger{false};
   uint64_t livelock_period{10000000};
@@ -88,7 +134,7 @@ phase_stats do_phase(const phase_info& phase, environment& env, std::vector<trac
     auto next_phase_complete = phase_complete;
     global_clock.tick(time_quantum);
 
-    auto progress = do_cycle(env, traces, trace_index, global_clock);
+    auto progress = do_cycle(env, schedule, traces, thread_traces, global_clock);
 
     if (progress == 0) {
       ++stalled_cycle;
@@ -133,8 +179,12 @@ phase_stats do_phase(const phase_info& phase, environment& env, std::vector<trac
 
     // Check for phase finish
     for (O3_CPU& cpu : env.cpu_view()) {
-      // Phase complete
-      next_phase_complete[cpu.cpu] = next_phase_complete[cpu.cpu] || (cpu.sim_instr() >= length);
+      // Phase complete when every thread of the core has completed it
+      bool threads_complete = true;
+      for (std::size_t thread = 0; thread < cpu.num_threads(); ++thread) {
+        threads_complete = threads_complete && (cpu.sim_thread_instr(thread) >= length);
+      }
+      next_phase_complete[cpu.cpu] = next_phase_complete[cpu.cpu] || threads_complete;
     }
 
     for (O3_CPU& cpu : env.cpu_view()) {
@@ -158,6 +208,10 @@ phase_stats do_phase(const phase_info& phase, environment& env, std::vector<trac
 
   phase_stats stats;
   stats.name = phase.name;
+  stats.host_elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - phase_start);
+  if (std::any_of(std::begin(operables), std::end(operables), [](const champsim::operable& op) { return op.profile_host_time; })) {
+    stats.host_time = host_time_by_component(env);
+  }
 
   for (std::size_t i = 0; i < std::size(trace_index); ++i) {
     stats.trace_names.push_back(trace_names.at(trace_index.at(i)));
@@ -198,4 +252,30 @@ std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases,
 
   return results;
 }
+
+// batched entry point: simulate several environments over a single decode of each trace
+std::vector<std::vector<phase_stats>> main(std::vector<std::reference_wrapper<environment>> envs, std::vector<phase_info>& phases,
+                                           std::vector<trace_broadcaster>& sources, const std::vector<trace_subscription>& plan)
+{
+  // Every environment must subscribe before any of them begins to consume
+  std::vector<std::vector<tracereader>> traces;
+  std::generate_n(std::back_inserter(traces), std::size(envs), [&] { return subscribe(sources, plan); });
+
+  std::vector<std::vector<phase_stats>> results(std::size(envs));
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < std::size(envs); ++i) {
+    threads.emplace_back([&, i] {
+      results.at(i) = main(envs.at(i).get(), phases, traces.at(i));
+
+      // Release this environment's cursors so that it does not hold back the others
+      traces.at(i).clear();
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  return results;
+}
 } // namespace champsim
@@ -0,0 +1,108 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "clock_schedule.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <utility>
+
+champsim::clock_schedule::clock_schedule(std::vector<std::reference_wrapper<operable>> operables_, chrono::clock::time_point now)
+    : operables(std::move(operables_))
+{
+  for (std::size_t i = 0; i < std::size(operables); ++i) {
+    const operable& op = operables.at(i);
+    auto dom = std::find_if(std::begin(domains), std::end(domains),
+                            [&op](const domain& d) { return d.period == op.clock_period && d.next == op.current_time; });
+    if (dom == std::end(domains)) {
+      dom = domains.insert(std::end(domains), domain{op.clock_period, op.current_time, {}});
+    }
+    dom->members.push_back(i);
+    quantum = std::min(quantum, op.clock_period);
+  }
+
+  if (std::empty(domains)) {
+    return;
+  }
+
+  // Every domain returns to the same phase relative to the clock after the least common multiple of the periods
+  auto hyperperiod = quantum.count();
+  for (const auto& dom : domains) {
+    hyperperiod = std::lcm(hyperperiod, dom.period.count());
+    if (hyperperiod / quantum.count() > static_cast<chrono::clock::rep>(max_pattern_length)) {
+      return;
+    }
+  }
+
+  const auto length = hyperperiod / quantum.count();
+  auto simulated = domains;
+  std::vector<std::vector<std::size_t>> candidate;
+  for (chrono::clock::rep tick = 1; tick <= length; ++tick) {
+    candidate.push_back(advance(simulated, now + tick * quantum));
+  }
+
+  // Operables that begin far behind the clock catch up over the first ticks, and the pattern does not repeat
+  const auto end_time = now + length * quantum;
+  auto in_phase = [now, end_time](const domain& before, const domain& after) { return (before.next - now) == (after.next - end_time); };
+  if (std::equal(std::begin(domains), std::end(domains), std::begin(simulated), in_phase)) {
+    pattern = std::move(candidate);
+  }
+}
+
+auto champsim::clock_schedule::advance(std::vector<domain>& doms, chrono::clock::time_point now) -> std::vector<std::size_t>
+{
+  std::vector<std::pair<chrono::clock::time_point, std::size_t>> due;
+  for (auto& dom : doms) {
+    if (dom.next < now) {
+      std::transform(std::begin(dom.members), std::end(dom.members), std::back_inserter(due), [time = dom.next](auto idx) { return std::pair{time, idx}; });
+
+      // operable::operate_on() operates until the operable has caught up with the clock
+      auto behind = now - dom.next;
+      dom.next += ((behind + dom.period - chrono::clock::duration{1}) / dom.period) * dom.period;
+    }
+  }
+
+  std::sort(std::begin(due), std::end(due));
+
+  std::vector<std::size_t> retval;
+  std::transform(std::begin(due), std::end(due), std::back_inserter(retval), [](const auto& x) { return x.second; });
+  return retval;
+}
+
+long champsim::clock_schedule::operate_on(const chrono::clock& clock)
+{
+  std::vector<std::size_t> computed;
+  const std::vector<std::size_t>* due = &computed;
+  if (std::empty(pattern)) {
+    computed = advance(domains, clock.now());
+  } else {
+    due = &pattern.at(pattern_index);
+    pattern_index = (pattern_index + 1) % std::size(pattern);
+  }
+
+  long progress{0};
+  for (auto idx : *due) {
+    progress += operables.at(idx).get().operate_on(clock);
+  }
+  return progress;
+}
+
+auto champsim::clock_schedule::time_quantum() const -> chrono::clock::duration { return quantum; }
+
+std::size_t champsim::clock_schedule::num_domains() const { return std::size(domains); }
+
+std::size_t champsim::clock_schedule::pattern_length() const { return std::size(pattern); }
@@ -1,5 +1,7 @@
 #include "core_stats.h"
 
+#include <algorithm>
+
 cpu_stats operator-(cpu_stats lhs, cpu_stats rhs)
 {
   lhs.begin_instrs -= rhs.begin_instrs;
@@ -7,9 +9,26 @@ cpu_stats operator-(cpu_stats lhs, cpu_stats rhs)
   lhs.end_instrs -= rhs.end_instrs;
   lhs.end_cycles -= rhs.end_cycles;
   lhs.total_rob_occupancy_at_branch_mispredict -= rhs.total_rob_occupancy_at_branch_mispredict;
+  lhs.wrong_path_fetched -= rhs.wrong_path_fetched;
+  lhs.wrong_path_executed -= rhs.wrong_path_executed;
+  lhs.memory_order_violations -= rhs.memory_order_violations;
+  lhs.memory_order_replayed -= rhs.memory_order_replayed;
 
   lhs.total_branch_types -= rhs.total_branch_types;
   lhs.branch_type_misses -= rhs.branch_type_misses;
 
+  for (std::size_t i = 0; i < std::min(std::size(lhs.threads), std::size(rhs.threads)); ++i) {
+    lhs.threads[i].begin_instrs -= rhs.threads[i].begin_instrs;
+    lhs.threads[i].end_instrs -= rhs.threads[i].end_instrs;
+    lhs.threads[i].branches -= rhs.threads[i].branches;
+    lhs.threads[i].branch_misses -= rhs.threads[i].branch_misses;
+  }
+
+  for (std::size_t i = 0; i < std::min(std::size(lhs.ports), std::size(rhs.ports)); ++i) {
+    lhs.ports[i].issued -= rhs.ports[i].issued;
+    lhs.ports[i].busy_cycles -= rhs.ports[i].busy_cycles;
+    lhs.ports[i].conflicts -= rhs.ports[i].conflicts;
+  }
+
   return lhs;
 }
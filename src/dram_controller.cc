@@ -101,9 +101,33 @@ long MEMORY_CONTROLLER::operate()
     progress += channel._operate();
   }
 
+  measure_utilization();
+
   return progress;
 }
 
+void MEMORY_CONTROLLER::measure_utilization()
+{
+  const auto elapsed = current_time - utilization_measured;
+  if (elapsed < data_bus_period * UTILIZATION_WINDOW) {
+    return;
+  }
+
+  champsim::chrono::clock::duration busy{};
+  for (auto& chan : channels) {
+    busy += chan.dbus_busy;
+    chan.dbus_busy = {};
+  }
+
+  // A request is counted when it takes the bus, so a window may be credited with the end of a transfer that spills into the next
+  const auto utilization =
+      std::min(static_cast<double>(busy.count()) / (static_cast<double>(elapsed.count()) * static_cast<double>(std::size(channels))), 1.0);
+  for (auto* ul : queues) {
+    ul->memory_utilization = utilization;
+  }
+  utilization_measured = current_time;
+}
+
 long DRAM_CHANNEL::operate()
 {
   long progress{0};
@@ -269,6 +293,7 @@ long DRAM_CHANNEL::populate_dbus()
 
       // set when bankgroup dbus will be next ready
       bankgroup_readytime[op_bankgroup] = current_time + DRAM_DBUS_RETURN_TIME + DRAM_DBUS_BANKGROUP_STALL;
+      dbus_busy += DRAM_DBUS_RETURN_TIME;
 
       if (iter_next_process->row_buffer_hit) {
         if (write_mode) {
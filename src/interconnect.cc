@@ -0,0 +1,296 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "interconnect.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fmt/core.h>
+
+#include "deadlock.h"
+
+namespace
+{
+enum direction : std::size_t { EAST, WEST, SOUTH, NORTH };
+
+std::size_t endpoint_count(const std::vector<champsim::channel*>& ul, const std::vector<std::vector<champsim::channel*>>& ll)
+{
+  return std::max(std::size(ul), std::empty(ll) ? std::size_t{0} : std::size(ll.front()));
+}
+
+std::size_t mesh_width_for(std::size_t endpoints, std::size_t requested)
+{
+  if (requested > 0)
+    return std::min(requested, std::max(endpoints, std::size_t{1}));
+  return std::max(static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(endpoints)))), std::size_t{1});
+}
+
+std::size_t stop_count(champsim::interconnect::topology_type topology, std::size_t endpoints, std::size_t width)
+{
+  if (topology == champsim::interconnect::topology_type::mesh)
+    return width * ((endpoints + width - 1) / width); // fill out the last row of the grid
+  return endpoints;
+}
+} // namespace
+
+champsim::interconnect::interconnect(std::string name, champsim::chrono::picoseconds clock_period_, topology_type topology_, std::size_t mesh_width,
+                                     uint64_t hop_latency, champsim::bandwidth::maximum_type link_bandwidth, std::size_t buffer_size,
+                                     std::vector<champsim::channel*> ul, std::vector<std::vector<champsim::channel*>> ll)
+    : champsim::operable(clock_period_), NAME(std::move(name)), topology(topology_), width(mesh_width_for(endpoint_count(ul, ll), mesh_width)),
+      stops(stop_count(topology_, endpoint_count(ul, ll), width)), HOP_LATENCY(hop_latency), LINK_BANDWIDTH(link_bandwidth), BUFFER_SIZE(buffer_size),
+      upper_levels(std::move(ul)), lower_levels(std::move(ll)), links(stops * num_directions), in_flight(std::size(upper_levels))
+{
+  assert(std::size(lower_levels) == std::size(upper_levels));
+  assert(std::all_of(std::begin(lower_levels), std::end(lower_levels), [n = num_slices()](const auto& x) { return std::size(x) == n; }));
+}
+
+std::size_t champsim::interconnect::num_slices() const { return std::empty(lower_levels) ? 0 : std::size(lower_levels.front()); }
+
+std::size_t champsim::interconnect::num_stops() const { return stops; }
+
+std::size_t champsim::interconnect::upper_stop(std::size_t upper) const { return upper * stops / std::size(upper_levels); }
+
+std::size_t champsim::interconnect::slice_stop(std::size_t slice) const { return slice * stops / num_slices(); }
+
+std::size_t champsim::interconnect::slice_of(champsim::address addr) const
+{
+  // Fold the block number onto itself so that every bit of it contributes to the choice of slice
+  auto folded = champsim::block_number{addr}.to<uint64_t>();
+  folded ^= folded >> 32;
+  folded ^= folded >> 16;
+  folded ^= folded >> 8;
+  return static_cast<std::size_t>(folded % num_slices());
+}
+
+std::size_t champsim::interconnect::next_link(std::size_t from, std::size_t to) const
+{
+  if (topology == topology_type::ring) {
+    auto clockwise = (to + stops - from) % stops;
+    return from * num_directions + (clockwise <= stops - clockwise ? EAST : WEST);
+  }
+
+  // Dimension-ordered routing: travel along the row, then along the column
+  if (from % width != to % width)
+    return from * num_directions + (from % width < to % width ? EAST : WEST);
+  return from * num_directions + (from < to ? SOUTH : NORTH);
+}
+
+std::size_t champsim::interconnect::link_end(std::size_t link) const
+{
+  auto from = link / num_directions;
+  switch (link % num_directions) {
+  case EAST:
+    return topology == topology_type::ring ? (from + 1) % stops : from + 1;
+  case WEST:
+    return topology == topology_type::ring ? (from + stops - 1) % stops : from - 1;
+  case SOUTH:
+    return from + width;
+  default:
+    return from - width;
+  }
+}
+
+std::size_t champsim::interconnect::hops(std::size_t from, std::size_t to) const
+{
+  std::size_t count = 0;
+  for (; from != to; from = link_end(next_link(from, to)))
+    ++count;
+  return count;
+}
+
+void champsim::interconnect::route(message msg, std::size_t from, champsim::chrono::clock::time_point ready_time)
+{
+  msg.ready_time = ready_time;
+  if (from == msg.destination)
+    ejecting.push_back(std::move(msg));
+  else
+    links.at(next_link(from, msg.destination)).push_back(std::move(msg));
+}
+
+void champsim::interconnect::initialize()
+{
+  // The slices and the upper levels set these flags on the channels they see when they are constructed
+  for (std::size_t upper = 0; upper < std::size(upper_levels); ++upper) {
+    auto& slices = lower_levels.at(upper);
+    for (auto* slice_queues : slices)
+      slice_queues->invalidations_accepted = upper_levels[upper]->invalidations_accepted;
+    upper_levels[upper]->victims_requested =
+        std::any_of(std::begin(slices), std::end(slices), [](const champsim::channel* x) { return x->victims_requested; });
+  }
+}
+
+bool champsim::interconnect::deliver(const message& msg)
+{
+  if (msg.kind == message_kind::response) {
+    upper_levels.at(msg.upper)->returned.push_back(msg.response.value());
+    return true;
+  }
+
+  if (msg.kind == message_kind::invalidation) {
+    upper_levels.at(msg.upper)->invalidations.push_back(msg.request.value().address);
+    return true;
+  }
+
+  if (msg.kind == message_kind::snoop) {
+    upper_levels.at(msg.upper)->snoops.push_back(msg.snoop.value());
+    return true;
+  }
+
+  auto* slice_queues = lower_levels.at(msg.upper).at(msg.slice);
+  switch (msg.kind) {
+  case message_kind::read:
+    return slice_queues->add_rq(msg.request.value());
+  case message_kind::write:
+    return slice_queues->add_wq(msg.request.value());
+  default:
+    return slice_queues->add_pq(msg.request.value());
+  }
+}
+
+long champsim::interconnect::eject()
+{
+  long progress{0};
+
+  // Messages that arrive at a full slice wait at its stop until the slice accepts them
+  auto it = std::begin(ejecting);
+  while (it != std::end(ejecting)) {
+    if (it->ready_time <= current_time && deliver(*it)) {
+      if (it->kind != message_kind::response && it->kind != message_kind::invalidation && it->kind != message_kind::snoop)
+        --in_flight.at(it->upper);
+      it = ejecting.erase(it);
+      ++progress;
+    } else {
+      ++it;
+    }
+  }
+
+  return progress;
+}
+
+long champsim::interconnect::traverse()
+{
+  long progress{0};
+  std::vector<std::pair<std::size_t, message>> crossed{};
+  for (std::size_t link_idx = 0; link_idx < std::size(links); ++link_idx) {
+    auto& link = links[link_idx];
+    champsim::bandwidth bw{LINK_BANDWIDTH};
+    auto it = std::begin(link);
+    while (bw.has_remaining() && it != std::end(link)) {
+      if (it->ready_time <= current_time) {
+        crossed.emplace_back(link_end(link_idx), std::move(*it));
+        it = link.erase(it);
+        bw.consume();
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // Messages cross at most one link per cycle
+  for (auto& [stop, msg] : crossed) {
+    route(std::move(msg), stop, current_time + HOP_LATENCY * clock_period);
+    ++progress;
+  }
+
+  return progress;
+}
+
+long champsim::interconnect::collect_responses()
+{
+  long progress{0};
+  for (std::size_t upper = 0; upper < std::size(upper_levels); ++upper) {
+    upper_levels[upper]->memory_utilization = 0;
+    for (std::size_t slice = 0; slice < num_slices(); ++slice) {
+      upper_levels[upper]->memory_utilization = std::max(upper_levels[upper]->memory_utilization, lower_levels[upper][slice]->memory_utilization);
+
+      auto& returned = lower_levels[upper][slice]->returned;
+      for (auto& resp : returned) {
+        route(message{message_kind::response, upper, slice, std::nullopt, resp, upper_stop(upper)}, slice_stop(slice), current_time);
+        ++progress;
+      }
+      returned.clear();
+
+      auto& invalidations = lower_levels[upper][slice]->invalidations;
+      for (auto addr : invalidations) {
+        champsim::channel::request_type inval;
+        inval.address = addr;
+        route(message{message_kind::invalidation, upper, slice, inval, std::nullopt, upper_stop(upper)}, slice_stop(slice), current_time);
+        ++progress;
+      }
+      invalidations.clear();
+
+      auto& snoops = lower_levels[upper][slice]->snoops;
+      for (const auto& snoop : snoops) {
+        route(message{message_kind::snoop, upper, slice, std::nullopt, std::nullopt, upper_stop(upper), {}, snoop}, slice_stop(slice), current_time);
+        ++progress;
+      }
+      snoops.clear();
+    }
+  }
+  return progress;
+}
+
+long champsim::interconnect::inject()
+{
+  long progress{0};
+  for (std::size_t upper = 0; upper < std::size(upper_levels); ++upper) {
+    auto* ul = upper_levels[upper];
+    ul->check_collision();
+
+    auto inject_from = [&, this](auto& queue, message_kind kind) {
+      while (!std::empty(queue) && in_flight[upper] < BUFFER_SIZE) {
+        auto slice = slice_of(queue.front().address);
+        route(message{kind, upper, slice, queue.front(), std::nullopt, slice_stop(slice)}, upper_stop(upper), current_time);
+        queue.pop_front();
+        ++in_flight[upper];
+        ++progress;
+      }
+    };
+
+    // Writes are injected ahead of reads and prefetches
+    inject_from(ul->WQ, message_kind::write);
+    inject_from(ul->RQ, message_kind::read);
+    inject_from(ul->PQ, message_kind::prefetch);
+  }
+  return progress;
+}
+
+long champsim::interconnect::operate()
+{
+  long progress{0};
+  progress += eject();
+  progress += traverse();
+  progress += collect_responses();
+  progress += inject();
+  return progress;
+}
+
+// LCOV_EXCL_START Exclude the following function from LCOV
+void champsim::interconnect::print_deadlock()
+{
+  std::string_view msg_writer{"upper: {} slice: {} destination: {} ready: {}"};
+  auto msg_pack = [time = current_time](const auto& entry) {
+    return std::tuple{entry.upper, entry.slice, entry.destination, entry.ready_time <= time};
+  };
+
+  for (std::size_t i = 0; i < std::size(links); ++i) {
+    if (!std::empty(links[i]))
+      champsim::range_print_deadlock(links[i], NAME + "_link_" + std::to_string(i), msg_writer, msg_pack);
+  }
+  champsim::range_print_deadlock(ejecting, NAME + "_eject", msg_writer, msg_pack);
+}
+// LCOV_EXCL_STOP
@@ -15,6 +15,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <utility>
 #include <nlohmann/json.hpp>
 
@@ -37,6 +38,31 @@ void to_json(nlohmann::json& j, const O3_CPU::stats_type& stats)
                      {"cycles", stats.cycles()},
                      {"Avg ROB occupancy at mispredict", std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / std::ceil(total_mispredictions)},
                      {"mispredict", mpki}};
+
+  if (stats.wrong_path_fetched > 0) {
+    j["wrong path"] = nlohmann::json{{"fetched", stats.wrong_path_fetched}, {"executed", stats.wrong_path_executed}};
+  }
+
+  if (stats.memory_order_violations > 0) {
+    j["memory order violations"] = nlohmann::json{{"violations", stats.memory_order_violations}, {"replayed", stats.memory_order_replayed}};
+  }
+
+  if (!std::empty(stats.ports)) {
+    std::vector<nlohmann::json> ports;
+    for (const auto& port : stats.ports) {
+      ports.push_back(nlohmann::json{
+          {"name", port.name}, {"count", port.count}, {"issued", port.issued}, {"busy cycles", port.busy_cycles}, {"conflicts", port.conflicts}});
+    }
+    j["ports"] = ports;
+  }
+
+  if (std::size(stats.threads) > 1) {
+    std::vector<nlohmann::json> threads;
+    for (const auto& thread : stats.threads) {
+      threads.push_back(nlohmann::json{{"instructions", thread.instrs()}, {"branches", thread.branches}, {"mispredicts", thread.branch_misses}});
+    }
+    j["threads"] = threads;
+  }
 }
 
 void to_json(nlohmann::json& j, const CACHE::stats_type& stats)
@@ -51,12 +77,29 @@ void to_json(nlohmann::json& j, const CACHE::stats_type& stats)
   statsmap.emplace("prefetch issued", stats.pf_issued);
   statsmap.emplace("useful prefetch", stats.pf_useful);
   statsmap.emplace("useless prefetch", stats.pf_useless);
+  statsmap.emplace("late prefetch", stats.pf_late);
+  statsmap.emplace("throttled prefetch", stats.pf_throttled);
+  statsmap.emplace("back invalidations", stats.back_invalidations);
+  statsmap.emplace("coherence misses", stats.coherence_misses);
+  statsmap.emplace("coherence snoops", stats.coherence_snoops);
 
   uint64_t total_downstream_demands = stats.mshr_return.total();
   for (std::size_t cpu = 0; cpu < NUM_CPUS; ++cpu)
     total_downstream_demands -= stats.mshr_return.value_or(std::pair{access_type::PREFETCH, cpu}, mshr_return_value_type{});
 
   statsmap.emplace("miss latency", std::ceil(stats.total_miss_latency_cycles) / std::ceil(total_downstream_demands));
+
+  if (!std::empty(stats.stack_distances)) {
+    std::vector<nlohmann::json> curves;
+    for (const auto& hist : stats.stack_distances) {
+      std::vector<uint64_t> misses;
+      for (std::size_t ways = 1; ways <= std::size(hist.distances); ++ways) {
+        misses.push_back(hist.misses(ways));
+      }
+      curves.push_back(nlohmann::json{{"sets", hist.sets}, {"accesses", hist.accesses()}, {"cold", hist.cold}, {"misses", misses}});
+    }
+    statsmap.emplace("stack distance", curves);
+  }
   for (const auto type : {access_type::LOAD, access_type::RFO, access_type::PREFETCH, access_type::WRITE, access_type::TRANSLATION}) {
     std::vector<hits_value_type> hits;
     std::vector<misses_value_type> misses;
@@ -105,8 +148,28 @@ void to_json(nlohmann::json& j, const champsim::phase_stats stats)
   std::map<std::string, nlohmann::json> statsmap{{"name", stats.name}, {"traces", stats.trace_names}};
   statsmap.emplace("roi", roi_stats);
   statsmap.emplace("sim", sim_stats);
+
+  using seconds = std::chrono::duration<double>;
+  nlohmann::json host_time{{"elapsed", std::chrono::duration_cast<seconds>(stats.host_elapsed).count()}};
+  if (!std::empty(stats.host_time)) {
+    std::vector<nlohmann::json> components;
+    for (const auto& component : stats.host_time) {
+      components.push_back(
+          nlohmann::json{{"name", component.name}, {"kind", component.kind}, {"seconds", std::chrono::duration_cast<seconds>(component.time).count()}});
+    }
+    host_time["components"] = components;
+  }
+  statsmap.emplace("host time", host_time);
   j = statsmap;
 }
 } // namespace champsim
 
 void champsim::json_printer::print(std::vector<phase_stats>& stats) { stream << nlohmann::json::array_t{std::begin(stats), std::end(stats)}; }
+
+void champsim::json_printer::print(std::vector<std::vector<phase_stats>>& stats)
+{
+  nlohmann::json::array_t batch{};
+  std::transform(std::begin(stats), std::end(stats), std::back_inserter(batch),
+                 [](const auto& config_stats) { return nlohmann::json::array_t{std::begin(config_stats), std::end(config_stats)}; });
+  stream << nlohmann::json(batch);
+}
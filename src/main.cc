@@ -16,7 +16,9 @@
 
 #include <algorithm>
 #include <fstream>
+#include <memory>
 #include <numeric>
+#include <optional>
 #include <string>
 #include <vector>
 #include <CLI/CLI.hpp>
@@ -31,17 +33,26 @@
 #include "environment.h"
 #include "ooo_cpu.h" // for O3_CPU
 #include "phase_info.h"
+#include "runtime_environment.h"
 #include "stats_printer.h"
+#include "synthetic_trace.h"
+#include "trace_broadcast.h"
 #include "tracereader.h"
 #include "vmem.h"
 
 namespace champsim
 {
 std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces);
-}
+std::vector<std::vector<phase_stats>> main(std::vector<std::reference_wrapper<environment>> envs, std::vector<phase_info>& phases,
+                                           std::vector<trace_broadcaster>& sources, const std::vector<trace_subscription>& plan);
+} // namespace champsim
 
 #ifndef CHAMPSIM_TEST_BUILD
+#ifdef CHAMPSIM_BATCH_BUILDS
+using configured_environment = champsim::configured::batch_environment<CHAMPSIM_BATCH_BUILDS>;
+#else
 using configured_environment = champsim::configured::generated_environment<CHAMPSIM_BUILD>;
+#endif
 
 const std::size_t NUM_CPUS = configured_environment::num_cpus;
 
@@ -54,24 +65,23 @@ const unsigned LOG2_PAGE_SIZE = champsim::lg2(PAGE_SIZE);
 #ifndef CHAMPSIM_TEST_BUILD
 int main(int argc, char** argv) // NOLINT(bugprone-exception-escape)
 {
-  configured_environment gen_environment{};
-
   CLI::App app{"A microarchitecture simulator for research and education"};
 
   bool knob_cloudsuite{false};
+  bool hide_heartbeat{false};
+  bool profile_host_time{false};
   long long warmup_instructions = 0;
   long long simulation_instructions = std::numeric_limits<long long>::max();
+  uint64_t trace_offset = 0;
+  std::size_t decoder_threads = 0;
   std::string json_file_name;
+  std::vector<std::string> config_names;
   std::vector<std::string> trace_names;
 
-  auto set_heartbeat_callback = [&](auto) {
-    for (O3_CPU& cpu : gen_environment.cpu_view()) {
-      cpu.show_heartbeat = false;
-    }
-  };
-
   app.add_flag("-c,--cloudsuite", knob_cloudsuite, "Read all traces using the cloudsuite format");
-  app.add_flag("--hide-heartbeat", set_heartbeat_callback, "Hide the heartbeat output");
+  app.add_flag("--hide-heartbeat", hide_heartbeat, "Hide the heartbeat output");
+  app.add_flag("--profile-host-time", profile_host_time,
+               "Measure the host time spent operating each component, and report it with the JSON output. This slows the simulation slightly.");
   auto* warmup_instr_option = app.add_option("-w,--warmup-instructions", warmup_instructions, "The number of instructions in the warmup phase");
   auto* deprec_warmup_instr_option =
       app.add_option("--warmup_instructions", warmup_instructions, "[deprecated] use --warmup-instructions instead")->excludes(warmup_instr_option);
@@ -83,7 +93,36 @@ int main(int argc, char** argv) // NOLINT(bugprone-exception-escape)
   auto* json_option =
       app.add_option("--json", json_file_name, "The name of the file to receive JSON output. If no name is specified, stdout will be used")->expected(0, 1);
 
-  app.add_option("traces", trace_names, "The paths to the traces")->required()->expected(NUM_CPUS)->check(CLI::ExistingFile);
+  app.add_option("--config", config_names,
+                 "A configuration written by `config.sh --emit-runtime`, to simulate instead of the configuration built into this executable. If given more "
+                 "than once, the configurations are simulated side by side.")
+      ->check(CLI::ExistingFile);
+
+  app.add_option("--trace-offset", trace_offset,
+                 "When several hardware threads run the same trace, start each this many instructions after the one before it, so that they do not run in "
+                 "lockstep");
+
+  auto* decoder_threads_option =
+      app.add_option("--decoder-threads", decoder_threads,
+                     "The number of threads that each xz or seekable zstd trace may use to decompress itself. By default, a single trace uses 4, and each "
+                     "of several traces uses 1, so that the decoders do not crowd out the simulation.")
+          ->check(CLI::PositiveNumber);
+
+  CLI::Validator synthetic_workload{
+      [](std::string& name) {
+        try {
+          (void)champsim::synthetic::parse(name);
+        } catch (const std::invalid_argument& err) {
+          return std::string{err.what()};
+        }
+        return std::string{};
+      },
+      "SYNTHETIC"};
+  app.add_option("traces", trace_names,
+                 "The paths to the traces, one for each hardware thread of each core. A synthetic workload, such as "
+                 "synthetic:pointer_chase,footprint=64M, may be given in place of a trace.")
+      ->required()
+      ->check(CLI::ExistingFile | synthetic_workload);
 
   CLI11_PARSE(app, argc, argv);
 
@@ -104,10 +143,54 @@ int main(int argc, char** argv) // NOLINT(bugprone-exception-escape)
     warmup_instructions = simulation_instructions / 5;
   }
 
-  std::vector<champsim::tracereader> traces;
-  std::transform(
-      std::begin(trace_names), std::end(trace_names), std::back_inserter(traces),
-      [knob_cloudsuite, repeat = simulation_given, i = uint8_t(0)](auto name) mutable { return get_tracereader(name, i++, knob_cloudsuite, repeat); });
+  std::optional<configured_environment> gen_environment{};
+  std::vector<std::unique_ptr<champsim::runtime_environment>> runtime_environments{};
+  std::vector<std::reference_wrapper<champsim::environment>> environments{};
+  if (std::empty(config_names)) {
+#ifdef CHAMPSIM_BATCH_BUILDS
+    environments = gen_environment.emplace().environments();
+#else
+    environments.push_back(gen_environment.emplace());
+#endif
+  } else {
+    try {
+      for (const auto& name : config_names) {
+        runtime_environments.push_back(champsim::load_runtime_environment(name));
+        environments.push_back(*runtime_environments.back());
+      }
+    } catch (const std::exception& err) {
+      fmt::print(stderr, "Could not load the configuration: {}\n", err.what());
+      return 1;
+    }
+  }
+
+  // Each hardware thread reads its own trace
+  for (champsim::environment& env : environments) {
+    std::size_t num_contexts = 0;
+    for (O3_CPU& cpu : env.cpu_view()) {
+      num_contexts += cpu.num_threads();
+    }
+    if (num_contexts != std::size(trace_names)) {
+      fmt::print(stderr, "Expected {} traces, one for each hardware thread, but {} were given\n", num_contexts, std::size(trace_names));
+      return 1;
+    }
+  }
+
+  if (hide_heartbeat) {
+    for (champsim::environment& env : environments) {
+      for (O3_CPU& cpu : env.cpu_view()) {
+        cpu.show_heartbeat = false;
+      }
+    }
+  }
+
+  if (profile_host_time) {
+    for (champsim::environment& env : environments) {
+      for (champsim::operable& op : env.operable_view()) {
+        op.profile_host_time = true;
+      }
+    }
+  }
 
   std::vector<champsim::phase_info> phases{
       {champsim::phase_info{"Warmup", true, warmup_instructions, std::vector<std::size_t>(std::size(trace_names), 0), trace_names},
@@ -118,28 +201,103 @@ int main(int argc, char** argv) // NOLINT(bugprone-exception-escape)
   }
 
   fmt::print("\n*** ChampSim Multicore Out-of-Order Simulator ***\nWarmup Instructions: {}\nSimulation Instructions: {}\nNumber of CPUs: {}\nPage size: {}\n\n",
-             phases.at(0).length, phases.at(1).length, std::size(gen_environment.cpu_view()), PAGE_SIZE);
+             phases.at(0).length, phases.at(1).length, NUM_CPUS, PAGE_SIZE);
 
-  auto phase_stats = champsim::main(gen_environment, phases, traces);
+  auto open_trace = [knob_cloudsuite, repeat = simulation_given](const std::string& name, std::size_t context) {
+    return get_tracereader(name, static_cast<uint8_t>(context), knob_cloudsuite, repeat);
+  };
 
-  fmt::print("\nChampSim completed all CPUs\n\n");
+  // Hardware threads that run the same trace share one source, and each starts after the one before it
+  std::vector<std::string> distinct_names;
+  std::vector<champsim::trace_subscription> plan;
+  for (const auto& name : trace_names) {
+    auto source = static_cast<std::size_t>(std::distance(std::begin(distinct_names), std::find(std::begin(distinct_names), std::end(distinct_names), name)));
+    if (source == std::size(distinct_names)) {
+      distinct_names.push_back(name);
+    }
+    auto copies = std::count_if(std::begin(plan), std::end(plan), [source](const auto& sub) { return sub.source == source; });
+    plan.push_back({source, static_cast<uint64_t>(copies) * trace_offset});
+  }
+
+  if (decoder_threads_option->count() > 0) {
+    set_decoder_threads(decoder_threads);
+  } else if (std::size(distinct_names) > 1) {
+    set_decoder_threads(1);
+  }
 
-  champsim::plain_printer{std::cout}.print(phase_stats);
+  std::vector<std::vector<champsim::phase_stats>> phase_stats;
+  if (std::size(environments) == 1 && std::size(distinct_names) == std::size(trace_names)) {
+    std::vector<champsim::tracereader> traces;
+    for (std::size_t i = 0; i < std::size(trace_names); ++i) {
+      traces.push_back(open_trace(trace_names.at(i), i));
+    }
+    phase_stats.push_back(champsim::main(environments.front(), phases, traces));
+  } else {
+    // Decode each trace once and share it among all hardware threads and configurations that run it
+    std::vector<champsim::trace_broadcaster> sources;
+    for (const auto& name : distinct_names) {
+      auto first_context = static_cast<std::size_t>(std::distance(std::begin(trace_names), std::find(std::begin(trace_names), std::end(trace_names), name)));
+      auto copies = static_cast<uint64_t>(std::count(std::begin(trace_names), std::end(trace_names), name));
+      if (copies > 1) {
+        // The cores of a configuration run on one thread and cannot wait for each other, so a core that falls too far behind reopens the trace.
+        // The buffer holds at least the offsets between the cores.
+        auto offset_batches = ((copies - 1) * trace_offset + champsim::trace_broadcaster::default_batch_size - 1) / champsim::trace_broadcaster::default_batch_size;
+        sources.emplace_back(std::function<champsim::tracereader()>{[open_trace, name, first_context] { return open_trace(name, first_context); }},
+                             champsim::trace_broadcaster::default_batch_size, champsim::trace_broadcaster::default_capacity + offset_batches,
+                             champsim::trace_broadcaster::default_pinned_capacity + offset_batches);
+      } else {
+        sources.emplace_back(open_trace(name, first_context));
+      }
+    }
+
+    if (std::size(environments) == 1) {
+      auto traces = champsim::subscribe(sources, plan);
+      phase_stats.push_back(champsim::main(environments.front(), phases, traces));
+    } else {
+      fmt::print("Simulating {} configurations in parallel\n\n", std::size(environments));
+      phase_stats = champsim::main(environments, phases, sources, plan);
+    }
 
-  for (CACHE& cache : gen_environment.cache_view()) {
-    cache.impl_prefetcher_final_stats();
+    for (std::size_t i = 0; i < std::size(sources); ++i) {
+      if (auto evictions = sources.at(i).evictions(); evictions > 0) {
+        fmt::print("WARNING: {} hardware threads fell too far behind the others on {} and decoded it again on their own\n", evictions, distinct_names.at(i));
+      }
+    }
   }
 
-  for (CACHE& cache : gen_environment.cache_view()) {
-    cache.impl_replacement_final_stats();
+  fmt::print("\nChampSim completed all CPUs\n\n");
+
+  for (std::size_t i = 0; i < std::size(environments); ++i) {
+    if (std::size(environments) > 1) {
+      fmt::print("=== Configuration {} ===\n", i);
+    }
+
+    champsim::plain_printer{std::cout}.print(phase_stats.at(i));
+
+    for (CACHE& cache : environments.at(i).get().cache_view()) {
+      cache.impl_prefetcher_final_stats();
+    }
+
+    for (CACHE& cache : environments.at(i).get().cache_view()) {
+      cache.impl_replacement_final_stats();
+    }
   }
 
   if (json_option->count() > 0) {
+    // A batch produces one list of phases per configuration
+    auto print_json = [&](std::ostream& stream) {
+      if (std::size(phase_stats) == 1) {
+        champsim::json_printer{stream}.print(phase_stats.front());
+      } else {
+        champsim::json_printer{stream}.print(phase_stats);
+      }
+    };
+
     if (json_file_name.empty()) {
-      champsim::json_printer{std::cout}.print(phase_stats);
+      print_json(std::cout);
     } else {
       std::ofstream json_file{json_file_name};
-      champsim::json_printer{json_file}.print(phase_stats);
+      print_json(json_file);
     }
   }
 
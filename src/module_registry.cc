@@ -0,0 +1,92 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "module_registry.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+
+#if __has_include("legacy_bridge.h")
+#include "legacy_bridge.h"
+#endif
+
+namespace
+{
+template <typename Map, typename Factory>
+auto lookup(const Map& table, const std::vector<std::string>& names, std::string_view kind, Factory none) -> typename Map::mapped_type
+{
+  if (std::empty(names)) {
+    return none;
+  }
+
+  if (std::size(names) > 1) {
+    throw std::invalid_argument{fmt::format("At most one {} may be selected at run time, but {} were given: {}", kind, std::size(names), fmt::join(names, ", "))};
+  }
+
+  auto found = table.find(names.front());
+  if (found == std::end(table)) {
+    std::vector<std::string_view> known{};
+    std::transform(std::begin(table), std::end(table), std::back_inserter(known), [](const auto& entry) { return std::string_view{entry.first}; });
+    throw std::invalid_argument{
+        fmt::format("No {} named '{}' was compiled into this executable. Available: {}", kind, names.front(), fmt::join(known, ", "))};
+  }
+  return found->second;
+}
+} // namespace
+
+CACHE::prefetcher_factory champsim::modules::registry::prefetcher(const std::vector<std::string>& names) const
+{
+  return ::lookup(prefetchers, names, "prefetcher",
+                  [](CACHE* cache) -> std::unique_ptr<CACHE::prefetcher_module_concept> { return std::make_unique<CACHE::prefetcher_module_model<>>(cache); });
+}
+
+CACHE::replacement_factory champsim::modules::registry::replacement(const std::vector<std::string>& names) const
+{
+  return ::lookup(replacements, names, "replacement policy",
+                  [](CACHE* cache) -> std::unique_ptr<CACHE::replacement_module_concept> { return std::make_unique<CACHE::replacement_module_model<>>(cache); });
+}
+
+O3_CPU::branch_factory champsim::modules::registry::branch_predictor(const std::vector<std::string>& names) const
+{
+  return ::lookup(branch_predictors, names, "branch predictor",
+                  [](O3_CPU* cpu) -> std::unique_ptr<O3_CPU::branch_module_concept> { return std::make_unique<O3_CPU::branch_module_model<>>(cpu); });
+}
+
+O3_CPU::btb_factory champsim::modules::registry::btb(const std::vector<std::string>& names) const
+{
+  return ::lookup(btbs, names, "branch target buffer",
+                  [](O3_CPU* cpu) -> std::unique_ptr<O3_CPU::btb_module_concept> { return std::make_unique<O3_CPU::btb_module_model<>>(cpu); });
+}
+
+auto champsim::modules::registry::compiled() -> const registry&
+{
+  static const registry instance = [] {
+    registry reg{};
+    register_compiled_modules(reg);
+    return reg;
+  }();
+  return instance;
+}
+
+#if __has_include("module_registry.inc")
+#include "module_registry.inc"
+#else
+void champsim::modules::register_compiled_modules(registry&) {}
+#endif
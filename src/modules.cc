@@ -23,6 +23,16 @@ bool champsim::modules::prefetcher::prefetch_line(champsim::address pf_addr, boo
   return intern_->prefetch_line(pf_addr, fill_this_level, prefetch_metadata);
 }
 
+unsigned champsim::modules::prefetcher::prefetch_aggressiveness() const
+{
+  return intern_->throttle.has_value() ? intern_->throttle->level() : champsim::prefetch_throttle::max_level;
+}
+
+unsigned champsim::modules::prefetcher::prefetch_degree(unsigned max_degree) const
+{
+  return intern_->throttle.has_value() ? intern_->throttle->degree(max_degree) : max_degree;
+}
+
 // LCOV_EXCL_START Exclude deprecated function
 bool champsim::modules::prefetcher::prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata) const
 {
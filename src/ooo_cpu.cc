@@ -34,11 +34,47 @@ std::chrono::seconds elapsed_time();
 
 constexpr long long STAT_PRINTING_PERIOD = 10000000;
 
+// The trace does not record the lengths of instructions on the wrong path, so they are assumed to be this long
+constexpr champsim::data::bytes WRONG_PATH_INSTR_SIZE{4};
+
+// The store-set predictor is sized as in the original proposal, and its SSIT is cleared after this many lookups
+constexpr std::size_t STORE_SET_SSIT_SIZE = 4096;
+constexpr std::size_t STORE_SET_LFST_SIZE = 128;
+constexpr uint64_t STORE_SET_CLEAR_INTERVAL = 1'000'000;
+
+O3_CPU::O3_CPU(champsim::core_builder<> b, branch_factory make_branch_predictor, btb_factory make_btb)
+    : champsim::operable(b.m_clock_period), cpu(b.m_cpu),
+      DIB(b.m_dib_set, b.m_dib_way, {champsim::data::bits{champsim::lg2(b.m_dib_window)}}, {champsim::data::bits{champsim::lg2(b.m_dib_window)}}),
+      LQ(b.m_lq_size), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size), DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
+      REGISTER_FILE_SIZE(b.m_register_file_size), ROB_SIZE(b.m_rob_size), SQ_SIZE(b.m_sq_size), DIB_HIT_BUFFER_SIZE(b.m_dib_hit_buffer_size),
+      FETCH_WIDTH(b.m_fetch_width), DECODE_WIDTH(b.m_decode_width), DISPATCH_WIDTH(b.m_dispatch_width), SCHEDULER_SIZE(b.m_schedule_width),
+      EXEC_WIDTH(b.m_execute_width), DIB_INORDER_WIDTH(b.m_dib_inorder_width), LQ_WIDTH(b.m_lq_width), SQ_WIDTH(b.m_sq_width), RETIRE_WIDTH(b.m_retire_width),
+      BRANCH_MISPREDICT_PENALTY(b.m_mispredict_penalty * b.m_clock_period), DISPATCH_LATENCY(b.m_dispatch_latency * b.m_clock_period),
+      DECODE_LATENCY(b.m_decode_latency * b.m_clock_period), SCHEDULING_LATENCY(b.m_schedule_latency * b.m_clock_period),
+      EXEC_LATENCY(b.m_execute_latency * b.m_clock_period), DIB_HIT_LATENCY(b.m_dib_hit_latency * b.m_clock_period), L1I_BANDWIDTH(b.m_l1i_bw),
+      L1D_BANDWIDTH(b.m_l1d_bw), FTQ_SIZE(b.m_ftq_size), RUNAHEAD_WIDTH(b.m_runahead_width), SMT_FETCH_POLICY(b.m_smt_fetch), SMT_PARTITIONING(b.m_smt_partitioning),
+      SHARED_ADDRESS_SPACE(b.m_shared_address_space), WRONG_PATH(b.m_wrong_path), MEMORY_DEPENDENCE(b.m_memory_dependence),
+      store_sets(STORE_SET_SSIT_SIZE, STORE_SET_LFST_SIZE, STORE_SET_CLEAR_INTERVAL),
+      EXECUTION_PORTS(b.m_execution_ports), FP_REGISTER_FIRST(b.m_fp_register_first), FP_REGISTER_LAST(b.m_fp_register_last),
+      reg_allocator(b.m_register_file_size, std::max<std::size_t>(b.m_threads, 1), b.m_smt_partitioning == champsim::smt_partitioning::partitioned),
+      IN_QUEUE_SIZE(2 * champsim::to_underlying(b.m_fetch_width)), threads(std::max<std::size_t>(b.m_threads, 1)), L1I_bus(b.m_cpu, b.m_fetch_queues),
+      L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), branch_module_pimpl(make_branch_predictor(this)), btb_module_pimpl(make_btb(this))
+{
+  roi_stats.threads.resize(std::size(threads));
+  sim_stats.threads.resize(std::size(threads));
+  for (const auto& port : EXECUTION_PORTS) {
+    port_free_time.emplace_back(port.count);
+    roi_stats.ports.push_back({port.name, port.count});
+    sim_stats.ports.push_back({port.name, port.count});
+  }
+}
+
 long O3_CPU::operate()
 {
   long progress{0};
   progress += retire_rob();                    // retire
   progress += complete_inflight_instruction(); // finalize execution
+  progress += squash_wrong_path();             // recover from branches resolved at execute
   progress += execute_instruction();           // execute instructions
   progress += schedule_instruction();          // schedule instructions
   progress += handle_memory_return();          // finalize memory transactions
@@ -46,11 +82,13 @@ long O3_CPU::operate()
 
   progress += dispatch_instruction(); // dispatch
   progress += decode_instruction();   // decode
+  progress += squash_wrong_path();    // recover from branches resolved at decode
   progress += promote_to_decode();
 
   progress += fetch_instruction(); // fetch
   progress += check_dib();
-  initialize_instruction();
+  progress += promote_to_ifetch();
+  initialize_instruction_dispatch(*this);
 
   // heartbeat
   if (show_heartbeat && (num_retired >= (last_heartbeat_instr + STAT_PRINTING_PERIOD))) {
@@ -85,9 +123,17 @@ void O3_CPU::begin_phase()
 
   // Record where the next phase begins
   stats_type stats;
+  stats.threads.resize(std::size(threads));
+  for (const auto& port : EXECUTION_PORTS) {
+    stats.ports.push_back({port.name, port.count});
+  }
   stats.name = "CPU " + std::to_string(cpu);
   stats.begin_instrs = num_retired;
   stats.begin_cycles = begin_phase_time.time_since_epoch() / clock_period;
+  for (std::size_t i = 0; i < std::size(threads); ++i) {
+    threads[i].begin_phase_instr = threads[i].num_retired;
+    stats.threads[i].begin_instrs = threads[i].num_retired;
+  }
   sim_stats = stats;
 }
 
@@ -96,6 +142,9 @@ void O3_CPU::end_phase(unsigned finished_cpu)
   // Record where the phase ended (overwrite if this is later)
   sim_stats.end_instrs = num_retired;
   sim_stats.end_cycles = current_time.time_since_epoch() / clock_period;
+  for (std::size_t i = 0; i < std::size(threads); ++i) {
+    sim_stats.threads[i].end_instrs = threads[i].num_retired;
+  }
 
   if (finished_cpu == this->cpu) {
     finish_phase_instr = num_retired;
@@ -105,25 +154,6 @@ void O3_CPU::end_phase(unsigned finished_cpu)
   }
 }
 
-void O3_CPU::initialize_instruction()
-{
-  champsim::bandwidth instrs_to_read_this_cycle{
-      std::min(FETCH_WIDTH, champsim::bandwidth::maximum_type{static_cast<long>(IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER))})};
-
-  bool stop_fetch = false;
-  while (current_time >= fetch_resume_time && instrs_to_read_this_cycle.has_remaining() && !stop_fetch && !std::empty(input_queue)) {
-    instrs_to_read_this_cycle.consume();
-
-    stop_fetch = do_init_instruction(input_queue.front());
-
-    // Add to IFETCH_BUFFER
-    IFETCH_BUFFER.push_back(input_queue.front());
-    input_queue.pop_front();
-
-    IFETCH_BUFFER.back().ready_time = current_time;
-  }
-}
-
 namespace
 {
 void do_stack_pointer_folding(ooo_model_instr& arch_instr)
@@ -145,51 +175,70 @@ void do_stack_pointer_folding(ooo_model_instr& arch_instr)
     }
   }
 }
-} // namespace
 
-bool O3_CPU::do_predict_branch(ooo_model_instr& arch_instr)
+champsim::op_class classify(const ooo_model_instr& arch_instr, unsigned fp_first, unsigned fp_last)
 {
-  bool stop_fetch = false;
+  if (arch_instr.is_branch) {
+    return champsim::op_class::branch;
+  }
+  if (!std::empty(arch_instr.destination_memory)) {
+    return champsim::op_class::store;
+  }
+  if (!std::empty(arch_instr.source_memory)) {
+    return champsim::op_class::load;
+  }
 
-  // handle branch prediction for all instructions as at this point we do not know if the instruction is a branch
-  sim_stats.total_branch_types.increment(arch_instr.branch);
-  auto [predicted_branch_target, always_taken] = impl_btb_prediction(arch_instr.ip, arch_instr.branch);
-  arch_instr.branch_prediction = impl_predict_branch(arch_instr.ip, predicted_branch_target, always_taken, arch_instr.branch) || always_taken;
-  if (!arch_instr.branch_prediction) {
-    predicted_branch_target = champsim::address{};
+  auto is_fp = [fp_first, fp_last](PHYSICAL_REGISTER_ID reg) {
+    return fp_first <= static_cast<unsigned>(reg) && static_cast<unsigned>(reg) <= fp_last;
+  };
+  if (std::any_of(std::begin(arch_instr.source_registers), std::end(arch_instr.source_registers), is_fp)
+      || std::any_of(std::begin(arch_instr.destination_registers), std::end(arch_instr.destination_registers), is_fp)) {
+    return champsim::op_class::fp;
   }
+  return champsim::op_class::alu;
+}
+} // namespace
 
-  if (arch_instr.is_branch) {
-    if constexpr (champsim::debug_print) {
-      fmt::print("[BRANCH] instr_id: {} ip: {} taken: {}\n", arch_instr.instr_id, arch_instr.ip, arch_instr.branch_taken);
-    }
+bool O3_CPU::do_check_branch_prediction(ooo_model_instr& arch_instr, champsim::address predicted_branch_target)
+{
+  bool stop_fetch = false;
 
-    // call code prefetcher every time the branch predictor is used
-    l1i->impl_prefetcher_branch_operate(arch_instr.ip, arch_instr.branch, predicted_branch_target);
+  if constexpr (champsim::debug_print) {
+    fmt::print("[BRANCH] instr_id: {} ip: {} taken: {}\n", arch_instr.instr_id, arch_instr.ip, arch_instr.branch_taken);
+  }
 
-    if (predicted_branch_target != arch_instr.branch_target
-        || (((arch_instr.branch == BRANCH_CONDITIONAL) || (arch_instr.branch == BRANCH_OTHER))
-            && arch_instr.branch_taken != arch_instr.branch_prediction)) { // conditional branches are re-evaluated at decode when the target is computed
-      sim_stats.total_rob_occupancy_at_branch_mispredict += std::size(ROB);
-      sim_stats.branch_type_misses.increment(arch_instr.branch);
-      if (!warmup) {
-        fetch_resume_time = champsim::chrono::clock::time_point::max();
-        stop_fetch = true;
-        arch_instr.branch_mispredicted = true;
+  // call code prefetcher every time the branch predictor is used
+  l1i->impl_prefetcher_branch_operate(arch_instr.ip, arch_instr.branch, predicted_branch_target);
+
+  if (predicted_branch_target != arch_instr.branch_target
+      || (((arch_instr.branch == BRANCH_CONDITIONAL) || (arch_instr.branch == BRANCH_OTHER))
+          && arch_instr.branch_taken != arch_instr.branch_prediction)) { // conditional branches are re-evaluated at decode when the target is computed
+    sim_stats.total_rob_occupancy_at_branch_mispredict += std::size(ROB);
+    sim_stats.branch_type_misses.increment(arch_instr.branch);
+    ++sim_stats.threads.at(arch_instr.thread).branch_misses;
+    if (!warmup) {
+      auto& thread = threads.at(arch_instr.thread);
+      if (WRONG_PATH) {
+        // Continue down the predicted path until the branch is resolved
+        thread.on_wrong_path = true;
+        thread.wrong_path_ip = (predicted_branch_target != champsim::address{}) ? predicted_branch_target : arch_instr.ip + WRONG_PATH_INSTR_SIZE;
+      } else {
+        thread.fetch_resume_time = champsim::chrono::clock::time_point::max();
       }
-    } else {
-      stop_fetch = arch_instr.branch_taken; // if correctly predicted taken, then we can't fetch anymore instructions this cycle
+      stop_fetch = true;
+      arch_instr.branch_mispredicted = true;
     }
-
-    impl_update_btb(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch);
-    impl_last_branch_result(arch_instr.ip, arch_instr.branch_target, arch_instr.branch_taken, arch_instr.branch);
+  } else {
+    stop_fetch = arch_instr.branch_taken; // if correctly predicted taken, then we can't fetch anymore instructions this cycle
   }
 
   return stop_fetch;
 }
 
-bool O3_CPU::do_init_instruction(ooo_model_instr& arch_instr)
+void O3_CPU::do_init_instruction(ooo_model_instr& arch_instr)
 {
+  arch_instr.op = ::classify(arch_instr, FP_REGISTER_FIRST, FP_REGISTER_LAST);
+
   // fast warmup eliminates register dependencies between instructions branch predictor, cache contents, and prefetchers are still warmed up
   if (warmup) {
     arch_instr.source_registers.clear();
@@ -197,7 +246,212 @@ bool O3_CPU::do_init_instruction(ooo_model_instr& arch_instr)
   }
 
   ::do_stack_pointer_folding(arch_instr);
-  return do_predict_branch(arch_instr);
+
+  // The memory operands are accessed in the address space of the thread
+  auto to_thread = [this, thread = arch_instr.thread](auto vaddr) { return thread_address(vaddr, thread); };
+  std::transform(std::begin(arch_instr.source_memory), std::end(arch_instr.source_memory), std::begin(arch_instr.source_memory), to_thread);
+  std::transform(std::begin(arch_instr.destination_memory), std::end(arch_instr.destination_memory), std::begin(arch_instr.destination_memory), to_thread);
+}
+
+champsim::address O3_CPU::thread_address(champsim::address vaddr, std::size_t thread) const
+{
+  if (SHARED_ADDRESS_SPACE) {
+    return vaddr;
+  }
+  return champsim::address{vaddr.to<uint64_t>() ^ (uint64_t{thread} << THREAD_ADDRESS_SHIFT)};
+}
+
+ooo_model_instr O3_CPU::do_synthesize_wrong_path(std::size_t thread_idx)
+{
+  auto& thread = threads.at(thread_idx);
+
+  // The trace does not record the wrong path, so its instructions are synthesized without registers or memory operands
+  ooo_model_instr instr{static_cast<uint8_t>(cpu), input_instr{}};
+  instr.ip = thread.wrong_path_ip;
+  instr.instr_id = next_instr_id++;
+  instr.thread = thread_idx;
+  instr.wrong_path = true;
+  ++sim_stats.wrong_path_fetched;
+
+  // Follow the targets in the BTB, taking conditional branches only if they point backward
+  auto [target, always_taken] = impl_btb_prediction(instr.ip, NOT_BRANCH);
+  instr.branch_prediction = (target != champsim::address{}) && (always_taken || target < instr.ip);
+  thread.wrong_path_ip = instr.branch_prediction ? target : instr.ip + WRONG_PATH_INSTR_SIZE;
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[WRONG PATH] {} instr_id: {} ip: {} next: {}\n", __func__, instr.instr_id, instr.ip, thread.wrong_path_ip);
+  }
+
+  return instr;
+}
+
+bool O3_CPU::can_enqueue_fetch(std::size_t thread, champsim::address ip, const champsim::bandwidth& bw) const
+{
+  if (FTQ_SIZE == 0) {
+    return bw.has_remaining();
+  }
+
+  // An instruction joins the youngest fetch target if it lies in the same block, and otherwise begins a new one
+  bool joins = !std::empty(FTQ) && !FTQ.back().closed && FTQ.back().thread == thread && FTQ.back().block == champsim::block_number{ip};
+  return joins || (bw.has_remaining() && std::size(FTQ) < FTQ_SIZE);
+}
+
+void O3_CPU::do_enqueue_fetch(ooo_model_instr&& instr, bool ends_target, champsim::bandwidth& bw)
+{
+  instr.ready_time = current_time;
+
+  if (FTQ_SIZE == 0) {
+    IFETCH_BUFFER.push_back(std::move(instr));
+    bw.consume();
+    return;
+  }
+
+  if (std::empty(FTQ) || FTQ.back().closed || FTQ.back().thread != instr.thread || FTQ.back().block != champsim::block_number{instr.ip}) {
+    // Prefetch the blocks of the targets that wait behind others, since fetch will not reach them at once
+    if (!std::empty(FTQ) && l1i->virtual_prefetch) {
+      l1i->prefetch_line(thread_address(instr.ip, instr.thread), true, 0);
+    }
+
+    FTQ.push_back({instr.thread, champsim::block_number{instr.ip}, {}, false});
+    bw.consume();
+  }
+
+  FTQ.back().instrs.push_back(std::move(instr));
+  FTQ.back().closed = ends_target;
+}
+
+long O3_CPU::promote_to_ifetch()
+{
+  champsim::bandwidth fetch_bw{
+      std::min(FETCH_WIDTH, champsim::bandwidth::maximum_type{static_cast<long>(IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER))})};
+  while (fetch_bw.has_remaining() && !std::empty(FTQ) && FTQ.front().instrs.front().ready_time <= current_time) {
+    IFETCH_BUFFER.push_back(std::move(FTQ.front().instrs.front()));
+    FTQ.front().instrs.pop_front();
+    if (std::empty(FTQ.front().instrs)) {
+      FTQ.pop_front();
+    }
+    fetch_bw.consume();
+  }
+
+  return fetch_bw.amount_consumed();
+}
+
+void O3_CPU::do_resolve_branch(const ooo_model_instr& instr)
+{
+  auto& thread = threads.at(instr.thread);
+
+  // pay misprediction penalty
+  thread.fetch_resume_time = current_time + BRANCH_MISPREDICT_PENALTY;
+
+  if (thread.on_wrong_path) {
+    thread.on_wrong_path = false;
+    thread.squash_after = instr.instr_id;
+  }
+}
+
+long O3_CPU::squash_wrong_path()
+{
+  long progress{0};
+  for (std::size_t i = 0; i < std::size(threads); ++i) {
+    if (threads[i].squash_after.has_value()) {
+      do_squash(i, *threads[i].squash_after);
+      threads[i].squash_after.reset();
+      ++progress;
+    }
+  }
+  return progress;
+}
+
+void O3_CPU::do_squash(std::size_t thread, uint64_t last_kept)
+{
+  auto squashed = [thread, last_kept](const auto& x) {
+    return x.thread == thread && x.instr_id > last_kept;
+  };
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[SQUASH] {} thread: {} after instr_id: {} cycle: {}\n", __func__, thread, last_kept, current_time.time_since_epoch() / clock_period);
+  }
+
+  for (auto& target : FTQ) {
+    target.instrs.erase(std::remove_if(std::begin(target.instrs), std::end(target.instrs), squashed), std::end(target.instrs));
+  }
+  FTQ.erase(std::remove_if(std::begin(FTQ), std::end(FTQ), [](const auto& target) { return std::empty(target.instrs); }), std::end(FTQ));
+
+  for (auto* buffer : {&IFETCH_BUFFER, &DIB_HIT_BUFFER, &DECODE_BUFFER, &DISPATCH_BUFFER, &ROB}) {
+    buffer->erase(std::remove_if(std::begin(*buffer), std::end(*buffer), squashed), std::end(*buffer));
+  }
+
+  // Loads that wait on a squashed store are younger than it, and so are squashed themselves
+  auto lq_squashed = [squashed](const std::optional<LSQ_ENTRY>& lq_entry) {
+    return lq_entry.has_value() && squashed(*lq_entry);
+  };
+  for (auto& sq_entry : SQ) {
+    auto& dependents = sq_entry.lq_depend_on_me;
+    dependents.erase(std::remove_if(std::begin(dependents), std::end(dependents), lq_squashed), std::end(dependents));
+  }
+  for (auto& lq_entry : LQ) {
+    if (lq_squashed(lq_entry)) {
+      lq_entry.reset();
+    }
+  }
+  SQ.erase(std::remove_if(std::begin(SQ), std::end(SQ), squashed), std::end(SQ));
+
+  // Free the registers renamed by the squashed instructions and restore the rename table
+  reg_allocator.squash(last_kept, thread);
+}
+
+std::optional<std::size_t> O3_CPU::choose_fetch_thread()
+{
+  if (std::size(threads) == 1) {
+    return 0;
+  }
+
+  auto can_fetch = [time = current_time](const hardware_thread& x) {
+    return x.fetch_resume_time <= time && (x.on_wrong_path || !std::empty(x.input_queue));
+  };
+
+  // ICOUNT counts the instructions of a thread that are in the front end or waiting to execute
+  auto icount = [this](std::size_t thread) {
+    auto in_thread = [thread](const ooo_model_instr& x) {
+      return x.thread == thread;
+    };
+    auto waiting = [thread](const ooo_model_instr& x) {
+      return x.thread == thread && !x.executed;
+    };
+    auto queued = std::accumulate(std::begin(FTQ), std::end(FTQ), std::ptrdiff_t{0}, [thread](auto acc, const fetch_target& x) {
+      return acc + (x.thread == thread ? static_cast<std::ptrdiff_t>(std::size(x.instrs)) : 0);
+    });
+    return queued + std::count_if(std::begin(IFETCH_BUFFER), std::end(IFETCH_BUFFER), in_thread)
+           + std::count_if(std::begin(DIB_HIT_BUFFER), std::end(DIB_HIT_BUFFER), in_thread)
+           + std::count_if(std::begin(DECODE_BUFFER), std::end(DECODE_BUFFER), in_thread)
+           + std::count_if(std::begin(DISPATCH_BUFFER), std::end(DISPATCH_BUFFER), in_thread) + std::count_if(std::begin(ROB), std::end(ROB), waiting);
+  };
+
+  // Candidates are considered in rotating order, so that ties are broken fairly
+  std::optional<std::size_t> chosen;
+  long chosen_count = 0;
+  for (std::size_t offset = 0; offset < std::size(threads); ++offset) {
+    auto candidate = (next_fetch_thread + offset) % std::size(threads);
+    if (!can_fetch(threads[candidate])) {
+      continue;
+    }
+
+    if (SMT_FETCH_POLICY == champsim::smt_fetch_policy::round_robin) {
+      chosen = candidate;
+      break;
+    }
+
+    auto count = icount(candidate);
+    if (!chosen.has_value() || count < chosen_count) {
+      chosen = candidate;
+      chosen_count = count;
+    }
+  }
+
+  if (chosen.has_value()) {
+    next_fetch_thread = (*chosen + 1) % std::size(threads);
+  }
+  return chosen;
 }
 
 long O3_CPU::check_dib()
@@ -243,7 +497,7 @@ long O3_CPU::fetch_instruction()
 
   // Find the chunk of instructions in the block
   auto no_match_ip = [](const auto& lhs, const auto& rhs) {
-    return champsim::block_number{lhs.ip} != champsim::block_number{rhs.ip};
+    return lhs.thread != rhs.thread || champsim::block_number{lhs.ip} != champsim::block_number{rhs.ip};
   };
 
   auto l1i_req_begin = std::find_if(std::begin(IFETCH_BUFFER), std::end(IFETCH_BUFFER), fetch_ready);
@@ -269,7 +523,7 @@ long O3_CPU::fetch_instruction()
 bool O3_CPU::do_fetch_instruction(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end)
 {
   CacheBus::request_type fetch_packet;
-  fetch_packet.v_address = begin->ip;
+  fetch_packet.v_address = thread_address(begin->ip, begin->thread);
   fetch_packet.instr_id = begin->instr_id;
   fetch_packet.ip = begin->ip;
 
@@ -373,8 +627,7 @@ long O3_CPU::decode_instruction()
           || (((db_entry.branch == BRANCH_CONDITIONAL) || (db_entry.branch == BRANCH_OTHER)) && db_entry.branch_taken == db_entry.branch_prediction)) {
         // clear the branch_mispredicted bit so we don't attempt to resume fetch again at execute
         db_entry.branch_mispredicted = 0;
-        // pay misprediction penalty
-        this->fetch_resume_time = this->current_time + BRANCH_MISPREDICT_PENALTY;
+        this->do_resolve_branch(db_entry);
       }
     }
     // Add to dispatch
@@ -408,19 +661,69 @@ long O3_CPU::dispatch_instruction()
 {
   champsim::bandwidth available_dispatch_bandwidth{DISPATCH_WIDTH};
 
+  // When the structures are partitioned, each thread may fill only its share of them
+  const auto num_threads = std::size(threads);
+  const bool partitioned = num_threads > 1 && SMT_PARTITIONING == champsim::smt_partitioning::partitioned;
+  std::vector<std::size_t> rob_held(num_threads, 0), lq_held(num_threads, 0), sq_held(num_threads, 0);
+  if (partitioned) {
+    for (const auto& rob_entry : ROB) {
+      ++rob_held.at(rob_entry.thread);
+    }
+    for (const auto& lq_entry : LQ) {
+      if (lq_entry.has_value()) {
+        ++lq_held.at(lq_entry->thread);
+      }
+    }
+    for (const auto& sq_entry : SQ) {
+      ++sq_held.at(sq_entry.thread);
+    }
+  }
+
+  auto can_dispatch = [&, this](const ooo_model_instr& instr) {
+    auto loads = std::size(instr.source_memory);
+    auto stores = std::size(instr.destination_memory);
+    return instr.ready_time <= current_time && std::size(ROB) != ROB_SIZE
+           && ((std::size_t)std::count_if(std::begin(LQ), std::end(LQ), [](const auto& lq_entry) { return !lq_entry.has_value(); }) >= loads)
+           && ((stores + std::size(SQ)) <= SQ_SIZE)
+           && (!partitioned
+               || (rob_held[instr.thread] < ROB_SIZE / num_threads && lq_held[instr.thread] + loads <= std::size(LQ) / num_threads
+                   && sq_held[instr.thread] + stores <= SQ_SIZE / num_threads));
+  };
+
   // dispatch DISPATCH_WIDTH instructions into the ROB
-  while (available_dispatch_bandwidth.has_remaining() && !std::empty(DISPATCH_BUFFER) && DISPATCH_BUFFER.front().ready_time <= current_time
-         && std::size(ROB) != ROB_SIZE
-         && ((std::size_t)std::count_if(std::begin(LQ), std::end(LQ), [](const auto& lq_entry) { return !lq_entry.has_value(); })
-             >= std::size(DISPATCH_BUFFER.front().source_memory))
-         && ((std::size(DISPATCH_BUFFER.front().destination_memory) + std::size(SQ)) <= SQ_SIZE)) {
-    ROB.push_back(std::move(DISPATCH_BUFFER.front()));
-    DISPATCH_BUFFER.pop_front();
-    do_memory_scheduling(ROB.back());
+  // Each thread dispatches in order, but a thread that stalls does not block the others
+  std::vector<bool> stalled(num_threads, false);
+  std::size_t stalled_count = 0;
+  auto keep = std::begin(DISPATCH_BUFFER);
+  auto dispatch_it = std::begin(DISPATCH_BUFFER);
+  for (; available_dispatch_bandwidth.has_remaining() && dispatch_it != std::end(DISPATCH_BUFFER) && stalled_count < num_threads; ++dispatch_it) {
+    if (stalled.at(dispatch_it->thread) || !can_dispatch(*dispatch_it)) {
+      if (!stalled.at(dispatch_it->thread)) {
+        stalled.at(dispatch_it->thread) = true;
+        ++stalled_count;
+      }
+      if (keep != dispatch_it) {
+        *keep = std::move(*dispatch_it);
+      }
+      ++keep;
+      continue;
+    }
+
+    // The ROB is kept in program order, which interleaves the threads in the order they were fetched
+    auto rob_it = ROB.insert(num_threads > 1 ? std::upper_bound(std::begin(ROB), std::end(ROB), *dispatch_it, ooo_model_instr::program_order) : std::end(ROB),
+                             std::move(*dispatch_it));
+    do_memory_scheduling(*rob_it);
+
+    if (partitioned) {
+      ++rob_held.at(rob_it->thread);
+      lq_held.at(rob_it->thread) += std::size(rob_it->source_memory);
+      sq_held.at(rob_it->thread) += std::size(rob_it->destination_memory);
+    }
 
     available_dispatch_bandwidth.consume();
-    ROB.back().ready_time = current_time + (warmup ? champsim::chrono::clock::duration{} : SCHEDULING_LATENCY);
+    rob_it->ready_time = current_time + (warmup ? champsim::chrono::clock::duration{} : SCHEDULING_LATENCY);
   }
+  DISPATCH_BUFFER.erase(keep, dispatch_it);
 
   return available_dispatch_bandwidth.amount_consumed();
 }
@@ -429,12 +732,21 @@ long O3_CPU::schedule_instruction()
 {
   champsim::bandwidth search_bw{SCHEDULER_SIZE};
   int progress{0};
-  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && search_bw.has_remaining(); ++rob_it) {
-    // if there aren't enough physical registers available for the next instruction, stop scheduling
-    unsigned long sources_to_allocate = std::count_if(rob_it->source_registers.begin(), rob_it->source_registers.end(),
-                                                      [&alloc = std::as_const(reg_allocator)](auto srcreg) { return !alloc.isAllocated(srcreg); });
-    if (reg_allocator.count_free_registers() < (sources_to_allocate + rob_it->destination_registers.size())) {
-      break;
+  std::vector<bool> stalled(std::size(threads), false);
+  std::size_t stalled_count = 0;
+  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && search_bw.has_remaining() && stalled_count < std::size(threads); ++rob_it) {
+    if (stalled.at(rob_it->thread)) {
+      continue;
+    }
+
+    // if there aren't enough physical registers available for the next instruction, stop scheduling this thread
+    unsigned long sources_to_allocate =
+        std::count_if(rob_it->source_registers.begin(), rob_it->source_registers.end(),
+                      [&alloc = std::as_const(reg_allocator), thread = rob_it->thread](auto srcreg) { return !alloc.isAllocated(srcreg, thread); });
+    if (reg_allocator.count_free_registers(rob_it->thread) < (sources_to_allocate + rob_it->destination_registers.size())) {
+      stalled.at(rob_it->thread) = true;
+      ++stalled_count;
+      continue;
     }
     if (!rob_it->scheduled && rob_it->ready_time <= current_time) {
       do_scheduling(*rob_it);
@@ -454,12 +766,12 @@ void O3_CPU::do_scheduling(ooo_model_instr& instr)
   // Mark register dependencies
   for (auto& src_reg : instr.source_registers) {
     // rename source register
-    src_reg = reg_allocator.rename_src_register(src_reg);
+    src_reg = reg_allocator.rename_src_register(src_reg, instr.thread);
   }
 
   for (auto& dreg : instr.destination_registers) {
     // rename destination register
-    dreg = reg_allocator.rename_dest_register(dreg, instr.instr_id);
+    dreg = reg_allocator.rename_dest_register(dreg, instr.instr_id, instr.thread);
   }
 
   instr.scheduled = true;
@@ -472,8 +784,10 @@ long O3_CPU::execute_instruction()
     if (rob_it->scheduled && !rob_it->executed && rob_it->ready_time <= current_time) {
       bool ready = std::all_of(std::begin(rob_it->source_registers), std::end(rob_it->source_registers),
                                [&alloc = std::as_const(reg_allocator)](auto srcreg) { return alloc.isValid(srcreg); });
-      if (ready) {
-        do_execution(*rob_it);
+      if (ready && std::empty(EXECUTION_PORTS)) {
+        do_execution(*rob_it, EXEC_LATENCY);
+        exec_bw.consume();
+      } else if (ready && do_issue_to_port(*rob_it)) {
         exec_bw.consume();
       }
     }
@@ -482,22 +796,63 @@ long O3_CPU::execute_instruction()
   return exec_bw.amount_consumed();
 }
 
-void O3_CPU::do_execution(ooo_model_instr& instr)
+bool O3_CPU::do_issue_to_port(ooo_model_instr& instr)
+{
+  // The instruction takes the first free port among the groups that accept its class
+  std::optional<std::size_t> first_accepting{};
+  for (std::size_t group = 0; group < std::size(EXECUTION_PORTS); ++group) {
+    const auto& port_desc = EXECUTION_PORTS[group];
+    if (std::find(std::begin(port_desc.ops), std::end(port_desc.ops), instr.op) == std::end(port_desc.ops)) {
+      continue;
+    }
+    if (!first_accepting.has_value()) {
+      first_accepting = group;
+    }
+
+    auto& free_time = port_free_time.at(group);
+    auto port = std::find_if(std::begin(free_time), std::end(free_time), [time = current_time](auto x) { return x <= time; });
+    if (port != std::end(free_time)) {
+      auto occupancy = port_desc.pipelined ? 1 : port_desc.latency;
+      *port = current_time + occupancy * clock_period;
+      ++sim_stats.ports.at(group).issued;
+      sim_stats.ports.at(group).busy_cycles += occupancy;
+      do_execution(instr, port_desc.latency * clock_period);
+      return true;
+    }
+  }
+
+  if (first_accepting.has_value()) {
+    ++sim_stats.ports.at(*first_accepting).conflicts;
+    return false;
+  }
+
+  // No port accepts this class, so it executes as it would without ports
+  do_execution(instr, EXEC_LATENCY);
+  return true;
+}
+
+void O3_CPU::do_execution(ooo_model_instr& instr, champsim::chrono::clock::duration latency)
 {
   instr.executed = true;
-  instr.ready_time = current_time + (warmup ? champsim::chrono::clock::duration{} : EXEC_LATENCY);
+  if (instr.wrong_path) {
+    ++sim_stats.wrong_path_executed;
+  }
+  if (warmup) {
+    latency = champsim::chrono::clock::duration{};
+  }
+  instr.ready_time = current_time + latency;
 
   // Mark LQ entries as ready to translate
   for (auto& lq_entry : LQ) {
     if (lq_entry.has_value() && lq_entry->instr_id == instr.instr_id) {
-      lq_entry->ready_time = current_time + (warmup ? champsim::chrono::clock::duration{} : EXEC_LATENCY);
+      lq_entry->ready_time = current_time + latency;
     }
   }
 
   // Mark SQ entries as ready to translate
   for (auto& sq_entry : SQ) {
     if (sq_entry.instr_id == instr.instr_id) {
-      sq_entry.ready_time = current_time + (warmup ? champsim::chrono::clock::duration{} : EXEC_LATENCY);
+      sq_entry.ready_time = current_time + latency;
     }
   }
 
@@ -513,12 +868,31 @@ void O3_CPU::do_memory_scheduling(ooo_model_instr& instr)
     auto q_entry = std::find_if_not(std::begin(LQ), std::end(LQ), [](const auto& lq_entry) { return lq_entry.has_value(); });
     assert(q_entry != std::end(LQ));
     q_entry->emplace(smem, instr.instr_id, instr.ip, instr.asid); // add it to the load queue
+    (*q_entry)->thread = instr.thread;
+
+    if (MEMORY_DEPENDENCE == champsim::memory_dependence_policy::store_sets) {
+      // Wait for the store that the predictor names, if it has not executed
+      auto predicted = store_sets.dispatch_load(instr.ip);
+      auto sq_it = std::find_if(std::begin(SQ), std::end(SQ), [predicted, thread = instr.thread](const auto& x) {
+        return predicted.has_value() && x.instr_id == *predicted && x.thread == thread;
+      });
+      if (sq_it != std::end(SQ) && !sq_it->fetch_issued) {
+        sq_it->lq_depend_on_me.emplace_back(*q_entry);
+        (*q_entry)->producer_id = sq_it->instr_id;
+      }
+    }
+    if (MEMORY_DEPENDENCE != champsim::memory_dependence_policy::oracle) {
+      continue; // Otherwise, the load searches the store queue only as it issues
+    }
 
-    // Check for forwarding
-    auto sq_it = std::max_element(std::begin(SQ), std::end(SQ), [smem](const auto& lhs, const auto& rhs) {
-      return lhs.virtual_address != smem || (rhs.virtual_address == smem && LSQ_ENTRY::program_order(lhs, rhs));
+    // Check for forwarding from a store of the same thread
+    auto forwards = [smem, thread = instr.thread](const auto& x) {
+      return x.virtual_address == smem && x.thread == thread;
+    };
+    auto sq_it = std::max_element(std::begin(SQ), std::end(SQ), [forwards](const auto& lhs, const auto& rhs) {
+      return !forwards(lhs) || (forwards(rhs) && LSQ_ENTRY::program_order(lhs, rhs));
     });
-    if (sq_it != std::end(SQ) && sq_it->virtual_address == smem) {
+    if (sq_it != std::end(SQ) && forwards(*sq_it)) {
       if (sq_it->fetch_issued) { // Store already executed
         (*q_entry)->finish(instr);
         q_entry->reset();
@@ -537,6 +911,10 @@ void O3_CPU::do_memory_scheduling(ooo_model_instr& instr)
   // store
   for (auto& dmem : instr.destination_memory) {
     SQ.emplace_back(dmem, instr.instr_id, instr.ip, instr.asid); // add it to the store queue
+    SQ.back().thread = instr.thread;
+    if (MEMORY_DEPENDENCE == champsim::memory_dependence_policy::store_sets) {
+      store_sets.dispatch_store(instr.ip, instr.instr_id);
+    }
   }
 
   if constexpr (champsim::debug_print) {
@@ -549,9 +927,17 @@ long O3_CPU::operate_lsq()
 {
   champsim::bandwidth store_bw{SQ_WIDTH};
 
-  const auto complete_id = std::empty(ROB) ? std::numeric_limits<uint64_t>::max() : ROB.front().instr_id;
-  auto do_complete = [time = current_time, finished = LSQ_ENTRY::precedes(complete_id), this](const auto& x) {
-    return finished(x) && x.ready_time <= time && this->do_complete_store(x);
+  // A store completes once its instruction has retired, that is, once it precedes the oldest instruction of its thread
+  std::vector<uint64_t> complete_id(std::size(threads), std::numeric_limits<uint64_t>::max());
+  std::size_t threads_found = 0;
+  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && threads_found < std::size(threads); ++rob_it) {
+    if (complete_id.at(rob_it->thread) == std::numeric_limits<uint64_t>::max()) {
+      complete_id.at(rob_it->thread) = rob_it->instr_id;
+      ++threads_found;
+    }
+  }
+  auto do_complete = [time = current_time, &complete_id, this](const auto& x) {
+    return LSQ_ENTRY::precedes(complete_id.at(x.thread))(x) && x.ready_time <= time && this->do_complete_store(x);
   };
 
   auto unfetched_begin = std::partition_point(std::begin(SQ), std::end(SQ), [](const auto& x) { return x.fetch_issued; });
@@ -572,7 +958,18 @@ long O3_CPU::operate_lsq()
 
   for (auto& lq_entry : LQ) {
     if (load_bw.has_remaining() && lq_entry.has_value() && lq_entry->producer_id == std::numeric_limits<uint64_t>::max() && !lq_entry->fetch_issued
-        && lq_entry->ready_time < current_time) {
+        && lq_entry->ready_time < current_time && can_issue_load(*lq_entry)) {
+      // Without the oracle, a load is forwarded from the youngest older store whose address is known as it issues
+      auto forwards = [&load = std::as_const(*lq_entry)](const LSQ_ENTRY& x) {
+        return x.fetch_issued && x.thread == load.thread && x.virtual_address == load.virtual_address && x.instr_id < load.instr_id;
+      };
+      if (MEMORY_DEPENDENCE != champsim::memory_dependence_policy::oracle && std::any_of(std::begin(SQ), std::end(SQ), forwards)) {
+        load_bw.consume();
+        lq_entry->finish(std::begin(ROB), std::end(ROB));
+        lq_entry.reset();
+        continue;
+      }
+
       auto success = execute_load(*lq_entry);
       if (success) {
         load_bw.consume();
@@ -592,13 +989,84 @@ void O3_CPU::do_finish_store(const LSQ_ENTRY& sq_entry)
 
   sq_entry.finish(std::begin(ROB), std::end(ROB));
 
+  // The address of the store is now known, so younger loads that read it too early are found before the waiting loads are released
+  if (MEMORY_DEPENDENCE != champsim::memory_dependence_policy::oracle) {
+    do_check_memory_order(sq_entry);
+  }
+  if (MEMORY_DEPENDENCE == champsim::memory_dependence_policy::store_sets) {
+    store_sets.execute_store(sq_entry.ip, sq_entry.instr_id);
+  }
+
   // Release dependent loads
   for (std::optional<LSQ_ENTRY>& dependent : sq_entry.lq_depend_on_me) {
     assert(dependent.has_value()); // LQ entry is still allocated
     assert(dependent->producer_id == sq_entry.instr_id);
 
-    dependent->finish(std::begin(ROB), std::end(ROB));
-    dependent.reset();
+    if (dependent->virtual_address == sq_entry.virtual_address) {
+      dependent->finish(std::begin(ROB), std::end(ROB));
+      dependent.reset();
+    } else {
+      dependent->producer_id = std::numeric_limits<uint64_t>::max(); // A predicted dependence that did not alias, so the load issues to memory
+    }
+  }
+}
+
+bool O3_CPU::can_issue_load(const LSQ_ENTRY& lq_entry) const
+{
+  if (MEMORY_DEPENDENCE != champsim::memory_dependence_policy::wait_all) {
+    return true;
+  }
+
+  // The load waits until every older store of its thread has executed
+  return std::none_of(std::begin(SQ), std::end(SQ), [&lq_entry](const auto& x) {
+    return x.thread == lq_entry.thread && x.instr_id < lq_entry.instr_id && !x.fetch_issued;
+  });
+}
+
+void O3_CPU::do_check_memory_order(const LSQ_ENTRY& sq_entry)
+{
+  // A load has read memory too early if it follows the store, reads the same address, and is not still waiting in the load queue
+  auto waiting = [&sq_entry](const ooo_model_instr& instr) {
+    return [&](const std::optional<LSQ_ENTRY>& lq_entry) {
+      return lq_entry.has_value() && lq_entry->instr_id == instr.instr_id && lq_entry->virtual_address == sq_entry.virtual_address && !lq_entry->fetch_issued;
+    };
+  };
+  auto violates = [&, this](const ooo_model_instr& instr) {
+    return instr.thread == sq_entry.thread && instr.instr_id > sq_entry.instr_id && instr.executed
+           && std::find(std::begin(instr.source_memory), std::end(instr.source_memory), sq_entry.virtual_address) != std::end(instr.source_memory)
+           && std::none_of(std::begin(LQ), std::end(LQ), waiting(instr));
+  };
+
+  auto violator = std::find_if(std::begin(ROB), std::end(ROB), violates);
+  if (violator == std::end(ROB)) {
+    return;
+  }
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[SQ] {} instr_id: {} violated by: {} vaddr: {}\n", __func__, sq_entry.instr_id, violator->instr_id, sq_entry.virtual_address);
+  }
+
+  ++sim_stats.memory_order_violations;
+  if (MEMORY_DEPENDENCE == champsim::memory_dependence_policy::store_sets) {
+    store_sets.violation(violator->ip, sq_entry.ip);
+  }
+  do_replay(violator->thread, violator->instr_id);
+}
+
+void O3_CPU::do_replay(std::size_t thread, uint64_t first_replayed)
+{
+  // The offending load and every younger instruction that has executed execute again, once the pipeline restarts.
+  // Their memory operations are not repeated, since the load now takes its value from the store.
+  for (auto& rob_entry : ROB) {
+    if (rob_entry.thread == thread && rob_entry.instr_id >= first_replayed && rob_entry.executed) {
+      rob_entry.executed = false;
+      rob_entry.completed = false;
+      rob_entry.ready_time = current_time + BRANCH_MISPREDICT_PENALTY;
+      for (auto dreg : rob_entry.destination_registers) {
+        reg_allocator.replay_dest_register(dreg);
+      }
+      ++sim_stats.memory_order_replayed;
+    }
   }
 }
 
@@ -640,7 +1108,9 @@ void O3_CPU::do_complete_execution(ooo_model_instr& instr)
   instr.completed = true;
 
   if (instr.branch_mispredicted) {
-    fetch_resume_time = current_time + BRANCH_MISPREDICT_PENALTY;
+    // clear the branch_mispredicted bit so that a replayed branch does not resolve again
+    instr.branch_mispredicted = false;
+    do_resolve_branch(instr);
   }
 }
 
@@ -668,7 +1138,8 @@ long O3_CPU::handle_memory_return()
 
     while (l1i_bw.has_remaining() && !l1i_entry.instr_depend_on_me.empty()) {
       auto fetched = std::find_if(std::begin(IFETCH_BUFFER), std::end(IFETCH_BUFFER), ooo_model_instr::matches_id(l1i_entry.instr_depend_on_me.front()));
-      if (fetched != std::end(IFETCH_BUFFER) && champsim::block_number{fetched->ip} == champsim::block_number{l1i_entry.v_address} && fetched->fetch_issued) {
+      if (fetched != std::end(IFETCH_BUFFER) && fetched->fetch_issued
+          && champsim::block_number{thread_address(fetched->ip, fetched->thread)} == champsim::block_number{l1i_entry.v_address}) {
         fetched->fetch_completed = true;
         l1i_bw.consume();
         ++progress;
@@ -706,28 +1177,66 @@ long O3_CPU::handle_memory_return()
 
 long O3_CPU::retire_rob()
 {
+  if (std::size(threads) > 1) {
+    return retire_threads();
+  }
+
   auto [retire_begin, retire_end] =
       champsim::get_span_p(std::cbegin(ROB), std::cend(ROB), champsim::bandwidth{RETIRE_WIDTH}, [](const auto& x) { return x.completed; });
   assert(std::distance(retire_begin, retire_end) >= 0); // end succeeds begin
+  std::for_each(retire_begin, retire_end, [this](const auto& x) { this->do_retire(x); });
+
+  auto retire_count = std::distance(retire_begin, retire_end);
+  ROB.erase(retire_begin, retire_end);
+
+  return retire_count;
+}
+
+long O3_CPU::retire_threads()
+{
+  // Each thread retires in order, but a thread that has not completed its oldest instruction does not block the others
+  champsim::bandwidth retire_bw{RETIRE_WIDTH};
+  std::vector<bool> stalled(std::size(threads), false);
+  std::size_t stalled_count = 0;
+  auto keep = std::begin(ROB);
+  auto rob_it = std::begin(ROB);
+  for (; retire_bw.has_remaining() && rob_it != std::end(ROB) && stalled_count < std::size(threads); ++rob_it) {
+    if (stalled.at(rob_it->thread) || !rob_it->completed) {
+      if (!stalled.at(rob_it->thread)) {
+        stalled.at(rob_it->thread) = true;
+        ++stalled_count;
+      }
+      if (keep != rob_it) {
+        *keep = std::move(*rob_it);
+      }
+      ++keep;
+      continue;
+    }
+
+    do_retire(*rob_it);
+    retire_bw.consume();
+  }
+  ROB.erase(keep, rob_it);
+
+  return retire_bw.amount_consumed();
+}
+
+void O3_CPU::do_retire(const ooo_model_instr& instr)
+{
   if constexpr (champsim::debug_print) {
-    std::for_each(retire_begin, retire_end, [cycle = current_time.time_since_epoch() / clock_period](const auto& x) {
-      fmt::print("[ROB] retire_rob instr_id: {} is retired cycle: {}\n", x.instr_id, cycle);
-    });
+    fmt::print("[ROB] retire_rob instr_id: {} is retired cycle: {}\n", instr.instr_id, current_time.time_since_epoch() / clock_period);
   }
 
+  assert(!instr.wrong_path); // wrong-path instructions are squashed before the branch retires
+
   // commit register writes to backend RAT
   // and recycle the old physical registers
-  for (auto rob_it = retire_begin; rob_it != retire_end; ++rob_it) {
-    for (auto dreg : rob_it->destination_registers) {
-      reg_allocator.retire_dest_register(dreg);
-    }
+  for (auto dreg : instr.destination_registers) {
+    reg_allocator.retire_dest_register(dreg);
   }
 
-  auto retire_count = std::distance(retire_begin, retire_end);
-  num_retired += retire_count;
-  ROB.erase(retire_begin, retire_end);
-
-  return retire_count;
+  ++num_retired;
+  ++threads.at(instr.thread).num_retired;
 }
 
 void O3_CPU::impl_initialize_branch_predictor() const { branch_module_pimpl->impl_initialize_branch_predictor(); }
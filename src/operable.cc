@@ -22,11 +22,17 @@ champsim::operable::operable(champsim::chrono::picoseconds clock_period_) : cloc
 
 long champsim::operable::operate_on(const champsim::chrono::clock& clock)
 {
+  const auto host_start = profile_host_time ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
   long progress{0};
   while (current_time < clock.now()) {
     progress += _operate();
   }
 
+  if (profile_host_time) {
+    host_time += std::chrono::steady_clock::now() - host_start;
+  }
+
   return progress;
 }
 
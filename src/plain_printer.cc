@@ -62,6 +62,30 @@ std::vector<std::string> champsim::plain_printer::format(O3_CPU::stats_type stat
                                 ::print_ratio(std::kilo::num * stats.branch_type_misses.value_or(idx, 0), stats.instrs())));
   }
 
+  if (stats.wrong_path_fetched > 0) {
+    lines.push_back(fmt::format("{} Wrong-path instructions fetched: {} executed: {}", stats.name, stats.wrong_path_fetched, stats.wrong_path_executed));
+  }
+
+  if (stats.memory_order_violations > 0) {
+    lines.push_back(fmt::format("{} Memory order violations: {} instructions replayed: {}", stats.name, stats.memory_order_violations,
+                                stats.memory_order_replayed));
+  }
+
+  for (const auto& port : stats.ports) {
+    lines.push_back(fmt::format("{} {} ports: {} issued: {} utilization: {}% conflicts: {}", stats.name, port.name, port.count, port.issued,
+                                ::print_ratio(100 * port.busy_cycles, port.count * static_cast<uint64_t>(stats.cycles())), port.conflicts));
+  }
+
+  if (std::size(stats.threads) > 1) {
+    for (std::size_t i = 0; i < std::size(stats.threads); ++i) {
+      const auto& thread = stats.threads[i];
+      lines.push_back(fmt::format("{} thread {} IPC: {} instructions: {} Branch Prediction Accuracy: {}% MPKI: {}", stats.name, i,
+                                  ::print_ratio(thread.instrs(), stats.cycles()), thread.instrs(),
+                                  ::print_ratio(100 * (thread.branches - thread.branch_misses), thread.branches),
+                                  ::print_ratio(std::kilo::num * thread.branch_misses, thread.instrs())));
+    }
+  }
+
   return lines;
 }
 
@@ -118,12 +142,31 @@ std::vector<std::string> champsim::plain_printer::format(CACHE::stats_type stats
 
     lines.push_back(fmt::format("cpu{}->{} PREFETCH REQUESTED: {:10} ISSUED: {:10} USEFUL: {:10} USELESS: {:10}", cpu, stats.name, stats.pf_requested,
                                 stats.pf_issued, stats.pf_useful, stats.pf_useless));
+    if (stats.pf_late > 0 || stats.pf_throttled > 0) {
+      lines.push_back(fmt::format("cpu{}->{} PREFETCH LATE: {:10} THROTTLED: {:10}", cpu, stats.name, stats.pf_late, stats.pf_throttled));
+    }
 
     uint64_t total_downstream_demands = total_mshr_return - stats.mshr_return.value_or(std::pair{access_type::PREFETCH, cpu}, mshr_return_value_type{});
     lines.push_back(
         fmt::format("cpu{}->{} AVERAGE MISS LATENCY: {} cycles", cpu, stats.name, ::print_ratio(stats.total_miss_latency_cycles, total_downstream_demands)));
   }
 
+  if (stats.back_invalidations > 0) {
+    lines.push_back(fmt::format("{} BACK INVALIDATIONS: {:10}", stats.name, stats.back_invalidations));
+  }
+
+  if (stats.coherence_misses > 0 || stats.coherence_snoops > 0) {
+    lines.push_back(fmt::format("{} COHERENCE MISSES: {:10}  SNOOPS: {:10}", stats.name, stats.coherence_misses, stats.coherence_snoops));
+  }
+
+  for (const auto& hist : stats.stack_distances) {
+    lines.push_back(fmt::format("{} STACK DISTANCE SETS: {} ACCESSES: {:10d} COLD: {:10d}", stats.name, hist.sets, hist.accesses(), hist.cold));
+    for (std::size_t ways = 1; ways <= std::size(hist.distances); ways *= 2) {
+      lines.push_back(fmt::format("  WAYS: {:4d} BLOCKS: {:10d} MISS: {:10d} MISS RATIO: {}", ways, hist.sets * ways, hist.misses(ways),
+                                  ::print_ratio(hist.misses(ways), hist.accesses())));
+    }
+  }
+
   return lines;
 }
 
@@ -156,9 +199,21 @@ std::vector<std::string> champsim::plain_printer::format(champsim::phase_stats&
   std::vector<std::string> lines{};
   lines.push_back(fmt::format("=== {} ===", stats.name));
 
-  int i = 0;
-  for (auto tn : stats.trace_names) {
-    lines.push_back(fmt::format("CPU {} runs {}", i++, tn));
+  // Each hardware thread of a core runs its own trace
+  std::vector<std::pair<std::size_t, std::size_t>> contexts{};
+  for (std::size_t cpu = 0; cpu < std::size(stats.roi_cpu_stats); ++cpu) {
+    for (std::size_t thread = 0; thread < std::size(stats.roi_cpu_stats[cpu].threads); ++thread) {
+      contexts.emplace_back(cpu, thread);
+    }
+  }
+  const bool smt = std::size(contexts) == std::size(stats.trace_names) && std::size(contexts) > std::size(stats.roi_cpu_stats);
+
+  for (std::size_t i = 0; i < std::size(stats.trace_names); ++i) {
+    if (smt) {
+      lines.push_back(fmt::format("CPU {} thread {} runs {}", contexts[i].first, contexts[i].second, stats.trace_names[i]));
+    } else {
+      lines.push_back(fmt::format("CPU {} runs {}", i, stats.trace_names[i]));
+    }
   }
 
   if (NUM_CPUS > 1) {
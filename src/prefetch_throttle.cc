@@ -0,0 +1,149 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prefetch_throttle.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "util/bits.h" // for lg2, next_pow2
+
+namespace
+{
+double ratio(double num, double denom) { return denom > 0 ? num / denom : 0; }
+
+/*
+ * The change in aggressiveness that Feedback Directed Prefetching makes for each case of accuracy, lateness, and pollution.
+ * Late prefetches call for more aggressiveness, unless they are inaccurate or, at middling accuracy, polluting. Pollution calls for less.
+ */
+int fdp_step(double accuracy, bool late, bool polluting)
+{
+  using throttle = champsim::prefetch_throttle;
+  if (accuracy >= throttle::accuracy_high) {
+    if (late) {
+      return 1;
+    }
+    return polluting ? -1 : 0;
+  }
+
+  if (accuracy >= throttle::accuracy_low) {
+    if (polluting) {
+      return -1;
+    }
+    return late ? 1 : 0;
+  }
+
+  return (late || polluting) ? -1 : 0;
+}
+} // namespace
+
+champsim::prefetch_throttle::prefetch_throttle(prefetch_throttle_policy policy_, std::size_t blocks)
+    : policy(policy_), interval_length(std::max<uint64_t>(blocks / 2, 1)), pollution_filter(champsim::next_pow2(std::max<std::size_t>(blocks, 1)))
+{
+  assert(policy != prefetch_throttle_policy::none);
+}
+
+std::size_t champsim::prefetch_throttle::filter_index(uint64_t block) const
+{
+  // Fold the upper bits of the block number into the index, so that blocks a multiple of the filter size apart are told apart
+  const auto bits = champsim::lg2(std::size(pollution_filter));
+  return static_cast<std::size_t>((block ^ (block >> bits)) & (std::size(pollution_filter) - 1));
+}
+
+void champsim::prefetch_throttle::prefetch_issued() { ++interval.issued; }
+
+void champsim::prefetch_throttle::prefetch_useful() { ++interval.useful; }
+
+void champsim::prefetch_throttle::prefetch_late() { ++interval.late; }
+
+void champsim::prefetch_throttle::demand_miss(uint64_t block)
+{
+  ++interval.demand_misses;
+  const auto index = filter_index(block);
+  if (pollution_filter.at(index)) {
+    ++interval.polluting;
+    pollution_filter.at(index) = false;
+  }
+}
+
+void champsim::prefetch_throttle::evicted_by_prefetch(uint64_t block) { pollution_filter.at(filter_index(block)) = true; }
+
+void champsim::prefetch_throttle::observe_utilization(double utilization) { m_utilization = utilization; }
+
+void champsim::prefetch_throttle::block_filled()
+{
+  if (++interval_fills >= interval_length) {
+    end_interval();
+  }
+}
+
+void champsim::prefetch_throttle::end_interval()
+{
+  measured.issued = (measured.issued + interval.issued) / 2;
+  measured.useful = (measured.useful + interval.useful) / 2;
+  measured.late = (measured.late + interval.late) / 2;
+  measured.polluting = (measured.polluting + interval.polluting) / 2;
+  measured.demand_misses = (measured.demand_misses + interval.demand_misses) / 2;
+  interval = counts{};
+  interval_fills = 0;
+
+  // Without prefetches, there is nothing to judge
+  if (measured.issued <= 0) {
+    return;
+  }
+
+  auto step = ::fdp_step(accuracy(), lateness() > lateness_threshold, pollution() > pollution_threshold);
+  if (policy == prefetch_throttle_policy::bandwidth) {
+    if (m_utilization >= utilization_high) {
+      // Memory is saturated: only the accurate prefetchers keep their place, and none may grow
+      step = (accuracy() < accuracy_high) ? -1 : std::min(step, 0);
+    } else if (m_utilization < utilization_low && step == 0 && accuracy() >= accuracy_low) {
+      // Memory has bandwidth to spare
+      step = 1;
+    }
+  }
+
+  m_level = static_cast<unsigned>(std::clamp<int>(static_cast<int>(m_level) + step, 1, max_level));
+}
+
+void champsim::prefetch_throttle::activate()
+{
+  remaining_budget = (m_level < max_level) ? (uint64_t{1} << (m_level - 1)) : std::numeric_limits<uint64_t>::max();
+}
+
+bool champsim::prefetch_throttle::permit()
+{
+  if (remaining_budget == 0) {
+    return false;
+  }
+  if (remaining_budget != std::numeric_limits<uint64_t>::max()) {
+    --remaining_budget;
+  }
+  return true;
+}
+
+unsigned champsim::prefetch_throttle::level() const { return m_level; }
+
+unsigned champsim::prefetch_throttle::degree(unsigned max_degree) const { return std::max((max_degree * m_level + max_level - 1) / max_level, 1u); }
+
+double champsim::prefetch_throttle::accuracy() const { return ::ratio(measured.useful, measured.issued); }
+
+double champsim::prefetch_throttle::lateness() const { return ::ratio(measured.late, measured.useful); }
+
+double champsim::prefetch_throttle::pollution() const { return ::ratio(measured.polluting, measured.demand_misses); }
+
+double champsim::prefetch_throttle::utilization() const { return m_utilization; }
@@ -130,6 +130,10 @@ long PageTableWalker::operate()
   progress += std::distance(std::cbegin(lower_level->returned), std::cend(lower_level->returned));
   lower_level->returned.clear();
 
+  for (auto* ul : upper_levels) {
+    ul->memory_utilization = lower_level->memory_utilization;
+  }
+
   std::vector<mshr_type> next_steps{};
 
   champsim::bandwidth fill_bw{MAX_FILL};
@@ -1,42 +1,57 @@
 #include "register_allocator.h"
 
+#include <algorithm>
 #include <cassert>
 
-RegisterAllocator::RegisterAllocator(size_t num_physical_registers)
+RegisterAllocator::RegisterAllocator(size_t num_physical_registers, std::size_t num_threads, bool partitioned)
+    : frontend_RAT(num_threads), backend_RAT(num_threads), thread_quota(partitioned ? num_physical_registers / num_threads : num_physical_registers),
+      held(num_threads, 0)
 {
   assert(num_physical_registers <= std::numeric_limits<PHYSICAL_REGISTER_ID>::max());
+  assert(num_threads > 0);
   for (size_t i = 0; i < num_physical_registers; ++i) {
     free_registers.push(static_cast<PHYSICAL_REGISTER_ID>(i));
   }
   physical_register_file = std::vector<physical_register>(num_physical_registers, {0, 0, false, false});
-  frontend_RAT.fill(-1); // default value for no mapping
-  backend_RAT.fill(-1);
+  for (auto& rat : frontend_RAT) {
+    rat.fill(-1); // default value for no mapping
+  }
+  for (auto& rat : backend_RAT) {
+    rat.fill(-1);
+  }
 }
 
-PHYSICAL_REGISTER_ID RegisterAllocator::rename_dest_register(int16_t reg, champsim::program_ordered<ooo_model_instr>::id_type producer_id)
+PHYSICAL_REGISTER_ID RegisterAllocator::allocate(int16_t reg, std::size_t thread)
 {
   assert(!free_registers.empty());
+  assert(held.at(thread) < thread_quota);
 
   PHYSICAL_REGISTER_ID phys_reg = free_registers.front();
   free_registers.pop();
-  frontend_RAT[reg] = phys_reg;
-  physical_register_file.at(phys_reg) = {(uint16_t)reg, producer_id, false, true}; // arch_reg_index, valid, busy
+  ++held.at(thread);
+  frontend_RAT.at(thread)[reg] = phys_reg;
 
   return phys_reg;
 }
 
-PHYSICAL_REGISTER_ID RegisterAllocator::rename_src_register(int16_t reg)
+PHYSICAL_REGISTER_ID RegisterAllocator::rename_dest_register(int16_t reg, champsim::program_ordered<ooo_model_instr>::id_type producer_id, std::size_t thread)
 {
-  PHYSICAL_REGISTER_ID phys = frontend_RAT[reg];
+  PHYSICAL_REGISTER_ID phys_reg = allocate(reg, thread);
+  physical_register_file.at(phys_reg) = {(uint16_t)reg, producer_id, false, true, thread}; // arch_reg_index, valid, busy, thread
+
+  return phys_reg;
+}
+
+PHYSICAL_REGISTER_ID RegisterAllocator::rename_src_register(int16_t reg, std::size_t thread)
+{
+  PHYSICAL_REGISTER_ID phys = frontend_RAT.at(thread)[reg];
 
   if (phys < 0) {
     // allocate the register if it hasn't yet been mapped
     // (common due to the traces being slices in the middle of a program)
-    phys = free_registers.front();
-    free_registers.pop();
-    frontend_RAT[reg] = phys;
-    backend_RAT[reg] = phys; //we assume this register's last write has been committed
-    physical_register_file.at(phys) = {(uint16_t)reg, 0, true, true}; // arch_reg_index, producing_inst_id, valid, busy
+    phys = allocate(reg, thread);
+    backend_RAT.at(thread)[reg] = phys; //we assume this register's last write has been committed
+    physical_register_file.at(phys) = {(uint16_t)reg, 0, true, true, thread}; // arch_reg_index, producing_inst_id, valid, busy, thread
   }
 
   return phys;
@@ -48,14 +63,21 @@ void RegisterAllocator::complete_dest_register(PHYSICAL_REGISTER_ID physreg)
   physical_register_file.at(physreg).valid = true;
 }
 
+void RegisterAllocator::replay_dest_register(PHYSICAL_REGISTER_ID physreg)
+{
+  // the producer will execute again, so its consumers must wait for it
+  physical_register_file.at(physreg).valid = false;
+}
+
 void RegisterAllocator::retire_dest_register(PHYSICAL_REGISTER_ID physreg)
 {
   // grab the arch reg index, find old phys reg in backend RAT
   uint16_t arch_reg = physical_register_file.at(physreg).arch_reg_index;
-  PHYSICAL_REGISTER_ID old_phys_reg = backend_RAT[arch_reg];
+  auto& rat = backend_RAT.at(physical_register_file.at(physreg).thread);
+  PHYSICAL_REGISTER_ID old_phys_reg = rat[arch_reg];
 
   // update the backend RAT with the new phys reg
-  backend_RAT[arch_reg] = physreg;
+  rat[arch_reg] = physreg;
 
   // free the old phys reg
   if (old_phys_reg != -1) {
@@ -65,15 +87,19 @@ void RegisterAllocator::retire_dest_register(PHYSICAL_REGISTER_ID physreg)
 
 void RegisterAllocator::free_register(PHYSICAL_REGISTER_ID physreg)
 {
+  --held.at(physical_register_file.at(physreg).thread);
   physical_register_file.at(physreg) = {255, 0, false, false}; // arch_reg_index, producing_inst_id, valid, busy
   free_registers.push(physreg);
 }
 
 bool RegisterAllocator::isValid(PHYSICAL_REGISTER_ID physreg) const { return physical_register_file.at(physreg).valid; }
 
-bool RegisterAllocator::isAllocated(PHYSICAL_REGISTER_ID archreg) const { return frontend_RAT[archreg] != -1; }
+bool RegisterAllocator::isAllocated(PHYSICAL_REGISTER_ID archreg, std::size_t thread) const { return frontend_RAT.at(thread)[archreg] != -1; }
 
-unsigned long RegisterAllocator::count_free_registers() const { return std::size(free_registers); }
+unsigned long RegisterAllocator::count_free_registers(std::size_t thread) const
+{
+  return std::min<unsigned long>(std::size(free_registers), thread_quota - held.at(thread));
+}
 
 int RegisterAllocator::count_reg_dependencies(const ooo_model_instr& instr) const
 {
@@ -82,19 +108,51 @@ int RegisterAllocator::count_reg_dependencies(const ooo_model_instr& instr) cons
 
 void RegisterAllocator::reset_frontend_RAT()
 {
-  std::copy(std::begin(backend_RAT), std::end(backend_RAT), std::begin(frontend_RAT));
-  // once wrong path is implemented:
-  // find registers allocated by wrong-path instructions and free them
+  for (std::size_t thread = 0; thread < std::size(frontend_RAT); ++thread) {
+    std::copy(std::begin(backend_RAT[thread]), std::end(backend_RAT[thread]), std::begin(frontend_RAT[thread]));
+  }
+}
+
+void RegisterAllocator::squash(champsim::program_ordered<ooo_model_instr>::id_type last_kept, std::size_t thread)
+{
+  // free the registers renamed by the squashed instructions
+  for (std::size_t i = 0; i < std::size(physical_register_file); ++i) {
+    const auto& reg = physical_register_file[i];
+    if (reg.busy && reg.thread == thread && reg.producing_instruction_id > last_kept) {
+      free_register(static_cast<PHYSICAL_REGISTER_ID>(i));
+    }
+  }
+
+  // map each architectural register to its youngest remaining producer, starting from the committed state
+  std::vector<std::pair<uint64_t, PHYSICAL_REGISTER_ID>> producers;
+  for (std::size_t i = 0; i < std::size(physical_register_file); ++i) {
+    const auto& reg = physical_register_file[i];
+    if (reg.busy && reg.thread == thread) {
+      producers.emplace_back(reg.producing_instruction_id, static_cast<PHYSICAL_REGISTER_ID>(i));
+    }
+  }
+  std::sort(std::begin(producers), std::end(producers));
+
+  auto& rat = frontend_RAT.at(thread);
+  std::copy(std::begin(backend_RAT.at(thread)), std::end(backend_RAT.at(thread)), std::begin(rat));
+  for (const auto& producer : producers) {
+    rat[physical_register_file[producer.second].arch_reg_index] = producer.second;
+  }
 }
 
 void RegisterAllocator::print_deadlock()
 {
-  fmt::print("Frontend Register Allocation Table        Backend Register Allocation Table\n");
-  for (size_t i = 0; i < frontend_RAT.size(); ++i) {
-    fmt::print("Arch reg: {:3}    Phys reg: {:3}            Arch reg: {:3}    Phys reg: {:3}\n", i, frontend_RAT[i], i, backend_RAT[i]);
+  for (std::size_t thread = 0; thread < std::size(frontend_RAT); ++thread) {
+    if (std::size(frontend_RAT) > 1) {
+      fmt::print("Thread {}\n", thread);
+    }
+    fmt::print("Frontend Register Allocation Table        Backend Register Allocation Table\n");
+    for (size_t i = 0; i < frontend_RAT[thread].size(); ++i) {
+      fmt::print("Arch reg: {:3}    Phys reg: {:3}            Arch reg: {:3}    Phys reg: {:3}\n", i, frontend_RAT[thread][i], i, backend_RAT[thread][i]);
+    }
   }
 
-  if (count_free_registers() == 0) {
+  if (std::empty(free_registers)) {
     fmt::print("\n**WARNING!! WARNING!!** THE PHYSICAL REGISTER FILE IS COMPLETELY OCCUPIED.\n");
     fmt::print("It is extremely likely your register file size is too small.\n");
   }
@@ -0,0 +1,507 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime_environment.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#include "champsim.h"
+#include "chrono.h"
+#include "defaults.hpp"
+#include "msl/arena.h"
+
+namespace
+{
+using cache_builder_type = champsim::cache_builder<>;
+using core_builder_type = champsim::core_builder<>;
+
+template <typename Builder, typename T>
+using setter_type = Builder& (Builder::*)(T);
+
+template <typename Builder, typename T, std::size_t N>
+using setter_table = std::array<std::pair<const char*, setter_type<Builder, T>>, N>;
+
+/**
+ * Call each setter whose key appears in the description, with the value given there.
+ */
+template <typename Builder, typename T, std::size_t N>
+void apply_present(Builder& builder, const nlohmann::json& desc, const setter_table<Builder, T, N>& setters)
+{
+  for (const auto& [key, setter] : setters) {
+    if (auto found = desc.find(key); found != std::end(desc)) {
+      (builder.*setter)(found->template get<T>());
+    }
+  }
+}
+
+template <typename T, typename F>
+void if_present(const nlohmann::json& desc, const char* key, F&& apply)
+{
+  if (auto found = desc.find(key); found != std::end(desc)) {
+    std::forward<F>(apply)(found->template get<T>());
+  }
+}
+
+const nlohmann::json& checked(const nlohmann::json& description)
+{
+  auto check = [&description](const char* key, std::size_t expected) {
+    if (auto given = description.at(key).get<std::size_t>(); given != expected) {
+      throw std::invalid_argument{fmt::format("The configuration specifies {} = {}, but this executable was built with {}", key, given, expected)};
+    }
+  };
+  check("num_cpus", NUM_CPUS);
+  check("block_size", BLOCK_SIZE);
+  check("page_size", PAGE_SIZE);
+  return description;
+}
+
+std::size_t queue_size(const nlohmann::json& value) { return value.is_null() ? std::numeric_limits<std::size_t>::max() : value.get<std::size_t>(); }
+
+std::vector<champsim::channel> make_channels(const nlohmann::json& descs)
+{
+  std::vector<champsim::channel> retval{};
+  std::transform(std::begin(descs), std::end(descs), std::back_inserter(retval), [](const nlohmann::json& desc) {
+    return champsim::channel{queue_size(desc.at("rq_size")), queue_size(desc.at("pq_size")), queue_size(desc.at("wq_size")),
+                             champsim::data::bits{desc.at("offset_bits").get<unsigned>()}, desc.at("match_offset_bits").get<bool>()};
+  });
+  return retval;
+}
+
+std::vector<champsim::channel*> channel_pointers(std::vector<champsim::channel>& channels, const nlohmann::json& indices)
+{
+  std::vector<champsim::channel*> retval{};
+  std::transform(std::begin(indices), std::end(indices), std::back_inserter(retval),
+                 [&channels](const nlohmann::json& idx) { return &channels.at(idx.get<std::size_t>()); });
+  return retval;
+}
+
+MEMORY_CONTROLLER make_dram(const nlohmann::json& desc, std::vector<champsim::channel>& channels)
+{
+  return MEMORY_CONTROLLER{champsim::chrono::picoseconds{desc.at("dbus_period").get<std::intmax_t>()},
+                           champsim::chrono::picoseconds{desc.at("mc_period").get<std::intmax_t>()},
+                           desc.at("tRP").get<std::size_t>(),
+                           desc.at("tRCD").get<std::size_t>(),
+                           desc.at("tCAS").get<std::size_t>(),
+                           desc.at("tRAS").get<std::size_t>(),
+                           champsim::chrono::microseconds{desc.at("refresh_period").get<long long>()},
+                           channel_pointers(channels, desc.at("upper_levels")),
+                           queue_size(desc.at("rq_size")),
+                           queue_size(desc.at("wq_size")),
+                           desc.at("channels").get<std::size_t>(),
+                           champsim::data::bytes{desc.at("channel_width").get<long long>()},
+                           desc.at("bank_rows").get<std::size_t>(),
+                           desc.at("bank_columns").get<std::size_t>(),
+                           desc.at("ranks").get<std::size_t>(),
+                           desc.at("bankgroups").get<std::size_t>(),
+                           desc.at("banks").get<std::size_t>(),
+                           desc.at("refreshes_per_period").get<std::size_t>()};
+}
+
+VirtualMemory make_vmem(const nlohmann::json& desc, MEMORY_CONTROLLER& dram)
+{
+  std::optional<uint64_t> seed{};
+  if (const auto& randomization = desc.at("randomization"); !randomization.is_null()) {
+    seed = randomization.get<uint64_t>();
+  }
+  return VirtualMemory{champsim::data::bytes{desc.at("pte_page_size").get<long long>()}, desc.at("num_levels").get<std::size_t>(),
+                       champsim::chrono::picoseconds{desc.at("minor_fault_penalty").get<std::intmax_t>()}, dram, seed,
+                       desc.value("shared_address_space", false)};
+}
+
+std::forward_list<PageTableWalker> make_ptws(const nlohmann::json& descs, std::vector<champsim::channel>& channels, VirtualMemory& vmem)
+{
+  std::forward_list<PageTableWalker> retval{};
+  auto tail = retval.before_begin(); // Keep the order of the description
+  for (const nlohmann::json& desc : descs) {
+    const auto name = desc.at("name").get<std::string>();
+    auto builder = champsim::ptw_builder{champsim::defaults::default_ptw}
+                       .name(name)
+                       .upper_levels(channel_pointers(channels, desc.at("upper_levels")))
+                       .virtual_memory(&vmem)
+                       .cpu(desc.at("cpu").get<uint32_t>())
+                       .lower_level(&channels.at(desc.at("lower_level").get<std::size_t>()));
+
+    if_present<uint32_t>(desc, "mshr_size", [&builder](auto value) { builder.mshr_size(value); });
+    if_present<champsim::bandwidth::maximum_type>(desc, "tag_bandwidth", [&builder](auto value) { builder.tag_bandwidth(value); });
+    if_present<champsim::bandwidth::maximum_type>(desc, "fill_bandwidth", [&builder](auto value) { builder.fill_bandwidth(value); });
+    if_present<std::intmax_t>(desc, "clock_period", [&builder](auto value) { builder.clock_period(champsim::chrono::picoseconds{value}); });
+    for (const nlohmann::json& pscl : desc.value("pscl", nlohmann::json::array())) {
+      builder.add_pscl(pscl.at(0).get<uint8_t>(), pscl.at(1).get<uint32_t>(), pscl.at(2).get<uint32_t>());
+    }
+
+    tail = retval.emplace_after(tail, builder);
+  }
+  return retval;
+}
+
+cache_builder_type default_cache_builder(const nlohmann::json& desc)
+{
+  auto without_modules = [](auto builder) { return builder.template prefetcher<>().template replacement<>(); };
+
+  const auto name = desc.value("defaults", std::string{});
+  if (name.empty()) {
+    return cache_builder_type{};
+  }
+  if (name == "l1i") {
+    return without_modules(champsim::defaults::default_l1i);
+  }
+  if (name == "l1d") {
+    return without_modules(champsim::defaults::default_l1d);
+  }
+  if (name == "l2c") {
+    return without_modules(champsim::defaults::default_l2c);
+  }
+  if (name == "llc") {
+    return without_modules(champsim::defaults::default_llc);
+  }
+  if (name == "itlb") {
+    return without_modules(champsim::defaults::default_itlb);
+  }
+  if (name == "dtlb") {
+    return without_modules(champsim::defaults::default_dtlb);
+  }
+  if (name == "stlb") {
+    return without_modules(champsim::defaults::default_stlb);
+  }
+  throw std::invalid_argument{fmt::format("Unknown cache defaults '{}'", name)};
+}
+
+champsim::inclusion_policy inclusion_named(const std::string& name)
+{
+  if (name == "nine") {
+    return champsim::inclusion_policy::nine;
+  }
+  if (name == "inclusive") {
+    return champsim::inclusion_policy::inclusive;
+  }
+  if (name == "exclusive") {
+    return champsim::inclusion_policy::exclusive;
+  }
+  throw std::invalid_argument{fmt::format("Unknown inclusion policy '{}'", name)};
+}
+
+champsim::coherence_protocol coherence_named(const std::string& name)
+{
+  if (name == "none") {
+    return champsim::coherence_protocol::none;
+  }
+  if (name == "mesi") {
+    return champsim::coherence_protocol::mesi;
+  }
+  if (name == "moesi") {
+    return champsim::coherence_protocol::moesi;
+  }
+  throw std::invalid_argument{fmt::format("Unknown coherence protocol '{}'", name)};
+}
+
+champsim::prefetch_throttle_policy prefetch_throttle_named(const std::string& name)
+{
+  if (name == "none") {
+    return champsim::prefetch_throttle_policy::none;
+  }
+  if (name == "fdp") {
+    return champsim::prefetch_throttle_policy::fdp;
+  }
+  if (name == "bandwidth") {
+    return champsim::prefetch_throttle_policy::bandwidth;
+  }
+  throw std::invalid_argument{fmt::format("Unknown prefetch throttle '{}'", name)};
+}
+
+champsim::smt_fetch_policy smt_fetch_named(const std::string& name)
+{
+  if (name == "round_robin") {
+    return champsim::smt_fetch_policy::round_robin;
+  }
+  if (name == "icount") {
+    return champsim::smt_fetch_policy::icount;
+  }
+  throw std::invalid_argument{fmt::format("Unknown fetch policy '{}'", name)};
+}
+
+champsim::smt_partitioning smt_partitioning_named(const std::string& name)
+{
+  if (name == "shared") {
+    return champsim::smt_partitioning::shared;
+  }
+  if (name == "partitioned") {
+    return champsim::smt_partitioning::partitioned;
+  }
+  throw std::invalid_argument{fmt::format("Unknown partitioning '{}'", name)};
+}
+
+champsim::memory_dependence_policy memory_dependence_named(const std::string& name)
+{
+  if (name == "oracle") {
+    return champsim::memory_dependence_policy::oracle;
+  }
+  if (name == "wait_all") {
+    return champsim::memory_dependence_policy::wait_all;
+  }
+  if (name == "store_sets") {
+    return champsim::memory_dependence_policy::store_sets;
+  }
+  throw std::invalid_argument{fmt::format("Unknown memory dependence policy '{}'", name)};
+}
+
+champsim::op_class op_class_named(const std::string& name)
+{
+  auto found = std::find(std::begin(champsim::op_class_names), std::end(champsim::op_class_names), name);
+  if (found == std::end(champsim::op_class_names)) {
+    throw std::invalid_argument{fmt::format("Unknown class of instruction '{}'", name)};
+  }
+  return static_cast<champsim::op_class>(std::distance(std::begin(champsim::op_class_names), found));
+}
+
+access_type access_type_named(const std::string& name)
+{
+  auto found = std::find(std::begin(access_type_names), std::end(access_type_names), name);
+  if (found == std::end(access_type_names)) {
+    throw std::invalid_argument{fmt::format("Unknown access type '{}'", name)};
+  }
+  return static_cast<access_type>(std::distance(std::begin(access_type_names), found));
+}
+
+std::forward_list<CACHE> make_caches(const nlohmann::json& descs, std::vector<champsim::channel>& channels, const champsim::modules::registry& registry)
+{
+  const setter_table<cache_builder_type, uint32_t, 6> count_setters{{{"sets", &cache_builder_type::sets},
+                                                                     {"log2_sets", &cache_builder_type::log2_sets},
+                                                                     {"ways", &cache_builder_type::ways},
+                                                                     {"log2_ways", &cache_builder_type::log2_ways},
+                                                                     {"pq_size", &cache_builder_type::pq_size},
+                                                                     {"mshr_size", &cache_builder_type::mshr_size}}};
+  const setter_table<cache_builder_type, uint64_t, 4> latency_setters{{{"log2_size", &cache_builder_type::log2_size},
+                                                                       {"latency", &cache_builder_type::latency},
+                                                                       {"hit_latency", &cache_builder_type::hit_latency},
+                                                                       {"fill_latency", &cache_builder_type::fill_latency}}};
+  const setter_table<cache_builder_type, champsim::bandwidth::maximum_type, 2> bandwidth_setters{
+      {{"tag_bandwidth", &cache_builder_type::tag_bandwidth}, {"fill_bandwidth", &cache_builder_type::fill_bandwidth}}};
+
+  // Each flag is given as a boolean, selecting the first setter if true and the second if false
+  const std::array<std::tuple<const char*, cache_builder_type& (cache_builder_type::*)(), cache_builder_type& (cache_builder_type::*)()>, 3> flag_setters{
+      {{"prefetch_as_load", &cache_builder_type::set_prefetch_as_load, &cache_builder_type::reset_prefetch_as_load},
+       {"wq_checks_full_addr", &cache_builder_type::set_wq_checks_full_addr, &cache_builder_type::reset_wq_checks_full_addr},
+       {"virtual_prefetch", &cache_builder_type::set_virtual_prefetch, &cache_builder_type::reset_virtual_prefetch}}};
+
+  std::forward_list<CACHE> retval{};
+  auto tail = retval.before_begin(); // Keep the order of the description
+  for (const nlohmann::json& desc : descs) {
+    auto builder = default_cache_builder(desc);
+    builder.name(desc.at("name").get<std::string>())
+        .upper_levels(channel_pointers(channels, desc.at("upper_levels")))
+        .lower_level(&channels.at(desc.at("lower_level").get<std::size_t>()));
+
+    apply_present(builder, desc, count_setters);
+    apply_present(builder, desc, latency_setters);
+    apply_present(builder, desc, bandwidth_setters);
+    for (const auto& [key, set, reset] : flag_setters) {
+      if_present<bool>(desc, key, [&builder, set = set, reset = reset](bool value) { (builder.*(value ? set : reset))(); });
+    }
+
+    if_present<std::size_t>(desc, "lower_translate", [&](auto idx) { builder.lower_translate(&channels.at(idx)); });
+    if_present<long long>(desc, "size", [&builder](auto value) { builder.size(champsim::data::bytes{value}); });
+    if_present<unsigned>(desc, "offset_bits", [&builder](auto value) { builder.offset_bits(champsim::data::bits{value}); });
+    if_present<std::intmax_t>(desc, "clock_period", [&builder](auto value) { builder.clock_period(champsim::chrono::picoseconds{value}); });
+    if_present<std::vector<uint64_t>>(desc, "stack_distance_sets", [&builder](auto value) { builder.stack_distance_sets(std::move(value)); });
+    if_present<std::size_t>(desc, "stack_distance_ways", [&builder](auto value) { builder.stack_distance_ways(value); });
+    if_present<std::string>(desc, "inclusion", [&builder](const auto& name) { builder.inclusion(inclusion_named(name)); });
+    if_present<std::string>(desc, "coherence", [&builder](const auto& name) { builder.coherence(coherence_named(name)); });
+    if_present<std::string>(desc, "prefetch_throttle", [&builder](const auto& name) { builder.prefetch_throttle(prefetch_throttle_named(name)); });
+    if_present<std::vector<std::string>>(desc, "prefetch_activate", [&builder](const auto& names) {
+      std::vector<access_type> types{};
+      std::transform(std::begin(names), std::end(names), std::back_inserter(types), access_type_named);
+      builder.prefetch_activate(std::move(types));
+    });
+
+    tail = retval.emplace_after(tail, builder, registry.prefetcher(desc.at("prefetcher").get<std::vector<std::string>>()),
+                                registry.replacement(desc.at("replacement").get<std::vector<std::string>>()));
+  }
+  return retval;
+}
+
+champsim::interconnect::topology_type topology_named(const std::string& name)
+{
+  if (name == "ring") {
+    return champsim::interconnect::topology_type::ring;
+  }
+  if (name == "mesh") {
+    return champsim::interconnect::topology_type::mesh;
+  }
+  throw std::invalid_argument{fmt::format("Unknown interconnect topology '{}'", name)};
+}
+
+std::forward_list<champsim::interconnect> make_interconnects(const nlohmann::json& descs, std::vector<champsim::channel>& channels)
+{
+  std::forward_list<champsim::interconnect> retval{};
+  auto tail = retval.before_begin(); // Keep the order of the description
+  for (const nlohmann::json& desc : descs) {
+    std::vector<std::vector<champsim::channel*>> lower_levels{};
+    std::transform(std::begin(desc.at("lower_levels")), std::end(desc.at("lower_levels")), std::back_inserter(lower_levels),
+                   [&channels](const nlohmann::json& indices) { return channel_pointers(channels, indices); });
+
+    tail = retval.emplace_after(tail, desc.at("name").get<std::string>(), champsim::chrono::picoseconds{desc.at("clock_period").get<std::intmax_t>()},
+                                topology_named(desc.at("topology").get<std::string>()), desc.at("mesh_width").get<std::size_t>(),
+                                desc.at("hop_latency").get<uint64_t>(), desc.at("link_bandwidth").get<champsim::bandwidth::maximum_type>(),
+                                desc.at("buffer_size").get<std::size_t>(), channel_pointers(channels, desc.at("upper_levels")), std::move(lower_levels));
+  }
+  return retval;
+}
+
+std::forward_list<O3_CPU> make_cores(const nlohmann::json& descs, std::vector<champsim::channel>& channels, std::forward_list<CACHE>& caches,
+                                     const champsim::modules::registry& registry)
+{
+  const setter_table<core_builder_type, std::size_t, 12> size_setters{{{"ifetch_buffer_size", &core_builder_type::ifetch_buffer_size},
+                                                                       {"decode_buffer_size", &core_builder_type::decode_buffer_size},
+                                                                       {"dispatch_buffer_size", &core_builder_type::dispatch_buffer_size},
+                                                                       {"dib_hit_buffer_size", &core_builder_type::dib_hit_buffer_size},
+                                                                       {"register_file_size", &core_builder_type::register_file_size},
+                                                                       {"rob_size", &core_builder_type::rob_size},
+                                                                       {"lq_size", &core_builder_type::lq_size},
+                                                                       {"sq_size", &core_builder_type::sq_size},
+                                                                       {"dib_set", &core_builder_type::dib_set},
+                                                                       {"dib_way", &core_builder_type::dib_way},
+                                                                       {"dib_window", &core_builder_type::dib_window},
+                                                                       {"ftq_size", &core_builder_type::ftq_size}}};
+  const setter_table<core_builder_type, champsim::bandwidth::maximum_type, 10> width_setters{{{"fetch_width", &core_builder_type::fetch_width},
+                                                                                              {"decode_width", &core_builder_type::decode_width},
+                                                                                              {"dispatch_width", &core_builder_type::dispatch_width},
+                                                                                              {"schedule_width", &core_builder_type::schedule_width},
+                                                                                              {"execute_width", &core_builder_type::execute_width},
+                                                                                              {"lq_width", &core_builder_type::lq_width},
+                                                                                              {"sq_width", &core_builder_type::sq_width},
+                                                                                              {"retire_width", &core_builder_type::retire_width},
+                                                                                              {"dib_inorder_width", &core_builder_type::dib_inorder_width},
+                                                                                              {"runahead_width", &core_builder_type::runahead_width}}};
+  const setter_table<core_builder_type, unsigned, 6> latency_setters{{{"mispredict_penalty", &core_builder_type::mispredict_penalty},
+                                                                      {"decode_latency", &core_builder_type::decode_latency},
+                                                                      {"dispatch_latency", &core_builder_type::dispatch_latency},
+                                                                      {"schedule_latency", &core_builder_type::schedule_latency},
+                                                                      {"execute_latency", &core_builder_type::execute_latency},
+                                                                      {"dib_hit_latency", &core_builder_type::dib_hit_latency}}};
+
+  auto cache_named = [&caches](const std::string& name) -> CACHE& {
+    auto found = std::find_if(std::begin(caches), std::end(caches), [&name](const CACHE& cache) { return cache.NAME == name; });
+    if (found == std::end(caches)) {
+      throw std::invalid_argument{fmt::format("No cache named '{}' is in the configuration", name)};
+    }
+    return *found;
+  };
+
+  std::forward_list<O3_CPU> retval{};
+  auto tail = retval.before_begin(); // Keep the order of the description
+  for (const nlohmann::json& desc : descs) {
+    auto defaults = champsim::defaults::default_core;
+    auto builder = defaults.branch_predictor<>().btb<>();
+
+    CACHE& l1i = cache_named(desc.at("l1i").get<std::string>());
+    CACHE& l1d = cache_named(desc.at("l1d").get<std::string>());
+    builder.index(desc.at("index").get<uint32_t>())
+        .l1i(&l1i)
+        .l1i_bandwidth(l1i.MAX_TAG)
+        .fetch_queues(&channels.at(desc.at("fetch_queues").get<std::size_t>()))
+        .l1d_bandwidth(l1d.MAX_TAG)
+        .data_queues(&channels.at(desc.at("data_queues").get<std::size_t>()));
+
+    apply_present(builder, desc, size_setters);
+    apply_present(builder, desc, width_setters);
+    apply_present(builder, desc, latency_setters);
+    if_present<std::intmax_t>(desc, "clock_period", [&builder](auto value) { builder.clock_period(champsim::chrono::picoseconds{value}); });
+    if_present<std::size_t>(desc, "threads", [&builder](auto value) { builder.threads(value); });
+    if_present<std::string>(desc, "smt_fetch_policy", [&builder](const auto& name) { builder.smt_fetch(smt_fetch_named(name)); });
+    if_present<std::string>(desc, "smt_partitioning", [&builder](const auto& name) { builder.smt_partition(smt_partitioning_named(name)); });
+    if_present<bool>(desc, "wrong_path", [&builder](bool value) { value ? builder.set_wrong_path() : builder.reset_wrong_path(); });
+    if_present<bool>(desc, "shared_address_space", [&builder](bool value) { value ? builder.set_shared_address_space() : builder.reset_shared_address_space(); });
+    if_present<std::string>(desc, "memory_dependence", [&builder](const auto& name) { builder.memory_dependence(memory_dependence_named(name)); });
+    if_present<std::vector<unsigned>>(desc, "fp_registers", [&builder](const auto& range) { builder.fp_registers(range.at(0), range.at(1)); });
+
+    std::vector<champsim::execution_port> ports;
+    for (const nlohmann::json& port_desc : desc.value("execution_ports", nlohmann::json::array())) {
+      champsim::execution_port port{port_desc.value("name", fmt::format("port{}", std::size(ports))), port_desc.value("count", std::size_t{1}), {},
+                                    port_desc.value("latency", 1u), port_desc.value("pipelined", true)};
+      for (const auto& op : port_desc.at("ops").get<std::vector<std::string>>()) {
+        port.ops.push_back(op_class_named(op));
+      }
+      ports.push_back(std::move(port));
+    }
+    builder.execution_ports(std::move(ports));
+
+    tail = retval.emplace_after(tail, builder, registry.branch_predictor(desc.at("branch_predictor").get<std::vector<std::string>>()),
+                                registry.btb(desc.at("btb").get<std::vector<std::string>>()));
+  }
+  return retval;
+}
+
+template <typename T, typename R = T>
+std::vector<std::reference_wrapper<R>> make_refs(std::forward_list<T>& elements)
+{
+  std::vector<std::reference_wrapper<R>> retval{};
+  std::transform(std::begin(elements), std::end(elements), std::back_inserter(retval), [](auto& x) { return std::ref<R>(x); });
+  return retval;
+}
+} // namespace
+
+champsim::runtime_environment::runtime_environment(const nlohmann::json& description, const modules::registry& registry)
+    : channels(::make_channels(::checked(description).at("channels"))), DRAM(::make_dram(description.at("dram"), channels)),
+      vmem(::make_vmem(description.at("vmem"), DRAM)), ptws(::make_ptws(description.at("ptws"), channels, vmem)),
+      caches(::make_caches(description.at("caches"), channels, registry)),
+      interconnects(::make_interconnects(description.value("interconnects", nlohmann::json::array()), channels)), cores(::make_cores(description.at("cores"), channels, caches, registry))
+{
+}
+
+auto champsim::runtime_environment::cpu_view() -> std::vector<std::reference_wrapper<O3_CPU>> { return ::make_refs(cores); }
+
+auto champsim::runtime_environment::cache_view() -> std::vector<std::reference_wrapper<CACHE>> { return ::make_refs(caches); }
+
+auto champsim::runtime_environment::ptw_view() -> std::vector<std::reference_wrapper<PageTableWalker>> { return ::make_refs(ptws); }
+
+auto champsim::runtime_environment::dram_view() -> MEMORY_CONTROLLER& { return DRAM; }
+
+auto champsim::runtime_environment::operable_view() -> std::vector<std::reference_wrapper<operable>>
+{
+  std::vector<std::reference_wrapper<operable>> retval{};
+  auto append = [&retval](auto&& refs) { std::copy(std::begin(refs), std::end(refs), std::back_inserter(retval)); };
+  append(::make_refs<O3_CPU, operable>(cores));
+  append(::make_refs<CACHE, operable>(caches));
+  append(::make_refs<champsim::interconnect, operable>(interconnects));
+  append(::make_refs<PageTableWalker, operable>(ptws));
+  retval.push_back(std::ref<operable>(DRAM));
+  return retval;
+}
+
+auto champsim::load_runtime_environment(const std::string& filename, const modules::registry& registry) -> std::unique_ptr<runtime_environment>
+{
+  std::ifstream description_file{filename};
+  if (!description_file.is_open()) {
+    throw std::invalid_argument{fmt::format("Could not open the configuration file '{}'", filename)};
+  }
+
+  try {
+    // Several environments may be simulated side by side on separate threads, so each takes its memory from an arena of its own
+    msl::huge_page_arena::scope arena{msl::huge_page_arena::make_persistent()};
+    return std::make_unique<runtime_environment>(nlohmann::json::parse(description_file), registry);
+  } catch (const nlohmann::json::exception& err) {
+    // Malformed files and missing or mistyped keys
+    throw std::invalid_argument{fmt::format("Could not read the configuration file '{}': {}", filename, err.what())};
+  }
+}
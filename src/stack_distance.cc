@@ -0,0 +1,139 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack_distance.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <numeric>
+#include <utility>
+
+uint64_t champsim::stack_distance_histogram::accesses() const { return std::accumulate(std::begin(distances), std::end(distances), beyond + cold); }
+
+uint64_t champsim::stack_distance_histogram::hits(std::size_t ways) const
+{
+  auto end = std::next(std::begin(distances), static_cast<long>(std::min(ways, std::size(distances))));
+  return std::accumulate(std::begin(distances), end, uint64_t{0});
+}
+
+uint64_t champsim::stack_distance_histogram::misses(std::size_t ways) const { return accesses() - hits(ways); }
+
+champsim::stack_distance_histogram champsim::operator-(stack_distance_histogram lhs, const stack_distance_histogram& rhs)
+{
+  assert(lhs.sets == rhs.sets);
+  assert(std::size(lhs.distances) == std::size(rhs.distances));
+  std::transform(std::begin(lhs.distances), std::end(lhs.distances), std::begin(rhs.distances), std::begin(lhs.distances), std::minus<>{});
+  lhs.beyond -= rhs.beyond;
+  lhs.cold -= rhs.cold;
+  return lhs;
+}
+
+void champsim::lru_stack::mark(std::size_t position, long delta)
+{
+  for (auto i = position + 1; i < std::size(tree); i += i & (~i + 1)) {
+    tree[i] += delta;
+  }
+}
+
+long champsim::lru_stack::count_through(std::size_t position) const
+{
+  long count = 0;
+  for (auto i = position + 1; i > 0; i -= i & (~i + 1)) {
+    count += tree[i];
+  }
+  return count;
+}
+
+void champsim::lru_stack::compact()
+{
+  constexpr std::size_t min_capacity = 64;
+
+  // Renumber the live positions densely, preserving their order
+  std::vector<std::pair<std::size_t, uint64_t>> live{};
+  live.reserve(std::size(last_position));
+  std::transform(std::begin(last_position), std::end(last_position), std::back_inserter(live), [](const auto& entry) { return std::pair{entry.second, entry.first}; });
+  std::sort(std::begin(live), std::end(live));
+
+  const auto capacity = std::max(2 * std::size(live), min_capacity);
+  tree.assign(capacity + 1, 0);
+  for (std::size_t i = 0; i < std::size(live); ++i) {
+    last_position[live[i].second] = i;
+    tree[i + 1] = 1;
+  }
+
+  // Build the tree in linear time
+  for (std::size_t i = 1; i < std::size(tree); ++i) {
+    if (auto parent = i + (i & (~i + 1)); parent < std::size(tree)) {
+      tree[parent] += tree[i];
+    }
+  }
+
+  next_position = std::size(live);
+}
+
+std::optional<std::size_t> champsim::lru_stack::access(uint64_t block)
+{
+  if (next_position + 1 >= std::size(tree)) {
+    compact();
+  }
+
+  std::optional<std::size_t> distance{};
+  if (auto found = last_position.find(block); found != std::end(last_position)) {
+    auto newer = static_cast<long>(std::size(last_position)) - count_through(found->second);
+    distance = static_cast<std::size_t>(newer);
+    mark(found->second, -1);
+  }
+
+  mark(next_position, 1);
+  last_position[block] = next_position++;
+  return distance;
+}
+
+std::size_t champsim::lru_stack::size() const { return std::size(last_position); }
+
+champsim::stack_distance_profiler::stack_distance_profiler(const std::vector<uint64_t>& set_counts, std::size_t max_ways_) : max_ways(max_ways_)
+{
+  std::transform(std::begin(set_counts), std::end(set_counts), std::back_inserter(geometries), [](auto sets) {
+    assert(sets > 0 && (sets & (sets - 1)) == 0);
+    return geometry{sets, std::vector<lru_stack>(sets)};
+  });
+}
+
+auto champsim::stack_distance_profiler::empty_histograms() const -> std::vector<stack_distance_histogram>
+{
+  std::vector<stack_distance_histogram> retval{};
+  std::transform(std::begin(geometries), std::end(geometries), std::back_inserter(retval),
+                 [ways = max_ways](const auto& geom) { return stack_distance_histogram{geom.sets, std::vector<uint64_t>(ways), 0, 0}; });
+  return retval;
+}
+
+void champsim::stack_distance_profiler::access(uint64_t block, std::vector<stack_distance_histogram>& histograms)
+{
+  assert(std::size(histograms) == std::size(geometries));
+  auto hist = std::begin(histograms);
+  for (auto& geom : geometries) {
+    auto distance = geom.stacks.at(block & (geom.sets - 1)).access(block);
+    if (!distance.has_value()) {
+      ++hist->cold;
+    } else if (distance.value() < std::size(hist->distances)) {
+      ++hist->distances.at(distance.value());
+    } else {
+      ++hist->beyond;
+    }
+    ++hist;
+  }
+}
@@ -0,0 +1,102 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "store_sets.h"
+
+#include <algorithm>
+#include <cassert>
+
+champsim::store_set_predictor::store_set_predictor(std::size_t ssit_size, std::size_t lfst_size, uint64_t clear_interval_)
+    : ssit(ssit_size, no_set), lfst(lfst_size), clear_interval(clear_interval_)
+{
+  assert(ssit_size > 0);
+  assert(lfst_size > 0);
+}
+
+std::size_t champsim::store_set_predictor::index(champsim::address ip) const
+{
+  // Fold the upper bits of the address onto the lower bits, since instructions are not aligned
+  auto folded = ip.to<uint64_t>();
+  folded ^= folded >> 32;
+  folded ^= folded >> 16;
+  return static_cast<std::size_t>(folded % std::size(ssit));
+}
+
+void champsim::store_set_predictor::count_access()
+{
+  if (clear_interval > 0 && ++accesses >= clear_interval) {
+    std::fill(std::begin(ssit), std::end(ssit), no_set);
+    accesses = 0;
+  }
+}
+
+std::optional<std::size_t> champsim::store_set_predictor::set_of(champsim::address ip) const
+{
+  auto ssid = ssit.at(index(ip));
+  if (ssid == no_set) {
+    return std::nullopt;
+  }
+  return ssid;
+}
+
+auto champsim::store_set_predictor::dispatch_load(champsim::address ip) -> std::optional<id_type>
+{
+  count_access();
+  auto ssid = set_of(ip);
+  if (!ssid.has_value()) {
+    return std::nullopt;
+  }
+  return lfst.at(*ssid);
+}
+
+void champsim::store_set_predictor::dispatch_store(champsim::address ip, id_type instr_id)
+{
+  count_access();
+  auto ssid = set_of(ip);
+  if (ssid.has_value()) {
+    lfst.at(*ssid) = instr_id;
+  }
+}
+
+void champsim::store_set_predictor::execute_store(champsim::address ip, id_type instr_id)
+{
+  // A younger store of the same set may have replaced this one already
+  auto ssid = set_of(ip);
+  if (ssid.has_value() && lfst.at(*ssid) == instr_id) {
+    lfst.at(*ssid).reset();
+  }
+}
+
+void champsim::store_set_predictor::violation(champsim::address load_ip, champsim::address store_ip)
+{
+  auto& load_set = ssit.at(index(load_ip));
+  auto& store_set = ssit.at(index(store_ip));
+
+  if (load_set == no_set && store_set == no_set) {
+    // Allocate a new set, named for the store
+    load_set = index(store_ip) % std::size(lfst);
+    store_set = load_set;
+  } else if (load_set == no_set) {
+    load_set = store_set;
+  } else if (store_set == no_set) {
+    store_set = load_set;
+  } else {
+    // Merge the sets, so that they converge on the smaller identifier
+    load_set = std::min(load_set, store_set);
+    store_set = load_set;
+  }
+}
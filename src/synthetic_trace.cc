@@ -0,0 +1,297 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "synthetic_trace.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <fmt/core.h>
+
+#include "trace_instruction.h"
+
+namespace
+{
+constexpr uint64_t block_size = 64;
+constexpr std::size_t body_size = 16;
+constexpr std::size_t mix_body_size = 64;
+
+// The loaded value, and the registers that arithmetic writes
+constexpr unsigned char load_register = 1;
+constexpr std::array<unsigned char, 4> alu_registers{{2, 3, 4, 5}};
+
+constexpr std::array<std::pair<std::string_view, champsim::synthetic::pattern>, 6> pattern_names{
+    {{"stream", champsim::synthetic::pattern::stream},
+     {"stride", champsim::synthetic::pattern::stride},
+     {"pointer_chase", champsim::synthetic::pattern::pointer_chase},
+     {"gups", champsim::synthetic::pattern::gups},
+     {"branchy", champsim::synthetic::pattern::branchy},
+     {"mix", champsim::synthetic::pattern::mix}}};
+
+uint64_t parse_size(std::string_view key, std::string_view value)
+{
+  std::size_t consumed = 0;
+  uint64_t retval = 0;
+  try {
+    retval = std::stoull(std::string{value}, &consumed);
+  } catch (const std::logic_error&) {
+    throw std::invalid_argument{fmt::format("The value of '{}' is not a number: '{}'", key, value)};
+  }
+
+  auto suffix = value.substr(consumed);
+  if (suffix == "k" || suffix == "K") {
+    return retval << 10;
+  }
+  if (suffix == "M") {
+    return retval << 20;
+  }
+  if (suffix == "G") {
+    return retval << 30;
+  }
+  if (!suffix.empty()) {
+    throw std::invalid_argument{fmt::format("Unknown size suffix '{}' for '{}'", suffix, key)};
+  }
+  return retval;
+}
+
+double parse_fraction(std::string_view key, std::string_view value)
+{
+  double retval = 0;
+  try {
+    retval = std::stod(std::string{value});
+  } catch (const std::logic_error&) {
+    throw std::invalid_argument{fmt::format("The value of '{}' is not a number: '{}'", key, value)};
+  }
+  if (retval < 0 || retval > 1) {
+    throw std::invalid_argument{fmt::format("The value of '{}' must be between 0 and 1, but is {}", key, retval)};
+  }
+  return retval;
+}
+
+std::vector<champsim::synthetic::generator::slot_kind> make_program(const champsim::synthetic::parameters& params, std::mt19937_64& rng)
+{
+  using slot_kind = champsim::synthetic::generator::slot_kind;
+  std::vector<slot_kind> retval;
+  switch (params.kind) {
+  case champsim::synthetic::pattern::stream:
+  case champsim::synthetic::pattern::stride:
+    // Loads alternate with the arithmetic that consumes them
+    for (std::size_t i = 0; i + 1 < body_size; ++i) {
+      retval.push_back((i % 2 == 0) ? slot_kind::load : slot_kind::alu);
+    }
+    break;
+  case champsim::synthetic::pattern::pointer_chase:
+    retval = {slot_kind::load, slot_kind::alu};
+    break;
+  case champsim::synthetic::pattern::gups:
+    retval = {slot_kind::load, slot_kind::alu, slot_kind::store};
+    break;
+  case champsim::synthetic::pattern::branchy:
+    // Each conditional branch skips the arithmetic that follows it if taken
+    for (std::size_t i = 0; i + 1 < body_size; ++i) {
+      retval.push_back((i % 2 == 1) ? slot_kind::branch : slot_kind::alu);
+    }
+    break;
+  case champsim::synthetic::pattern::mix:
+    std::uniform_real_distribution<double> dist{0, 1};
+    std::generate_n(std::back_inserter(retval), mix_body_size - 1, [&] {
+      auto draw = dist(rng);
+      if (draw < params.loads) {
+        return slot_kind::load;
+      }
+      if (draw < params.loads + params.stores) {
+        return slot_kind::store;
+      }
+      if (draw < params.loads + params.stores + params.branches) {
+        return slot_kind::branch;
+      }
+      return slot_kind::alu;
+    });
+    break;
+  }
+  retval.push_back(slot_kind::loop);
+  return retval;
+}
+} // namespace
+
+bool champsim::synthetic::is_synthetic(std::string_view name) { return name.substr(0, std::size(prefix)) == prefix; }
+
+auto champsim::synthetic::parse(std::string_view name) -> parameters
+{
+  if (!is_synthetic(name)) {
+    throw std::invalid_argument{fmt::format("'{}' does not name a synthetic workload", name)};
+  }
+  name.remove_prefix(std::size(prefix));
+
+  std::vector<std::string_view> fields;
+  for (auto comma = name.find(','); comma != std::string_view::npos; comma = name.find(',')) {
+    fields.push_back(name.substr(0, comma));
+    name.remove_prefix(comma + 1);
+  }
+  fields.push_back(name);
+
+  parameters retval{};
+  auto kind = std::find_if(std::begin(pattern_names), std::end(pattern_names), [&](const auto& entry) { return entry.first == fields.front(); });
+  if (kind == std::end(pattern_names)) {
+    throw std::invalid_argument{fmt::format("Unknown synthetic pattern '{}'", fields.front())};
+  }
+  retval.kind = kind->second;
+
+  for (auto field = std::next(std::begin(fields)); field != std::end(fields); ++field) {
+    auto equals = field->find('=');
+    if (equals == std::string_view::npos) {
+      throw std::invalid_argument{fmt::format("Expected a parameter of the form key=value, but got '{}'", *field)};
+    }
+    auto key = field->substr(0, equals);
+    auto value = field->substr(equals + 1);
+
+    if (key == "footprint") {
+      retval.footprint = parse_size(key, value);
+    } else if (key == "stride") {
+      retval.stride = parse_size(key, value);
+    } else if (key == "length") {
+      retval.length = parse_size(key, value);
+    } else if (key == "seed") {
+      retval.seed = parse_size(key, value);
+    } else if (key == "mispredict") {
+      retval.mispredict = parse_fraction(key, value);
+    } else if (key == "loads") {
+      retval.loads = parse_fraction(key, value);
+    } else if (key == "stores") {
+      retval.stores = parse_fraction(key, value);
+    } else if (key == "branches") {
+      retval.branches = parse_fraction(key, value);
+    } else {
+      throw std::invalid_argument{fmt::format("Unknown synthetic workload parameter '{}'", key)};
+    }
+  }
+
+  if (retval.footprint < block_size) {
+    throw std::invalid_argument{fmt::format("The footprint must be at least {} bytes", block_size)};
+  }
+  if (retval.loads + retval.stores + retval.branches > 1) {
+    throw std::invalid_argument{"The fractions of loads, stores, and branches must not sum to more than 1"};
+  }
+  return retval;
+}
+
+champsim::synthetic::generator::generator(uint8_t cpu_idx, parameters params_) : cpu(cpu_idx), params(params_), rng(params.seed)
+{
+  // A stream reads every word, and a stride skips several blocks
+  if (params.stride == 0) {
+    params.stride = (params.kind == pattern::stride) ? 4 * block_size : sizeof(uint64_t);
+  }
+  program = make_program(params, rng);
+
+  if (params.kind == pattern::pointer_chase) {
+    // Sattolo's algorithm gives a random permutation that is a single cycle, so that the chase visits every block before it repeats
+    chase_next.resize(std::max<uint64_t>(params.footprint / block_size, 1));
+    std::iota(std::begin(chase_next), std::end(chase_next), uint64_t{0});
+    for (auto i = std::size(chase_next) - 1; i > 0; --i) {
+      std::uniform_int_distribution<std::size_t> dist{0, i - 1};
+      std::swap(chase_next.at(i), chase_next.at(dist(rng)));
+    }
+  }
+}
+
+uint64_t champsim::synthetic::generator::address_for(slot_kind kind)
+{
+  switch (params.kind) {
+  case pattern::stream:
+  case pattern::stride: {
+    auto retval = next_address;
+    next_address = (next_address + params.stride) % params.footprint;
+    return retval;
+  }
+  case pattern::pointer_chase: {
+    auto retval = next_address * block_size;
+    next_address = chase_next.at(next_address);
+    return retval;
+  }
+  case pattern::gups:
+    // The store updates the word that was just loaded
+    if (kind == slot_kind::load) {
+      std::uniform_int_distribution<uint64_t> dist{0, params.footprint / sizeof(uint64_t) - 1};
+      next_address = dist(rng) * sizeof(uint64_t);
+    }
+    return next_address;
+  case pattern::branchy:
+  case pattern::mix:
+    break;
+  }
+  std::uniform_int_distribution<uint64_t> dist{0, params.footprint / sizeof(uint64_t) - 1};
+  return dist(rng) * sizeof(uint64_t);
+}
+
+ooo_model_instr champsim::synthetic::generator::operator()()
+{
+  auto kind = program.at(pc);
+  input_instr instr{};
+  instr.ip = code_base + pc * 4;
+
+  auto next_pc = (pc + 1) % std::size(program);
+  auto alu_register = alu_registers.at(pc % std::size(alu_registers));
+  switch (kind) {
+  case slot_kind::alu:
+    instr.source_registers[0] = load_register;
+    instr.destination_registers[0] = alu_register;
+    break;
+  case slot_kind::load:
+    // Each load of a pointer chase depends on the one before it
+    if (params.kind == pattern::pointer_chase) {
+      instr.source_registers[0] = load_register;
+    }
+    instr.destination_registers[0] = load_register;
+    instr.source_memory[0] = data_base + address_for(kind);
+    break;
+  case slot_kind::store:
+    instr.source_registers[0] = (params.kind == pattern::gups) ? alu_registers.at((pc - 1) % std::size(alu_registers)) : load_register;
+    instr.destination_memory[0] = data_base + address_for(kind);
+    break;
+  case slot_kind::branch: {
+    // Branches are biased to be taken, and go against their bias at the given rate
+    std::bernoulli_distribution against_bias{params.mispredict};
+    instr.is_branch = 1;
+    instr.branch_taken = against_bias(rng) ? 0 : 1;
+    instr.source_registers[0] = champsim::REG_FLAGS;
+    instr.source_registers[1] = champsim::REG_INSTRUCTION_POINTER;
+    instr.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
+    if (instr.branch_taken) {
+      next_pc = (pc + 2) % std::size(program);
+    }
+    break;
+  }
+  case slot_kind::loop:
+    instr.is_branch = 1;
+    instr.branch_taken = 1;
+    instr.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
+    break;
+  }
+
+  ooo_model_instr retval{cpu, instr};
+  if (retval.branch_taken) {
+    retval.branch_target = champsim::address{code_base + next_pc * 4};
+  }
+
+  pc = next_pc;
+  ++emitted;
+  return retval;
+}
+
+bool champsim::synthetic::generator::eof() const { return params.length != 0 && emitted >= params.length; }
@@ -0,0 +1,257 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "trace_broadcast.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+template <typename State>
+void produce(std::shared_ptr<State> state, champsim::tracereader source, std::size_t batch_size)
+{
+  bool source_eof = false;
+  while (!source_eof) {
+    // Decode outside of the lock, so that the subscribers may continue to consume
+    champsim::trace_broadcaster::batch_type batch;
+    batch.reserve(batch_size);
+    while (std::size(batch) < batch_size && !source.eof()) {
+      batch.push_back(source.next_unnumbered());
+    }
+    source_eof = source.eof();
+
+    std::unique_lock lock{state->mtx};
+    state->consumed.wait(lock, [&state] { return state->stopping || std::size(state->batches) < state->capacity; });
+    if (state->stopping) {
+      return;
+    }
+
+    if (!std::empty(batch)) {
+      state->batches.push_back(std::make_shared<const champsim::trace_broadcaster::batch_type>(std::move(batch)));
+    }
+    state->source_eof = source_eof;
+    lock.unlock();
+    state->produced.notify_all();
+  }
+}
+} // namespace
+
+void champsim::trace_broadcaster::shared_state::release_consumed()
+{
+  // Until the first subscriber arrives, hold everything
+  if (std::empty(cursors)) {
+    return;
+  }
+
+  auto oldest = *std::min_element(std::begin(cursors), std::end(cursors));
+
+  // Every subscriber has gone away, so there is no need to continue decoding
+  if (oldest >= evicted) {
+    stopping = true;
+    return;
+  }
+
+  while (!std::empty(batches) && first_batch < oldest) {
+    first_instr += std::size(*batches.front());
+    batches.pop_front();
+    ++first_batch;
+  }
+}
+
+void champsim::trace_broadcaster::shared_state::evict_oldest()
+{
+  auto oldest = *std::min_element(std::begin(cursors), std::end(cursors));
+  evictions += static_cast<std::size_t>(std::count(std::begin(cursors), std::end(cursors), oldest));
+  std::replace(std::begin(cursors), std::end(cursors), oldest, evicted);
+  release_consumed();
+}
+
+champsim::trace_broadcaster::trace_broadcaster(tracereader&& source, std::size_t batch_size, std::size_t capacity)
+    : state(std::make_shared<shared_state>(std::max<std::size_t>(capacity, 1), std::max<std::size_t>(capacity, 1), nullptr)),
+      producer(::produce<shared_state>, state, std::move(source), std::max<std::size_t>(batch_size, 1))
+{
+}
+
+champsim::trace_broadcaster::trace_broadcaster(std::function<tracereader()> open, std::size_t batch_size, std::size_t capacity, std::size_t pinned_capacity)
+    : state(std::make_shared<shared_state>(std::max<std::size_t>(capacity, 1), std::max({pinned_capacity, capacity, std::size_t{1}}), open)),
+      producer(::produce<shared_state>, state, open(), std::max<std::size_t>(batch_size, 1))
+{
+}
+
+champsim::trace_broadcaster::~trace_broadcaster() { stop(); }
+
+auto champsim::trace_broadcaster::operator=(trace_broadcaster&& other) noexcept -> trace_broadcaster&
+{
+  if (this != &other) {
+    // A running thread cannot be assigned over, so this broadcaster's producer must finish first
+    stop();
+    state = std::move(other.state);
+    producer = std::move(other.producer);
+  }
+  return *this;
+}
+
+void champsim::trace_broadcaster::stop()
+{
+  if (state != nullptr) {
+    {
+      std::lock_guard lock{state->mtx};
+      state->stopping = true;
+    }
+    state->consumed.notify_all();
+    state->produced.notify_all();
+  }
+
+  if (producer.joinable()) {
+    producer.join();
+  }
+}
+
+auto champsim::trace_broadcaster::subscribe(uint64_t offset) -> subscriber
+{
+  std::lock_guard lock{state->mtx};
+  state->cursors.push_back(state->first_batch);
+  return subscriber{state, std::size(state->cursors) - 1, offset};
+}
+
+std::size_t champsim::trace_broadcaster::evictions() const
+{
+  std::lock_guard lock{state->mtx};
+  return state->evictions;
+}
+
+champsim::trace_broadcaster::subscriber::subscriber(std::shared_ptr<shared_state> state_, std::size_t id_, uint64_t offset)
+    : state(std::move(state_)), id(id_), to_skip(offset), taken(state->first_instr)
+{
+}
+
+champsim::trace_broadcaster::subscriber::subscriber(subscriber&& other) noexcept
+    : state(std::move(other.state)), id(other.id), current(std::move(other.current)), position(other.position), to_skip(other.to_skip), taken(other.taken),
+      private_source(std::move(other.private_source))
+{
+}
+
+auto champsim::trace_broadcaster::subscriber::operator=(subscriber&& other) noexcept -> subscriber&
+{
+  std::swap(state, other.state);
+  std::swap(id, other.id);
+  std::swap(current, other.current);
+  std::swap(position, other.position);
+  std::swap(to_skip, other.to_skip);
+  std::swap(taken, other.taken);
+  std::swap(private_source, other.private_source);
+  return *this;
+}
+
+champsim::trace_broadcaster::subscriber::~subscriber()
+{
+  if (state != nullptr) {
+    {
+      std::lock_guard lock{state->mtx};
+      state->cursors.at(id) = detached;
+      state->release_consumed();
+    }
+    state->consumed.notify_all();
+  }
+}
+
+bool champsim::trace_broadcaster::subscriber::fetch() const
+{
+  while (!private_source.has_value()) {
+    if (current != nullptr && position < std::size(*current)) {
+      if (to_skip == 0) {
+        return true;
+      }
+      auto skipped = std::min<uint64_t>(to_skip, std::size(*current) - position);
+      position += skipped;
+      to_skip -= skipped;
+      continue;
+    }
+
+    std::unique_lock lock{state->mtx};
+    auto& cursor = state->cursors.at(id);
+    auto available = [&] { return cursor < state->first_batch + std::size(state->batches); };
+    auto full = [&] { return state->reopen && std::size(state->batches) >= state->capacity; };
+    state->produced.wait(lock, [&] { return available() || cursor == evicted || state->source_eof || state->stopping || full(); });
+
+    if (cursor == evicted) {
+      // Continue alone, from the first instruction not yet taken
+      lock.unlock();
+      current.reset();
+      private_source = state->reopen();
+      to_skip += taken;
+      break;
+    }
+
+    if (!available() && !state->source_eof && !state->stopping) {
+      if (state->capacity < state->pinned_capacity) {
+        // The subscribers furthest behind may run on this thread, so rather than wait for them, keep their batches for them
+        state->capacity = std::min(2 * state->capacity, state->pinned_capacity);
+      } else {
+        // Rather than hold any more, leave the subscribers furthest behind to decode on their own
+        state->evict_oldest();
+      }
+      lock.unlock();
+      state->consumed.notify_all();
+      continue;
+    }
+
+    if (!available()) {
+      current.reset();
+      return false;
+    }
+
+    current = state->batches.at(cursor - state->first_batch);
+    position = 0;
+    taken += std::size(*current);
+    ++cursor;
+    state->release_consumed();
+    lock.unlock();
+    state->consumed.notify_all();
+  }
+
+  return fetch_private();
+}
+
+bool champsim::trace_broadcaster::subscriber::fetch_private() const
+{
+  for (; to_skip > 0 && !private_source->eof(); --to_skip) {
+    (void)private_source->next_unnumbered();
+  }
+  return !private_source->eof();
+}
+
+ooo_model_instr champsim::trace_broadcaster::subscriber::operator()()
+{
+  if (!fetch()) {
+    throw std::out_of_range{"Read past the end of a broadcast trace"};
+  }
+  if (private_source.has_value()) {
+    return private_source->next_unnumbered();
+  }
+  return current->at(position++);
+}
+
+bool champsim::trace_broadcaster::subscriber::eof() const { return !fetch(); }
+
+std::vector<champsim::tracereader> champsim::subscribe(std::vector<trace_broadcaster>& sources, const std::vector<trace_subscription>& plan)
+{
+  std::vector<tracereader> retval;
+  std::transform(std::begin(plan), std::end(plan), std::back_inserter(retval),
+                 [&sources](const trace_subscription& sub) { return tracereader{sources.at(sub.source).subscribe(sub.offset)}; });
+  return retval;
+}
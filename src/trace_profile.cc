@@ -0,0 +1,263 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "trace_profile.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+#include <thread>
+
+#include "trace_broadcast.h"
+#include "util/bits.h" // for lg2
+
+namespace
+{
+// The finalizer of SplitMix64, which spreads the block numbers evenly over the hash space
+uint64_t mix(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+
+template <typename F>
+void for_each_data_address(const ooo_model_instr& instr, F&& func)
+{
+  for (auto addr : instr.source_memory) {
+    func(addr.to<uint64_t>());
+  }
+  for (auto addr : instr.destination_memory) {
+    func(addr.to<uint64_t>());
+  }
+}
+
+// Consume a reader on the calling thread, up to the given number of instructions
+template <typename F>
+void drain(champsim::tracereader& reader, uint64_t max_instructions, F&& func)
+{
+  for (uint64_t i = 0; (max_instructions == 0 || i < max_instructions) && !reader.eof(); ++i) {
+    func(reader());
+  }
+}
+} // namespace
+
+void champsim::trace_profile::reuse_histogram::add(std::optional<std::size_t> distance, uint64_t weight)
+{
+  if (!distance.has_value()) {
+    cold += weight;
+    return;
+  }
+
+  std::size_t bucket = distance.value() == 0 ? 0 : champsim::lg2(distance.value()) + 1;
+  if (std::size(buckets) <= bucket) {
+    buckets.resize(bucket + 1);
+  }
+  buckets.at(bucket) += weight;
+}
+
+uint64_t champsim::trace_profile::reuse_histogram::accesses() const { return std::accumulate(std::begin(buckets), std::end(buckets), cold); }
+
+uint64_t champsim::trace_profile::reuse_histogram::hits(std::size_t blocks) const
+{
+  // Bucket k holds distances less than 2^k, which hit in a cache of at least 2^k blocks
+  uint64_t retval = 0;
+  for (std::size_t k = 0; k < std::size(buckets) && (std::size_t{1} << k) <= blocks; ++k) {
+    retval += buckets.at(k);
+  }
+  return retval;
+}
+
+champsim::trace_profile::reuse_profiler::reuse_profiler(uint64_t granularity, double sample_rate)
+    : shift(static_cast<unsigned>(champsim::lg2(granularity))),
+      threshold(static_cast<uint64_t>(std::clamp(sample_rate, 0.0, 1.0) * static_cast<double>(hash_modulus))),
+      weight(threshold > 0 ? hash_modulus / threshold : 0)
+{
+  assert(granularity > 0 && (granularity & (granularity - 1)) == 0);
+}
+
+void champsim::trace_profile::reuse_profiler::access(uint64_t address)
+{
+  auto block = address >> shift;
+  if (threshold < hash_modulus && (::mix(block) % hash_modulus) >= threshold) {
+    return;
+  }
+
+  // Among the sampled blocks, a distance of d stands for a distance of d / rate among all blocks
+  auto distance = stack.access(block);
+  if (distance.has_value()) {
+    distance = distance.value() * weight;
+  }
+  histogram.add(distance, weight);
+}
+
+champsim::trace_profile::footprint_profiler::footprint_profiler(uint64_t interval_, uint64_t block_size, uint64_t page_size)
+    : interval(std::max<uint64_t>(interval_, 1)), block_shift(static_cast<unsigned>(champsim::lg2(block_size))),
+      page_shift(static_cast<unsigned>(champsim::lg2(page_size)))
+{
+}
+
+void champsim::trace_profile::footprint_profiler::sample()
+{
+  samples.push_back({instructions, std::size(code_blocks), std::size(data_blocks), std::size(data_pages), std::size(interval_blocks)});
+  interval_blocks.clear();
+}
+
+void champsim::trace_profile::footprint_profiler::operator()(const ooo_model_instr& instr)
+{
+  code_blocks.insert(instr.ip.to<uint64_t>() >> block_shift);
+  ::for_each_data_address(instr, [this](uint64_t addr) {
+    data_blocks.insert(addr >> block_shift);
+    data_pages.insert(addr >> page_shift);
+    interval_blocks.insert(addr >> block_shift);
+  });
+
+  if (++instructions % interval == 0) {
+    sample();
+  }
+}
+
+void champsim::trace_profile::footprint_profiler::finish()
+{
+  if (instructions % interval != 0 || std::empty(samples)) {
+    sample();
+  }
+}
+
+void champsim::trace_profile::stride_profiler::operator()(const ooo_model_instr& instr)
+{
+  if (std::empty(instr.source_memory) && std::empty(instr.destination_memory)) {
+    return;
+  }
+
+  // Follow the first operand of each instruction, since instructions with several operands usually access adjacent words
+  auto address = std::empty(instr.source_memory) ? instr.destination_memory.front() : instr.source_memory.front();
+  auto [found, inserted] = by_ip.try_emplace(instr.ip.to<uint64_t>());
+  auto& hist = found->second;
+  if (inserted) {
+    hist.strides.ip = instr.ip.to<uint64_t>();
+  } else {
+    auto stride = static_cast<int64_t>(address.to<uint64_t>() - hist.last_address);
+    ++hist.strides.strides[stride];
+    ++overall[stride];
+  }
+  ++hist.strides.accesses;
+  hist.last_address = address.to<uint64_t>();
+}
+
+auto champsim::trace_profile::stride_profiler::top(std::size_t num_ips, std::size_t num_strides) const -> std::vector<ip_strides>
+{
+  std::vector<ip_strides> retval{};
+  std::transform(std::begin(by_ip), std::end(by_ip), std::back_inserter(retval), [](const auto& entry) { return entry.second.strides; });
+
+  auto by_accesses = [](const ip_strides& lhs, const ip_strides& rhs) { return std::tie(rhs.accesses, lhs.ip) < std::tie(lhs.accesses, rhs.ip); };
+  auto middle = std::next(std::begin(retval), static_cast<long>(std::min(num_ips, std::size(retval))));
+  std::partial_sort(std::begin(retval), middle, std::end(retval), by_accesses);
+  retval.erase(middle, std::end(retval));
+
+  // Keep only the most common strides of each instruction
+  for (auto& entry : retval) {
+    std::vector<std::pair<int64_t, uint64_t>> strides{std::begin(entry.strides), std::end(entry.strides)};
+    std::sort(std::begin(strides), std::end(strides), [](const auto& lhs, const auto& rhs) { return lhs.second > rhs.second; });
+    strides.resize(std::min(num_strides, std::size(strides)));
+    entry.strides = {std::begin(strides), std::end(strides)};
+  }
+  return retval;
+}
+
+void champsim::trace_profile::branch_profiler::operator()(const ooo_model_instr& instr)
+{
+  if (!instr.is_branch || instr.branch == NOT_BRANCH) {
+    return;
+  }
+
+  ++stats.count.at(instr.branch);
+  if (instr.branch_taken) {
+    ++stats.taken.at(instr.branch);
+  }
+
+  if (instr.branch == BRANCH_CONDITIONAL) {
+    auto& direction = by_ip[instr.ip.to<uint64_t>()];
+    ++(instr.branch_taken ? direction.taken : direction.not_taken);
+  } else {
+    by_ip.try_emplace(instr.ip.to<uint64_t>());
+  }
+}
+
+auto champsim::trace_profile::branch_profiler::result() const -> branch_stats
+{
+  auto retval = stats;
+  retval.static_branches = std::size(by_ip);
+  for (const auto& [ip, direction] : by_ip) {
+    auto total = direction.taken + direction.not_taken;
+    if (100 * std::max(direction.taken, direction.not_taken) >= 99 * total) {
+      retval.biased_conditional += total;
+    }
+  }
+  return retval;
+}
+
+auto champsim::trace_profile::run(tracereader&& source, const options& opts) -> profile
+{
+  profile retval{};
+  trace_broadcaster broadcast{std::move(source)};
+  tracereader block_reader{broadcast.subscribe()};
+  tracereader page_reader{broadcast.subscribe()};
+  tracereader other_reader{broadcast.subscribe()};
+
+  std::thread block_thread{[&] {
+    reuse_profiler blocks{opts.block_size, opts.sample_rate};
+    ::drain(block_reader, opts.max_instructions, [&](const ooo_model_instr& instr) {
+      ::for_each_data_address(instr, [&](uint64_t addr) { blocks.access(addr); });
+    });
+    retval.block_reuse = std::move(blocks.histogram);
+  }};
+
+  std::thread page_thread{[&] {
+    reuse_profiler pages{opts.page_size, opts.sample_rate};
+    footprint_profiler footprint{opts.footprint_interval, opts.block_size, opts.page_size};
+    ::drain(page_reader, opts.max_instructions, [&](const ooo_model_instr& instr) {
+      ::for_each_data_address(instr, [&](uint64_t addr) { pages.access(addr); });
+      footprint(instr);
+    });
+    footprint.finish();
+    retval.page_reuse = std::move(pages.histogram);
+    retval.footprint = std::move(footprint.samples);
+  }};
+
+  // The strides and branches are found on this thread
+  stride_profiler strides{};
+  branch_profiler branches{};
+  ::drain(other_reader, opts.max_instructions, [&](const ooo_model_instr& instr) {
+    ++retval.instructions;
+    retval.loads += std::size(instr.source_memory);
+    retval.stores += std::size(instr.destination_memory);
+    strides(instr);
+    branches(instr);
+  });
+  retval.strides = std::move(strides.overall);
+  retval.strides_by_ip = strides.top(opts.top_ips, opts.top_strides);
+  retval.branches = branches.result();
+
+  block_thread.join();
+  page_thread.join();
+  return retval;
+}
@@ -16,15 +16,19 @@
 
 #include "tracereader.h"
 
+#include <algorithm>
 #include <fstream>
+#include <limits>
 #include <string>
 
 #include "inf_stream.h"
 #include "repeatable.h"
+#include "synthetic_trace.h"
+#include "zstd_seekable.h"
 
 namespace champsim
 {
-uint64_t tracereader::instr_unique_id = 0; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+thread_local uint64_t tracereader::instr_unique_id = 0; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 
 ooo_model_instr apply_branch_target(ooo_model_instr branch, const ooo_model_instr& target)
 {
@@ -40,13 +44,21 @@ champsim::tracereader get_tracereader_for_type(std::string fname, uint8_t cpu)
   }
 
   if (bool is_lzma_compressed = (fname.substr(std::size(fname) - 2) == "xz"); is_lzma_compressed) {
-    return champsim::tracereader{R<T, champsim::inf_istream<champsim::decomp_tags::lzma_tag_t<>>>(cpu, fname)};
+    return champsim::tracereader{R<T, champsim::inf_istream<champsim::decomp_tags::lzma_mt_tag_t<>>>(cpu, fname)};
   }
 
   if (bool is_bzip2_compressed = (fname.substr(std::size(fname) - 3) == "bz2"); is_bzip2_compressed) {
     return champsim::tracereader{R<T, champsim::inf_istream<champsim::decomp_tags::bzip2_tag_t>>(cpu, fname)};
   }
 
+  if (bool is_zstd_compressed = (fname.substr(std::size(fname) - 3) == "zst"); is_zstd_compressed) {
+    // Seekable streams of several frames are decoded a frame per thread
+    if (champsim::zstd_seekable::is_multiframe(fname)) {
+      return champsim::tracereader{R<T, champsim::zstd_seekable::parallel_istream>(cpu, fname)};
+    }
+    return champsim::tracereader{R<T, champsim::inf_istream<champsim::decomp_tags::zstd_tag_t<>>>(cpu, fname)};
+  }
+
   return champsim::tracereader{R<T, std::ifstream>(cpu, fname)};
 }
 } // namespace champsim
@@ -56,6 +68,11 @@ using repeatable_reader_t = champsim::repeatable<champsim::bulk_tracereader<T, S
 
 champsim::tracereader get_tracereader(const std::string& fname, uint8_t cpu, bool is_cloudsuite, bool repeat)
 {
+  // Synthetic workloads are named in place of a trace, and run until their given length or forever
+  if (champsim::synthetic::is_synthetic(fname)) {
+    return champsim::tracereader{champsim::synthetic::generator{cpu, champsim::synthetic::parse(fname)}};
+  }
+
   if (is_cloudsuite && repeat) {
     return champsim::get_tracereader_for_type<repeatable_reader_t, cloudsuite_instr>(fname, cpu);
   }
@@ -70,3 +87,9 @@ champsim::tracereader get_tracereader(const std::string& fname, uint8_t cpu, boo
 
   return champsim::get_tracereader_for_type<champsim::bulk_tracereader, input_instr>(fname, cpu);
 }
+
+void set_decoder_threads(std::size_t threads)
+{
+  champsim::decomp_tags::lzma_mt_tag_t<>::threads = static_cast<uint32_t>(std::clamp<std::size_t>(threads, 1, std::numeric_limits<uint32_t>::max()));
+  champsim::zstd_seekable::parallel_istream::default_threads = std::max<std::size_t>(threads, 1);
+}
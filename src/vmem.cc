@@ -26,8 +26,8 @@
 using namespace champsim::data::data_literals;
 
 VirtualMemory::VirtualMemory(champsim::data::bytes page_table_page_size, std::size_t page_table_levels, champsim::chrono::clock::duration minor_penalty,
-                             MEMORY_CONTROLLER& dram_, std::optional<uint64_t> randomization_seed_)
-    : randomization_seed(randomization_seed_), dram(dram_), minor_fault_penalty(minor_penalty), pt_levels(page_table_levels),
+                             MEMORY_CONTROLLER& dram_, std::optional<uint64_t> randomization_seed_, bool shared_address_space_)
+    : randomization_seed(randomization_seed_), dram(dram_), shared_address_space(shared_address_space_), minor_fault_penalty(minor_penalty), pt_levels(page_table_levels),
       pte_page_size(page_table_page_size),
       next_pte_page(
           champsim::dynamic_extent{champsim::data::bits{LOG2_PAGE_SIZE}, champsim::data::bits{champsim::lg2(champsim::data::bytes{pte_page_size}.count())}}, 0)
@@ -54,6 +54,14 @@ VirtualMemory::VirtualMemory(champsim::data::bytes page_table_page_size, std::si
 {
 }
 
+VirtualMemory::VirtualMemory(champsim::data::bytes page_table_page_size, std::size_t page_table_levels, champsim::chrono::clock::duration minor_penalty,
+                             MEMORY_CONTROLLER& dram_, std::optional<uint64_t> randomization_seed_)
+    : VirtualMemory(page_table_page_size, page_table_levels, minor_penalty, dram_, randomization_seed_, false)
+{
+}
+
+uint32_t VirtualMemory::address_space_of(uint32_t cpu_num) const { return shared_address_space ? 0 : cpu_num; }
+
 void VirtualMemory::populate_pages()
 {
   assert(dram.size() > 1_MiB);
@@ -106,7 +114,7 @@ std::size_t VirtualMemory::available_ppages() const { return (ppage_free_list.si
 
 std::pair<champsim::page_number, champsim::chrono::clock::duration> VirtualMemory::va_to_pa(uint32_t cpu_num, champsim::page_number vaddr)
 {
-  auto [ppage, fault] = vpage_to_ppage_map.try_emplace({cpu_num, champsim::page_number{vaddr}}, ppage_front());
+  auto [ppage, fault] = vpage_to_ppage_map.try_emplace({address_space_of(cpu_num), champsim::page_number{vaddr}}, ppage_front());
 
   // this vpage doesn't yet have a ppage mapping
   if (fault) {
@@ -131,7 +139,7 @@ std::pair<champsim::address, champsim::chrono::clock::duration> VirtualMemory::g
 
   champsim::dynamic_extent pte_table_entry_extent{champsim::address::bits, shamt(level)};
   auto [ppage, fault] =
-      page_table.try_emplace({cpu_num, level, champsim::address_slice{pte_table_entry_extent, vaddr}}, champsim::splice(active_pte_page, next_pte_page));
+      page_table.try_emplace({address_space_of(cpu_num), level, champsim::address_slice{pte_table_entry_extent, vaddr}}, champsim::splice(active_pte_page, next_pte_page));
 
   // this PTE doesn't yet have a mapping
   if (fault) {
@@ -0,0 +1,264 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "zstd_seekable.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <fmt/core.h>
+#include <zstd.h>
+
+namespace
+{
+constexpr uint32_t skippable_magic = 0x184D2A5E;
+constexpr uint32_t seekable_magic = 0x8F92EAB1;
+constexpr std::size_t skippable_header_size = 8;
+constexpr std::size_t footer_size = 9;
+constexpr uint8_t checksum_flag = 0x80;
+
+uint32_t get_le32(const char* bytes)
+{
+  uint32_t retval = 0;
+  for (std::size_t i = 0; i < 4; ++i) {
+    retval |= uint32_t{static_cast<uint8_t>(bytes[i])} << (8 * i);
+  }
+  return retval;
+}
+
+void put_le32(std::ostream& out, uint32_t val)
+{
+  std::array<char, 4> bytes;
+  for (std::size_t i = 0; i < std::size(bytes); ++i) {
+    bytes[i] = static_cast<char>((val >> (8 * i)) & 0xff);
+  }
+  out.write(std::data(bytes), std::size(bytes));
+}
+} // namespace
+
+std::vector<champsim::zstd_seekable::frame> champsim::zstd_seekable::read_seek_table(std::istream& in)
+{
+  in.seekg(0, std::ios::end);
+  auto end = static_cast<uint64_t>(in.tellg());
+  if (!in || end < footer_size) {
+    in.clear();
+    return {};
+  }
+
+  std::array<char, footer_size> footer;
+  in.seekg(static_cast<std::streamoff>(end - footer_size));
+  in.read(std::data(footer), std::size(footer));
+  if (!in || get_le32(&footer[5]) != seekable_magic) {
+    in.clear();
+    return {};
+  }
+
+  auto num_frames = get_le32(&footer[0]);
+  std::size_t entry_size = ((static_cast<uint8_t>(footer[4]) & checksum_flag) != 0) ? 12 : 8;
+  auto table_size = skippable_header_size + num_frames * entry_size + footer_size;
+  if (end < table_size) {
+    return {};
+  }
+
+  // The skippable frame header gives the size of its contents, which include the footer
+  std::vector<char> raw(table_size - footer_size);
+  in.seekg(static_cast<std::streamoff>(end - table_size));
+  in.read(std::data(raw), static_cast<std::streamsize>(std::size(raw)));
+  if (!in || get_le32(std::data(raw)) != skippable_magic || get_le32(std::data(raw) + 4) != table_size - skippable_header_size) {
+    in.clear();
+    return {};
+  }
+
+  std::vector<frame> retval;
+  uint64_t compressed_offset = 0;
+  uint64_t decompressed_offset = 0;
+  for (std::size_t i = 0; i < num_frames; ++i) {
+    const auto* entry = std::data(raw) + skippable_header_size + i * entry_size;
+    frame next{compressed_offset, decompressed_offset, get_le32(entry), get_le32(entry + 4)};
+    compressed_offset += next.compressed_size;
+    decompressed_offset += next.decompressed_size;
+    retval.push_back(next);
+  }
+  return retval;
+}
+
+bool champsim::zstd_seekable::is_multiframe(const std::string& fname)
+{
+  std::ifstream in{fname, std::ios::binary};
+  return std::size(read_seek_table(in)) > 1;
+}
+
+auto champsim::zstd_seekable::frame_containing(const std::vector<frame>& table, uint64_t decompressed_offset) -> std::vector<frame>::const_iterator
+{
+  auto found = std::upper_bound(std::cbegin(table), std::cend(table), decompressed_offset,
+                                [](uint64_t offset, const frame& x) { return offset < x.decompressed_offset; });
+  if (found == std::cbegin(table)) {
+    return std::cend(table);
+  }
+  found = std::prev(found);
+  if (decompressed_offset >= found->decompressed_offset + found->decompressed_size) {
+    return std::cend(table);
+  }
+  return found;
+}
+
+champsim::zstd_seekable::writer::writer(std::ostream& out, int compression_level, std::size_t max_frame_size)
+    : dest(&out), level(compression_level), frame_size(std::max<std::size_t>(max_frame_size, 1))
+{
+  pending.reserve(frame_size);
+}
+
+champsim::zstd_seekable::writer::~writer() { close(); }
+
+auto champsim::zstd_seekable::writer::write(const char* s, std::streamsize count) -> writer&
+{
+  auto remaining = static_cast<std::size_t>(count);
+  while (remaining > 0) {
+    auto chunk = std::min(remaining, frame_size - std::size(pending));
+    pending.insert(std::end(pending), s, std::next(s, static_cast<std::ptrdiff_t>(chunk)));
+    s = std::next(s, static_cast<std::ptrdiff_t>(chunk));
+    remaining -= chunk;
+
+    if (std::size(pending) == frame_size) {
+      write_frame();
+    }
+  }
+  return *this;
+}
+
+std::vector<char> champsim::zstd_seekable::compress_frame(const char* s, std::size_t count, int compression_level)
+{
+  std::vector<char> compressed(::ZSTD_compressBound(count));
+  auto ret = ::ZSTD_compress(std::data(compressed), std::size(compressed), s, count, compression_level);
+  if (::ZSTD_isError(ret)) {
+    throw std::runtime_error{fmt::format("Could not compress a frame: {}", ::ZSTD_getErrorName(ret))};
+  }
+  compressed.resize(ret);
+  return compressed;
+}
+
+void champsim::zstd_seekable::writer::write_frame()
+{
+  if (std::empty(pending)) {
+    return;
+  }
+
+  auto compressed = compress_frame(std::data(pending), std::size(pending), level);
+  auto decompressed_size = std::size(pending);
+  pending.clear();
+  append_frame(compressed, decompressed_size);
+}
+
+void champsim::zstd_seekable::writer::append_frame(const std::vector<char>& compressed, std::size_t decompressed_size)
+{
+  write_frame();
+  dest->write(std::data(compressed), static_cast<std::streamsize>(std::size(compressed)));
+
+  table.push_back({compressed_offset, decompressed_offset, static_cast<uint32_t>(std::size(compressed)), static_cast<uint32_t>(decompressed_size)});
+  compressed_offset += std::size(compressed);
+  decompressed_offset += decompressed_size;
+}
+
+void champsim::zstd_seekable::writer::close()
+{
+  if (closed) {
+    return;
+  }
+  write_frame();
+
+  // Seek table entries omit the optional checksums
+  put_le32(*dest, skippable_magic);
+  put_le32(*dest, static_cast<uint32_t>(std::size(table) * 8 + footer_size));
+  for (const auto& entry : table) {
+    put_le32(*dest, entry.compressed_size);
+    put_le32(*dest, entry.decompressed_size);
+  }
+  put_le32(*dest, static_cast<uint32_t>(std::size(table)));
+  dest->put(0);
+  put_le32(*dest, seekable_magic);
+  dest->flush();
+  closed = true;
+}
+
+champsim::zstd_seekable::parallel_istream::parallel_istream(std::string fname, std::size_t num_threads)
+    : parallel_istream(std::make_unique<std::ifstream>(fname, std::ios::binary), num_threads)
+{
+}
+
+champsim::zstd_seekable::parallel_istream::parallel_istream(std::unique_ptr<std::istream> in, std::size_t num_threads)
+    : underlying(std::move(in)), table(read_seek_table(*underlying)), threads(std::max<std::size_t>(num_threads, 1))
+{
+  if (std::empty(table)) {
+    throw std::invalid_argument{"The stream is not a seekable zstd stream"};
+  }
+  fill();
+}
+
+void champsim::zstd_seekable::parallel_istream::fill()
+{
+  // Read each frame on this thread, since the underlying stream is sequential, and decode it on another
+  while (std::size(decoding) < threads && next_frame < std::size(table)) {
+    const auto& next = table.at(next_frame++);
+    std::vector<char> compressed(next.compressed_size);
+    underlying->seekg(static_cast<std::streamoff>(next.compressed_offset));
+    underlying->read(std::data(compressed), static_cast<std::streamsize>(std::size(compressed)));
+
+    decoding.push_back(std::async(std::launch::async, [compressed = std::move(compressed), size = next.decompressed_size] {
+      std::vector<char> decompressed(size);
+      auto ret = ::ZSTD_decompress(std::data(decompressed), std::size(decompressed), std::data(compressed), std::size(compressed));
+      if (::ZSTD_isError(ret) || ret != size) {
+        throw std::runtime_error{fmt::format("Could not decompress a frame: {}", ::ZSTD_isError(ret) ? ::ZSTD_getErrorName(ret) : "size mismatch")};
+      }
+      return decompressed;
+    }));
+  }
+}
+
+void champsim::zstd_seekable::parallel_istream::seek_frame(std::vector<frame>::const_iterator first)
+{
+  decoding.clear();
+  current.clear();
+  current_pos = 0;
+  next_frame = static_cast<std::size_t>(std::distance(std::cbegin(table), first));
+  eof_ = false;
+  fill();
+}
+
+auto champsim::zstd_seekable::parallel_istream::read(char* s, std::streamsize count) -> parallel_istream&
+{
+  gcount_ = 0;
+  while (gcount_ < count) {
+    if (current_pos == std::size(current)) {
+      if (std::empty(decoding)) {
+        eof_ = true;
+        break;
+      }
+
+      current = decoding.front().get();
+      decoding.pop_front();
+      current_pos = 0;
+      fill();
+    }
+
+    auto chunk = std::min(static_cast<std::size_t>(count - gcount_), std::size(current) - current_pos);
+    std::copy_n(std::next(std::cbegin(current), static_cast<std::ptrdiff_t>(current_pos)), chunk, std::next(s, gcount_));
+    current_pos += chunk;
+    gcount_ += static_cast<std::streamsize>(chunk);
+  }
+  return *this;
+}
@@ -51,3 +51,21 @@ TEST_CASE("An operable with a scale greater than 2 skips multiple cycles") {
 
   REQUIRE(uut.count == num_cycles/4);
 }
+
+TEST_CASE("An operable accumulates its host time only when profiled") {
+  champsim::chrono::clock global_clock{};
+  champsim::chrono::clock::duration period{100};
+  mock_operable uut{period};
+
+  global_clock.tick(period);
+  uut.operate_on(global_clock);
+  REQUIRE(uut.host_time == std::chrono::steady_clock::duration::zero());
+
+  uut.profile_host_time = true;
+  for (int i = 0; i < 100; ++i) {
+    global_clock.tick(period);
+    uut.operate_on(global_clock);
+  }
+  REQUIRE(uut.count == 101);
+  REQUIRE(uut.host_time > std::chrono::steady_clock::duration::zero());
+}
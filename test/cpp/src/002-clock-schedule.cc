@@ -0,0 +1,104 @@
+#include <catch.hpp>
+#include "clock_schedule.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <vector>
+
+namespace {
+struct recording_operable : champsim::operable {
+  std::vector<int>* log;
+  int id;
+
+  recording_operable(champsim::chrono::picoseconds period, std::vector<int>* log_, int id_) : operable(period), log(log_), id(id_) {}
+  long operate() { log->push_back(id); return 1; }
+};
+
+/*
+ * The order in which operables were operated before schedules were precomputed
+ */
+void sort_and_operate(std::vector<std::reference_wrapper<champsim::operable>> operables, const champsim::chrono::clock& clock) {
+  std::stable_sort(std::begin(operables), std::end(operables),
+      [](const champsim::operable& lhs, const champsim::operable& rhs) { return lhs.current_time < rhs.current_time; });
+  for (champsim::operable& op : operables)
+    op.operate_on(clock);
+}
+
+template <std::size_t N>
+std::pair<std::vector<int>, std::vector<int>> compare_orders(std::array<long, N> periods, int num_ticks) {
+  std::vector<int> expected_log, actual_log;
+  std::vector<recording_operable> expected_ops, actual_ops;
+  for (std::size_t i = 0; i < N; ++i) {
+    expected_ops.emplace_back(champsim::chrono::picoseconds{periods[i]}, &expected_log, static_cast<int>(i));
+    actual_ops.emplace_back(champsim::chrono::picoseconds{periods[i]}, &actual_log, static_cast<int>(i));
+  }
+
+  std::vector<std::reference_wrapper<champsim::operable>> expected_view{std::begin(expected_ops), std::end(expected_ops)};
+  std::vector<std::reference_wrapper<champsim::operable>> actual_view{std::begin(actual_ops), std::end(actual_ops)};
+
+  champsim::chrono::clock expected_clock{}, actual_clock{};
+  champsim::clock_schedule uut{actual_view, actual_clock.now()};
+  for (int i = 0; i < num_ticks; ++i) {
+    expected_clock.tick(uut.time_quantum());
+    sort_and_operate(expected_view, expected_clock);
+
+    actual_clock.tick(uut.time_quantum());
+    uut.operate_on(actual_clock);
+  }
+
+  return {expected_log, actual_log};
+}
+}
+
+TEST_CASE("A clock schedule groups operables by their clock period") {
+  std::vector<int> log;
+  recording_operable a{champsim::chrono::picoseconds{250}, &log, 0};
+  recording_operable b{champsim::chrono::picoseconds{312}, &log, 1};
+  recording_operable c{champsim::chrono::picoseconds{250}, &log, 2};
+
+  champsim::clock_schedule uut{{a, b, c}, champsim::chrono::clock::time_point{}};
+  REQUIRE(uut.num_domains() == 2);
+  REQUIRE(uut.time_quantum() == champsim::chrono::picoseconds{250});
+  REQUIRE(uut.pattern_length() == 156);
+}
+
+TEST_CASE("A clock schedule operates in the same order as sorting by the current time") {
+  auto [expected, actual] = compare_orders(std::array<long, 5>{{250, 312, 250, 625, 250}}, 1000);
+  REQUIRE(std::size(actual) > 0);
+  REQUIRE(actual == expected);
+}
+
+TEST_CASE("A clock schedule with a single domain operates every operable on every tick") {
+  auto [expected, actual] = compare_orders(std::array<long, 3>{{100, 100, 100}}, 10);
+  REQUIRE(std::size(actual) == 30);
+  REQUIRE(actual == expected);
+}
+
+TEST_CASE("A clock schedule with a long repeating pattern computes each tick") {
+  auto [expected, actual] = compare_orders(std::array<long, 3>{{1000, 65537, 65539}}, 1000);
+  REQUIRE(actual == expected);
+
+  std::vector<int> log;
+  recording_operable a{champsim::chrono::picoseconds{1000}, &log, 0};
+  recording_operable b{champsim::chrono::picoseconds{65537}, &log, 1};
+  recording_operable c{champsim::chrono::picoseconds{65539}, &log, 2};
+  champsim::clock_schedule uut{{a, b, c}, champsim::chrono::clock::time_point{}};
+  REQUIRE(uut.pattern_length() == 0);
+}
+
+TEST_CASE("A clock schedule catches up operables that are behind the clock") {
+  std::vector<int> log;
+  recording_operable a{champsim::chrono::picoseconds{100}, &log, 0};
+  recording_operable b{champsim::chrono::picoseconds{100}, &log, 1};
+  b.current_time += champsim::chrono::picoseconds{300};
+
+  champsim::chrono::clock global_clock{};
+  global_clock.tick(champsim::chrono::picoseconds{300});
+  champsim::clock_schedule uut{{a, b}, global_clock.now()};
+  REQUIRE(uut.num_domains() == 2);
+
+  global_clock.tick(uut.time_quantum());
+  uut.operate_on(global_clock);
+  REQUIRE(log == std::vector<int>{0, 0, 0, 0, 1});
+}
@@ -0,0 +1,117 @@
+#include <catch.hpp>
+#include "msl/arena.h"
+
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+TEST_CASE("An arena reserves whole huge pages") {
+  champsim::msl::huge_page_arena uut{1};
+  REQUIRE(uut.reserved() == 0);
+
+  (void)uut.allocate(100);
+  REQUIRE(uut.reserved() > 0);
+  REQUIRE(uut.reserved() % champsim::msl::huge_page_arena::huge_page_size == 0);
+  REQUIRE(uut.reserved_huge() <= uut.reserved());
+}
+
+TEST_CASE("An arena respects the requested alignment") {
+  champsim::msl::huge_page_arena uut{};
+  auto alignment = GENERATE(as<std::size_t>{}, 8, 16, 64, 4096);
+
+  (void)uut.allocate(3);
+  auto* ptr = uut.allocate(100, alignment);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0);
+}
+
+TEST_CASE("An arena reuses freed blocks of the same size") {
+  champsim::msl::huge_page_arena uut{};
+  auto* first = uut.allocate(256);
+  uut.deallocate(first, 256);
+  auto* second = uut.allocate(256);
+  REQUIRE(first == second);
+}
+
+TEST_CASE("An arena places structures larger than a chunk in a chunk of their own") {
+  champsim::msl::huge_page_arena uut{1};
+  auto* small = uut.allocate(64);
+  auto* large = uut.allocate(3 * champsim::msl::huge_page_arena::huge_page_size);
+  auto* next = uut.allocate(64);
+
+  REQUIRE(large != nullptr);
+  REQUIRE(uut.reserved() == 4 * champsim::msl::huge_page_arena::huge_page_size);
+  REQUIRE(static_cast<std::byte*>(next) == static_cast<std::byte*>(small) + 64);
+}
+
+TEST_CASE("Containers may be allocated from an arena") {
+  champsim::msl::huge_page_arena arena{};
+
+  std::vector<long, champsim::msl::arena_allocator<long>> vec{champsim::msl::arena_allocator<long>{arena}};
+  for (long i = 0; i < 1000; ++i)
+    vec.push_back(i);
+  REQUIRE(std::accumulate(std::begin(vec), std::end(vec), 0l) == 999 * 1000 / 2);
+
+  using map_alloc = champsim::msl::arena_allocator<std::pair<const int, int>>;
+  std::map<int, int, std::less<int>, map_alloc> map{map_alloc{arena}};
+  for (int i = 0; i < 100; ++i)
+    map[i] = 2 * i;
+  REQUIRE(std::size(map) == 100);
+  REQUIRE(map.at(42) == 84);
+
+  REQUIRE(arena.reserved() > 0);
+  REQUIRE(vec.get_allocator() == map.get_allocator());
+}
+
+TEST_CASE("Allocators of different arenas are not equal") {
+  champsim::msl::huge_page_arena first{}, second{};
+  REQUIRE(champsim::msl::arena_allocator<int>{first} != champsim::msl::arena_allocator<int>{second});
+  REQUIRE(champsim::msl::arena_allocator<int>{} == champsim::msl::arena_allocator<int>{champsim::msl::huge_page_arena::global()});
+}
+
+TEST_CASE("Each thread has its own global arena") {
+  champsim::msl::huge_page_arena* other = nullptr;
+  std::thread worker{[&other] { other = &champsim::msl::huge_page_arena::global(); }};
+  worker.join();
+
+  REQUIRE(other != nullptr);
+  REQUIRE(other != &champsim::msl::huge_page_arena::global());
+  REQUIRE(&champsim::msl::huge_page_arena::global() == &champsim::msl::huge_page_arena::global());
+}
+
+TEST_CASE("A scope sets the global arena of its thread while it lives") {
+  auto& outer = champsim::msl::huge_page_arena::global();
+  auto& first = champsim::msl::huge_page_arena::make_persistent();
+  auto& second = champsim::msl::huge_page_arena::make_persistent();
+  {
+    champsim::msl::huge_page_arena::scope first_scope{first};
+    REQUIRE(&champsim::msl::huge_page_arena::global() == &first);
+
+    std::vector<int, champsim::msl::arena_allocator<int>> vec{};
+    REQUIRE(vec.get_allocator().resource() == &first);
+    {
+      champsim::msl::huge_page_arena::scope second_scope{second};
+      REQUIRE(&champsim::msl::huge_page_arena::global() == &second);
+
+      // Allocators keep the arena they were made with
+      vec.resize(100);
+      REQUIRE(first.reserved() > 0);
+      REQUIRE(second.reserved() == 0);
+    }
+    REQUIRE(&champsim::msl::huge_page_arena::global() == &first);
+  }
+  REQUIRE(&champsim::msl::huge_page_arena::global() == &outer);
+}
+
+TEST_CASE("An arena that frees and allocates the same sizes does not grow") {
+  champsim::msl::huge_page_arena uut{1};
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<void*> held{};
+    for (std::size_t bytes : {64, 192, 1024, 4096})
+      held.push_back(uut.allocate(bytes));
+    for (auto [ptr, bytes] : {std::pair{held.at(0), 64}, {held.at(1), 192}, {held.at(2), 1024}, {held.at(3), 4096}})
+      uut.deallocate(ptr, static_cast<std::size_t>(bytes));
+  }
+  REQUIRE(uut.reserved() == champsim::msl::huge_page_arena::huge_page_size);
+}
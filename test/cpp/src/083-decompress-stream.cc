@@ -116,3 +116,45 @@ TEST_CASE("An inf_stream can inflate a bz2-compressed text") {
   comp_stream.read(inflated, static_cast<std::streamsize>(std::size(plaintext)));
   REQUIRE_THAT(std::string{inflated}, Catch::Matchers::Equals(plaintext));
 }
+
+TEST_CASE("An inf_stream can inflate a xz-compressed text on several threads") {
+  champsim::inf_istream<champsim::decomp_tags::lzma_mt_tag_t<>, std::istringstream> comp_stream{std::istringstream{xz_cyphertext}};
+
+  char inflated[1000] = {};
+  comp_stream.read(inflated, static_cast<std::streamsize>(std::size(plaintext)));
+  REQUIRE_THAT(std::string{inflated}, Catch::Matchers::Equals(plaintext));
+}
+
+TEST_CASE("An inf_stream can inflate a zstd-compressed text") {
+  std::string zstd_cyphertext(ZSTD_compressBound(std::size(plaintext)), '\0');
+  zstd_cyphertext.resize(ZSTD_compress(std::data(zstd_cyphertext), std::size(zstd_cyphertext), std::data(plaintext), std::size(plaintext), 3));
+
+  champsim::inf_istream<champsim::decomp_tags::zstd_tag_t<>, std::istringstream> comp_stream{std::istringstream{zstd_cyphertext}};
+
+  STATIC_REQUIRE(std::is_move_constructible<decltype(comp_stream)>::value);
+  STATIC_REQUIRE(std::is_move_assignable<decltype(comp_stream)>::value);
+  STATIC_REQUIRE(std::is_swappable<decltype(comp_stream)>::value);
+
+  char inflated[1000] = {};
+  comp_stream.read(inflated, static_cast<std::streamsize>(std::size(plaintext)));
+  REQUIRE_THAT(std::string{inflated}, Catch::Matchers::Equals(plaintext));
+}
+
+TEST_CASE("An inf_stream delivers output that the decompressor holds after consuming its input") {
+  // Highly compressible text is consumed in one read, but inflates to many output buffers
+  std::string long_plaintext;
+  for (int i = 0; i < 64; ++i) {
+    long_plaintext += std::string(4096, static_cast<char>('a' + (i % 26)));
+  }
+  std::string zstd_cyphertext(ZSTD_compressBound(std::size(long_plaintext)), '\0');
+  zstd_cyphertext.resize(ZSTD_compress(std::data(zstd_cyphertext), std::size(zstd_cyphertext), std::data(long_plaintext), std::size(long_plaintext), 3));
+
+  champsim::inf_istream<champsim::decomp_tags::zstd_tag_t<>, std::istringstream> comp_stream{std::istringstream{zstd_cyphertext}};
+
+  std::string inflated(std::size(long_plaintext) + 1, '\0');
+  comp_stream.read(std::data(inflated), static_cast<std::streamsize>(std::size(inflated)));
+  REQUIRE(comp_stream.gcount() == static_cast<std::streamsize>(std::size(long_plaintext)));
+  REQUIRE(comp_stream.eof());
+  inflated.resize(std::size(long_plaintext));
+  REQUIRE(inflated == long_plaintext);
+}
@@ -0,0 +1,174 @@
+#include <catch.hpp>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "trace_broadcast.h"
+
+namespace {
+  struct counting_reader {
+    uint64_t next = 0;
+    uint64_t length;
+
+    explicit counting_reader(uint64_t len) : length(len) {}
+
+    ooo_model_instr operator()() {
+      input_instr i{};
+      i.ip = next++;
+      return ooo_model_instr{0, i};
+    }
+
+    bool eof() const { return next >= length; }
+  };
+
+  std::vector<uint64_t> drain(champsim::tracereader& reader) {
+    std::vector<uint64_t> retval{};
+    while (!reader.eof()) {
+      retval.push_back(reader().ip.to<uint64_t>());
+    }
+    return retval;
+  }
+}
+
+TEST_CASE("Every subscriber to a trace broadcast sees the whole trace") {
+  constexpr uint64_t trace_length = 1000;
+  champsim::trace_broadcaster uut{champsim::tracereader{::counting_reader{trace_length}}, 16, 4};
+
+  std::vector<champsim::tracereader> readers{};
+  for (int i = 0; i < 3; ++i) {
+    readers.emplace_back(uut.subscribe());
+  }
+
+  std::vector<std::vector<uint64_t>> results(std::size(readers));
+  std::vector<std::thread> threads{};
+  for (std::size_t i = 0; i < std::size(readers); ++i) {
+    threads.emplace_back([&, i]{ results.at(i) = ::drain(readers.at(i)); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<uint64_t> expected(trace_length);
+  std::iota(std::begin(expected), std::end(expected), 0);
+  for (const auto& result : results) {
+    REQUIRE_THAT(result, Catch::Matchers::Equals(expected));
+  }
+}
+
+TEST_CASE("A detached subscriber does not hold back a trace broadcast") {
+  constexpr uint64_t trace_length = 1000;
+  champsim::trace_broadcaster uut{champsim::tracereader{::counting_reader{trace_length}}, 16, 2};
+
+  champsim::tracereader reader{uut.subscribe()};
+  {
+    champsim::tracereader early_leaver{uut.subscribe()};
+    (void)early_leaver();
+  }
+
+  REQUIRE(std::size(::drain(reader)) == trace_length);
+}
+
+TEST_CASE("A trace broadcast of an empty trace is immediately at its end") {
+  champsim::trace_broadcaster uut{champsim::tracereader{::counting_reader{0}}};
+  champsim::tracereader reader{uut.subscribe()};
+  REQUIRE(reader.eof());
+}
+
+TEST_CASE("Subscribers on one thread do not wait for each other if the trace can be reopened") {
+  constexpr uint64_t trace_length = 1000;
+  champsim::trace_broadcaster uut{std::function<champsim::tracereader()>{[] { return champsim::tracereader{::counting_reader{trace_length}}; }}, 16, 4, 8};
+
+  champsim::tracereader laggard{uut.subscribe()};
+  champsim::tracereader leader{uut.subscribe()};
+
+  // The laggard takes a few instructions, then the leader runs far beyond the buffer
+  std::vector<uint64_t> laggard_result{};
+  for (int i = 0; i < 20; ++i) {
+    laggard_result.push_back(laggard().ip.to<uint64_t>());
+  }
+  auto leader_result = ::drain(leader);
+  auto laggard_rest = ::drain(laggard);
+  laggard_result.insert(std::end(laggard_result), std::begin(laggard_rest), std::end(laggard_rest));
+
+  std::vector<uint64_t> expected(trace_length);
+  std::iota(std::begin(expected), std::end(expected), 0);
+  REQUIRE_THAT(leader_result, Catch::Matchers::Equals(expected));
+  REQUIRE_THAT(laggard_result, Catch::Matchers::Equals(expected));
+  REQUIRE(uut.evictions() == 1);
+}
+
+TEST_CASE("A trace broadcast holds the batches of subscribers behind on one thread until its pinned capacity") {
+  constexpr uint64_t trace_length = 1000;
+  champsim::trace_broadcaster uut{std::function<champsim::tracereader()>{[] { return champsim::tracereader{::counting_reader{trace_length}}; }}, 16, 4, 64};
+
+  champsim::tracereader laggard{uut.subscribe()};
+  champsim::tracereader leader{uut.subscribe()};
+
+  // The whole trace fits in the pinned buffer, so the laggard keeps reading from it
+  std::vector<uint64_t> laggard_result{};
+  for (int i = 0; i < 20; ++i) {
+    laggard_result.push_back(laggard().ip.to<uint64_t>());
+  }
+  auto leader_result = ::drain(leader);
+  auto laggard_rest = ::drain(laggard);
+  laggard_result.insert(std::end(laggard_result), std::begin(laggard_rest), std::end(laggard_rest));
+
+  std::vector<uint64_t> expected(trace_length);
+  std::iota(std::begin(expected), std::end(expected), 0);
+  REQUIRE_THAT(leader_result, Catch::Matchers::Equals(expected));
+  REQUIRE_THAT(laggard_result, Catch::Matchers::Equals(expected));
+  REQUIRE(uut.evictions() == 0);
+}
+
+TEST_CASE("A subscriber to a trace broadcast may begin at an offset") {
+  constexpr uint64_t trace_length = 1000;
+  auto offset = GENERATE(uint64_t{0}, uint64_t{10}, uint64_t{100}, uint64_t{1000});
+
+  std::vector<champsim::trace_broadcaster> sources{};
+  sources.emplace_back(std::function<champsim::tracereader()>{[] { return champsim::tracereader{::counting_reader{trace_length}}; }}, 16, 16);
+  auto readers = champsim::subscribe(sources, {{0, 0}, {0, offset}});
+
+  std::vector<uint64_t> expected(trace_length);
+  std::iota(std::begin(expected), std::end(expected), 0);
+  REQUIRE_THAT(::drain(readers.at(0)), Catch::Matchers::Equals(expected));
+  REQUIRE_THAT(::drain(readers.at(1)), Catch::Matchers::Equals(std::vector<uint64_t>(std::next(std::begin(expected), static_cast<long>(offset)), std::end(expected))));
+}
+
+TEST_CASE("Instructions from a trace broadcast are numbered in the order they are consumed") {
+  constexpr uint64_t trace_length = 1000;
+  champsim::trace_broadcaster uut{std::function<champsim::tracereader()>{[] { return champsim::tracereader{::counting_reader{trace_length}}; }}, 16, 4, 4};
+
+  champsim::tracereader laggard{uut.subscribe()};
+  champsim::tracereader leader{uut.subscribe()};
+
+  // The leader runs far beyond the buffer, so that the laggard is evicted and reads privately
+  std::vector<uint64_t> ids{};
+  for (int i = 0; i < 20; ++i) {
+    ids.push_back(laggard().instr_id);
+  }
+  while (!leader.eof()) {
+    ids.push_back(leader().instr_id);
+  }
+  while (!laggard.eof()) {
+    ids.push_back(laggard().instr_id);
+  }
+
+  // Neither the producer nor the private reader of the evicted subscriber takes an ID
+  std::vector<uint64_t> expected(2 * trace_length);
+  std::iota(std::begin(expected), std::end(expected), ids.front());
+  REQUIRE_THAT(ids, Catch::Matchers::Equals(expected));
+  REQUIRE(uut.evictions() == 1);
+}
+
+TEST_CASE("A trace broadcast can be assigned over one that is still decoding") {
+  constexpr uint64_t trace_length = 1000;
+  champsim::trace_broadcaster uut{champsim::tracereader{::counting_reader{trace_length}}, 16, 2};
+  champsim::tracereader stale{uut.subscribe()};
+  (void)stale();
+
+  uut = champsim::trace_broadcaster{champsim::tracereader{::counting_reader{trace_length / 2}}, 16, 2};
+  champsim::tracereader reader{uut.subscribe()};
+  REQUIRE(std::size(::drain(reader)) == trace_length / 2);
+}
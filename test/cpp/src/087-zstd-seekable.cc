@@ -0,0 +1,152 @@
+#include <catch.hpp>
+#include <future>
+#include <numeric>
+#include <sstream>
+
+#include "inf_stream.h"
+#include "tracereader.h"
+#include "zstd_seekable.h"
+
+namespace {
+  std::string counting_text(std::size_t length) {
+    std::string retval(length, '\0');
+    for (std::size_t i = 0; i < length; ++i) {
+      retval[i] = static_cast<char>('a' + ((i / 7) % 26));
+    }
+    return retval;
+  }
+
+  std::string seekable_compress(const std::string& plaintext, std::size_t frame_size) {
+    std::ostringstream out;
+    {
+      champsim::zstd_seekable::writer writer{out, 3, frame_size};
+      writer.write(std::data(plaintext), static_cast<std::streamsize>(std::size(plaintext)));
+    }
+    return out.str();
+  }
+
+  std::string read_all(champsim::zstd_seekable::parallel_istream& in) {
+    std::string retval;
+    std::array<char, 1000> buf;
+    while (!in.eof()) {
+      in.read(std::data(buf), static_cast<std::streamsize>(std::size(buf)));
+      retval.append(std::data(buf), static_cast<std::size_t>(in.gcount()));
+    }
+    return retval;
+  }
+}
+
+TEST_CASE("A seekable zstd stream records the location of each frame") {
+  auto plaintext = ::counting_text(10000);
+  std::istringstream compressed{::seekable_compress(plaintext, 4096)};
+
+  auto table = champsim::zstd_seekable::read_seek_table(compressed);
+  REQUIRE(std::size(table) == 3);
+  REQUIRE(table.at(0).decompressed_offset == 0);
+  REQUIRE(table.at(1).decompressed_offset == 4096);
+  REQUIRE(table.at(2).decompressed_offset == 8192);
+  REQUIRE(table.at(2).decompressed_size == 10000 - 8192);
+  REQUIRE(table.at(1).compressed_offset == table.at(0).compressed_size);
+
+  REQUIRE(champsim::zstd_seekable::frame_containing(table, 5000) == std::next(std::cbegin(table)));
+  REQUIRE(champsim::zstd_seekable::frame_containing(table, 10000) == std::cend(table));
+}
+
+TEST_CASE("Frames compressed on other threads can be appended to a seekable zstd stream") {
+  auto plaintext = ::counting_text(10000);
+  std::vector<std::future<std::vector<char>>> frames;
+  for (std::size_t offset = 0; offset < std::size(plaintext); offset += 4096) {
+    frames.push_back(std::async(std::launch::async, [&plaintext, offset] {
+      return champsim::zstd_seekable::compress_frame(std::data(plaintext) + offset, std::min<std::size_t>(4096, std::size(plaintext) - offset), 3);
+    }));
+  }
+
+  std::ostringstream out;
+  {
+    champsim::zstd_seekable::writer writer{out, 3, 4096};
+    writer.write(std::data(plaintext), 10);
+    for (std::size_t i = 0; i < std::size(frames); ++i) {
+      writer.append_frame(frames.at(i).get(), std::min<std::size_t>(4096, std::size(plaintext) - 4096 * i));
+    }
+  }
+
+  champsim::zstd_seekable::parallel_istream uut{std::make_unique<std::istringstream>(out.str())};
+  REQUIRE(std::size(uut.frames()) == 4);
+  REQUIRE(uut.frames().at(1).decompressed_offset == 10);
+  REQUIRE(::read_all(uut) == plaintext.substr(0, 10) + plaintext);
+}
+
+TEST_CASE("A stream without a seek table is not seekable") {
+  std::istringstream not_seekable{"This text is not compressed."};
+  REQUIRE(std::empty(champsim::zstd_seekable::read_seek_table(not_seekable)));
+  REQUIRE_THROWS(champsim::zstd_seekable::parallel_istream{std::make_unique<std::istringstream>("This text is not compressed.")});
+}
+
+TEST_CASE("A seekable zstd stream is an ordinary zstd stream") {
+  auto plaintext = ::counting_text(10000);
+  champsim::inf_istream<champsim::decomp_tags::zstd_tag_t<>, std::istringstream> uut{std::istringstream{::seekable_compress(plaintext, 4096)}};
+
+  std::string inflated(std::size(plaintext) + 1, '\0');
+  uut.read(std::data(inflated), static_cast<std::streamsize>(std::size(inflated)));
+  REQUIRE(uut.gcount() == static_cast<std::streamsize>(std::size(plaintext)));
+  inflated.resize(std::size(plaintext));
+  REQUIRE(inflated == plaintext);
+}
+
+TEST_CASE("A reader can begin at any frame of a seekable zstd stream") {
+  auto plaintext = ::counting_text(10000);
+  auto compressed = ::seekable_compress(plaintext, 4096);
+  std::istringstream table_source{compressed};
+  auto table = champsim::zstd_seekable::read_seek_table(table_source);
+
+  std::istringstream source{compressed};
+  source.seekg(static_cast<std::streamoff>(table.at(1).compressed_offset));
+  champsim::inf_istream<champsim::decomp_tags::zstd_tag_t<>, std::istringstream> uut{std::move(source)};
+
+  std::string inflated(100, '\0');
+  uut.read(std::data(inflated), static_cast<std::streamsize>(std::size(inflated)));
+  REQUIRE(inflated == plaintext.substr(4096, 100));
+}
+
+TEST_CASE("The frames of a seekable zstd stream can be decoded in parallel") {
+  auto num_threads = GENERATE(std::size_t{1}, std::size_t{4});
+  auto plaintext = ::counting_text(100000);
+  champsim::zstd_seekable::parallel_istream uut{std::make_unique<std::istringstream>(::seekable_compress(plaintext, 4096)), num_threads};
+
+  REQUIRE(std::size(uut.frames()) == 25);
+  REQUIRE(::read_all(uut) == plaintext);
+
+  SECTION("And the reader can seek to a frame") {
+    uut.seek_frame(champsim::zstd_seekable::frame_containing(uut.frames(), 50000));
+    REQUIRE(::read_all(uut) == plaintext.substr(uut.frames().at(50000 / 4096).decompressed_offset));
+  }
+}
+
+TEST_CASE("A tracereader can read a seekable zstd stream in parallel") {
+  std::string raw_trace;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    input_instr instr{};
+    instr.ip = 0x1000 + 4 * i;
+    raw_trace.append(reinterpret_cast<const char*>(&instr), sizeof(instr));
+  }
+
+  champsim::bulk_tracereader<input_instr, champsim::zstd_seekable::parallel_istream> uut{
+      0, champsim::zstd_seekable::parallel_istream{std::make_unique<std::istringstream>(::seekable_compress(raw_trace, 10 * sizeof(input_instr) + 3))}};
+
+  for (uint64_t i = 0; i < 1000; ++i) {
+    REQUIRE(uut().ip == champsim::address{0x1000 + 4 * i});
+  }
+}
+
+TEST_CASE("The number of decoder threads can be set for traces opened later") {
+  const auto old_lzma_threads = champsim::decomp_tags::lzma_mt_tag_t<>::threads.load();
+  const auto old_zstd_threads = champsim::zstd_seekable::parallel_istream::default_threads.load();
+
+  auto [requested, expected] = GENERATE(table<std::size_t, std::size_t>({{1, 1}, {3, 3}, {0, 1}}));
+  set_decoder_threads(requested);
+  CHECK(champsim::decomp_tags::lzma_mt_tag_t<>::threads == expected);
+  CHECK(champsim::zstd_seekable::parallel_istream::default_threads == expected);
+
+  champsim::decomp_tags::lzma_mt_tag_t<>::threads = old_lzma_threads;
+  champsim::zstd_seekable::parallel_istream::default_threads = old_zstd_threads;
+}
@@ -0,0 +1,140 @@
+#include <catch.hpp>
+#include <set>
+
+#include "synthetic_trace.h"
+#include "tracereader.h"
+
+namespace {
+  std::vector<ooo_model_instr> take(champsim::synthetic::generator& uut, std::size_t count) {
+    std::vector<ooo_model_instr> retval{};
+    for (std::size_t i = 0; i < count; ++i) {
+      retval.push_back(uut());
+    }
+    return retval;
+  }
+
+  std::vector<uint64_t> loaded_addresses(const std::vector<ooo_model_instr>& instrs) {
+    std::vector<uint64_t> retval{};
+    for (const auto& instr : instrs) {
+      for (auto addr : instr.source_memory) {
+        retval.push_back(addr.to<uint64_t>());
+      }
+    }
+    return retval;
+  }
+}
+
+TEST_CASE("A synthetic workload is parsed from its name") {
+  auto params = champsim::synthetic::parse("synthetic:pointer_chase,footprint=4M,seed=7,length=1k");
+  REQUIRE(params.kind == champsim::synthetic::pattern::pointer_chase);
+  REQUIRE(params.footprint == (4 << 20));
+  REQUIRE(params.seed == 7);
+  REQUIRE(params.length == 1024);
+
+  REQUIRE(champsim::synthetic::is_synthetic("synthetic:stream"));
+  REQUIRE_FALSE(champsim::synthetic::is_synthetic("600.perlbench_s-210B.champsimtrace.xz"));
+
+  REQUIRE_THROWS_AS(champsim::synthetic::parse("synthetic:unknown"), std::invalid_argument);
+  REQUIRE_THROWS_AS(champsim::synthetic::parse("synthetic:stream,colour=blue"), std::invalid_argument);
+  REQUIRE_THROWS_AS(champsim::synthetic::parse("synthetic:stream,footprint=big"), std::invalid_argument);
+  REQUIRE_THROWS_AS(champsim::synthetic::parse("synthetic:branchy,mispredict=2"), std::invalid_argument);
+  REQUIRE_THROWS_AS(champsim::synthetic::parse("synthetic:mix,loads=0.5,stores=0.5,branches=0.5"), std::invalid_argument);
+}
+
+TEST_CASE("A pointer chase visits every block of its footprint once before it repeats") {
+  constexpr uint64_t footprint = 64 * 256;
+  champsim::synthetic::generator uut{0, champsim::synthetic::parse("synthetic:pointer_chase,footprint=16k")};
+
+  // Each iteration of the loop is one load, one arithmetic instruction, and the loop branch
+  auto loads = ::loaded_addresses(::take(uut, 3 * 256));
+  REQUIRE(std::size(loads) == 256);
+
+  std::set<uint64_t> distinct{std::begin(loads), std::end(loads)};
+  REQUIRE(std::size(distinct) == 256);
+  for (auto addr : loads) {
+    REQUIRE(addr >= champsim::synthetic::generator::data_base);
+    REQUIRE(addr < champsim::synthetic::generator::data_base + footprint);
+    REQUIRE(addr % 64 == 0);
+  }
+
+  // Each load depends on the one before it
+  uut = champsim::synthetic::generator{0, champsim::synthetic::parse("synthetic:pointer_chase,footprint=16k")};
+  auto first = uut();
+  REQUIRE_THAT(first.source_registers, Catch::Matchers::RangeEquals(first.destination_registers));
+}
+
+TEST_CASE("A stream reads successive words, and a stride skips blocks") {
+  auto [name, stride] = GENERATE(std::pair{"synthetic:stream", uint64_t{8}}, std::pair{"synthetic:stride", uint64_t{256}},
+                                 std::pair{"synthetic:stride,stride=4k", uint64_t{4096}});
+  champsim::synthetic::generator uut{0, champsim::synthetic::parse(name)};
+
+  auto loads = ::loaded_addresses(::take(uut, 100));
+  REQUIRE(std::size(loads) > 2);
+  for (std::size_t i = 1; i < std::size(loads); ++i) {
+    REQUIRE(loads.at(i) - loads.at(i - 1) == stride);
+  }
+}
+
+TEST_CASE("GUPS updates the word it loads") {
+  constexpr uint64_t footprint = 1 << 20;
+  champsim::synthetic::generator uut{0, champsim::synthetic::parse("synthetic:gups,footprint=1M")};
+
+  for (int i = 0; i < 100; ++i) {
+    auto load = uut();
+    (void)uut();
+    auto store = uut();
+    (void)uut();
+    REQUIRE(std::size(load.source_memory) == 1);
+    REQUIRE_THAT(store.destination_memory, Catch::Matchers::RangeEquals(load.source_memory));
+    REQUIRE(load.source_memory.front().to<uint64_t>() < champsim::synthetic::generator::data_base + footprint);
+  }
+}
+
+TEST_CASE("Branches of a synthetic workload go against their bias at the given rate") {
+  auto rate = GENERATE(0.0, 0.1, 0.5);
+  champsim::synthetic::generator uut{0, champsim::synthetic::parse("synthetic:branchy,mispredict=" + std::to_string(rate))};
+
+  std::size_t branches = 0;
+  std::size_t not_taken = 0;
+  std::size_t loops = 0;
+  std::size_t wrong_targets = 0;
+  auto instrs = ::take(uut, 100000);
+  for (auto it = std::begin(instrs); it != std::end(instrs); ++it) {
+    if (it->branch == BRANCH_CONDITIONAL) {
+      ++branches;
+      not_taken += it->branch_taken ? 0 : 1;
+    }
+    if (it->branch == BRANCH_DIRECT_JUMP) {
+      ++loops;
+    }
+
+    // Every taken branch names the instruction that follows it
+    if (it->branch_taken && std::next(it) != std::end(instrs) && it->branch_target != std::next(it)->ip) {
+      ++wrong_targets;
+    }
+  }
+
+  REQUIRE(loops > 0);
+  REQUIRE(wrong_targets == 0);
+  REQUIRE(static_cast<double>(not_taken) / static_cast<double>(branches) == Approx(rate).margin(0.01));
+}
+
+TEST_CASE("A mix of synthetic instructions follows the given ratios") {
+  champsim::synthetic::generator uut{0, champsim::synthetic::parse("synthetic:mix,loads=0.5,stores=0.25,branches=0,seed=3")};
+
+  auto count = [&](auto kind) { return std::count(std::begin(uut.body()), std::end(uut.body()), kind); };
+  auto size = static_cast<double>(std::size(uut.body()));
+  REQUIRE(static_cast<double>(count(champsim::synthetic::generator::slot_kind::load)) / size == Approx(0.5).margin(0.15));
+  REQUIRE(static_cast<double>(count(champsim::synthetic::generator::slot_kind::store)) / size == Approx(0.25).margin(0.15));
+  REQUIRE(count(champsim::synthetic::generator::slot_kind::branch) == 0);
+}
+
+TEST_CASE("A synthetic workload may be opened in place of a trace") {
+  auto uut = get_tracereader("synthetic:stream,length=100", 0, false, false);
+  std::size_t count = 0;
+  while (!uut.eof()) {
+    (void)uut();
+    ++count;
+  }
+  REQUIRE(count == 100);
+}
@@ -0,0 +1,95 @@
+#include <catch.hpp>
+#include <algorithm>
+
+#include "trace_profile.h"
+
+TEST_CASE("A reuse histogram groups distances in powers of two") {
+  champsim::trace_profile::reuse_histogram uut;
+  uut.add(std::nullopt);
+  uut.add(0);
+  uut.add(1);
+  uut.add(2);
+  uut.add(3);
+  uut.add(100);
+
+  REQUIRE(uut.cold == 1);
+  REQUIRE(uut.accesses() == 6);
+  REQUIRE(std::size(uut.buckets) == 8);
+  REQUIRE(uut.buckets.at(0) == 1);
+  REQUIRE(uut.buckets.at(1) == 1);
+  REQUIRE(uut.buckets.at(2) == 2);
+  REQUIRE(uut.buckets.at(7) == 1);
+
+  REQUIRE(uut.hits(1) == 1);
+  REQUIRE(uut.hits(4) == 4);
+  REQUIRE(uut.hits(128) == 5);
+}
+
+TEST_CASE("The reuse distance of a cyclic access pattern is its length less one") {
+  constexpr uint64_t num_blocks = 100;
+  champsim::trace_profile::reuse_profiler uut{64};
+  for (int pass = 0; pass < 3; ++pass) {
+    for (uint64_t i = 0; i < num_blocks; ++i) {
+      uut.access(64 * i + 8); // Addresses within the same block are the same block
+    }
+  }
+
+  REQUIRE(uut.histogram.cold == num_blocks);
+  REQUIRE(uut.histogram.buckets.at(7) == 2 * num_blocks); // 99 is in [64, 128)
+  REQUIRE(uut.histogram.accesses() == 3 * num_blocks);
+}
+
+TEST_CASE("A sampled reuse profile estimates the full profile") {
+  constexpr uint64_t num_blocks = 10000;
+  champsim::trace_profile::reuse_profiler uut{64, 0.1};
+  for (int pass = 0; pass < 2; ++pass) {
+    for (uint64_t i = 0; i < num_blocks; ++i) {
+      uut.access(64 * i);
+    }
+  }
+
+  REQUIRE(static_cast<double>(uut.histogram.cold) == Approx(num_blocks).epsilon(0.1));
+  REQUIRE(static_cast<double>(uut.histogram.accesses()) == Approx(2 * num_blocks).epsilon(0.1));
+
+  // The distance 9999 falls in [8192, 16384), and the scaled distances of the samples should land nearby
+  auto near = uut.histogram.buckets.at(13) + uut.histogram.buckets.at(14);
+  REQUIRE(static_cast<double>(near) == Approx(num_blocks).epsilon(0.1));
+}
+
+TEST_CASE("A trace profile finds the footprint and strides of a stream") {
+  champsim::trace_profile::options opts;
+  opts.footprint_interval = 1000;
+  auto uut = champsim::trace_profile::run(get_tracereader("synthetic:stream,footprint=16k,length=10000", 0, false, false), opts);
+
+  REQUIRE(uut.instructions == 10000);
+  REQUIRE(uut.loads > 0);
+  REQUIRE(std::size(uut.footprint) == 10);
+  REQUIRE(uut.footprint.back().instructions == 10000);
+  REQUIRE(uut.footprint.back().code_blocks == 1);
+  REQUIRE(uut.footprint.back().data_pages == 4);
+  REQUIRE(uut.footprint.back().data_blocks == 256);
+
+  // The stream reads successive words from eight loads in its loop, and wraps around at the end of its footprint
+  REQUIRE(uut.strides.at(64) > uut.loads * 99 / 100);
+  REQUIRE(std::size(uut.strides_by_ip) == 8);
+  for (const auto& entry : uut.strides_by_ip) {
+    auto most_common = std::max_element(std::begin(entry.strides), std::end(entry.strides), [](auto lhs, auto rhs) { return lhs.second < rhs.second; });
+    REQUIRE(most_common->first == 64);
+  }
+
+  REQUIRE(uut.block_reuse.cold == 256);
+  REQUIRE(uut.page_reuse.cold == 4);
+  REQUIRE(uut.block_reuse.accesses() == uut.loads + uut.stores);
+}
+
+TEST_CASE("A trace profile counts branches by type and bias") {
+  champsim::trace_profile::options opts;
+  opts.max_instructions = 10000;
+  auto uut = champsim::trace_profile::run(get_tracereader("synthetic:branchy,mispredict=0", 0, false, false), opts);
+
+  REQUIRE(uut.instructions == 10000);
+  REQUIRE(uut.branches.count.at(BRANCH_CONDITIONAL) > 0);
+  REQUIRE(uut.branches.count.at(BRANCH_DIRECT_JUMP) > 0);
+  REQUIRE(uut.branches.biased_conditional == uut.branches.count.at(BRANCH_CONDITIONAL));
+  REQUIRE(uut.branches.static_branches > 1);
+}
@@ -0,0 +1,251 @@
+#include <catch.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+#include "msl/arena.h"
+#include "module_registry.h"
+#include "runtime_environment.h"
+#include "../../../prefetcher/next_line/next_line.h"
+#include "../../../replacement/lru/lru.h"
+
+namespace
+{
+champsim::modules::registry test_registry()
+{
+  champsim::modules::registry reg{};
+  reg.add_prefetcher<next_line>("next_line");
+  reg.add_replacement<lru>("lru");
+  return reg;
+}
+
+/*
+ * A single core, whose L1I and L1D are both connected directly to DRAM.
+ * Channels 0 and 1 are the core's fetch and data queues, and channels 2 and 3 connect the L1I and L1D to DRAM.
+ */
+nlohmann::json small_description()
+{
+  auto channel = nlohmann::json{{"rq_size", 16}, {"pq_size", 16}, {"wq_size", 16}, {"offset_bits", 6}, {"match_offset_bits", false}};
+
+  return nlohmann::json{
+      {"num_cpus", 1},
+      {"block_size", 64},
+      {"page_size", 4096},
+      {"channels", {channel, channel, channel, channel}},
+      {"dram",
+       {{"dbus_period", 312},
+        {"mc_period", 625},
+        {"tRP", 24},
+        {"tRCD", 24},
+        {"tCAS", 24},
+        {"tRAS", 52},
+        {"refresh_period", 32000},
+        {"upper_levels", {2, 3}},
+        {"rq_size", 64},
+        {"wq_size", 64},
+        {"channels", 1},
+        {"channel_width", 8},
+        {"bank_rows", 65536},
+        {"bank_columns", 1024},
+        {"ranks", 1},
+        {"bankgroups", 8},
+        {"banks", 4},
+        {"refreshes_per_period", 8192}}},
+      {"vmem", {{"pte_page_size", 4096}, {"num_levels", 5}, {"minor_fault_penalty", 200}, {"randomization", 1}}},
+      {"ptws", nlohmann::json::array()},
+      {"caches",
+       {{{"name", "test_L1I"},
+         {"defaults", "l1i"},
+         {"upper_levels", {0}},
+         {"lower_level", 2},
+         {"sets", 32},
+         {"ways", 4},
+         {"prefetcher", nlohmann::json::array()},
+         {"replacement", {"lru"}}},
+        {{"name", "test_L1D"},
+         {"upper_levels", {1}},
+         {"lower_level", 3},
+         {"sets", 64},
+         {"ways", 8},
+         {"prefetch_activate", {"LOAD", "PREFETCH"}},
+         {"prefetcher", {"next_line"}},
+         {"replacement", {"lru"}}}}},
+      {"cores",
+       {{{"index", 0},
+         {"l1i", "test_L1I"},
+         {"l1d", "test_L1D"},
+         {"fetch_queues", 0},
+         {"data_queues", 1},
+         {"rob_size", 128},
+         {"branch_predictor", nlohmann::json::array()},
+         {"btb", nlohmann::json::array()}}}}};
+}
+} // namespace
+
+TEST_CASE("A module registry finds modules by name")
+{
+  auto reg = test_registry();
+  auto make_prefetcher = reg.prefetcher({"next_line"});
+  auto make_replacement = reg.replacement({"lru"});
+
+  CACHE uut{champsim::cache_builder{}.sets(16).ways(4), make_prefetcher, make_replacement};
+
+  REQUIRE(uut.NUM_SET == 16);
+  REQUIRE(uut.NUM_WAY == 4);
+}
+
+TEST_CASE("A module registry selects no module for an empty list")
+{
+  auto reg = test_registry();
+  REQUIRE(reg.prefetcher({}));
+  REQUIRE(reg.replacement({}));
+  REQUIRE(reg.branch_predictor({}));
+  REQUIRE(reg.btb({}));
+}
+
+TEST_CASE("A module registry rejects unknown names")
+{
+  auto reg = test_registry();
+  REQUIRE_THROWS_AS(reg.prefetcher({"not_a_prefetcher"}), std::invalid_argument);
+  REQUIRE_THROWS_AS(reg.replacement({"next_line"}), std::invalid_argument);
+}
+
+TEST_CASE("A module registry selects at most one module")
+{
+  auto reg = test_registry();
+  REQUIRE_THROWS_AS(reg.replacement({"lru", "lru"}), std::invalid_argument);
+}
+
+TEST_CASE("A runtime environment assembles the described elements")
+{
+  champsim::runtime_environment uut{small_description(), test_registry()};
+
+  REQUIRE(std::size(uut.cpu_view()) == 1);
+  REQUIRE(std::size(uut.ptw_view()) == 0);
+  REQUIRE(std::size(uut.operable_view()) == 4);
+
+  auto caches = uut.cache_view();
+  REQUIRE(std::size(caches) == 2);
+
+  auto named = [&caches](std::string name) -> CACHE& {
+    return std::find_if(std::begin(caches), std::end(caches), [name](const CACHE& c) { return c.NAME == name; })->get();
+  };
+
+  CACHE& l1i = named("test_L1I");
+  CHECK(l1i.NUM_SET == 32);
+  CHECK(l1i.NUM_WAY == 4);
+
+  CACHE& l1d = named("test_L1D");
+  CHECK(l1d.NUM_SET == 64);
+  CHECK(l1d.NUM_WAY == 8);
+  CHECK(l1d.pref_activate_mask == std::vector<access_type>{access_type::LOAD, access_type::PREFETCH});
+
+  CHECK(uut.cpu_view().front().get().ROB_SIZE == 128);
+}
+
+TEST_CASE("A runtime environment must agree with the executable")
+{
+  auto desc = small_description();
+  desc["num_cpus"] = 2;
+  REQUIRE_THROWS_AS(champsim::runtime_environment(desc, test_registry()), std::invalid_argument);
+}
+
+TEST_CASE("A runtime environment must name compiled modules")
+{
+  auto desc = small_description();
+  desc["caches"][0]["replacement"] = {"not_a_replacement"};
+  REQUIRE_THROWS_AS(champsim::runtime_environment(desc, test_registry()), std::invalid_argument);
+}
+
+TEST_CASE("A runtime environment keeps the elements in the order they are described")
+{
+  // Two copies of the small system, with a page table walker for each, all connected directly to DRAM
+  auto desc = small_description();
+  auto channel = desc.at("channels").at(0);
+  desc["channels"] = nlohmann::json::array();
+  for (int i = 0; i < 12; ++i) {
+    desc["channels"].push_back(channel);
+  }
+  desc["dram"]["upper_levels"] = {2, 3, 6, 7, 10, 11};
+
+  auto caches = desc.at("caches");
+  auto cores = desc.at("cores");
+  desc["caches"] = nlohmann::json::array();
+  desc["cores"] = nlohmann::json::array();
+  desc["ptws"] = nlohmann::json::array();
+  for (int cpu = 0; cpu < 2; ++cpu) {
+    const auto name = [cpu](std::string base) { return base + "_" + std::to_string(cpu); };
+    const auto first_channel = 4 * cpu;
+
+    auto l1i = caches.at(0);
+    l1i["name"] = name("test_L1I");
+    l1i["upper_levels"] = {first_channel};
+    l1i["lower_level"] = first_channel + 2;
+    auto l1d = caches.at(1);
+    l1d["name"] = name("test_L1D");
+    l1d["upper_levels"] = {first_channel + 1};
+    l1d["lower_level"] = first_channel + 3;
+    desc["caches"].push_back(l1i);
+    desc["caches"].push_back(l1d);
+
+    auto core = cores.at(0);
+    core["index"] = cpu;
+    core["l1i"] = name("test_L1I");
+    core["l1d"] = name("test_L1D");
+    core["fetch_queues"] = first_channel;
+    core["data_queues"] = first_channel + 1;
+    desc["cores"].push_back(core);
+
+    desc["ptws"].push_back({{"name", name("test_PTW")}, {"cpu", cpu}, {"upper_levels", {8 + cpu}}, {"lower_level", 10 + cpu}});
+  }
+
+  champsim::runtime_environment uut{desc, test_registry()};
+
+  auto cpus = uut.cpu_view();
+  REQUIRE(std::size(cpus) == 2);
+  CHECK(cpus.at(0).get().cpu == 0);
+  CHECK(cpus.at(1).get().cpu == 1);
+
+  std::vector<std::string> cache_names{};
+  for (CACHE& cache : uut.cache_view()) {
+    cache_names.push_back(cache.NAME);
+  }
+  CHECK_THAT(cache_names, Catch::Matchers::Equals(std::vector<std::string>{"test_L1I_0", "test_L1D_0", "test_L1I_1", "test_L1D_1"}));
+
+  std::vector<std::string> ptw_names{};
+  for (PageTableWalker& ptw : uut.ptw_view()) {
+    ptw_names.push_back(ptw.NAME);
+  }
+  CHECK_THAT(ptw_names, Catch::Matchers::Equals(std::vector<std::string>{"test_PTW_0", "test_PTW_1"}));
+
+  // Cores, then caches, then page table walkers, then DRAM
+  auto operables = uut.operable_view();
+  REQUIRE(std::size(operables) == 9);
+  CHECK(&operables.at(0).get() == &cpus.at(0).get());
+  CHECK(&operables.at(1).get() == &cpus.at(1).get());
+  CHECK(&operables.at(2).get() == &uut.cache_view().at(0).get());
+  CHECK(&operables.at(5).get() == &uut.cache_view().at(3).get());
+  CHECK(&operables.at(6).get() == &uut.ptw_view().at(0).get());
+}
+
+TEST_CASE("A loaded runtime environment takes its memory from an arena of its own")
+{
+  const std::string filename{"093-arena-environment.json"};
+  {
+    std::ofstream description_file{filename};
+    description_file << small_description().dump();
+  }
+
+  // A new thread's arena has reserved nothing, so any structure built in it would show
+  std::size_t thread_reserved = 0;
+  std::thread loader{[&] {
+    auto env = champsim::load_runtime_environment(filename, test_registry());
+    thread_reserved = champsim::msl::huge_page_arena::global().reserved();
+  }};
+  loader.join();
+  std::remove(filename.c_str());
+
+  REQUIRE(thread_reserved == 0);
+}
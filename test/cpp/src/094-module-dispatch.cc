@@ -0,0 +1,159 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "instr.h"
+#include "module_registry.h"
+#include "modules.h"
+#include "ooo_cpu.h"
+
+#include <map>
+
+namespace
+{
+  std::map<CACHE*, long> victim_counts;
+  std::map<CACHE*, long> update_counts;
+  std::map<O3_CPU*, long> prediction_counts;
+}
+
+struct dispatch_counting_replacement : champsim::modules::replacement
+{
+  using replacement::replacement;
+
+  long find_victim(uint32_t, uint64_t, long, const CACHE::BLOCK*, champsim::address, champsim::address, access_type)
+  {
+    ++::victim_counts[intern_];
+    return 0;
+  }
+
+  void update_replacement_state(uint32_t, long, long, champsim::address, champsim::address, champsim::address, access_type, bool)
+  {
+    ++::update_counts[intern_];
+  }
+};
+
+struct dispatch_counting_predictor : champsim::modules::branch_predictor
+{
+  using branch_predictor::branch_predictor;
+
+  bool predict_branch(champsim::address)
+  {
+    ++::prediction_counts[intern_];
+    return false;
+  }
+
+  void last_branch_result(champsim::address, champsim::address, bool, uint8_t) {}
+};
+
+SCENARIO("Caches call the same replacement hooks whether their modules are fixed at compile time or selected at run time") {
+  GIVEN("Two caches with the same replacement policy, one selected at run time") {
+    champsim::modules::registry reg{};
+    reg.add_replacement<dispatch_counting_replacement>("dispatch_counting_replacement");
+
+    do_nothing_MRC mock_ll_static, mock_ll_dynamic;
+    to_rq_MRP mock_ul_static, mock_ul_dynamic;
+    auto builder = champsim::cache_builder{champsim::defaults::default_l1d}
+      .sets(1)
+      .ways(2)
+      .hit_latency(1)
+      .fill_latency(1)
+      .offset_bits(champsim::data::bits{});
+
+    CACHE uut_static{champsim::cache_builder{builder}
+      .name("094a-uut-static")
+      .upper_levels({&mock_ul_static.queues})
+      .lower_level(&mock_ll_static.queues)
+      .prefetcher<>()
+      .replacement<dispatch_counting_replacement>()
+    };
+    CACHE uut_dynamic{champsim::cache_builder{builder}
+      .name("094a-uut-dynamic")
+      .upper_levels({&mock_ul_dynamic.queues})
+      .lower_level(&mock_ll_dynamic.queues)
+      .prefetcher<>()
+      .replacement<>(),
+      reg.prefetcher({}), reg.replacement({"dispatch_counting_replacement"})
+    };
+
+    std::array<champsim::operable*, 6> elements{{&mock_ll_static, &mock_ul_static, &uut_static, &mock_ll_dynamic, &mock_ul_dynamic, &uut_dynamic}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("The same sequence of loads is issued to each") {
+      ::victim_counts.clear();
+      ::update_counts.clear();
+
+      for (auto addr : {0xdeadbeef, 0xcafebabe, 0xdeadbeef}) {
+        decltype(mock_ul_static)::request_type test;
+        test.address = champsim::address{addr};
+        test.is_translated = true;
+        test.cpu = 0;
+        test.type = access_type::LOAD;
+        mock_ul_static.issue(test);
+        mock_ul_dynamic.issue(test);
+
+        for (int i = 0; i < 100; ++i) {
+          for (auto elem : elements)
+            elem->_operate();
+        }
+      }
+
+      THEN("Both caches invoke the module equally often") {
+        REQUIRE(::update_counts[&uut_static] > 0);
+        REQUIRE(::update_counts[&uut_dynamic] == ::update_counts[&uut_static]);
+        REQUIRE(::victim_counts[&uut_dynamic] == ::victim_counts[&uut_static]);
+      }
+
+      THEN("Both caches have the same statistics") {
+        REQUIRE(uut_static.sim_stats.hits.total() == uut_dynamic.sim_stats.hits.total());
+        REQUIRE(uut_static.sim_stats.misses.total() == uut_dynamic.sim_stats.misses.total());
+      }
+    }
+  }
+}
+
+SCENARIO("Cores call the same branch predictor whether it is fixed at compile time or selected at run time") {
+  GIVEN("Two cores with the same branch predictor, one selected at run time") {
+    champsim::modules::registry reg{};
+    reg.add_branch_predictor<dispatch_counting_predictor>("dispatch_counting_predictor");
+
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut_static{champsim::core_builder{}
+      .ifetch_buffer_size(3)
+      .fetch_width(champsim::bandwidth::maximum_type{3})
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+      .branch_predictor<dispatch_counting_predictor>()
+    };
+    O3_CPU uut_dynamic{champsim::core_builder{}
+      .ifetch_buffer_size(3)
+      .fetch_width(champsim::bandwidth::maximum_type{3})
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues),
+      reg.branch_predictor({"dispatch_counting_predictor"}), reg.btb({})
+    };
+
+    WHEN("Each core receives the same instructions") {
+      ::prediction_counts.clear();
+
+      for (auto* uut : {&uut_static, &uut_dynamic}) {
+        uut->initialize();
+        for (uint64_t ip : {0xdeadbeef, 0xcafebabe, 0xfeedbeef}) {
+          uut->threads.at(0).input_queue.push_back(champsim::test::instruction_with_ip(ip));
+        }
+        for (int i = 0; i < 10; ++i) {
+          uut->_operate();
+        }
+      }
+
+      THEN("Each instruction is predicted once by each core") {
+        REQUIRE(::prediction_counts[&uut_static] == 3);
+        REQUIRE(::prediction_counts[&uut_dynamic] == 3);
+      }
+    }
+  }
+}
@@ -0,0 +1,256 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+#include "vmem.h"
+#include "dram_controller.h"
+
+namespace {
+ooo_model_instr instruction_of_thread(uint64_t id, std::size_t thread)
+{
+  auto instr = champsim::test::instruction_with_ip(id + 1);
+  instr.instr_id = id;
+  instr.thread = thread;
+  return instr;
+}
+}
+
+SCENARIO("A core with two threads retires the instructions of both") {
+  auto policy = GENERATE(champsim::smt_fetch_policy::round_robin, champsim::smt_fetch_policy::icount);
+  auto partitioning = GENERATE(champsim::smt_partitioning::shared, champsim::smt_partitioning::partitioned);
+
+  GIVEN("A core with two threads") {
+    constexpr std::size_t num_instrs = 20;
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+      .threads(2)
+      .smt_fetch(policy)
+      .smt_partition(partitioning)
+      .ifetch_buffer_size(16)
+      .decode_buffer_size(16)
+      .dispatch_buffer_size(16)
+      .register_file_size(128)
+      .rob_size(16)
+      .lq_size(8)
+      .sq_size(8)
+      .fetch_width(champsim::bandwidth::maximum_type{2})
+      .decode_width(champsim::bandwidth::maximum_type{2})
+      .dispatch_width(champsim::bandwidth::maximum_type{2})
+      .schedule_width(champsim::bandwidth::maximum_type{4})
+      .execute_width(champsim::bandwidth::maximum_type{2})
+      .retire_width(champsim::bandwidth::maximum_type{2})
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_L1I, &mock_L1D}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Each thread is given its own instructions") {
+      for (std::size_t thread = 0; thread < uut.num_threads(); ++thread) {
+        for (uint64_t i = 0; i < num_instrs; ++i) {
+          uut.threads.at(thread).input_queue.push_back(champsim::test::instruction_with_ip(0x1000 * (thread + 1) + 4 * i));
+        }
+      }
+
+      for (int i = 0; i < 1000 && static_cast<std::size_t>(uut.num_retired) < 2 * num_instrs; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+      }
+
+      for (auto elem : elements)
+        elem->end_phase(0);
+
+      THEN("Every instruction of both threads is retired") {
+        REQUIRE(uut.num_retired == 2 * num_instrs);
+        REQUIRE(uut.threads.at(0).num_retired == num_instrs);
+        REQUIRE(uut.threads.at(1).num_retired == num_instrs);
+      }
+
+      THEN("Each thread's instructions are counted in its statistics") {
+        REQUIRE(std::size(uut.sim_stats.threads) == 2);
+        REQUIRE(uut.sim_stats.threads.at(0).instrs() == num_instrs);
+        REQUIRE(uut.sim_stats.threads.at(1).instrs() == num_instrs);
+        REQUIRE(uut.sim_stats.instrs() == 2 * num_instrs);
+      }
+    }
+
+    WHEN("One thread cannot fetch") {
+      for (std::size_t thread = 0; thread < uut.num_threads(); ++thread) {
+        for (uint64_t i = 0; i < num_instrs; ++i) {
+          uut.threads.at(thread).input_queue.push_back(champsim::test::instruction_with_ip(0x1000 * (thread + 1) + 4 * i));
+        }
+      }
+      uut.threads.at(1).fetch_resume_time = champsim::chrono::clock::time_point::max();
+
+      for (int i = 0; i < 1000 && static_cast<std::size_t>(uut.num_retired) < num_instrs; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+      }
+
+      THEN("The other thread fetches and retires all of its instructions") {
+        REQUIRE(uut.threads.at(0).num_retired == num_instrs);
+        REQUIRE(uut.threads.at(1).num_retired == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("The threads of a core have their own address spaces unless the address space is shared") {
+  auto shared_address_space = GENERATE(false, true);
+
+  GIVEN("A core with two threads") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    auto builder = champsim::core_builder{}
+      .threads(2)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues);
+    if (shared_address_space) {
+      builder.set_shared_address_space();
+    }
+    O3_CPU uut{builder};
+
+    MEMORY_CONTROLLER dram{champsim::chrono::picoseconds{3200}, champsim::chrono::picoseconds{6400}, std::size_t{18}, std::size_t{18}, std::size_t{18}, std::size_t{38}, champsim::chrono::microseconds{64000}, {}, 64, 64, 1, champsim::data::bytes{8}, 1024, 1024, 4, 4, 4, 8192};
+    VirtualMemory vmem{champsim::data::bytes{1ull << 12}, 5, std::chrono::nanoseconds{6400}, dram};
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_L1I, &mock_L1D}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Each thread loads from the same virtual address") {
+      const champsim::address vaddr{0xdeadbeef};
+      for (std::size_t thread = 0; thread < uut.num_threads(); ++thread) {
+        uut.threads.at(thread).input_queue.push_back(champsim::test::instruction_with_ip_and_source_memory(champsim::address{0x1000}, vaddr));
+      }
+
+      for (int i = 0; i < 100 && uut.num_retired < 2; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+      }
+
+      THEN("The loads translate to different physical pages only if the address space is not shared") {
+        REQUIRE(uut.num_retired == 2);
+        REQUIRE(std::size(mock_L1D.addresses) == 2);
+        auto [ppage_a, delay_a] = vmem.va_to_pa(0, champsim::page_number{mock_L1D.addresses.at(0)});
+        auto [ppage_b, delay_b] = vmem.va_to_pa(0, champsim::page_number{mock_L1D.addresses.at(1)});
+        if (shared_address_space) {
+          REQUIRE(ppage_a == ppage_b);
+        } else {
+          REQUIRE(ppage_a != ppage_b);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A partitioned reorder buffer limits each thread to its share") {
+  auto partitioning = GENERATE(champsim::smt_partitioning::shared, champsim::smt_partitioning::partitioned);
+
+  GIVEN("A core with two threads and a small reorder buffer") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+      .threads(2)
+      .smt_partition(partitioning)
+      .rob_size(4)
+      .dispatch_width(champsim::bandwidth::maximum_type{4})
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.warmup = false;
+
+    WHEN("One thread has more instructions to dispatch than its share") {
+      for (uint64_t id = 0; id < 4; ++id) {
+        uut.DISPATCH_BUFFER.push_back(instruction_of_thread(id, 0));
+      }
+      uut.dispatch_instruction();
+
+      THEN("It fills only its share of a partitioned reorder buffer") {
+        if (partitioning == champsim::smt_partitioning::partitioned) {
+          REQUIRE(std::size(uut.ROB) == 2);
+          REQUIRE(std::size(uut.DISPATCH_BUFFER) == 2);
+        } else {
+          REQUIRE(std::size(uut.ROB) == 4);
+          REQUIRE(std::empty(uut.DISPATCH_BUFFER));
+        }
+      }
+
+      AND_WHEN("The other thread dispatches behind the stalled instructions") {
+        uut.DISPATCH_BUFFER.push_back(instruction_of_thread(4, 1));
+        uut.dispatch_instruction();
+
+        THEN("It passes them only if the reorder buffer is partitioned") {
+          if (partitioning == champsim::smt_partitioning::partitioned) {
+            REQUIRE(std::size(uut.ROB) == 3);
+            REQUIRE(uut.ROB.back().thread == 1);
+            REQUIRE(std::size(uut.DISPATCH_BUFFER) == 2);
+            REQUIRE(std::all_of(std::begin(uut.DISPATCH_BUFFER), std::end(uut.DISPATCH_BUFFER), [](const auto& x) { return x.thread == 0; }));
+          } else {
+            REQUIRE(std::size(uut.ROB) == 4);
+            REQUIRE(std::size(uut.DISPATCH_BUFFER) == 1);
+          }
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A thread retires even if another thread's oldest instruction has not completed") {
+  GIVEN("A reorder buffer with an incomplete instruction ahead of a complete one of another thread") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+      .threads(2)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    uut.ROB.push_back(instruction_of_thread(0, 0));
+    uut.ROB.push_back(instruction_of_thread(1, 1));
+    uut.ROB.back().completed = true;
+
+    WHEN("The core retires") {
+      auto retired = uut.retire_rob();
+
+      THEN("Only the complete instruction is retired") {
+        REQUIRE(retired == 1);
+        REQUIRE(std::size(uut.ROB) == 1);
+        REQUIRE(uut.ROB.front().thread == 0);
+        REQUIRE(uut.threads.at(0).num_retired == 0);
+        REQUIRE(uut.threads.at(1).num_retired == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("Partitioned physical registers are divided among the threads") {
+  GIVEN("A register allocator for two threads") {
+    auto partitioned = GENERATE(false, true);
+    RegisterAllocator ra{8, 2, partitioned};
+
+    WHEN("One thread renames four registers") {
+      for (int16_t reg = 1; reg <= 4; ++reg) {
+        ra.rename_dest_register(reg, static_cast<uint64_t>(reg), 0);
+      }
+
+      THEN("The other thread keeps its share only if the registers are partitioned") {
+        REQUIRE(ra.count_free_registers(1) == 4);
+        if (partitioned) {
+          REQUIRE(ra.count_free_registers(0) == 0);
+        } else {
+          REQUIRE(ra.count_free_registers(0) == 4);
+        }
+      }
+
+      THEN("The threads rename through separate tables") {
+        REQUIRE(ra.isAllocated(1, 0));
+        REQUIRE_FALSE(ra.isAllocated(1, 1));
+      }
+    }
+  }
+}
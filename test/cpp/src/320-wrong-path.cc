@@ -0,0 +1,135 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("A core fetches down the wrong path of a mispredicted branch") {
+  auto wrong_path = GENERATE(false, true);
+
+  GIVEN("A core that does not predict taken branches") {
+    constexpr std::size_t num_instrs = 10;
+    do_nothing_MRC mock_L1I{2}, mock_L1D;
+
+    // The core calls the branch hook of its L1I's prefetcher, which must exist even though the mock serves the fetches
+    champsim::channel unused_queues{};
+    CACHE branch_hook{champsim::cache_builder{champsim::defaults::default_l1i}.name("320-L1I").upper_levels({&unused_queues}).lower_level(&unused_queues)};
+
+    auto builder = champsim::core_builder{}
+      .ifetch_buffer_size(16)
+      .decode_buffer_size(16)
+      .dispatch_buffer_size(16)
+      .register_file_size(128)
+      .rob_size(16)
+      .lq_size(8)
+      .sq_size(8)
+      .fetch_width(champsim::bandwidth::maximum_type{2})
+      .decode_width(champsim::bandwidth::maximum_type{2})
+      .dispatch_width(champsim::bandwidth::maximum_type{2})
+      .schedule_width(champsim::bandwidth::maximum_type{4})
+      .execute_width(champsim::bandwidth::maximum_type{2})
+      .retire_width(champsim::bandwidth::maximum_type{2})
+      .decode_latency(2)
+      .mispredict_penalty(1)
+      .l1i(&branch_hook)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues);
+    if (wrong_path)
+      builder.set_wrong_path();
+    O3_CPU uut{builder};
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_L1I, &mock_L1D}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A taken branch at the end of a block is followed by instructions at its target") {
+      auto branch = champsim::test::branch_instruction_with_ip(0x103c);
+      branch.branch_target = champsim::address{0x2000};
+      uut.threads.at(0).input_queue.push_back(branch);
+      for (uint64_t i = 0; i < num_instrs; ++i) {
+        uut.threads.at(0).input_queue.push_back(champsim::test::instruction_with_ip(0x2000 + 4 * i));
+        uut.threads.at(0).input_queue.back().instr_id = i + 1;
+      }
+
+      for (int i = 0; i < 1000 && static_cast<std::size_t>(uut.num_retired) < num_instrs + 1; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+      }
+
+      THEN("Only the instructions of the trace are retired") {
+        REQUIRE(uut.num_retired == num_instrs + 1);
+        REQUIRE(std::empty(uut.ROB));
+      }
+
+      THEN("The block that follows the branch is fetched only down the wrong path") {
+        auto fetched_next_block = std::any_of(std::begin(mock_L1I.addresses), std::end(mock_L1I.addresses),
+                                              [](auto addr) { return champsim::block_number{addr} == champsim::block_number{champsim::address{0x1040}}; });
+        REQUIRE(fetched_next_block == wrong_path);
+        if (wrong_path) {
+          REQUIRE(uut.sim_stats.wrong_path_fetched > 0);
+        } else {
+          REQUIRE(uut.sim_stats.wrong_path_fetched == 0);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Squashing the wrong path recovers the reorder buffer, load and store queues, and rename table") {
+  GIVEN("A reorder buffer with two instructions that write the same register, the second of which also loads and stores") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+      .set_wrong_path()
+      .register_file_size(16)
+      .rob_size(4)
+      .lq_size(2)
+      .sq_size(2)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.warmup = false;
+
+    auto kept = champsim::test::instruction_with_registers(5);
+    kept.instr_id = 1;
+    uut.ROB.push_back(kept);
+    uut.do_scheduling(uut.ROB.back());
+    auto free_registers = uut.reg_allocator.count_free_registers();
+
+    auto squashed = champsim::test::instruction_with_registers(5);
+    squashed.instr_id = 2;
+    squashed.source_memory.push_back(champsim::address{0xdeadbeef});
+    squashed.destination_memory.push_back(champsim::address{0xcafebabe});
+    squashed.wrong_path = true;
+    uut.ROB.push_back(squashed);
+    uut.do_memory_scheduling(uut.ROB.back());
+    uut.do_scheduling(uut.ROB.back());
+
+    WHEN("The instructions after the first are squashed") {
+      uut.do_squash(0, 1);
+
+      THEN("Only the first instruction remains") {
+        REQUIRE(std::size(uut.ROB) == 1);
+        REQUIRE(uut.ROB.front().instr_id == 1);
+      }
+
+      THEN("The load and store queues are empty") {
+        REQUIRE(std::none_of(std::begin(uut.LQ), std::end(uut.LQ), [](const auto& x) { return x.has_value(); }));
+        REQUIRE(std::empty(uut.SQ));
+      }
+
+      THEN("The squashed register is freed, and the register is renamed to the first instruction's") {
+        REQUIRE(uut.reg_allocator.count_free_registers() == free_registers);
+
+        auto next = champsim::test::instruction_with_registers(5);
+        next.instr_id = 3;
+        uut.ROB.push_back(next);
+        uut.do_scheduling(uut.ROB.back());
+        REQUIRE(uut.ROB.back().source_registers.at(0) == uut.ROB.front().destination_registers.at(0));
+      }
+    }
+  }
+}
@@ -0,0 +1,167 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("A fetch target queue lets the branch predictor run ahead of fetch") {
+  auto ftq_size = GENERATE(std::size_t{0}, std::size_t{8});
+
+  GIVEN("A core with a small fetch buffer") {
+    constexpr std::size_t num_instrs = 64;
+    do_nothing_MRC mock_L1I{10}, mock_L1D;
+
+    // The fetch-directed prefetches are sent to the L1I, which is not operated so that its queue can be inspected
+    champsim::channel unused_queues{};
+    CACHE l1i{champsim::cache_builder{champsim::defaults::default_l1i}.name("330-L1I").upper_levels({&unused_queues}).lower_level(&unused_queues)};
+
+    O3_CPU uut{champsim::core_builder{}
+      .ftq_size(ftq_size)
+      .runahead_width(champsim::bandwidth::maximum_type{2})
+      .ifetch_buffer_size(4)
+      .decode_buffer_size(16)
+      .dispatch_buffer_size(16)
+      .register_file_size(128)
+      .rob_size(16)
+      .lq_size(8)
+      .sq_size(8)
+      .fetch_width(champsim::bandwidth::maximum_type{2})
+      .decode_width(champsim::bandwidth::maximum_type{2})
+      .dispatch_width(champsim::bandwidth::maximum_type{2})
+      .schedule_width(champsim::bandwidth::maximum_type{4})
+      .execute_width(champsim::bandwidth::maximum_type{2})
+      .retire_width(champsim::bandwidth::maximum_type{2})
+      .l1i(&l1i)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_L1I, &mock_L1D}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("The core runs instructions that span several blocks") {
+      for (uint64_t i = 0; i < num_instrs; ++i) {
+        uut.threads.at(0).input_queue.push_back(champsim::test::instruction_with_ip(0x1000 + 4 * i));
+        uut.threads.at(0).input_queue.back().instr_id = i;
+      }
+
+      std::size_t max_ftq_occupancy = 0;
+      for (int i = 0; i < 2000 && static_cast<std::size_t>(uut.num_retired) < num_instrs; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+        max_ftq_occupancy = std::max(max_ftq_occupancy, std::size(uut.FTQ));
+      }
+
+      THEN("Every instruction is retired") {
+        REQUIRE(uut.num_retired == num_instrs);
+      }
+
+      THEN("The fetch target queue holds no more than its size") {
+        REQUIRE(max_ftq_occupancy <= ftq_size);
+      }
+
+      THEN("The blocks ahead of fetch are prefetched only if there is a fetch target queue") {
+        if (ftq_size > 0) {
+          REQUIRE(l1i.sim_stats.pf_requested > 0);
+        } else {
+          REQUIRE(l1i.sim_stats.pf_requested == 0);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Fetch targets end at the end of a block") {
+  GIVEN("A core with a fetch target queue of two targets") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    champsim::channel unused_queues{};
+    CACHE l1i{champsim::cache_builder{champsim::defaults::default_l1i}.name("330-L1I-b").upper_levels({&unused_queues}).lower_level(&unused_queues)};
+    O3_CPU uut{champsim::core_builder{}
+      .ftq_size(2)
+      .runahead_width(champsim::bandwidth::maximum_type{4})
+      .l1i(&l1i)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    WHEN("Instructions from three blocks are queued") {
+      champsim::bandwidth bw{champsim::bandwidth::maximum_type{4}};
+      for (uint64_t ip : {0x1000, 0x1004, 0x1040, 0x1044}) {
+        REQUIRE(uut.can_enqueue_fetch(0, champsim::address{ip}, bw));
+        uut.do_enqueue_fetch(champsim::test::instruction_with_ip(ip), false, bw);
+      }
+
+      THEN("The instructions of each block share a target, and the third block does not fit") {
+        REQUIRE(std::size(uut.FTQ) == 2);
+        REQUIRE(std::size(uut.FTQ.front().instrs) == 2);
+        REQUIRE(std::size(uut.FTQ.back().instrs) == 2);
+        REQUIRE(uut.can_enqueue_fetch(0, champsim::address{0x1048}, bw));
+        REQUIRE_FALSE(uut.can_enqueue_fetch(0, champsim::address{0x1080}, bw));
+      }
+
+      THEN("Only the block that waits behind another is prefetched") {
+        REQUIRE(l1i.sim_stats.pf_requested == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("Fetch-directed prefetches are made in the address space of the thread") {
+  auto shared = GENERATE(false, true);
+  GIVEN("A core with two threads and a fetch target queue") {
+    do_nothing_MRC mock_L1I, mock_L1D, mock_ll, mock_lt;
+    champsim::channel unused_queues{};
+    CACHE l1i{champsim::cache_builder{champsim::defaults::default_l1i}
+      .name(std::string{"330-L1I-smt-"} + (shared ? "shared" : "private"))
+      .upper_levels({&unused_queues})
+      .lower_level(&mock_ll.queues)
+      .lower_translate(&mock_lt.queues)
+    };
+    auto builder = champsim::core_builder{}
+      .threads(2)
+      .ftq_size(2)
+      .runahead_width(champsim::bandwidth::maximum_type{4})
+      .l1i(&l1i)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues);
+    if (shared) {
+      builder.set_shared_address_space();
+    }
+    O3_CPU uut{builder};
+
+    std::array<champsim::operable*, 3> elements{{&l1i, &mock_ll, &mock_lt}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("The second thread queues instructions from two blocks") {
+      champsim::bandwidth bw{champsim::bandwidth::maximum_type{4}};
+      for (uint64_t ip : {0x1000, 0x1040}) {
+        auto instr = champsim::test::instruction_with_ip(ip);
+        instr.thread = 1;
+        uut.do_enqueue_fetch(std::move(instr), false, bw);
+      }
+
+      for (int i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The block behind the first is translated in the thread's address space") {
+        const auto expected = shared ? champsim::address{0x1040} : uut.thread_address(champsim::address{0x1040}, 1);
+        REQUIRE(std::any_of(std::begin(mock_lt.addresses), std::end(mock_lt.addresses),
+              [expected](auto addr){ return champsim::block_number{addr} == champsim::block_number{expected}; }));
+        if (!shared) {
+          REQUIRE(std::none_of(std::begin(mock_lt.addresses), std::end(mock_lt.addresses),
+                [](auto addr){ return champsim::block_number{addr} == champsim::block_number{champsim::address{0x1040}}; }));
+        }
+      }
+    }
+  }
+}
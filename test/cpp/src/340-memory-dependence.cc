@@ -0,0 +1,157 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+namespace {
+/*
+ * A slow load produces the address register of a store, and a younger load reads the store's address.
+ * The younger load has no register dependences, so it is ready to issue long before the store executes.
+ */
+std::array<ooo_model_instr, 3> aliasing_sequence(uint64_t first_id)
+{
+  auto producer = champsim::test::instruction_with_ip_and_source_memory(champsim::address{0x1000}, champsim::address{0xdead0000});
+  producer.destination_registers.push_back(1);
+
+  auto store = champsim::test::instruction_with_ip(0x1004);
+  store.source_registers.push_back(1);
+  store.destination_memory.push_back(champsim::address{0xcafe0000});
+
+  auto load = champsim::test::instruction_with_ip_and_source_memory(champsim::address{0x1008}, champsim::address{0xcafe0000});
+  load.destination_registers.push_back(2);
+
+  std::array<ooo_model_instr, 3> retval{{producer, store, load}};
+  for (auto& instr : retval) {
+    instr.instr_id = first_id++;
+  }
+  return retval;
+}
+}
+
+SCENARIO("A store set holds a load until the store it depends on executes") {
+  GIVEN("An empty store-set predictor") {
+    champsim::store_set_predictor uut{64, 8, 0};
+    champsim::address load_ip{0x1008}, store_ip{0x1004};
+
+    THEN("A load does not wait for any store") {
+      REQUIRE_FALSE(uut.dispatch_load(load_ip).has_value());
+      REQUIRE_FALSE(uut.set_of(load_ip).has_value());
+    }
+
+    WHEN("A load and a store violate memory order") {
+      uut.violation(load_ip, store_ip);
+
+      THEN("They are placed in the same set") {
+        REQUIRE(uut.set_of(load_ip).has_value());
+        REQUIRE(uut.set_of(load_ip) == uut.set_of(store_ip));
+      }
+
+      AND_WHEN("The store is dispatched") {
+        uut.dispatch_store(store_ip, 5);
+
+        THEN("The load waits for it") {
+          REQUIRE(uut.dispatch_load(load_ip) == 5);
+        }
+
+        AND_WHEN("The store executes") {
+          uut.execute_store(store_ip, 5);
+
+          THEN("The load no longer waits") {
+            REQUIRE_FALSE(uut.dispatch_load(load_ip).has_value());
+          }
+        }
+      }
+    }
+  }
+
+  GIVEN("A store-set predictor that is cleared after every two lookups") {
+    champsim::store_set_predictor uut{64, 8, 2};
+    uut.violation(champsim::address{0x1008}, champsim::address{0x1004});
+
+    WHEN("Two lookups are made") {
+      uut.dispatch_store(champsim::address{0x1004}, 5);
+      uut.dispatch_store(champsim::address{0x1004}, 6);
+
+      THEN("The sets are forgotten") {
+        REQUIRE_FALSE(uut.set_of(champsim::address{0x1008}).has_value());
+        REQUIRE_FALSE(uut.set_of(champsim::address{0x1004}).has_value());
+      }
+    }
+  }
+}
+
+SCENARIO("A load that issues ahead of an aliasing store is replayed") {
+  auto policy = GENERATE(champsim::memory_dependence_policy::oracle, champsim::memory_dependence_policy::wait_all,
+                         champsim::memory_dependence_policy::store_sets);
+
+  GIVEN("A core with a slow data cache") {
+    do_nothing_MRC mock_L1I, mock_L1D{20};
+    O3_CPU uut{champsim::core_builder{}
+      .memory_dependence(policy)
+      .ifetch_buffer_size(16)
+      .decode_buffer_size(16)
+      .dispatch_buffer_size(16)
+      .register_file_size(128)
+      .rob_size(16)
+      .lq_size(8)
+      .sq_size(8)
+      .fetch_width(champsim::bandwidth::maximum_type{4})
+      .decode_width(champsim::bandwidth::maximum_type{4})
+      .dispatch_width(champsim::bandwidth::maximum_type{4})
+      .schedule_width(champsim::bandwidth::maximum_type{4})
+      .execute_width(champsim::bandwidth::maximum_type{4})
+      .lq_width(champsim::bandwidth::maximum_type{2})
+      .sq_width(champsim::bandwidth::maximum_type{2})
+      .retire_width(champsim::bandwidth::maximum_type{4})
+      .mispredict_penalty(1)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_L1I, &mock_L1D}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    auto run_sequence = [&](uint64_t first_id) {
+      auto target = uut.num_retired + 3;
+      for (auto& instr : aliasing_sequence(first_id)) {
+        uut.threads.at(0).input_queue.push_back(instr);
+      }
+      for (int i = 0; i < 1000 && uut.num_retired < target; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+      }
+    };
+
+    WHEN("The sequence runs") {
+      run_sequence(0);
+
+      THEN("Every instruction is retired") {
+        REQUIRE(uut.num_retired == 3);
+      }
+
+      THEN("Only the store-set predictor, which has not yet learned the dependence, violates memory order") {
+        if (policy == champsim::memory_dependence_policy::store_sets) {
+          REQUIRE(uut.sim_stats.memory_order_violations == 1);
+          REQUIRE(uut.sim_stats.memory_order_replayed > 0);
+        } else {
+          REQUIRE(uut.sim_stats.memory_order_violations == 0);
+          REQUIRE(uut.sim_stats.memory_order_replayed == 0);
+        }
+      }
+
+      AND_WHEN("The sequence runs again") {
+        auto violations = uut.sim_stats.memory_order_violations;
+        run_sequence(3);
+
+        THEN("The load waits for the store, and memory order is not violated again") {
+          REQUIRE(uut.num_retired == 6);
+          REQUIRE(uut.sim_stats.memory_order_violations == violations);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,98 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("Instructions are classified by their operands") {
+  GIVEN("A core whose floating-point registers are numbered 32 through 63") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+      .fp_registers(32, 63)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    WHEN("Instructions of each kind are initialized") {
+      auto alu = champsim::test::instruction_with_registers(5);
+      auto fp = champsim::test::instruction_with_registers(40);
+      auto load = champsim::test::instruction_with_ip_and_source_memory(champsim::address{0x1000}, champsim::address{0xcafe0000});
+      auto store = champsim::test::instruction_with_registers(40);
+      store.destination_memory.push_back(champsim::address{0xcafe0000});
+      auto branch = champsim::test::branch_instruction_with_ip(0x1000);
+
+      for (auto* instr : {&alu, &fp, &load, &store, &branch}) {
+        uut.do_init_instruction(*instr);
+      }
+
+      THEN("Each is given its class") {
+        REQUIRE(alu.op == champsim::op_class::alu);
+        REQUIRE(fp.op == champsim::op_class::fp);
+        REQUIRE(load.op == champsim::op_class::load);
+        REQUIRE(store.op == champsim::op_class::store);
+        REQUIRE(branch.op == champsim::op_class::branch);
+      }
+    }
+  }
+}
+
+SCENARIO("A non-pipelined execution port accepts one instruction at a time") {
+  auto pipelined = GENERATE(true, false);
+
+  GIVEN("A core with a single port of latency 4") {
+    constexpr std::size_t num_instrs = 8;
+    constexpr unsigned latency = 4;
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{champsim::core_builder{}
+      .execution_ports({champsim::execution_port{"alu", 1, {champsim::op_class::alu}, latency, pipelined}})
+      .ifetch_buffer_size(16)
+      .decode_buffer_size(16)
+      .dispatch_buffer_size(16)
+      .register_file_size(128)
+      .rob_size(16)
+      .fetch_width(champsim::bandwidth::maximum_type{4})
+      .decode_width(champsim::bandwidth::maximum_type{4})
+      .dispatch_width(champsim::bandwidth::maximum_type{4})
+      .schedule_width(champsim::bandwidth::maximum_type{4})
+      .execute_width(champsim::bandwidth::maximum_type{4})
+      .retire_width(champsim::bandwidth::maximum_type{4})
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_L1I, &mock_L1D}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Independent instructions are executed") {
+      for (uint64_t i = 0; i < num_instrs; ++i) {
+        uut.threads.at(0).input_queue.push_back(champsim::test::instruction_with_ip(0x1000 + 4 * i));
+        uut.threads.at(0).input_queue.back().instr_id = i;
+      }
+
+      for (int i = 0; i < 1000 && static_cast<std::size_t>(uut.num_retired) < num_instrs; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+      }
+
+      THEN("Every instruction issues to the port") {
+        REQUIRE(uut.num_retired == num_instrs);
+        REQUIRE(std::size(uut.sim_stats.ports) == 1);
+        REQUIRE(uut.sim_stats.ports.at(0).name == "alu");
+        REQUIRE(uut.sim_stats.ports.at(0).issued == num_instrs);
+      }
+
+      THEN("The port is busy for one cycle for each instruction if pipelined, and for its latency otherwise") {
+        REQUIRE(uut.sim_stats.ports.at(0).busy_cycles == num_instrs * (pipelined ? 1 : latency));
+      }
+
+      THEN("Instructions wait for a port that is not pipelined") {
+        if (!pipelined) {
+          REQUIRE(uut.sim_stats.ports.at(0).conflicts > 0);
+        }
+      }
+    }
+  }
+}
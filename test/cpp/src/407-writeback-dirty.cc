@@ -102,3 +102,57 @@ SCENARIO("Blocks that have been written are marked dirty") {
     }
   }
 }
+
+SCENARIO("Without coherence, a fill replaces a victim even if its block was written while it was in flight") {
+  GIVEN("An empty cache with one block") {
+    constexpr uint64_t hit_latency = 4;
+    constexpr uint64_t fill_latency = 3;
+    constexpr int lower_latency = 20;
+    do_nothing_MRC mock_ll{lower_latency};
+    to_wq_MRP mock_ul_write;
+    to_rq_MRP mock_ul_read;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+      .name("407-uut-refill")
+      .sets(1)
+      .ways(1)
+      .upper_levels({{&mock_ul_write.queues, &mock_ul_read.queues}})
+      .lower_level(&mock_ll.queues)
+      .hit_latency(hit_latency)
+      .fill_latency(fill_latency)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&uut, &mock_ll, &mock_ul_write, &mock_ul_read}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A block is read, and then written before the read returns") {
+      decltype(mock_ul_read)::request_type read;
+      read.address = champsim::address{0xdeadbeef};
+      read.cpu = 0;
+      read.type = access_type::LOAD;
+      read.instr_id = 1;
+      REQUIRE(mock_ul_read.issue(read));
+
+      for (uint64_t i = 0; i < hit_latency + 2; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      auto write = read;
+      write.type = access_type::WRITE;
+      write.instr_id = 2;
+      REQUIRE(mock_ul_write.issue(write));
+
+      for (auto i = 0; i < 2 * lower_latency; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The read fill evicts the written block, and writes it back") {
+        REQUIRE_THAT(mock_ll.addresses, Catch::Matchers::RangeEquals(std::array{read.address, write.address}));
+      }
+    }
+  }
+}
@@ -0,0 +1,342 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+namespace {
+bool holds(const CACHE& cache, champsim::address addr)
+{
+  return std::any_of(std::begin(cache.block), std::end(cache.block), [match = champsim::block_number{addr}](const auto& blk) {
+    return blk.valid && champsim::block_number{blk.address} == match;
+  });
+}
+
+bool holds_dirty(const CACHE& cache, champsim::address addr)
+{
+  return std::any_of(std::begin(cache.block), std::end(cache.block), [match = champsim::block_number{addr}](const auto& blk) {
+    return blk.valid && blk.dirty && champsim::block_number{blk.address} == match;
+  });
+}
+}
+
+SCENARIO("An inclusive cache removes the blocks it evicts from its upper levels") {
+  auto [policy, str] = GENERATE(table<champsim::inclusion_policy, std::string_view>({
+      {champsim::inclusion_policy::nine, "409a-"},
+      {champsim::inclusion_policy::inclusive, "409b-"}
+  }));
+
+  GIVEN("A large upper level above a cache with a single block") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    champsim::channel middle{};
+    CACHE upper{champsim::cache_builder{champsim::defaults::default_l2c}
+      .name(std::string{str} + "upper")
+      .sets(1)
+      .ways(4)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&middle)
+    };
+    CACHE lower{champsim::cache_builder{champsim::defaults::default_llc}
+      .name(std::string{str} + "lower")
+      .sets(1)
+      .ways(1)
+      .inclusion(policy)
+      .upper_levels({&middle})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&upper, &lower, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Two blocks are read") {
+      typename to_rq_MRP::request_type first;
+      first.address = champsim::address{0xdeadbeef};
+      first.cpu = 0;
+      first.instr_id = 1;
+      mock_ul.issue(first);
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      auto second = first;
+      second.address = champsim::address{0xcafebabe};
+      second.instr_id = 2;
+      mock_ul.issue(second);
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("Both reads are returned") {
+        REQUIRE(std::size(mock_ul.packets) == 2);
+        REQUIRE(mock_ul.packets.at(0).return_time > 0);
+        REQUIRE(mock_ul.packets.at(1).return_time > 0);
+      }
+
+      THEN("The lower level holds only the second block") {
+        REQUIRE_FALSE(holds(lower, first.address));
+        REQUIRE(holds(lower, second.address));
+      }
+
+      THEN("The upper level holds the first block only if the lower level is not inclusive") {
+        REQUIRE(holds(upper, second.address));
+        if (policy == champsim::inclusion_policy::inclusive) {
+          REQUIRE_FALSE(holds(upper, first.address));
+          REQUIRE(upper.sim_stats.back_invalidations == 1);
+        } else {
+          REQUIRE(holds(upper, first.address));
+          REQUIRE(upper.sim_stats.back_invalidations == 0);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A back-invalidated dirty block is written back") {
+  GIVEN("A large upper level above an inclusive cache with a single block") {
+    do_nothing_MRC mock_ll;
+    to_wq_MRP mock_ul_write;
+    to_rq_MRP mock_ul_read;
+    champsim::channel middle{};
+    CACHE upper{champsim::cache_builder{champsim::defaults::default_l2c}
+      .name("409c-upper")
+      .sets(1)
+      .ways(4)
+      .upper_levels({&mock_ul_write.queues, &mock_ul_read.queues})
+      .lower_level(&middle)
+    };
+    CACHE lower{champsim::cache_builder{champsim::defaults::default_llc}
+      .name("409c-lower")
+      .sets(1)
+      .ways(1)
+      .inclusion(champsim::inclusion_policy::inclusive)
+      .upper_levels({&middle})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 5> elements{{&upper, &lower, &mock_ll, &mock_ul_write, &mock_ul_read}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A block is read and then written, and another block is read") {
+      typename to_rq_MRP::request_type first;
+      first.address = champsim::address{0xdeadbeef};
+      first.cpu = 0;
+      first.instr_id = 1;
+      mock_ul_read.issue(first);
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      auto write = first;
+      write.type = access_type::WRITE;
+      write.response_requested = false;
+      mock_ul_write.issue(write);
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      REQUIRE(holds_dirty(upper, first.address));
+
+      auto second = first;
+      second.address = champsim::address{0xcafebabe};
+      second.instr_id = 2;
+      mock_ul_read.issue(second);
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The upper level gives up the block and writes it back") {
+        REQUIRE_FALSE(holds(upper, first.address));
+        REQUIRE(upper.sim_stats.back_invalidations == 1);
+      }
+
+      THEN("The writeback passes through the lower level without evicting its block") {
+        REQUIRE(holds(lower, second.address));
+        REQUIRE_FALSE(holds(lower, first.address));
+        REQUIRE_THAT(mock_ll.addresses, Catch::Matchers::RangeEquals(std::array{first.address, second.address, first.address}));
+      }
+    }
+  }
+}
+
+SCENARIO("An exclusive cache holds the victims of its upper levels") {
+  GIVEN("An upper level with a single block above an exclusive cache") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    champsim::channel middle{};
+    CACHE upper{champsim::cache_builder{champsim::defaults::default_l2c}
+      .name("409d-upper")
+      .sets(1)
+      .ways(1)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&middle)
+    };
+    CACHE lower{champsim::cache_builder{champsim::defaults::default_llc}
+      .name("409d-lower")
+      .sets(1)
+      .ways(4)
+      .inclusion(champsim::inclusion_policy::exclusive)
+      .upper_levels({&middle})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&upper, &lower, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    typename to_rq_MRP::request_type first;
+    first.address = champsim::address{0xdeadbeef};
+    first.cpu = 0;
+    first.instr_id = 1;
+
+    auto second = first;
+    second.address = champsim::address{0xcafebabe};
+    second.instr_id = 2;
+
+    WHEN("A block is read") {
+      mock_ul.issue(first);
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("Only the upper level holds it") {
+        REQUIRE(mock_ul.packets.at(0).return_time > 0);
+        REQUIRE(holds(upper, first.address));
+        REQUIRE_FALSE(holds(lower, first.address));
+      }
+
+      AND_WHEN("Another block is read") {
+        mock_ul.issue(second);
+
+        for (auto i = 0; i < 100; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("The clean victim of the upper level fills the lower level without becoming dirty") {
+          REQUIRE(holds(upper, second.address));
+          REQUIRE(holds(lower, first.address));
+          REQUIRE_FALSE(holds_dirty(lower, first.address));
+          REQUIRE_FALSE(holds(lower, second.address));
+        }
+
+        AND_WHEN("The first block is read again") {
+          auto again = first;
+          again.instr_id = 3;
+          mock_ul.issue(again);
+
+          for (auto i = 0; i < 100; ++i)
+            for (auto elem : elements)
+              elem->_operate();
+
+          THEN("It is returned from the lower level, which gives it up") {
+            REQUIRE(mock_ul.packets.at(2).return_time > 0);
+            REQUIRE(lower.sim_stats.hits.value_or(std::pair{access_type::LOAD, 0}, 0) == 1);
+            REQUIRE(holds(upper, first.address));
+            REQUIRE_FALSE(holds(lower, first.address));
+            REQUIRE(holds(lower, second.address));
+          }
+
+          THEN("No clean block is written to memory") {
+            REQUIRE_THAT(mock_ll.addresses, Catch::Matchers::RangeEquals(std::array{first.address, second.address}));
+          }
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("An exclusive cache gives up a dirty block only once its writeback is accepted") {
+  GIVEN("An exclusive cache that holds a dirty block, above a full write queue") {
+    to_wq_MRP mock_ul_write;
+    to_rq_MRP mock_ul_read;
+    champsim::channel lower_queues{32, 32, 1, champsim::data::bits{LOG2_BLOCK_SIZE}, false};
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_llc}
+      .name("409e-uut")
+      .sets(1)
+      .ways(4)
+      .inclusion(champsim::inclusion_policy::exclusive)
+      .upper_levels({&mock_ul_write.queues, &mock_ul_read.queues})
+      .lower_level(&lower_queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ul_write, &mock_ul_read}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    typename to_wq_MRP::request_type write;
+    write.address = champsim::address{0xdeadbeef};
+    write.cpu = 0;
+    write.instr_id = 1;
+    write.type = access_type::WRITE;
+    write.response_requested = false;
+    mock_ul_write.issue(write);
+
+    for (auto i = 0; i < 100; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+
+    REQUIRE(holds_dirty(uut, write.address));
+
+    typename champsim::channel::request_type filler;
+    filler.address = champsim::address{0xcafebabe};
+    filler.type = access_type::WRITE;
+    REQUIRE(lower_queues.add_wq(filler));
+
+    WHEN("The block is read") {
+      typename to_rq_MRP::request_type read;
+      read.address = write.address;
+      read.cpu = 0;
+      read.instr_id = 2;
+      mock_ul_read.issue(read);
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The read waits, and the block stays in the cache") {
+        REQUIRE(mock_ul_read.packets.at(0).return_time == 0);
+        REQUIRE(holds_dirty(uut, write.address));
+        REQUIRE(std::empty(lower_queues.RQ));
+        REQUIRE(std::size(lower_queues.WQ) == 1);
+      }
+
+      AND_WHEN("The write queue drains") {
+        lower_queues.WQ.clear();
+
+        for (auto i = 0; i < 100; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("The block is written back, then given up to the reader") {
+          REQUIRE(mock_ul_read.packets.at(0).return_time > 0);
+          REQUIRE_FALSE(holds(uut, write.address));
+          REQUIRE(std::size(lower_queues.WQ) == 1);
+          REQUIRE(champsim::block_number{lower_queues.WQ.front().address} == champsim::block_number{write.address});
+        }
+      }
+    }
+  }
+}
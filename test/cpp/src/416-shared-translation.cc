@@ -0,0 +1,68 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "channel.h"
+
+SCENARIO("Packets on the same virtual page are restarted by a single translation") {
+  GIVEN("An empty cache with a slow translator") {
+    constexpr auto hit_latency = 2;
+    constexpr auto fill_latency = 1;
+    constexpr auto translation_latency = 50;
+    do_nothing_MRC mock_translator{translation_latency};
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul{[](auto x, auto y){ return x.v_address == y.v_address; }};
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l1d}
+      .name("416a-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .lower_translate(&mock_translator.queues)
+      .hit_latency(hit_latency)
+      .fill_latency(fill_latency)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&uut, &mock_ll, &mock_ul, &mock_translator}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Two packets on the same page are sent several cycles apart") {
+      typename to_rq_MRP::request_type first;
+      first.address = champsim::address{0xdeadbeef};
+      first.v_address = champsim::address{0xdeadbeef};
+      first.is_translated = false;
+      first.cpu = 0;
+
+      auto second = first;
+      second.address = champsim::address{0xdeadb00f};
+      second.v_address = champsim::address{0xdeadb00f};
+
+      mock_ul.issue(first);
+      for (auto i = 0; i < 20; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+      }
+      mock_ul.issue(second);
+
+      for (auto i = 0; i < 200; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+      }
+
+      THEN("Both packets are translated to the page of the first translation") {
+        REQUIRE(mock_translator.packet_count() == 2);
+        REQUIRE(std::size(mock_ll.addresses) == 2);
+        REQUIRE(mock_ll.addresses.at(0) == champsim::address{0x11111eef});
+        REQUIRE(mock_ll.addresses.at(1) == champsim::address{0x1111100f});
+      }
+
+      THEN("The second packet does not wait for its own translation") {
+        REQUIRE(std::size(mock_ul.packets) == 2);
+        REQUIRE(mock_ul.packets.at(1).return_time > 0);
+        REQUIRE(mock_ul.packets.at(1).return_time < mock_ul.packets.at(1).issue_time + translation_latency);
+      }
+    }
+  }
+}
@@ -0,0 +1,243 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "prefetch_throttle.h"
+
+namespace
+{
+  // Fill blocks until the interval ends
+  void end_interval(champsim::prefetch_throttle& uut, std::size_t blocks)
+  {
+    for (std::size_t i = 0; i < blocks / 2; ++i)
+      uut.block_filled();
+  }
+
+  // An interval of inaccurate prefetches, one of which evicted a block that was later demanded
+  void polluting_interval(champsim::prefetch_throttle& uut, std::size_t blocks)
+  {
+    for (int i = 0; i < 10; ++i)
+      uut.prefetch_issued();
+    uut.prefetch_useful();
+    uut.evicted_by_prefetch(0x100);
+    uut.demand_miss(0x100);
+    end_interval(uut, blocks);
+  }
+}
+
+SCENARIO("A prefetch throttle begins unrestricted") {
+  GIVEN("A new prefetch throttle") {
+    champsim::prefetch_throttle uut{champsim::prefetch_throttle_policy::fdp, 16};
+
+    THEN("It is at the greatest level") {
+      REQUIRE(uut.level() == champsim::prefetch_throttle::max_level);
+      REQUIRE(uut.degree(8) == 8);
+    }
+
+    THEN("It permits any number of prefetches") {
+      uut.activate();
+      for (int i = 0; i < 100; ++i)
+        REQUIRE(uut.permit());
+    }
+
+    WHEN("An interval passes without prefetches") {
+      end_interval(uut, 16);
+
+      THEN("The level does not change") {
+        REQUIRE(uut.level() == champsim::prefetch_throttle::max_level);
+      }
+    }
+  }
+}
+
+SCENARIO("Feedback directed prefetching lowers the aggressiveness of inaccurate, polluting prefetches") {
+  GIVEN("A prefetch throttle with the FDP policy") {
+    constexpr std::size_t blocks = 16;
+    champsim::prefetch_throttle uut{champsim::prefetch_throttle_policy::fdp, blocks};
+
+    WHEN("An interval of inaccurate, polluting prefetches passes") {
+      polluting_interval(uut, blocks);
+
+      THEN("The measurements reflect the interval") {
+        REQUIRE(uut.accuracy() == Approx(0.1));
+        REQUIRE(uut.pollution() == Approx(1.0));
+        REQUIRE(uut.lateness() == Approx(0.0));
+      }
+
+      THEN("The level is lowered by one") {
+        REQUIRE(uut.level() == champsim::prefetch_throttle::max_level - 1);
+      }
+
+      THEN("The allowance of each access is limited") {
+        uut.activate();
+        for (int i = 0; i < 8; ++i)
+          REQUIRE(uut.permit());
+        REQUIRE_FALSE(uut.permit());
+
+        AND_WHEN("Another access activates the prefetcher") {
+          uut.activate();
+
+          THEN("The allowance is renewed") {
+            REQUIRE(uut.permit());
+          }
+        }
+      }
+
+      AND_WHEN("An interval of accurate, late prefetches passes") {
+        for (int i = 0; i < 100; ++i) {
+          uut.prefetch_issued();
+          uut.prefetch_useful();
+        }
+        for (int i = 0; i < 50; ++i)
+          uut.prefetch_late();
+        end_interval(uut, blocks);
+
+        THEN("The level is raised again") {
+          REQUIRE(uut.accuracy() > champsim::prefetch_throttle::accuracy_high);
+          REQUIRE(uut.level() == champsim::prefetch_throttle::max_level);
+        }
+      }
+    }
+
+    WHEN("Many intervals of inaccurate, polluting prefetches pass") {
+      for (int i = 0; i < 10; ++i)
+        polluting_interval(uut, blocks);
+
+      THEN("The level stops at the most conservative") {
+        REQUIRE(uut.level() == 1);
+        REQUIRE(uut.degree(8) == 2);
+        REQUIRE(uut.degree(1) == 1);
+      }
+
+      THEN("Each access is allowed one prefetch") {
+        uut.activate();
+        REQUIRE(uut.permit());
+        REQUIRE_FALSE(uut.permit());
+      }
+    }
+  }
+}
+
+SCENARIO("The bandwidth-aware policy responds to the utilization of memory") {
+  constexpr std::size_t blocks = 16;
+
+  // Prefetches of middling accuracy that are neither late nor polluting, which FDP leaves alone
+  auto middling_interval = [](champsim::prefetch_throttle& uut) {
+    for (int i = 0; i < 10; ++i)
+      uut.prefetch_issued();
+    for (int i = 0; i < 6; ++i)
+      uut.prefetch_useful();
+    end_interval(uut, blocks);
+  };
+
+  GIVEN("A prefetch throttle with the FDP policy") {
+    champsim::prefetch_throttle uut{champsim::prefetch_throttle_policy::fdp, blocks};
+
+    WHEN("Memory is saturated") {
+      uut.observe_utilization(0.9);
+      middling_interval(uut);
+
+      THEN("The level does not change") {
+        REQUIRE(uut.level() == champsim::prefetch_throttle::max_level);
+      }
+    }
+  }
+
+  GIVEN("A prefetch throttle with the bandwidth-aware policy") {
+    champsim::prefetch_throttle uut{champsim::prefetch_throttle_policy::bandwidth, blocks};
+
+    WHEN("Memory is saturated") {
+      uut.observe_utilization(0.9);
+      middling_interval(uut);
+
+      THEN("The level is lowered") {
+        REQUIRE(uut.utilization() == Approx(0.9));
+        REQUIRE(uut.level() == champsim::prefetch_throttle::max_level - 1);
+      }
+
+      AND_WHEN("Memory becomes idle") {
+        uut.observe_utilization(0.1);
+        middling_interval(uut);
+
+        THEN("The level is raised") {
+          REQUIRE(uut.level() == champsim::prefetch_throttle::max_level);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A cache measures the feedback of its prefetches") {
+  GIVEN("A cache with a prefetch throttle") {
+    constexpr auto hit_latency = 2;
+    do_nothing_MRC mock_ll{100};
+    to_rq_MRP mock_ul;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l2c}
+      .name("433-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .hit_latency(hit_latency)
+      .prefetch_throttle(champsim::prefetch_throttle_policy::fdp)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    REQUIRE(uut.throttle.has_value());
+
+    WHEN("A demand finds its block still being prefetched") {
+      const champsim::address addr{0xdeadbeef};
+      REQUIRE(uut.prefetch_line(addr, true, 0));
+      for (int i = 0; i < 2*hit_latency; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      decltype(mock_ul)::request_type pkt;
+      pkt.address = addr;
+      pkt.type = access_type::LOAD;
+      pkt.cpu = 0;
+      mock_ul.issue(pkt);
+      for (int i = 0; i < 2*hit_latency; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The prefetch is counted useful and late") {
+        REQUIRE(uut.sim_stats.pf_useful == 1);
+        REQUIRE(uut.sim_stats.pf_late == 1);
+      }
+    }
+
+    WHEN("The throttle has lowered the aggressiveness") {
+      for (int i = 0; i < 10; ++i)
+        polluting_interval(*uut.throttle, uut.NUM_SET * uut.NUM_WAY);
+      uut.throttle->activate();
+
+      auto first = uut.prefetch_line(champsim::address{0xdeadbeef}, true, 0);
+      auto second = uut.prefetch_line(champsim::address{0xcafebabe}, true, 0);
+
+      THEN("Prefetches beyond the allowance are dropped") {
+        REQUIRE(first);
+        REQUIRE_FALSE(second);
+        REQUIRE(uut.sim_stats.pf_requested == 2);
+        REQUIRE(uut.sim_stats.pf_issued == 1);
+        REQUIRE(uut.sim_stats.pf_throttled == 1);
+      }
+    }
+
+    WHEN("The memory reports its utilization") {
+      mock_ll.queues.memory_utilization = 0.8;
+      for (auto elem : elements)
+        elem->_operate();
+
+      THEN("The cache passes it to its upper levels and its throttle") {
+        REQUIRE(mock_ul.queues.memory_utilization == Approx(0.8));
+        REQUIRE(uut.throttle->utilization() == Approx(0.8));
+      }
+    }
+  }
+}
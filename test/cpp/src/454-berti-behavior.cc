@@ -0,0 +1,126 @@
+#include <catch.hpp>
+#include <algorithm>
+#include "address.h"
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+#include "../../../prefetcher/berti/berti.h"
+
+namespace
+{
+  // Miss on consecutive blocks from one IP, one every `spacing` cycles, where each miss fills `latency` cycles after it is issued
+  void train_stream(CACHE& cache, berti& uut, champsim::address ip, champsim::block_number base, long spacing, long latency, long count)
+  {
+    const auto start = cache.current_time;
+    auto at_cycle = [&](long cycle) { cache.current_time = start + cycle * cache.clock_period; };
+    for (long cycle = 0; cycle <= (count - 1) * spacing + latency; ++cycle) {
+      at_cycle(cycle);
+      if (cycle >= latency && (cycle - latency) % spacing == 0 && (cycle - latency) / spacing < count)
+        uut.prefetcher_cache_fill(champsim::address{base + (cycle - latency) / spacing}, 0, 0, false, champsim::address{}, 0);
+      if (cycle % spacing == 0 && cycle / spacing < count)
+        uut.prefetcher_cache_operate(champsim::address{base + cycle / spacing}, ip, false, false, access_type::LOAD, 0);
+    }
+  }
+
+  std::vector<berti::delta_type> deltas_with_status(berti& uut, champsim::address ip, berti::delta_status status)
+  {
+    std::vector<berti::delta_type> retval;
+    auto entry = uut.deltas.check_hit({{ip}});
+    if (entry.has_value()) {
+      for (auto delta : entry->deltas) {
+        if (delta.status == status)
+          retval.push_back(delta.delta);
+      }
+    }
+    std::sort(std::begin(retval), std::end(retval));
+    return retval;
+  }
+}
+
+SCENARIO("The berti prefetcher learns the deltas that are timely for the fill latency") {
+  auto [latency, first_timely] = GENERATE(table<long, berti::delta_type>({{15, 2}, {35, 4}}));
+  GIVEN("A berti prefetcher") {
+    CACHE cache{champsim::cache_builder{champsim::defaults::default_l1d}.name("454-cache")};
+    berti uut{&cache};
+    const champsim::address ip{0xcafecafe};
+
+    WHEN("An IP misses on consecutive blocks for one learning period, with latency " + std::to_string(latency)) {
+      train_stream(cache, uut, ip, champsim::block_number{0xffff'0000}, 10, latency, berti::LEARN_PERIOD + 4);
+
+      THEN("The nearest delta that prefetches into the cache is the first timely one") {
+        auto learned = deltas_with_status(uut, ip, berti::delta_status::this_level);
+        REQUIRE_FALSE(std::empty(learned));
+        REQUIRE(learned.front() == first_timely);
+      }
+
+      THEN("No untimely delta is learned") {
+        for (auto status : {berti::delta_status::this_level, berti::delta_status::next_level}) {
+          auto learned = deltas_with_status(uut, ip, status);
+          REQUIRE(std::all_of(std::begin(learned), std::end(learned), [first_timely=first_timely](auto d){ return d >= first_timely; }));
+        }
+      }
+    }
+
+    WHEN("An IP misses on consecutive blocks for less than one learning period") {
+      train_stream(cache, uut, ip, champsim::block_number{0xffff'0000}, 10, latency, berti::LEARN_PERIOD / 2);
+
+      THEN("No delta prefetches") {
+        REQUIRE(std::empty(deltas_with_status(uut, ip, berti::delta_status::this_level)));
+        REQUIRE(std::empty(deltas_with_status(uut, ip, berti::delta_status::next_level)));
+      }
+    }
+  }
+}
+
+SCENARIO("The berti prefetcher prefetches ahead of a stream of misses") {
+  GIVEN("A cache with a berti prefetcher") {
+    do_nothing_MRC mock_ll{20};
+    to_rq_MRP mock_ul;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l1d}
+      .name("454-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .prefetcher<berti>()
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("One IP loads consecutive blocks in a page") {
+      static uint64_t id = 1;
+      const champsim::block_number base{champsim::address{0xffff'0000}};
+      constexpr long count = 48;
+      for (long i = 0; i < count; ++i) {
+        decltype(mock_ul)::request_type pkt;
+        pkt.address = champsim::address{base + i};
+        pkt.ip = champsim::address{0xcafecafe};
+        pkt.instr_id = id++;
+        pkt.cpu = 0;
+        mock_ul.issue(pkt);
+
+        for (int j = 0; j < 10; ++j)
+          for (auto elem : elements)
+            elem->_operate();
+      }
+
+      for (int j = 0; j < 100; ++j)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("Blocks beyond the demanded ones were prefetched") {
+        REQUIRE(uut.sim_stats.pf_issued > 0);
+        REQUIRE(std::any_of(std::begin(mock_ll.addresses), std::end(mock_ll.addresses), [base](auto addr){ return champsim::block_number{addr} >= base + count; }));
+      }
+
+      THEN("Some demands hit the prefetched blocks") {
+        REQUIRE(uut.sim_stats.pf_useful > 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,164 @@
+#include <catch.hpp>
+#include <algorithm>
+#include "address.h"
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+#include "../../../prefetcher/ipcp/ipcp.h"
+
+namespace
+{
+  struct ipcp_fixture {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut;
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+    uint64_t id = 1;
+
+    explicit ipcp_fixture(std::string name)
+      : uut{champsim::cache_builder{champsim::defaults::default_l1d}
+          .name(name)
+          .upper_levels({&mock_ul.queues})
+          .lower_level(&mock_ll.queues)
+          .prefetcher<ipcp>()
+        }
+    {
+      for (auto elem : elements) {
+        elem->initialize();
+        elem->warmup = false;
+        elem->begin_phase();
+      }
+    }
+
+    // Load the block from the IP and wait for it to return, then give the addresses that the cache requested from the lower level
+    std::vector<champsim::block_number> access(champsim::block_number block, champsim::address ip)
+    {
+      const auto before = std::size(mock_ll.addresses);
+
+      decltype(mock_ul)::request_type pkt;
+      pkt.address = champsim::address{block};
+      pkt.ip = ip;
+      pkt.instr_id = id++;
+      pkt.cpu = 0;
+      REQUIRE(mock_ul.issue(pkt));
+
+      for (int i = 0; i < 50; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      std::vector<champsim::block_number> retval;
+      std::transform(std::next(std::begin(mock_ll.addresses), static_cast<long>(before)), std::end(mock_ll.addresses), std::back_inserter(retval),
+          [](auto addr){ return champsim::block_number{addr}; });
+      return retval;
+    }
+  };
+
+  bool contains(const std::vector<champsim::block_number>& blocks, champsim::block_number block)
+  {
+    return std::find(std::begin(blocks), std::end(blocks), block) != std::end(blocks);
+  }
+}
+
+SCENARIO("The ipcp prefetcher prefetches the next line for an unclassified IP") {
+  GIVEN("A cache with an ipcp prefetcher") {
+    ipcp_fixture fixture{"455-uut-nl"};
+    const champsim::block_number block{champsim::address{0xffff'0400}};
+
+    WHEN("A new IP misses") {
+      auto requested = fixture.access(block, champsim::address{0xcafecafe});
+
+      THEN("The next line is prefetched") {
+        REQUIRE(contains(requested, block + 1));
+        REQUIRE_THAT(requested, Catch::Matchers::SizeIs(2));
+      }
+    }
+  }
+}
+
+SCENARIO("The ipcp prefetcher prefetches along a constant stride") {
+  auto stride = GENERATE(as<ipcp::stride_type>{}, -3, -2, -1, 1, 2, 3);
+  GIVEN("A cache with an ipcp prefetcher") {
+    ipcp_fixture fixture{"455-uut-cs-[" + std::to_string(stride) + "]"};
+    const champsim::address ip{0xcafecafe};
+    const champsim::block_number base{champsim::address{0xffff'0800}}; // The middle of a page
+
+    WHEN("An IP strides four times") {
+      std::vector<champsim::block_number> requested;
+      for (ipcp::stride_type i = 0; i < 4; ++i)
+        requested = fixture.access(base + stride * i, ip);
+
+      THEN("The last access prefetches three strides ahead") {
+        const auto last = base + stride * 3;
+        for (ipcp::stride_type i = 1; i <= 3; ++i)
+          REQUIRE(contains(requested, last + stride * i));
+      }
+    }
+  }
+}
+
+SCENARIO("The ipcp prefetcher predicts complex strides from their signature") {
+  GIVEN("A cache with an ipcp prefetcher") {
+    ipcp_fixture fixture{"455-uut-cplx"};
+    const champsim::address ip{0xcafecafe};
+    const std::array<ipcp::stride_type, 2> pattern{{1, 2}};
+
+    WHEN("An IP repeats a pattern of strides") {
+      champsim::block_number block{champsim::address{0xffff'0000}};
+      std::vector<champsim::block_number> requested;
+      for (std::size_t i = 0; i < 20; ++i) {
+        auto just_requested = fixture.access(block, ip);
+        requested.insert(std::end(requested), std::begin(just_requested), std::end(just_requested));
+        block = block + pattern.at(i % std::size(pattern));
+      }
+
+      THEN("The next strides of the pattern are prefetched") {
+        // The next access would be to block, followed by strides of 1, 2
+        REQUIRE(contains(requested, block));
+        REQUIRE(contains(requested, block + 1));
+        REQUIRE(contains(requested, block + 3));
+      }
+
+      THEN("Blocks off the pattern are not prefetched") {
+        REQUIRE_FALSE(contains(requested, block + 2));
+      }
+    }
+  }
+}
+
+SCENARIO("The ipcp prefetcher streams through dense regions") {
+  auto forward = GENERATE(true, false);
+  GIVEN("A cache with an ipcp prefetcher") {
+    ipcp_fixture fixture{std::string{"455-uut-gs-"} + (forward ? "fwd" : "back")};
+    const champsim::block_number region_begin{champsim::address{0xffff'0000}};
+    const auto direction = forward ? 1 : -1;
+    const auto start = forward ? region_begin : region_begin + static_cast<long>(ipcp::REGION_BLOCKS - 1);
+
+    WHEN("Many IPs touch most of a region in order") {
+      std::vector<champsim::block_number> requested;
+      const auto count = static_cast<long>(ipcp::DENSE_THRESHOLD);
+      for (long i = 0; i < count; ++i)
+        requested = fixture.access(start + direction * i, champsim::address{static_cast<uint64_t>(0x1000 + 4 * i)});
+
+      THEN("The access that makes the region dense prefetches ahead of the stream") {
+        const auto last = start + direction * (count - 1);
+        for (long i = 1; i <= static_cast<long>(ipcp::GS_DEGREE); ++i)
+          REQUIRE(contains(requested, last + direction * i));
+      }
+    }
+
+    WHEN("Many IPs touch a few blocks of a region") {
+      std::vector<champsim::block_number> requested;
+      for (long i = 0; i < 8; ++i) {
+        auto just_requested = fixture.access(start + direction * 2 * i, champsim::address{static_cast<uint64_t>(0x1000 + 4 * i)});
+        requested.insert(std::end(requested), std::begin(just_requested), std::end(just_requested));
+      }
+
+      THEN("No block far ahead of the accesses is prefetched") {
+        const auto last = start + direction * 14;
+        REQUIRE_FALSE(contains(requested, last + direction * 2));
+        REQUIRE_FALSE(contains(requested, last + direction * 3));
+      }
+    }
+  }
+}
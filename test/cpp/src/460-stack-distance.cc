@@ -0,0 +1,125 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "stack_distance.h"
+
+TEST_CASE("An LRU stack reports cold accesses") {
+  champsim::lru_stack uut{};
+  REQUIRE_FALSE(uut.access(0xdead).has_value());
+  REQUIRE_FALSE(uut.access(0xbeef).has_value());
+  REQUIRE(uut.size() == 2);
+}
+
+TEST_CASE("An LRU stack reports the number of distinct intervening blocks") {
+  champsim::lru_stack uut{};
+  for (uint64_t block : {1, 2, 3, 2, 2})
+    (void)uut.access(block);
+
+  // 1 was followed by 2, 3, 2, 2
+  REQUIRE(uut.access(1) == std::optional<std::size_t>{2});
+  REQUIRE(uut.access(1) == std::optional<std::size_t>{0});
+  REQUIRE(uut.access(3) == std::optional<std::size_t>{2});
+}
+
+TEST_CASE("An LRU stack agrees with a naive stack over a long stream") {
+  champsim::lru_stack uut{};
+  std::vector<uint64_t> naive{};
+
+  uint64_t seed = 1;
+  for (int i = 0; i < 20000; ++i) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    uint64_t block = (seed >> 33) % 300;
+
+    std::optional<std::size_t> expected{};
+    if (auto found = std::find(std::rbegin(naive), std::rend(naive), block); found != std::rend(naive)) {
+      expected = static_cast<std::size_t>(std::distance(std::rbegin(naive), found));
+      naive.erase(std::prev(found.base()));
+    }
+    naive.push_back(block);
+
+    REQUIRE(uut.access(block) == expected);
+  }
+}
+
+TEST_CASE("A stack distance profiler separates geometries") {
+  champsim::stack_distance_profiler uut{{1, 2}, 4};
+  auto hists = uut.empty_histograms();
+  REQUIRE(std::size(hists) == 2);
+
+  // Blocks 0 and 2 map to the same set of a two-set cache, and block 1 to the other
+  for (uint64_t block : {0, 1, 2, 0})
+    uut.access(block, hists);
+
+  REQUIRE(hists.at(0).sets == 1);
+  REQUIRE(hists.at(0).cold == 3);
+  REQUIRE(hists.at(0).distances.at(2) == 1);
+  REQUIRE(hists.at(0).misses(2) == 4);
+  REQUIRE(hists.at(0).misses(3) == 3);
+
+  REQUIRE(hists.at(1).sets == 2);
+  REQUIRE(hists.at(1).cold == 3);
+  REQUIRE(hists.at(1).distances.at(1) == 1);
+  REQUIRE(hists.at(1).misses(1) == 4);
+  REQUIRE(hists.at(1).misses(2) == 3);
+}
+
+TEST_CASE("A stack distance histogram counts distances past its depth") {
+  champsim::stack_distance_profiler uut{{1}, 2};
+  auto hists = uut.empty_histograms();
+  for (uint64_t block : {0, 1, 2, 3, 0})
+    uut.access(block, hists);
+
+  REQUIRE(hists.at(0).beyond == 1);
+  REQUIRE(hists.at(0).accesses() == 5);
+  REQUIRE(hists.at(0).misses(2) == 5);
+}
+
+SCENARIO("A cache with a stack distance profile records its accesses") {
+  GIVEN("A cache that profiles its own geometry") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{champsim::cache_builder{champsim::defaults::default_l1d}
+      .name("460-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .stack_distance_ways(8)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    THEN("The profile models the cache's own geometry") {
+      REQUIRE_THAT(uut.sim_stats.stack_distances, Catch::Matchers::SizeIs(1));
+      REQUIRE(uut.sim_stats.stack_distances.front().sets == uut.NUM_SET);
+      REQUIRE_THAT(uut.sim_stats.stack_distances.front().distances, Catch::Matchers::SizeIs(8));
+    }
+
+    WHEN("The same block is accessed twice") {
+      decltype(mock_ul)::request_type seed;
+      seed.address = champsim::address{0xdeadbeef};
+      seed.is_translated = true;
+      seed.cpu = 0;
+      seed.type = access_type::LOAD;
+
+      for (uint64_t id = 1; id <= 2; ++id) {
+        seed.instr_id = id;
+        REQUIRE(mock_ul.issue(seed));
+
+        for (auto i = 0; i < 100; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+      }
+
+      THEN("The first access is cold and the second has distance zero") {
+        REQUIRE(uut.sim_stats.stack_distances.front().cold == 1);
+        REQUIRE(uut.sim_stats.stack_distances.front().distances.at(0) == 1);
+      }
+    }
+  }
+}
@@ -0,0 +1,292 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+namespace {
+template <typename F>
+bool holds_where(const CACHE& cache, champsim::address addr, F&& pred)
+{
+  return std::any_of(std::begin(cache.block), std::end(cache.block), [match = champsim::block_number{addr}, pred](const auto& blk) {
+    return blk.valid && champsim::block_number{blk.address} == match && pred(blk);
+  });
+}
+
+bool holds(const CACHE& cache, champsim::address addr)
+{
+  return holds_where(cache, addr, [](const auto&) { return true; });
+}
+
+bool holds_shared(const CACHE& cache, champsim::address addr)
+{
+  return holds_where(cache, addr, [](const auto& blk) { return blk.shared; });
+}
+
+bool holds_dirty(const CACHE& cache, champsim::address addr)
+{
+  return holds_where(cache, addr, [](const auto& blk) { return blk.dirty; });
+}
+}
+
+SCENARIO("A coherence directory keeps the copies of a block in two caches consistent") {
+  auto [protocol, str] = GENERATE(table<champsim::coherence_protocol, std::string_view>({
+      {champsim::coherence_protocol::mesi, "470a-"},
+      {champsim::coherence_protocol::moesi, "470b-"}
+  }));
+
+  GIVEN("Two private caches above a shared cache with a directory") {
+    do_nothing_MRC mock_ll;
+    std::array<to_rq_MRP, 2> mock_reads{};
+    std::array<to_wq_MRP, 2> mock_writes{};
+    std::array<champsim::channel, 2> middle{};
+
+    std::vector<CACHE> privates{};
+    for (std::size_t i = 0; i < std::size(middle); ++i) {
+      privates.emplace_back(champsim::cache_builder{champsim::defaults::default_l2c}
+                                .name(std::string{str} + "private-" + std::to_string(i))
+                                .upper_levels({&mock_reads[i].queues, &mock_writes[i].queues})
+                                .lower_level(&middle[i]));
+    }
+    CACHE shared{champsim::cache_builder{champsim::defaults::default_llc}
+      .name(std::string{str} + "shared")
+      .coherence(protocol)
+      .upper_levels({&middle[0], &middle[1]})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::vector<champsim::operable*> elements{{&shared, &mock_ll}};
+    for (auto& x : privates) elements.push_back(&x);
+    for (auto& x : mock_reads) elements.push_back(&x);
+    for (auto& x : mock_writes) elements.push_back(&x);
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    auto run = [&elements]() {
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+    };
+
+    typename to_rq_MRP::request_type read;
+    read.address = champsim::address{0xdeadbeef};
+    read.cpu = 0;
+    read.instr_id = 1;
+
+    WHEN("Both caches read the block") {
+      mock_reads[0].issue(read);
+      run();
+      mock_reads[1].issue(read);
+      run();
+
+      THEN("The second read downgrades the first copy, and both copies are shared") {
+        REQUIRE(mock_reads[0].packets.at(0).return_time > 0);
+        REQUIRE(mock_reads[1].packets.at(0).return_time > 0);
+        REQUIRE(holds_shared(privates[0], read.address));
+        REQUIRE(holds_shared(privates[1], read.address));
+        REQUIRE(shared.sim_stats.coherence_snoops == 1);
+        REQUIRE(std::size(mock_ll.addresses) == 1);
+      }
+
+      AND_WHEN("The first cache requests ownership of the block") {
+        auto rfo = read;
+        rfo.type = access_type::RFO;
+        rfo.instr_id = 2;
+        mock_reads[0].issue(rfo);
+        run();
+
+        THEN("The request misses on the shared copy and is served by the shared cache") {
+          REQUIRE(mock_reads[0].packets.at(1).return_time > 0);
+          REQUIRE(privates[0].sim_stats.coherence_misses == 1);
+          REQUIRE(shared.sim_stats.hits.value_or(std::pair{access_type::RFO, 0}, 0) == 1);
+          REQUIRE(std::size(mock_ll.addresses) == 1);
+        }
+
+        THEN("The other copy is invalidated, and the remaining copy is no longer shared") {
+          REQUIRE_FALSE(holds(privates[1], read.address));
+          REQUIRE(holds(privates[0], read.address));
+          REQUIRE_FALSE(holds_shared(privates[0], read.address));
+        }
+
+        AND_WHEN("The owner writes the block, and the other cache reads it again") {
+          auto write = rfo;
+          write.type = access_type::WRITE;
+          write.instr_id = 3;
+          write.response_requested = false;
+          mock_writes[0].issue(write);
+          run();
+
+          REQUIRE(holds_dirty(privates[0], read.address));
+
+          auto again = read;
+          again.instr_id = 4;
+          mock_reads[1].issue(again);
+          run();
+
+          THEN("The read misses because of the write") {
+            REQUIRE(mock_reads[1].packets.at(1).return_time > 0);
+            REQUIRE(privates[1].sim_stats.coherence_misses == 1);
+            REQUIRE(holds_shared(privates[0], read.address));
+            REQUIRE(holds_shared(privates[1], read.address));
+          }
+
+          THEN("The owner writes back the block only under MESI") {
+            if (protocol == champsim::coherence_protocol::moesi) {
+              REQUIRE(holds_dirty(privates[0], read.address));
+              REQUIRE_FALSE(holds_dirty(shared, read.address));
+            } else {
+              REQUIRE_FALSE(holds_dirty(privates[0], read.address));
+              REQUIRE(holds_dirty(shared, read.address));
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A dirty block written back in answer to a snoop is not taken back by the cache that passed the snoop up") {
+  auto [protocol, str] = GENERATE(table<champsim::coherence_protocol, std::string_view>({
+      {champsim::coherence_protocol::mesi, "470d-"},
+      {champsim::coherence_protocol::moesi, "470e-"}
+  }));
+
+  GIVEN("An upper cache above one of two private caches, which share a cache with a directory") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_upper_read;
+    to_wq_MRP mock_upper_write;
+    to_rq_MRP mock_other_read;
+    champsim::channel upper_to_private{};
+    std::array<champsim::channel, 2> middle{};
+
+    CACHE upper{champsim::cache_builder{champsim::defaults::default_l2c}
+      .name(std::string{str} + "upper")
+      .upper_levels({&mock_upper_read.queues, &mock_upper_write.queues})
+      .lower_level(&upper_to_private)
+    };
+    std::vector<CACHE> privates{};
+    privates.emplace_back(champsim::cache_builder{champsim::defaults::default_l2c}
+                              .name(std::string{str} + "private-0")
+                              .upper_levels({&upper_to_private})
+                              .lower_level(&middle[0]));
+    privates.emplace_back(champsim::cache_builder{champsim::defaults::default_l2c}
+                              .name(std::string{str} + "private-1")
+                              .upper_levels({&mock_other_read.queues})
+                              .lower_level(&middle[1]));
+    CACHE shared{champsim::cache_builder{champsim::defaults::default_llc}
+      .name(std::string{str} + "shared")
+      .coherence(protocol)
+      .upper_levels({&middle[0], &middle[1]})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::vector<champsim::operable*> elements{{&upper, &shared, &mock_ll, &mock_upper_read, &mock_upper_write, &mock_other_read}};
+    for (auto& x : privates) elements.push_back(&x);
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    auto run = [&elements]() {
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+    };
+
+    typename to_rq_MRP::request_type read;
+    read.address = champsim::address{0xdeadbeef};
+    read.cpu = 0;
+    read.instr_id = 1;
+    mock_upper_read.issue(read);
+    run();
+
+    typename to_wq_MRP::request_type write;
+    write.address = read.address;
+    write.cpu = 0;
+    write.instr_id = 2;
+    write.type = access_type::WRITE;
+    write.response_requested = false;
+    mock_upper_write.issue(write);
+    run();
+
+    REQUIRE(holds_dirty(upper, read.address));
+    REQUIRE(holds(privates[0], read.address));
+
+    WHEN("The other private cache requests ownership of the block") {
+      auto rfo = read;
+      rfo.type = access_type::RFO;
+      rfo.instr_id = 3;
+      mock_other_read.issue(rfo);
+      run();
+
+      THEN("The dirty block passes through the private cache to the shared cache") {
+        REQUIRE(mock_other_read.packets.at(0).return_time > 0);
+        REQUIRE_FALSE(holds(upper, read.address));
+        REQUIRE_FALSE(holds(privates[0], read.address));
+        REQUIRE(holds_dirty(shared, read.address));
+      }
+    }
+  }
+}
+
+SCENARIO("A cache without a directory does not snoop its upper levels") {
+  GIVEN("Two private caches above a shared cache without a directory") {
+    do_nothing_MRC mock_ll;
+    std::array<to_rq_MRP, 2> mock_reads{};
+    std::array<champsim::channel, 2> middle{};
+
+    std::vector<CACHE> privates{};
+    for (std::size_t i = 0; i < std::size(middle); ++i) {
+      privates.emplace_back(champsim::cache_builder{champsim::defaults::default_l2c}
+                                .name("470c-private-" + std::to_string(i))
+                                .upper_levels({&mock_reads[i].queues})
+                                .lower_level(&middle[i]));
+    }
+    CACHE shared{champsim::cache_builder{champsim::defaults::default_llc}
+      .name("470c-shared")
+      .upper_levels({&middle[0], &middle[1]})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::vector<champsim::operable*> elements{{&shared, &mock_ll}};
+    for (auto& x : privates) elements.push_back(&x);
+    for (auto& x : mock_reads) elements.push_back(&x);
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Both caches read the block, and one requests ownership of it") {
+      typename to_rq_MRP::request_type read;
+      read.address = champsim::address{0xdeadbeef};
+      read.cpu = 0;
+      read.instr_id = 1;
+      mock_reads[0].issue(read);
+      mock_reads[1].issue(read);
+
+      auto rfo = read;
+      rfo.type = access_type::RFO;
+      rfo.instr_id = 2;
+      mock_reads[0].issue(rfo);
+
+      for (auto i = 0; i < 200; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("Both copies remain, and neither is shared") {
+        REQUIRE(holds(privates[0], read.address));
+        REQUIRE(holds(privates[1], read.address));
+        REQUIRE_FALSE(holds_shared(privates[0], read.address));
+        REQUIRE_FALSE(holds_shared(privates[1], read.address));
+        REQUIRE(shared.sim_stats.coherence_snoops == 0);
+      }
+    }
+  }
+}
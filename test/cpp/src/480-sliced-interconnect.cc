@@ -0,0 +1,226 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "interconnect.h"
+
+#include <array>
+
+TEST_CASE("A ring routes messages in the shorter direction") {
+  std::array<champsim::channel, 8> uls{};
+  std::vector<champsim::channel*> ul_ptrs{};
+  std::vector<std::vector<champsim::channel*>> ll_ptrs{};
+  for (auto& ul : uls) {
+    ul_ptrs.push_back(&ul);
+    ll_ptrs.push_back({&ul});
+  }
+
+  champsim::interconnect uut{"480-ring", champsim::chrono::picoseconds{1}, champsim::interconnect::topology_type::ring, 0, 1,
+                             champsim::bandwidth::maximum_type{1}, 8, ul_ptrs, ll_ptrs};
+
+  REQUIRE(uut.num_stops() == 8);
+  REQUIRE(uut.hops(0, 0) == 0);
+  REQUIRE(uut.hops(0, 3) == 3);
+  REQUIRE(uut.hops(0, 4) == 4);
+  REQUIRE(uut.hops(0, 5) == 3);
+  REQUIRE(uut.hops(6, 1) == 3);
+}
+
+TEST_CASE("A mesh routes messages along rows and then columns") {
+  std::array<champsim::channel, 7> uls{};
+  std::vector<champsim::channel*> ul_ptrs{};
+  std::vector<std::vector<champsim::channel*>> ll_ptrs{};
+  for (auto& ul : uls) {
+    ul_ptrs.push_back(&ul);
+    ll_ptrs.push_back({&ul});
+  }
+
+  champsim::interconnect uut{"480-mesh", champsim::chrono::picoseconds{1}, champsim::interconnect::topology_type::mesh, 0, 1,
+                             champsim::bandwidth::maximum_type{1}, 8, ul_ptrs, ll_ptrs};
+
+  // Seven endpoints fill a three-by-three grid
+  REQUIRE(uut.num_stops() == 9);
+  REQUIRE(uut.hops(0, 8) == 4);
+  REQUIRE(uut.hops(2, 6) == 4);
+  REQUIRE(uut.hops(4, 5) == 1);
+  REQUIRE(uut.hops(1, 7) == 2);
+}
+
+SCENARIO("Requests travel to the slice that holds their block") {
+  GIVEN("A ring with one upper level and four slices") {
+    constexpr uint64_t hop_latency = 3;
+    to_rq_MRP mock_ul;
+    std::array<do_nothing_MRC, 4> mock_slices{};
+    std::vector<champsim::channel*> slice_queues{};
+    for (auto& slice : mock_slices)
+      slice_queues.push_back(&slice.queues);
+
+    champsim::interconnect uut{"480-uut", champsim::chrono::picoseconds{1}, champsim::interconnect::topology_type::ring, 0, hop_latency,
+                               champsim::bandwidth::maximum_type{1}, 32, {&mock_ul.queues}, {slice_queues}};
+
+    std::vector<champsim::operable*> elements{{&uut, &mock_ul}};
+    for (auto& slice : mock_slices)
+      elements.push_back(&slice);
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Requests are sent to many blocks") {
+      for (uint64_t i = 0; i < 16; ++i) {
+        typename to_rq_MRP::request_type pkt;
+        pkt.address = champsim::address{0xdead0000 + i * BLOCK_SIZE};
+        pkt.cpu = 0;
+        mock_ul.issue(pkt);
+
+        for (auto elem : elements)
+          elem->_operate();
+      }
+
+      for (auto i = 0; i < 100; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+      }
+
+      THEN("Each slice receives only the blocks that hash to it") {
+        std::size_t total = 0;
+        for (std::size_t slice = 0; slice < std::size(mock_slices); ++slice) {
+          for (auto addr : mock_slices[slice].addresses)
+            REQUIRE(uut.slice_of(addr) == slice);
+          total += std::size(mock_slices[slice].addresses);
+        }
+        REQUIRE(total == 16);
+      }
+
+      THEN("Every request is returned, with a latency that grows with the distance to its slice") {
+        for (const auto& result : mock_ul.packets) {
+          auto distance = uut.hops(uut.upper_stop(0), uut.slice_stop(uut.slice_of(result.pkt.address)));
+          REQUIRE(result.return_time > 0);
+          REQUIRE(result.return_time - result.issue_time >= static_cast<long>(2 * distance * hop_latency));
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Messages that share a link contend for its bandwidth") {
+  GIVEN("A ring with one upper level and two slices") {
+    constexpr uint64_t hop_latency = 2;
+    to_rq_MRP mock_ul;
+    std::array<do_nothing_MRC, 2> mock_slices{};
+
+    champsim::interconnect uut{"480-uut", champsim::chrono::picoseconds{1}, champsim::interconnect::topology_type::ring, 0, hop_latency,
+                               champsim::bandwidth::maximum_type{1}, 32, {&mock_ul.queues}, {{&mock_slices[0].queues, &mock_slices[1].queues}}};
+
+    std::array<champsim::operable*, 4> elements{{&uut, &mock_ul, &mock_slices[0], &mock_slices[1]}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Several requests for the remote slice are sent at once") {
+      constexpr std::size_t num_requests = 4;
+      uint64_t block = 0;
+      for (std::size_t sent = 0; sent < num_requests; ++block) {
+        typename to_rq_MRP::request_type pkt;
+        pkt.address = champsim::address{block * BLOCK_SIZE};
+        pkt.cpu = 0;
+        if (uut.slice_of(pkt.address) == 1) {
+          mock_ul.issue(pkt);
+          ++sent;
+        }
+      }
+
+      for (auto i = 0; i < 100; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+      }
+
+      THEN("The requests arrive one per cycle") {
+        REQUIRE(std::size(mock_slices[1].addresses) == num_requests);
+        std::vector<long> return_times{};
+        for (const auto& result : mock_ul.packets)
+          return_times.push_back(result.return_time);
+        std::sort(std::begin(return_times), std::end(return_times));
+        for (std::size_t i = 1; i < std::size(return_times); ++i)
+          REQUIRE(return_times.at(i) == return_times.at(i - 1) + 1);
+      }
+    }
+  }
+}
+
+SCENARIO("Cache slices behind an interconnect fill the blocks requested of them") {
+  GIVEN("Two upper-level caches connected to two slices") {
+    std::array<to_rq_MRP, 2> mock_uls{};
+    std::array<do_nothing_MRC, 2> mock_lls{};
+    std::array<champsim::channel, 2> upper_queues{};
+    std::array<std::array<champsim::channel, 2>, 2> slice_queues{};
+
+    std::vector<CACHE> uppers{};
+    for (std::size_t i = 0; i < std::size(mock_uls); ++i) {
+      uppers.emplace_back(champsim::cache_builder{champsim::defaults::default_l2c}
+                              .name("480-upper-" + std::to_string(i))
+                              .upper_levels({&mock_uls[i].queues})
+                              .lower_level(&upper_queues[i]));
+    }
+
+    std::vector<CACHE> slices{};
+    for (std::size_t i = 0; i < std::size(mock_lls); ++i) {
+      slices.emplace_back(champsim::cache_builder{champsim::defaults::default_llc}
+                              .name("480-slice-" + std::to_string(i))
+                              .upper_levels({&slice_queues[0][i], &slice_queues[1][i]})
+                              .lower_level(&mock_lls[i].queues));
+    }
+
+    champsim::interconnect uut{"480-uut", champsim::chrono::picoseconds{1}, champsim::interconnect::topology_type::ring, 0, 2,
+                               champsim::bandwidth::maximum_type{1}, 4, {&upper_queues[0], &upper_queues[1]},
+                               {{&slice_queues[0][0], &slice_queues[0][1]}, {&slice_queues[1][0], &slice_queues[1][1]}}};
+
+    std::vector<champsim::operable*> elements{&uut};
+    for (auto& x : mock_uls) elements.push_back(&x);
+    for (auto& x : mock_lls) elements.push_back(&x);
+    for (auto& x : uppers) elements.push_back(&x);
+    for (auto& x : slices) elements.push_back(&x);
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Both upper levels request the same blocks") {
+      constexpr uint64_t num_blocks = 16;
+      for (uint64_t i = 0; i < num_blocks; ++i) {
+        for (auto& ul : mock_uls) {
+          typename to_rq_MRP::request_type pkt;
+          pkt.address = champsim::address{0xcafe0000 + i * BLOCK_SIZE};
+          pkt.cpu = 0;
+          ul.issue(pkt);
+        }
+      }
+
+      for (auto i = 0; i < 1000; ++i) {
+        for (auto elem : elements)
+          elem->_operate();
+      }
+
+      THEN("Every request is returned") {
+        for (const auto& ul : mock_uls) {
+          REQUIRE(std::size(ul.packets) == num_blocks);
+          for (const auto& result : ul.packets)
+            REQUIRE(result.return_time > 0);
+        }
+      }
+
+      THEN("Each block is fetched once, by its own slice") {
+        REQUIRE(std::size(mock_lls[0].addresses) + std::size(mock_lls[1].addresses) == num_blocks);
+        for (std::size_t slice = 0; slice < std::size(mock_lls); ++slice) {
+          for (auto addr : mock_lls[slice].addresses)
+            REQUIRE(uut.slice_of(addr) == slice);
+        }
+      }
+    }
+  }
+}
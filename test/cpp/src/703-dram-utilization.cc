@@ -0,0 +1,44 @@
+#include <catch.hpp>
+#include "defaults.hpp"
+#include "dram_controller.h"
+
+SCENARIO("The memory controller reports the utilization of its data bus to its upper levels") {
+  GIVEN("A memory controller with one upper level") {
+    const auto clock_period = champsim::chrono::picoseconds{3200};
+    champsim::channel ul{64, 64, 64, champsim::data::bits{LOG2_BLOCK_SIZE}, false};
+    MEMORY_CONTROLLER uut{clock_period, clock_period*2, 24, 24, 24, 52, champsim::chrono::microseconds{64000}, {&ul}, 64, 64, 1, champsim::data::bytes{8}, 65536, 128, 1, 8, 4, 8192};
+    uut.warmup = false;
+    uut.initialize();
+    uut.begin_phase();
+
+    WHEN("No requests arrive") {
+      for (int i = 0; i < 10000; ++i)
+        uut._operate();
+
+      THEN("The utilization is zero") {
+        REQUIRE(ul.memory_utilization == 0);
+      }
+    }
+
+    WHEN("A stream of reads arrives") {
+      uint64_t next_address = 0;
+      for (int i = 0; i < 10000; ++i) {
+        while (ul.rq_occupancy() < 32) {
+          champsim::channel::request_type pkt;
+          pkt.address = champsim::address{next_address};
+          pkt.cpu = 0;
+          pkt.type = access_type::LOAD;
+          pkt.response_requested = false;
+          ul.add_rq(pkt);
+          next_address += BLOCK_SIZE;
+        }
+        uut._operate();
+      }
+
+      THEN("The data bus is busy for part of the time") {
+        REQUIRE(ul.memory_utilization > 0);
+        REQUIRE(ul.memory_utilization <= 1);
+      }
+    }
+  }
+}
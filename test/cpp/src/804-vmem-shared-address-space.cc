@@ -0,0 +1,39 @@
+#include <catch.hpp>
+#include "vmem.h"
+
+#include "dram_controller.h"
+
+SCENARIO("Cores that share an address space share their translations") {
+  auto shared_address_space = GENERATE(false, true);
+
+  GIVEN("A virtual memory") {
+    constexpr unsigned levels = 5;
+    constexpr champsim::data::bytes pte_page_size{1ull << 12};
+    MEMORY_CONTROLLER dram{champsim::chrono::picoseconds{3200}, champsim::chrono::picoseconds{6400}, std::size_t{18}, std::size_t{18}, std::size_t{18}, std::size_t{38}, champsim::chrono::microseconds{64000}, {}, 64, 64, 1, champsim::data::bytes{8}, 1024, 1024, 4, 4, 4, 8192};
+    VirtualMemory uut{pte_page_size, levels, std::chrono::nanoseconds{6400}, dram, {}, shared_address_space};
+
+    WHEN("Two cores translate the same page") {
+      const champsim::page_number to_check{0xdeadbeef};
+      auto [ppage_a, delay_a] = uut.va_to_pa(0, to_check);
+      auto [ppage_b, delay_b] = uut.va_to_pa(1, to_check);
+      auto [pte_a, pte_delay_a] = uut.get_pte_pa(0, to_check, 1);
+      auto [pte_b, pte_delay_b] = uut.get_pte_pa(1, to_check, 1);
+
+      THEN("The first translation faults") {
+        REQUIRE(delay_a > champsim::chrono::clock::duration::zero());
+      }
+
+      THEN("The second translation and its page table share the first only if the address space is shared") {
+        if (shared_address_space) {
+          REQUIRE(ppage_a == ppage_b);
+          REQUIRE(delay_b == champsim::chrono::clock::duration::zero());
+          REQUIRE(pte_a == pte_b);
+        } else {
+          REQUIRE(ppage_a != ppage_b);
+          REQUIRE(delay_b > champsim::chrono::clock::duration::zero());
+          REQUIRE(pte_a != pte_b);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,25 @@
+#include <catch.hpp>
+
+#include "champsim.h"
+#include "channel.h"
+
+TEST_CASE("Benchmark the collision checks of a channel", "[.][benchmark]") {
+  auto queue_size = GENERATE(as<std::size_t>{}, 8, 32, 128);
+
+  // Every request is to a distinct block, so that each is compared against every request ahead of it
+  champsim::channel prototype{queue_size, queue_size, queue_size, champsim::data::bits{LOG2_BLOCK_SIZE}, false};
+  for (uint64_t i = 0; i < queue_size; ++i) {
+    champsim::channel::request_type pkt;
+    pkt.address = champsim::address{0x10000000 + i * BLOCK_SIZE};
+    prototype.add_wq(pkt);
+    pkt.address = champsim::address{0x20000000 + i * BLOCK_SIZE};
+    prototype.add_rq(pkt);
+    pkt.address = champsim::address{0x30000000 + i * BLOCK_SIZE};
+    prototype.add_pq(pkt);
+  }
+
+  BENCHMARK_ADVANCED(std::to_string(queue_size) + " requests in each queue")(Catch::Benchmark::Chronometer meter) {
+    std::vector<champsim::channel> uut(static_cast<std::size_t>(meter.runs()), prototype);
+    meter.measure([&uut](int i) { uut.at(static_cast<std::size_t>(i)).check_collision(); });
+  };
+}
@@ -0,0 +1,71 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+TEST_CASE("Benchmark the tag lookup of a cache", "[.][benchmark]") {
+  auto ways = GENERATE(as<uint32_t>{}, 4, 8, 16, 32);
+  constexpr uint32_t sets = 64;
+  constexpr std::size_t batch_size = 64;
+
+  do_nothing_MRC mock_ll;
+  champsim::channel upper{};
+  CACHE uut{champsim::cache_builder{champsim::defaults::default_l1d}
+    .name("991-uut")
+    .sets(sets)
+    .ways(ways)
+    .mshr_size(batch_size)
+    .hit_latency(1)
+    .tag_bandwidth(champsim::bandwidth::maximum_type{batch_size})
+    .fill_bandwidth(champsim::bandwidth::maximum_type{batch_size})
+    .upper_levels({&upper})
+    .lower_level(&mock_ll.queues)
+  };
+
+  std::array<champsim::operable*, 2> elements{{&uut, &mock_ll}};
+  for (auto elem : elements) {
+    elem->initialize();
+    elem->warmup = false;
+    elem->begin_phase();
+  }
+
+  // Successive accesses go to successive sets, and successive visits to a set look for different ways
+  std::vector<champsim::address> resident;
+  for (uint64_t i = 0; i < uint64_t{sets} * ways; ++i) {
+    resident.emplace_back(0x10000000 + i * BLOCK_SIZE);
+  }
+
+  std::size_t next = 0;
+  auto run_batch = [&](std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+      champsim::channel::request_type pkt;
+      pkt.address = resident.at(next);
+      pkt.cpu = 0;
+      pkt.type = access_type::LOAD;
+      upper.add_rq(pkt);
+      next = (next + 1) % std::size(resident);
+    }
+
+    std::size_t returned = 0;
+    long cycles = 0;
+    while (returned < count) {
+      for (auto elem : elements)
+        elem->_operate();
+      returned += std::size(upper.returned);
+      upper.returned.clear();
+      ++cycles;
+    }
+    return cycles;
+  };
+
+  // Fill every way of every set, then check that the batches hit
+  for (std::size_t filled = 0; filled < std::size(resident); filled += batch_size)
+    run_batch(batch_size);
+  const auto misses = uut.sim_stats.misses.total();
+  run_batch(batch_size);
+  REQUIRE(uut.sim_stats.misses.total() == misses);
+
+  BENCHMARK(std::to_string(batch_size) + " hits in a cache of " + std::to_string(ways) + " ways") {
+    return run_batch(batch_size);
+  };
+}
@@ -0,0 +1,58 @@
+#include <catch.hpp>
+#include "msl/lru_table.h"
+#include "access_type.h"
+#include "event_counter.h"
+
+#include <random>
+
+namespace {
+  struct entry
+  {
+    uint64_t value;
+
+    auto index() const { return value; }
+    auto tag() const { return value; }
+  };
+}
+
+TEST_CASE("Benchmark the hits and fills of an lru_table", "[.][benchmark]") {
+  auto ways = GENERATE(as<std::size_t>{}, 4, 8, 16);
+  constexpr std::size_t sets = 256;
+  constexpr std::size_t accesses = 1024;
+
+  // Twice as many distinct values as entries, so that about half of the accesses hit
+  std::mt19937_64 rng{ways};
+  std::uniform_int_distribution<uint64_t> dist{0, 2 * sets * ways - 1};
+  std::vector<::entry> values;
+  std::generate_n(std::back_inserter(values), accesses, [&]{ return ::entry{dist(rng)}; });
+
+  champsim::msl::lru_table<::entry> uut{sets, ways};
+
+  BENCHMARK(std::to_string(accesses) + " accesses to a table of " + std::to_string(ways) + " ways") {
+    std::size_t hits = 0;
+    for (const auto& value : values) {
+      if (uut.check_hit(value).has_value())
+        ++hits;
+      else
+        uut.fill(value);
+    }
+    return hits;
+  };
+}
+
+TEST_CASE("Benchmark the increment of an event_counter", "[.][benchmark]") {
+  auto num_keys = GENERATE(as<std::size_t>{}, 4, 64);
+  constexpr std::size_t increments = 1024;
+
+  std::vector<std::pair<access_type, std::size_t>> keys;
+  for (std::size_t i = 0; i < increments; ++i)
+    keys.emplace_back(access_type::LOAD, (i * 7) % num_keys);
+
+  champsim::stats::event_counter<std::pair<access_type, std::size_t>> uut{};
+
+  BENCHMARK(std::to_string(increments) + " increments over " + std::to_string(num_keys) + " keys") {
+    for (const auto& key : keys)
+      uut.increment(key);
+    return uut.value_or(keys.front(), 0);
+  };
+}
@@ -0,0 +1,51 @@
+#include <catch.hpp>
+
+#include "address.h"
+#include "dram_controller.h"
+
+#include <numeric>
+#include <random>
+
+namespace {
+  std::vector<champsim::address> random_addresses(std::size_t count)
+  {
+    std::mt19937_64 rng{count};
+    std::vector<champsim::address> retval;
+    std::generate_n(std::back_inserter(retval), count, [&]{ return champsim::address{rng() >> 16}; });
+    return retval;
+  }
+}
+
+TEST_CASE("Benchmark the slicing of addresses with dynamic extents", "[.][benchmark]") {
+  constexpr std::size_t count = 1024;
+  const auto addresses = ::random_addresses(count);
+  const champsim::dynamic_extent set_extent{champsim::data::bits{16}, champsim::data::bits{6}};
+
+  BENCHMARK(std::to_string(count) + " dynamic slices") {
+    return std::accumulate(std::begin(addresses), std::end(addresses), uint64_t{}, [&](auto acc, const auto& addr) {
+      return acc + addr.slice(set_extent).template to<uint64_t>();
+    });
+  };
+
+  BENCHMARK(std::to_string(count) + " dynamic upper slices") {
+    return std::accumulate(std::begin(addresses), std::end(addresses), uint64_t{}, [&](auto acc, const auto& addr) {
+      return acc + addr.slice_upper(champsim::data::bits{6}).template to<uint64_t>();
+    });
+  };
+}
+
+TEST_CASE("Benchmark the DRAM address mapping", "[.][benchmark]") {
+  constexpr std::size_t count = 1024;
+  const auto addresses = ::random_addresses(count);
+  const DRAM_ADDRESS_MAPPING uut{champsim::data::bytes{8}, 8, 2, 8, 4, 1024, 2, 65536};
+
+  BENCHMARK(std::to_string(count) + " bank lookups") {
+    return std::accumulate(std::begin(addresses), std::end(addresses), 0ul, [&](auto acc, const auto& addr) { return acc + uut.get_bank(addr); });
+  };
+
+  BENCHMARK(std::to_string(count) + " bit swizzles") {
+    return std::accumulate(std::begin(addresses), std::end(addresses), 0ul, [&](auto acc, const auto& addr) {
+      return acc + uut.swizzle_bits(addr, 16, champsim::data::bits{}, 5, 2);
+    });
+  };
+}
@@ -0,0 +1,40 @@
+#include <catch.hpp>
+
+#include <sstream>
+
+#include "trace_instruction.h"
+#include "tracereader.h"
+
+TEST_CASE("Benchmark the decoding of a trace", "[.][benchmark]") {
+  constexpr std::size_t count = 4096;
+
+  // A mix of loads, stores, and branches, so that each kind of field is decoded
+  std::string raw_trace;
+  for (uint64_t i = 0; i < count; ++i) {
+    input_instr instr{};
+    instr.ip = 0x400000 + 4 * i;
+    instr.is_branch = (i % 8 == 7);
+    instr.branch_taken = instr.is_branch && (i % 16 == 15);
+    instr.source_registers[0] = 1;
+    instr.destination_registers[0] = 2;
+    if (i % 4 == 0)
+      instr.source_memory[0] = 0x10000000 + 8 * i;
+    if (i % 4 == 1)
+      instr.destination_memory[0] = 0x20000000 + 8 * i;
+    raw_trace.append(reinterpret_cast<const char*>(&instr), sizeof(instr));
+  }
+
+  BENCHMARK_ADVANCED("Decode " + std::to_string(count) + " instructions")(Catch::Benchmark::Chronometer meter) {
+    std::vector<champsim::bulk_tracereader<input_instr, std::istringstream>> uut;
+    for (int i = 0; i < meter.runs(); ++i)
+      uut.emplace_back(0, std::istringstream{raw_trace});
+
+    meter.measure([&uut](int i) {
+      auto& reader = uut.at(static_cast<std::size_t>(i));
+      uint64_t checksum = 0;
+      for (std::size_t j = 0; j < count; ++j)
+        checksum += reader().ip.to<uint64_t>();
+      return checksum;
+    });
+  };
+}
@@ -0,0 +1,81 @@
+import unittest
+
+import benchmark.suite
+
+def make_result(kips=1000, peak_rss=100000, host_time=None, configuration='one-core', workload='stream'):
+    return {
+        'configuration': configuration,
+        'workload': workload,
+        'kips': kips,
+        'peak_rss_kib': peak_rss,
+        'host_ns_per_instruction': host_time or { 'O3_CPU': 400, 'CACHE': 500, 'MEMORY_CONTROLLER': 10 }
+    }
+
+class SummarizeTests(unittest.TestCase):
+    def setUp(self):
+        self.stats = [{
+            'name': 'Simulation',
+            'roi': { 'cores': [{ 'instructions': 1000000 }, { 'instructions': 1000000 }] },
+            'host time': {
+                'elapsed': 2.0,
+                'components': [
+                    { 'name': 'cpu0', 'kind': 'O3_CPU', 'seconds': 0.5 },
+                    { 'name': 'cpu1', 'kind': 'O3_CPU', 'seconds': 0.5 },
+                    { 'name': 'cpu0_L1D', 'kind': 'CACHE', 'seconds': 0.2 },
+                    { 'name': 'LLC', 'kind': 'CACHE', 'seconds': 0.4 }
+                ]
+            }
+        }]
+
+    def test_throughput_counts_every_core(self):
+        self.assertEqual(benchmark.suite.summarize(self.stats, 1234)['kips'], 1000)
+
+    def test_peak_rss_is_kept(self):
+        self.assertEqual(benchmark.suite.summarize(self.stats, 1234)['peak_rss_kib'], 1234)
+
+    def test_host_time_is_grouped_by_kind(self):
+        host_time = benchmark.suite.summarize(self.stats, 1234)['host_ns_per_instruction']
+        self.assertEqual(host_time.keys(), { 'O3_CPU', 'CACHE' })
+        self.assertAlmostEqual(host_time['O3_CPU'], 500)
+        self.assertAlmostEqual(host_time['CACHE'], 300)
+
+    def test_unprofiled_run_has_no_host_time(self):
+        del self.stats[0]['host time']['components']
+        self.assertEqual(benchmark.suite.summarize(self.stats, 1234)['host_ns_per_instruction'], {})
+
+class CompareTests(unittest.TestCase):
+    def test_identical_results_do_not_regress(self):
+        self.assertEqual(benchmark.suite.compare([make_result()], [make_result()]), [])
+
+    def test_small_slowdown_is_tolerated(self):
+        self.assertEqual(benchmark.suite.compare([make_result(kips=1000)], [make_result(kips=950)], tolerance=0.1), [])
+
+    def test_throughput_regression(self):
+        regressions = benchmark.suite.compare([make_result(kips=1000)], [make_result(kips=800)], tolerance=0.1)
+        self.assertEqual(len(regressions), 1)
+        self.assertIn('KIPS', regressions[0])
+
+    def test_peak_rss_regression(self):
+        regressions = benchmark.suite.compare([make_result(peak_rss=100000)], [make_result(peak_rss=150000)], tolerance=0.1)
+        self.assertEqual(len(regressions), 1)
+        self.assertIn('RSS', regressions[0])
+
+    def test_component_regression(self):
+        base = make_result()
+        slow_cache = make_result(host_time={ 'O3_CPU': 400, 'CACHE': 700, 'MEMORY_CONTROLLER': 10 })
+        regressions = benchmark.suite.compare([base], [slow_cache], tolerance=0.1)
+        self.assertEqual(len(regressions), 1)
+        self.assertIn('CACHE', regressions[0])
+
+    def test_small_components_are_ignored(self):
+        base = make_result()
+        slow_dram = make_result(host_time={ 'O3_CPU': 400, 'CACHE': 500, 'MEMORY_CONTROLLER': 30 })
+        self.assertEqual(benchmark.suite.compare([base], [slow_dram], tolerance=0.1), [])
+
+    def test_results_are_matched_by_configuration_and_workload(self):
+        baseline = [make_result(kips=1000, workload='stream'), make_result(kips=100, workload='gups')]
+        results = [make_result(kips=100, workload='gups'), make_result(kips=1000, workload='stream')]
+        self.assertEqual(benchmark.suite.compare(baseline, results), [])
+
+    def test_new_results_are_not_compared(self):
+        self.assertEqual(benchmark.suite.compare([make_result(workload='stream')], [make_result(kips=1, workload='mix')]), [])
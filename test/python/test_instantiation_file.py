@@ -95,6 +95,42 @@ class CpuBuilderTest(unittest.TestCase):
     def test_dib_window(self):
         self.get_element_diff(['.dib_window(1)'], dib_window=1)
 
+    def test_threads(self):
+        self.get_element_diff(['.threads(2)'], threads=2)
+
+    def test_smt_fetch_policy(self):
+        self.get_element_diff(['.smt_fetch(champsim::smt_fetch_policy::round_robin)'], smt_fetch_policy='round_robin')
+        self.get_element_diff(['.smt_fetch(champsim::smt_fetch_policy::icount)'], smt_fetch_policy='icount')
+
+    def test_smt_partitioning(self):
+        self.get_element_diff(['.smt_partition(champsim::smt_partitioning::partitioned)'], smt_partitioning='partitioned')
+
+    def test_ftq_size(self):
+        self.get_element_diff(['.ftq_size(24)'], ftq_size=24)
+
+    def test_runahead_width(self):
+        self.get_element_diff(['.runahead_width(champsim::bandwidth::maximum_type{2})'], runahead_width=2)
+
+    def test_wrong_path(self):
+        self.get_element_diff(['.set_wrong_path()'], wrong_path=True)
+        self.get_element_diff(['.reset_wrong_path()'], wrong_path=False)
+
+    def test_shared_address_space(self):
+        self.get_element_diff(['.set_shared_address_space()'], shared_address_space=True)
+        self.get_element_diff(['.reset_shared_address_space()'], shared_address_space=False)
+
+    def test_memory_dependence(self):
+        self.get_element_diff(['.memory_dependence(champsim::memory_dependence_policy::store_sets)'], memory_dependence='store_sets')
+
+    def test_execution_ports(self):
+        self.get_element_diff(['.execution_ports({champsim::execution_port{"port0", 1, {champsim::op_class::alu}, 1, true}})'],
+            execution_ports=[{'ops': ['alu']}])
+        self.get_element_diff(['.execution_ports({champsim::execution_port{"div", 1, {champsim::op_class::alu, champsim::op_class::fp}, 12, false}})'],
+            execution_ports=[{'name': 'div', 'ops': ['alu', 'fp'], 'latency': 12, 'pipelined': False}])
+
+    def test_fp_registers(self):
+        self.get_element_diff(['.fp_registers(32, 63)'], fp_registers=[32, 63])
+
     def test_dib_set_dict(self):
         self.get_element_diff(['.dib_set(1)'], DIB={ 'sets': 1 })
 
@@ -176,6 +212,25 @@ class CacheBuilderTests(unittest.TestCase):
         self.get_element_diff(['.prefetch_activate(access_type::LOAD)'], prefetch_activate=['LOAD'])
         self.get_element_diff(['.prefetch_activate(access_type::LOAD, access_type::WRITE)'], prefetch_activate=['LOAD', 'WRITE'])
 
+    def test_mrc_sets(self):
+        self.get_element_diff(['.stack_distance_sets({1024})'], mrc_sets=[1024])
+        self.get_element_diff(['.stack_distance_sets({1024, 2048})'], mrc_sets=[1024, 2048])
+
+    def test_mrc_ways(self):
+        self.get_element_diff(['.stack_distance_ways(32)'], mrc_ways=32)
+
+    def test_inclusion(self):
+        self.get_element_diff(['.inclusion(champsim::inclusion_policy::inclusive)'], inclusion='inclusive')
+        self.get_element_diff(['.inclusion(champsim::inclusion_policy::exclusive)'], inclusion='exclusive')
+
+    def test_coherence(self):
+        self.get_element_diff(['.coherence(champsim::coherence_protocol::mesi)'], coherence='mesi')
+        self.get_element_diff(['.coherence(champsim::coherence_protocol::moesi)'], coherence='moesi')
+
+    def test_prefetch_throttle(self):
+        self.get_element_diff(['.prefetch_throttle(champsim::prefetch_throttle_policy::fdp)'], prefetch_throttle='fdp')
+        self.get_element_diff(['.prefetch_throttle(champsim::prefetch_throttle_policy::bandwidth)'], prefetch_throttle='bandwidth')
+
     @unittest.skip
     def test_lower_translate(self):
         self.get_element_diff(['.lower_translate(&test_cache_to_test_lt_channel)'], lower_translate='test_lt')
@@ -304,3 +359,55 @@ class GetQueueInfoTests(unittest.TestCase):
             { 'is_good_boy': False }
         ]
         self.assertEqual(expected, evaluated)
+
+class ModuleRegistryLinesTests(unittest.TestCase):
+    def test_modules_are_added_by_class_name(self):
+        with tempfile.TemporaryDirectory() as dtemp:
+            module_info = {
+                'pref': [{ 'class': 'pig', 'path': dtemp, 'legacy': False }],
+                'repl': [{ 'class': 'cow', 'path': dtemp, 'legacy': False }],
+                'branch': [{ 'class': 'dog', 'path': dtemp, 'legacy': False }],
+                'btb': [{ 'class': 'cat', 'path': dtemp, 'legacy': False }]
+            }
+            evaluated = [l.strip() for l in config.instantiation_file.get_module_registry_lines(module_info)]
+            self.assertIn('reg.add_prefetcher<class pig>("pig");', evaluated)
+            self.assertIn('reg.add_replacement<class cow>("cow");', evaluated)
+            self.assertIn('reg.add_branch_predictor<class dog>("dog");', evaluated)
+            self.assertIn('reg.add_btb<class cat>("cat");', evaluated)
+
+    def test_legacy_module_headers_are_not_included(self):
+        with tempfile.TemporaryDirectory() as dtemp:
+            with open(os.path.join(dtemp, 'pig.h'), 'wt') as wfp:
+                print('', file=wfp)
+            module_info = {
+                'pref': [{ 'class': 'pig', 'path': dtemp, 'legacy': True }]
+            }
+            evaluated = [l.strip() for l in config.instantiation_file.get_module_registry_lines(module_info)]
+            self.assertNotIn(f'#include "{os.path.join(dtemp, "pig.h")}"', evaluated)
+            self.assertIn('reg.add_prefetcher<class pig>("pig");', evaluated)
+
+class CacheOperateLinesTests(unittest.TestCase):
+    def test_operate_is_instantiated_for_each_pair_of_modules(self):
+        with tempfile.TemporaryDirectory() as dtemp:
+            pig = { 'class': 'pig', 'path': dtemp, 'legacy': False }
+            cow = { 'class': 'cow', 'path': dtemp, 'legacy': False }
+            dog = { 'class': 'dog', 'path': dtemp, 'legacy': False }
+            evaluated = [l.strip() for l in config.instantiation_file.get_cache_operate_lines([([pig], [cow]), ([pig], [cow, dog])])]
+            self.assertIn('template long CACHE::operate_as<CACHE::prefetcher_module_model<class pig>, CACHE::replacement_module_model<class cow>>(CACHE& cache);', evaluated)
+            self.assertIn('template long CACHE::operate_as<CACHE::prefetcher_module_model<class pig>, CACHE::replacement_module_model<class cow, class dog>>(CACHE& cache);', evaluated)
+
+    def test_repeated_pairs_are_instantiated_once(self):
+        with tempfile.TemporaryDirectory() as dtemp:
+            pig = { 'class': 'pig', 'path': dtemp, 'legacy': False }
+            cow = { 'class': 'cow', 'path': dtemp, 'legacy': False }
+            evaluated = [l.strip() for l in config.instantiation_file.get_cache_operate_lines([([pig], [cow]), ([pig], [cow])])]
+            self.assertEqual(1, sum(l.startswith('template long CACHE::operate_as') for l in evaluated))
+
+    def test_legacy_module_headers_are_not_included(self):
+        with tempfile.TemporaryDirectory() as dtemp:
+            with open(os.path.join(dtemp, 'pig.h'), 'wt') as wfp:
+                print('', file=wfp)
+            pig = { 'class': 'pig', 'path': dtemp, 'legacy': True }
+            evaluated = [l.strip() for l in config.instantiation_file.get_cache_operate_lines([([pig], [])])]
+            self.assertNotIn(f'#include "{os.path.join(dtemp, "pig.h")}"', evaluated)
+            self.assertIn('template long CACHE::operate_as<CACHE::prefetcher_module_model<class pig>, CACHE::replacement_module_model<>>(CACHE& cache);', evaluated)
@@ -3,6 +3,7 @@ import itertools
 import random
 
 import config.parse
+import config.util
 
 class ExecutableNameTests(unittest.TestCase):
 
@@ -714,3 +715,175 @@ class PathEndInTests(unittest.TestCase):
                 path = ({'name': x} for x in range(length))
                 result = config.parse.path_end_in(path, 'last')
                 self.assertEqual(result, {'name': length-1, 'lower_level': 'last'})
+
+class CheckInclusionTests(unittest.TestCase):
+    def test_known_policies_are_accepted(self):
+        for policy in ('nine', 'inclusive', 'exclusive'):
+            with self.subTest(policy=policy):
+                config.parse.check_inclusion(({'name': 'test_cache', 'inclusion': policy},))
+
+    def test_policy_may_be_omitted(self):
+        config.parse.check_inclusion(({'name': 'test_cache'},))
+
+    def test_unknown_policy_is_rejected(self):
+        with self.assertRaises(ValueError):
+            config.parse.check_inclusion(({'name': 'test_cache', 'inclusion': 'strict'},))
+
+class CheckCoherenceTests(unittest.TestCase):
+    def test_known_protocols_are_accepted(self):
+        for protocol in ('none', 'mesi', 'moesi'):
+            with self.subTest(protocol=protocol):
+                config.parse.check_coherence(({'name': 'test_cache', 'coherence': protocol},))
+
+    def test_protocol_may_be_omitted(self):
+        config.parse.check_coherence(({'name': 'test_cache'},))
+
+    def test_unknown_protocol_is_rejected(self):
+        with self.assertRaises(ValueError):
+            config.parse.check_coherence(({'name': 'test_cache', 'coherence': 'msi'},))
+
+class CheckPrefetchThrottleTests(unittest.TestCase):
+    def test_known_policies_are_accepted(self):
+        for policy in ('none', 'fdp', 'bandwidth'):
+            with self.subTest(policy=policy):
+                config.parse.check_prefetch_throttle(({'name': 'test_cache', 'prefetch_throttle': policy},))
+
+    def test_policy_may_be_omitted(self):
+        config.parse.check_prefetch_throttle(({'name': 'test_cache'},))
+
+    def test_unknown_policy_is_rejected(self):
+        with self.assertRaises(ValueError):
+            config.parse.check_prefetch_throttle(({'name': 'test_cache', 'prefetch_throttle': 'hpac'},))
+
+class CheckSmtTests(unittest.TestCase):
+    def test_known_policies_are_accepted(self):
+        for policy, partitioning in itertools.product(('icount', 'round_robin'), ('shared', 'partitioned')):
+            with self.subTest(policy=policy, partitioning=partitioning):
+                config.parse.check_smt(({'name': 'test_cpu', 'threads': 2, 'smt_fetch_policy': policy, 'smt_partitioning': partitioning},))
+
+    def test_threads_may_be_omitted(self):
+        config.parse.check_smt(({'name': 'test_cpu'},))
+
+    def test_thread_count_is_bounded(self):
+        for threads in (0, 5):
+            with self.subTest(threads=threads):
+                with self.assertRaises(ValueError):
+                    config.parse.check_smt(({'name': 'test_cpu', 'threads': threads},))
+
+    def test_unknown_policy_is_rejected(self):
+        with self.assertRaises(ValueError):
+            config.parse.check_smt(({'name': 'test_cpu', 'smt_fetch_policy': 'fifo'},))
+        with self.assertRaises(ValueError):
+            config.parse.check_smt(({'name': 'test_cpu', 'smt_partitioning': 'dynamic'},))
+
+class CheckMemoryDependenceTests(unittest.TestCase):
+    def test_known_policies_are_accepted(self):
+        for policy in ('oracle', 'wait_all', 'store_sets'):
+            with self.subTest(policy=policy):
+                config.parse.check_memory_dependence(({'name': 'test_cpu', 'memory_dependence': policy},))
+
+    def test_policy_may_be_omitted(self):
+        config.parse.check_memory_dependence(({'name': 'test_cpu'},))
+
+    def test_unknown_policy_is_rejected(self):
+        with self.assertRaises(ValueError):
+            config.parse.check_memory_dependence(({'name': 'test_cpu', 'memory_dependence': 'store_vectors'},))
+
+class CheckExecutionPortsTests(unittest.TestCase):
+    def test_ports_may_be_omitted(self):
+        config.parse.check_execution_ports(({'name': 'test_cpu'},))
+
+    def test_known_classes_are_accepted(self):
+        config.parse.check_execution_ports(({'name': 'test_cpu', 'execution_ports': [
+            {'ops': ['alu', 'branch'], 'count': 4},
+            {'ops': ['fp'], 'latency': 4},
+            {'ops': ['load', 'store'], 'count': 3}
+        ]},))
+
+    def test_unknown_class_is_rejected(self):
+        with self.assertRaises(ValueError):
+            config.parse.check_execution_ports(({'name': 'test_cpu', 'execution_ports': [{'ops': ['simd']}]},))
+
+    def test_port_must_accept_something(self):
+        with self.assertRaises(ValueError):
+            config.parse.check_execution_ports(({'name': 'test_cpu', 'execution_ports': [{'ops': []}]},))
+
+    def test_count_must_be_positive(self):
+        with self.assertRaises(ValueError):
+            config.parse.check_execution_ports(({'name': 'test_cpu', 'execution_ports': [{'ops': ['alu'], 'count': 0}]},))
+
+    def test_fp_registers_are_a_range(self):
+        with self.assertRaises(ValueError):
+            config.parse.check_execution_ports(({'name': 'test_cpu', 'fp_registers': [32]},))
+
+class SliceCachesTests(unittest.TestCase):
+    def get_caches(self, llc):
+        return {
+            'ul0': {'name': 'ul0', 'lower_level': 'llc'},
+            'ul1': {'name': 'ul1', 'lower_level': 'llc'},
+            'llc': {'name': 'llc', 'lower_level': 'DRAM', 'frequency': 2000, 'ways': 8, **llc}
+        }
+
+    def test_unsliced_caches_are_unchanged(self):
+        caches = self.get_caches({})
+        result, _, interconnects = config.parse.slice_caches(caches)
+        self.assertEqual(result, caches)
+        self.assertEqual(interconnects, [])
+
+    def test_slices_replace_the_cache(self):
+        result, _, _ = config.parse.slice_caches(self.get_caches({'slices': 4}))
+        self.assertEqual(set(result.keys()), {'ul0', 'ul1', 'llc_0', 'llc_1', 'llc_2', 'llc_3'})
+        for i in range(4):
+            self.assertEqual(result[f'llc_{i}']['lower_level'], 'DRAM')
+            self.assertEqual(result[f'llc_{i}']['ways'], 8)
+            self.assertNotIn('slices', result[f'llc_{i}'])
+
+    def test_upper_levels_connect_to_the_interconnect(self):
+        result, _, interconnects = config.parse.slice_caches(self.get_caches({'slices': 2}))
+        self.assertEqual(len(interconnects), 1)
+        self.assertEqual(result['ul0']['lower_level'], interconnects[0]['name'])
+        self.assertEqual(result['ul1']['lower_level'], interconnects[0]['name'])
+        self.assertEqual(interconnects[0]['_uppers'], ['ul0', 'ul1'])
+        self.assertEqual(interconnects[0]['_slices'], ['llc_0', 'llc_1'])
+
+    def test_capacity_is_divided(self):
+        cases = (
+            ({'sets': 2048}, {'sets': 512}),
+            ({'log2_sets': 11}, {'sets': 512}),
+            ({'size': 1048576}, {'size': 262144}),
+            ({'log2_size': 20}, {'size': 262144}),
+            ({}, {'sets': 2048*2//4})
+        )
+        for given, expected in cases:
+            with self.subTest(given=given):
+                result, _, _ = config.parse.slice_caches(self.get_caches({'slices': 4, **given}))
+                self.assertEqual(config.util.subdict(result['llc_0'], ('sets', 'log2_sets', 'size', 'log2_size')), expected)
+
+    def test_interconnect_inherits_the_frequency(self):
+        _, _, interconnects = config.parse.slice_caches(self.get_caches({'slices': 2}))
+        self.assertEqual(interconnects[0]['frequency'], 2000)
+
+    def test_interconnect_parameters_are_passed_through(self):
+        noc = {'name': 'ring0', 'topology': 'mesh', 'mesh_width': 2, 'hop_latency': 3, 'link_bandwidth': 4, 'buffer_size': 5, 'frequency': 1000}
+        _, _, interconnects = config.parse.slice_caches(self.get_caches({'slices': 2, 'interconnect': noc}))
+        self.assertEqual(config.util.subdict(interconnects[0], noc.keys()), noc)
+
+    def test_unknown_topology_is_rejected(self):
+        with self.assertRaises(ValueError):
+            config.parse.slice_caches(self.get_caches({'slices': 2, 'interconnect': {'topology': 'torus'}}))
+
+    def test_slices_must_be_a_power_of_two(self):
+        for slices in (3, 6, 12):
+            with self.subTest(slices=slices):
+                with self.assertRaises(ValueError):
+                    config.parse.slice_caches(self.get_caches({'slices': slices, 'sets': 4096}))
+
+    def test_page_table_walkers_connect_to_the_interconnect(self):
+        ptws = {
+            'ptw0': {'name': 'ptw0', 'lower_level': 'llc'},
+            'ptw1': {'name': 'ptw1', 'lower_level': 'ul0'}
+        }
+        _, result, interconnects = config.parse.slice_caches(self.get_caches({'slices': 2}), ptws)
+        self.assertEqual(result['ptw0']['lower_level'], interconnects[0]['name'])
+        self.assertEqual(result['ptw1']['lower_level'], 'ul0')
+        self.assertEqual(interconnects[0]['_uppers'], ['ul0', 'ul1', 'ptw0'])
@@ -0,0 +1,124 @@
+import unittest
+
+import config.parse
+import config.runtime
+
+class OffsetBitsTests(unittest.TestCase):
+    def test_number(self):
+        self.assertEqual(config.runtime.offset_bits(6, 64, 4096), 6)
+
+    def test_logarithm_of_number(self):
+        self.assertEqual(config.runtime.offset_bits('champsim::lg2(64)', 64, 4096), 6)
+
+    def test_logarithm_of_block_size(self):
+        self.assertEqual(config.runtime.offset_bits('champsim::lg2(BLOCK_SIZE)', 128, 4096), 7)
+
+    def test_logarithm_of_page_size(self):
+        self.assertEqual(config.runtime.offset_bits('champsim::lg2(PAGE_SIZE)', 64, 8192), 13)
+
+class QueueSizeTests(unittest.TestCase):
+    def test_number(self):
+        self.assertEqual(config.runtime.queue_size(16), 16)
+
+    def test_unbounded(self):
+        self.assertIsNone(config.runtime.queue_size('std::numeric_limits<std::size_t>::max()'))
+
+class CopiedTests(unittest.TestCase):
+    def test_keys_are_renamed(self):
+        self.assertEqual(config.runtime.copied({ 'max_tag_check': 2 }, config.runtime.cache_copied_keys), { 'tag_bandwidth': 2 })
+
+    def test_missing_keys_are_omitted(self):
+        self.assertEqual(config.runtime.copied({ 'cow': 'moo' }, config.runtime.cache_copied_keys), {})
+
+class ClockPeriodTests(unittest.TestCase):
+    def test_frequency_is_converted(self):
+        self.assertEqual(config.runtime.clock_period({ 'frequency': 4000 }), { 'clock_period': 250 })
+
+    def test_no_frequency(self):
+        self.assertEqual(config.runtime.clock_period({}), {})
+
+class RuntimeDescriptionTests(unittest.TestCase):
+    def get_description(self, config_dict):
+        _, elements, _, _, config_file = config.parse.parse_config(config_dict)
+        return config.runtime.get_runtime_description(**elements, config_file=config_file)
+
+    def test_sizes_are_recorded(self):
+        evaluated = self.get_description({})
+        self.assertEqual(evaluated['num_cpus'], 1)
+        self.assertEqual(evaluated['block_size'], 64)
+        self.assertEqual(evaluated['page_size'], 4096)
+
+    def test_every_cache_is_described(self):
+        evaluated = self.get_description({})
+        self.assertEqual({c['name'] for c in evaluated['caches']}, {'cpu0_L1I', 'cpu0_L1D', 'cpu0_L2C', 'cpu0_ITLB', 'cpu0_DTLB', 'cpu0_STLB', 'LLC'})
+
+    def test_channels_are_numbered(self):
+        evaluated = self.get_description({})
+        for elem in (*evaluated['caches'], *evaluated['ptws']):
+            self.assertLess(elem['lower_level'], len(evaluated['channels']))
+            for ul in elem['upper_levels']:
+                self.assertLess(ul, len(evaluated['channels']))
+
+    def test_inclusion_is_recorded(self):
+        evaluated = self.get_description({'LLC': {'inclusion': 'inclusive'}})
+        llc = next(c for c in evaluated['caches'] if c['name'] == 'LLC')
+        self.assertEqual(llc['inclusion'], 'inclusive')
+
+    def test_coherence_is_recorded(self):
+        evaluated = self.get_description({'LLC': {'coherence': 'moesi'}})
+        llc = next(c for c in evaluated['caches'] if c['name'] == 'LLC')
+        self.assertEqual(llc['coherence'], 'moesi')
+
+    def test_prefetch_throttle_is_recorded(self):
+        evaluated = self.get_description({'L2C': {'prefetch_throttle': 'fdp'}})
+        l2c = next(c for c in evaluated['caches'] if c['name'] == 'cpu0_L2C')
+        self.assertEqual(l2c['prefetch_throttle'], 'fdp')
+
+    def test_shared_address_space_is_recorded(self):
+        self.assertFalse(self.get_description({})['vmem']['shared_address_space'])
+        self.assertTrue(self.get_description({'virtual_memory': {'shared_address_space': True}})['vmem']['shared_address_space'])
+
+    def test_cores_share_the_address_space_of_the_virtual_memory(self):
+        self.assertNotIn('shared_address_space', self.get_description({})['cores'][0])
+        self.assertTrue(self.get_description({'virtual_memory': {'shared_address_space': True}})['cores'][0]['shared_address_space'])
+
+    def test_smt_is_recorded(self):
+        evaluated = self.get_description({'threads': 2, 'smt_fetch_policy': 'round_robin', 'smt_partitioning': 'partitioned'})
+        self.assertEqual(evaluated['cores'][0]['threads'], 2)
+        self.assertEqual(evaluated['cores'][0]['smt_fetch_policy'], 'round_robin')
+        self.assertEqual(evaluated['cores'][0]['smt_partitioning'], 'partitioned')
+
+    def test_ftq_is_recorded(self):
+        evaluated = self.get_description({'ftq_size': 24, 'runahead_width': 2})
+        self.assertEqual(evaluated['cores'][0]['ftq_size'], 24)
+        self.assertEqual(evaluated['cores'][0]['runahead_width'], 2)
+
+    def test_wrong_path_is_recorded(self):
+        self.assertNotIn('wrong_path', self.get_description({})['cores'][0])
+        self.assertTrue(self.get_description({'wrong_path': True})['cores'][0]['wrong_path'])
+
+    def test_memory_dependence_is_recorded(self):
+        self.assertEqual(self.get_description({'memory_dependence': 'wait_all'})['cores'][0]['memory_dependence'], 'wait_all')
+
+    def test_execution_ports_are_recorded(self):
+        ports = [{'name': 'alu', 'ops': ['alu', 'branch'], 'count': 4}]
+        evaluated = self.get_description({'execution_ports': ports, 'fp_registers': [32, 63]})
+        self.assertEqual(evaluated['cores'][0]['execution_ports'], ports)
+        self.assertEqual(evaluated['cores'][0]['fp_registers'], [32, 63])
+
+    def test_cores_name_their_caches(self):
+        evaluated = self.get_description({})
+        self.assertEqual(evaluated['cores'][0]['l1i'], 'cpu0_L1I')
+        self.assertEqual(evaluated['cores'][0]['l1d'], 'cpu0_L1D')
+
+    def test_sliced_caches_are_connected_through_an_interconnect(self):
+        evaluated = self.get_description({'num_cores': 2, 'LLC': {'slices': 2}})
+        self.assertEqual(len(evaluated['interconnects']), 1)
+        noc = evaluated['interconnects'][0]
+        self.assertEqual(len(noc['upper_levels']), 2)
+        self.assertEqual([len(ll) for ll in noc['lower_levels']], [2, 2])
+
+        slices = {c['name']: c for c in evaluated['caches'] if c['name'].startswith('LLC_')}
+        self.assertEqual(set(slices.keys()), {'LLC_0', 'LLC_1'})
+        for i, name in enumerate(('LLC_0', 'LLC_1')):
+            self.assertEqual(slices[name]['upper_levels'], [ll[i] for ll in noc['lower_levels']])
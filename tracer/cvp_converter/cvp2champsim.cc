@@ -17,12 +17,21 @@
 #include <algorithm>
 #include <assert.h>
 #include <cstdint>
+#include <deque>
+#include <fstream>
+#include <future>
 #include <map>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <lzma.h>
 
 #include "../../inc/trace_instruction.h"
+#include "../../inc/zstd_seekable.h"
 
 // defines for the paths for the various decompression programs and Apple/Linux differences
 
@@ -114,6 +123,27 @@ struct trace {
   // read a single record from the trace file, return true on success, false on EOF
 
   bool read(FILE* f)
+  {
+    return read_from([f](void* dest, std::size_t size) { return fread(dest, size, 1, f) == 1; });
+  }
+
+  // read a single record from memory, advancing the pointer past it
+
+  bool read(const unsigned char*& p, const unsigned char* end)
+  {
+    return read_from([&p, end](void* dest, std::size_t size) {
+      if (static_cast<std::size_t>(end - p) < size)
+        return false;
+      memcpy(dest, p, size);
+      p += size;
+      return true;
+    });
+  }
+
+  // read a single record through a function that copies bytes from the source, returning false if they are not there
+
+  template <typename F>
+  bool read_from(F&& get)
   {
 
     // initialize
@@ -127,17 +157,13 @@ struct trace {
 
     // get the PC
 
-    int n;
-    n = fread(&PC, 8, 1, f);
-    if (!n)
+    if (!get(&PC, 8))
       return false;
-    if (feof(f))
-      return false;
-    assert(n == 1);
 
     // get the instruction type
 
-    assert(fread(&type, 1, 1, f) == 1);
+    bool good = get(&type, 1);
+    assert(good);
 
     // base on the type, read in different stuff
 
@@ -146,8 +172,8 @@ struct trace {
     case storeInstClass:
       // load or store? get the effective address and access size
 
-      assert(fread(&EA, 8, 1, f) == 1);
-      assert(fread(&access_size, 1, 1, f) == 1);
+      good = get(&EA, 8) && get(&access_size, 1);
+      assert(good);
       break;
     case condBranchInstClass:
     case uncondDirectBranchInstClass:
@@ -155,9 +181,11 @@ struct trace {
 
       // branch? get "taken" and the target
 
-      assert(fread(&taken, 1, 1, f) == 1);
+      good = get(&taken, 1);
+      assert(good);
       if (taken) {
-        assert(fread(&target, 8, 1, f) == 1);
+        good = get(&target, 8);
+        assert(good);
       } else {
         // if not taken, default target is fallthru, i.e. PC+4
         target = PC + 4;
@@ -173,16 +201,20 @@ struct trace {
 
     // get the number of input registers and their names
 
-    assert(fread(&num_input_regs, 1, 1, f) == 1);
+    good = get(&num_input_regs, 1);
+    assert(good);
     for (int i = 0; i < num_input_regs; i++) {
-      assert(fread(&input_reg_names[i], 1, 1, f) == 1);
+      good = get(&input_reg_names[i], 1);
+      assert(good);
     }
 
     // get the number of output registers and their names
 
-    assert(fread(&num_output_regs, 1, 1, f) == 1);
+    good = get(&num_output_regs, 1);
+    assert(good);
     for (int i = 0; i < num_output_regs; i++) {
-      assert(fread(&output_reg_names[i], 1, 1, f) == 1);
+      good = get(&output_reg_names[i], 1);
+      assert(good);
     }
 
     // read the output registers
@@ -191,13 +223,16 @@ struct trace {
     for (int i = 0; i < num_output_regs; i++) {
       if (output_reg_names[i] <= 31 || output_reg_names[i] == 64) {
         // scalars or flags?
-        assert(fread(&output_reg_values[i][0], 8, 1, f) == 1);
+        good = get(&output_reg_values[i][0], 8);
+        assert(good);
       } else if (output_reg_names[i] >= 32 && output_reg_names[i] < 64) {
         // SIMD values?
-        assert(fread(&output_reg_values[i][0], 16, 1, f) == 1);
+        good = get(&output_reg_values[i][0], 16);
+        assert(good);
       } else
         assert(0);
     }
+    (void)good;
 
     // success!
 
@@ -319,35 +354,590 @@ void preprocess_file(void)
   fflush(stderr);
 }
 
+// give a code page that is also used for data a new page of its own
+
+UINT64 allocate_page(UINT64 page)
+{
+  static int num_allocs = 0;
+  num_allocs++;
+  fprintf(stderr, "[%d]", num_allocs);
+  fflush(stderr);
+  // allocate a new page
+  UINT64 new_page = bump_page;
+  for (;;) {
+    if (code_pages.find(new_page) != code_pages.end() || data_pages.find(new_page) != data_pages.end())
+      new_page++;
+    else
+      break;
+  }
+  bump_page = new_page + 1;
+  remapped_pages[page] = new_page;
+  return new_page;
+}
+
 // take an address representing data and make sure it doesn't overlap with code
 
 UINT64 transform(UINT64 a)
 {
-  static int num_allocs = 0;
   UINT64 page = a >> 12;
   UINT64 new_page = page;
   if (code_pages.find(page) != code_pages.end()) {
-    new_page = remapped_pages[page];
-    if (new_page == 0) {
-      num_allocs++;
-      fprintf(stderr, "[%d]", num_allocs);
-      fflush(stderr);
-      // allocate a new page
-      new_page = bump_page;
-      for (;;) {
-        if (code_pages.find(new_page) != code_pages.end() || data_pages.find(new_page) != data_pages.end())
-          new_page++;
-        else
-          break;
-      }
-      bump_page = new_page + 1;
-      remapped_pages[page] = new_page;
-    }
+    auto found = remapped_pages.find(page);
+    new_page = (found != remapped_pages.end()) ? found->second : allocate_page(page);
   }
   a = new_page << 12 | (a & 0xfff);
   return a;
 }
 
+// figure out the op type of a record
+
+OpType classify(const trace& t)
+{
+  // if this is a branch then do more stuff; we don't care about non-branches
+
+  if (!is_branch(t.type))
+    return OPTYPE_OP;
+
+  // if this is a conditional branch then it's direct and we're done figuring out the type
+
+  if (t.type == condBranchInstClass)
+    return OPTYPE_JMP_DIRECT_COND;
+
+  // this is some other kind of branch. it should have a non-zero target
+
+  assert(t.target);
+
+  OpType c;
+
+  // on ARM, calls link the return address in register X30. let's see if this
+  // instruction is doing that; if so, it's a call or wants us to believe it is
+
+  if (t.num_output_regs == 1 && t.output_reg_names[0] == 30) {
+
+    // is it indirect?
+
+    if (t.type == uncondIndirectBranchInstClass)
+      c = OPTYPE_CALL_INDIRECT_UNCOND;
+    else
+      c = OPTYPE_CALL_DIRECT_UNCOND;
+  } else {
+    // no X30? then it's just an unconditional jump
+    // is it indirect?
+
+    if (t.type == uncondIndirectBranchInstClass)
+      c = OPTYPE_JMP_INDIRECT_UNCOND;
+    else
+      c = OPTYPE_JMP_DIRECT_UNCOND;
+  }
+
+  // on ARM, returns are an indirect jump to X30. let's see if we're doing this
+
+  if (t.num_input_regs == 1)
+    if (t.input_reg_names[0] == 30) {
+
+      // yes. it's a return.
+
+      c = OPTYPE_RET_UNCOND;
+    }
+
+  return c;
+}
+
+// make a ChampSim instruction out of a record. the register lists of the record are trimmed to fit
+
+trace_instr_format convert(trace& t, OpType c)
+{
+  trace_instr_format ct = {};
+  ct.ip = t.PC;
+  ct.is_branch = false;
+
+  if (is_branch(t.type)) {
+    ct.is_branch = true;
+
+    // OK now make a branch instruction out of this bad boy
+
+    switch (c) {
+    case OPTYPE_JMP_DIRECT_UNCOND:
+      // writes IP only
+      ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
+      ct.branch_taken = t.taken;
+      break;
+    case OPTYPE_JMP_DIRECT_COND:
+      ct.branch_taken = t.taken;
+      // reads FLAGS, writes IP
+      ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
+      // turns out pin records conditional direct branches as also reading IP. whatever.
+      ct.source_registers[0] = champsim::REG_INSTRUCTION_POINTER;
+      ct.source_registers[1] = champsim::REG_FLAGS;
+      break;
+    case OPTYPE_CALL_INDIRECT_UNCOND:
+      ct.branch_taken = true;
+      // reads something else, reads IP, reads SP, writes SP, writes IP
+      ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
+      ct.destination_registers[1] = champsim::REG_STACK_POINTER;
+      ct.source_registers[0] = champsim::REG_INSTRUCTION_POINTER;
+      ct.source_registers[1] = champsim::REG_STACK_POINTER;
+      ct.source_registers[2] = ::REG_AX;
+      break;
+    case OPTYPE_CALL_DIRECT_UNCOND:
+      ct.branch_taken = true;
+      // reads IP, reads SP, writes SP, writes IP
+      ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
+      ct.destination_registers[1] = champsim::REG_STACK_POINTER;
+      ct.source_registers[0] = champsim::REG_INSTRUCTION_POINTER;
+      ct.source_registers[1] = champsim::REG_STACK_POINTER;
+      break;
+    case OPTYPE_JMP_INDIRECT_UNCOND:
+      ct.branch_taken = true;
+      // reads something else, writes IP
+      ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
+      ct.source_registers[0] = ::REG_AX;
+      break;
+    case OPTYPE_RET_UNCOND:
+      ct.branch_taken = true;
+      // reads SP, writes SP, writes IP
+      ct.source_registers[0] = champsim::REG_STACK_POINTER;
+      ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
+      ct.destination_registers[1] = champsim::REG_STACK_POINTER;
+      break;
+    default:
+      assert(0);
+    }
+  } else {
+    if (t.num_input_regs > NUM_INSTR_SOURCES)
+      t.num_input_regs = NUM_INSTR_SOURCES;
+    if (t.num_output_regs == 0) {
+      t.num_output_regs = 1;
+      t.output_reg_names[0] = 0;
+    }
+    // for (int a=0; a<t.num_output_regs; a++) {
+    for (int a = 0; a < 1; a++) {
+      int x = t.output_reg_names[a];
+      if (x == champsim::REG_INSTRUCTION_POINTER)
+        x = 64;
+      if (x == champsim::REG_STACK_POINTER)
+        x = 65;
+      if (x == champsim::REG_FLAGS)
+        x = 66;
+      if (x == 0)
+        x = 67;
+      ct.destination_registers[a] = x;
+      for (int i = 0; i < t.num_input_regs; i++) {
+        int x = t.input_reg_names[i];
+        if (x == champsim::REG_INSTRUCTION_POINTER)
+          x = 64;
+        if (x == champsim::REG_STACK_POINTER)
+          x = 65;
+        if (x == champsim::REG_FLAGS)
+          x = 66;
+        if (x == 0)
+          x = 67;
+        ct.source_registers[i] = x;
+      }
+      switch (t.type) {
+      case loadInstClass:
+        ct.source_memory[0] = transform(t.EA);
+        break;
+      case storeInstClass:
+        ct.destination_memory[0] = transform(t.EA);
+        break;
+      case aluInstClass:
+      case fpInstClass:
+      case slowAluInstClass:
+        break;
+      case uncondDirectBranchInstClass:
+      case condBranchInstClass:
+      case uncondIndirectBranchInstClass:
+      case undefInstClass:
+        assert(0);
+      }
+    }
+  }
+  return ct;
+}
+
+/* ================================================================== */
+// Parallel conversion
+//
+// A CVP trace has no markers between its records, but the length of a
+// record can be found from a few of its bytes. The reader walks the
+// decompressed trace to split it into chunks of whole records, which are
+// decoded on a pool of threads. The results are consumed in the order of
+// the chunks, so the output is the same as that of a sequential pass.
+/* ================================================================== */
+
+unsigned num_threads = 0;
+std::size_t chunk_records = 1 << 16;
+
+// find the length of the record at the start of a buffer, or 0 if the buffer does not hold all of it
+
+std::size_t record_length(const unsigned char* p, std::size_t avail)
+{
+  std::size_t len = 9; // PC and type
+  if (avail < len)
+    return 0;
+  auto type = static_cast<InstClass>(p[8]);
+  if (type == loadInstClass || type == storeInstClass) {
+    len += 9; // EA and access size
+  } else if (is_branch(type)) {
+    if (avail < len + 1)
+      return 0;
+    len += p[len] ? 9 : 1; // taken, and the target if it was
+  }
+
+  if (avail < len + 1)
+    return 0;
+  len += 1 + p[len]; // input registers
+
+  if (avail < len + 1)
+    return 0;
+  std::size_t num_output_regs = p[len];
+  const unsigned char* output_reg_names = p + len + 1;
+  len += 1 + num_output_regs;
+  if (avail < len)
+    return 0;
+  for (std::size_t i = 0; i < num_output_regs; i++)
+    len += (output_reg_names[i] >= 32 && output_reg_names[i] < 64) ? 16 : 8;
+
+  return avail >= len ? len : 0;
+}
+
+struct chunk {
+  std::vector<unsigned char> bytes;
+  std::size_t records = 0;
+};
+
+// split the trace into chunks, give each to work() on its own thread, and give the results to consume() in order
+
+template <typename Work, typename Consume>
+void for_each_chunk(Work work, Consume consume)
+{
+  FILE* f = open_trace_file();
+  if (!f)
+    exit(1);
+
+  std::deque<std::future<decltype(work(std::declval<const chunk&>()))>> in_flight;
+  auto launch = [&](chunk c) {
+    while (in_flight.size() >= num_threads) {
+      consume(in_flight.front().get());
+      in_flight.pop_front();
+    }
+    in_flight.push_back(std::async(std::launch::async, [work, c = std::move(c)] { return work(c); }));
+  };
+
+  chunk next;
+  std::size_t scanned = 0; // the length of the whole records at the start of next.bytes
+  std::vector<unsigned char> buf(1 << 20);
+  for (;;) {
+    std::size_t n = fread(buf.data(), 1, buf.size(), f);
+    if (n == 0)
+      break;
+    next.bytes.insert(next.bytes.end(), buf.begin(), buf.begin() + n);
+
+    for (std::size_t len; (len = record_length(next.bytes.data() + scanned, next.bytes.size() - scanned)) > 0;) {
+      scanned += len;
+      if (++next.records == chunk_records) {
+        chunk remainder;
+        remainder.bytes.assign(next.bytes.begin() + scanned, next.bytes.end());
+        next.bytes.resize(scanned);
+        launch(std::move(next));
+        next = std::move(remainder);
+        scanned = 0;
+      }
+    }
+  }
+
+  if (scanned < next.bytes.size())
+    fprintf(stderr, "ignoring %zu bytes of an incomplete record at the end of the trace\n", next.bytes.size() - scanned);
+  next.bytes.resize(scanned);
+  if (next.records > 0)
+    launch(std::move(next));
+
+  for (auto& result : in_flight)
+    consume(result.get());
+
+  if (f != stdin)
+    pclose(f);
+}
+
+// find the code and data pages, and allocate the remapped pages in the order a sequential pass would
+
+void preprocess_file_parallel(void)
+{
+  struct pages {
+    std::vector<UINT64> code;
+    std::vector<UINT64> data; // in the order of their first access
+  };
+
+  fprintf(stderr, "preprocessing to find code and data pages...\n");
+  fflush(stderr);
+
+  std::vector<UINT64> data_order;
+  for_each_chunk(
+      [](const chunk& c) {
+        pages retval;
+        std::unordered_set<UINT64> code_seen, data_seen;
+        trace t;
+        for (const unsigned char *p = c.bytes.data(), *end = p + c.bytes.size(); t.read(p, end);) {
+          if (code_seen.insert(t.PC >> 12).second)
+            retval.code.push_back(t.PC >> 12);
+          if ((t.type == loadInstClass || t.type == storeInstClass) && data_seen.insert(t.EA >> 12).second)
+            retval.data.push_back(t.EA >> 12);
+        }
+        return retval;
+      },
+      [&](pages result) {
+        for (auto page : result.code)
+          code_pages[page] = true;
+        for (auto page : result.data) {
+          if (data_pages.find(page) == data_pages.end()) {
+            data_pages[page] = true;
+            data_order.push_back(page);
+          }
+        }
+      });
+  fprintf(stderr, "%ld code pages, %ld data pages\n", code_pages.size(), data_pages.size());
+
+  // every page that needs one is remapped here, so that converting the chunks only reads the map
+  for (auto page : data_order)
+    if (code_pages.find(page) != code_pages.end())
+      allocate_page(page);
+  fprintf(stderr, "\n");
+  fflush(stderr);
+}
+
+// the destination of the converted trace, compressed according to the suffix of its name
+
+class output_file
+{
+  FILE* raw = nullptr;
+  std::ofstream file;
+  lzma_stream xz = LZMA_STREAM_INIT;
+  bool is_xz = false;
+  std::unique_ptr<champsim::zstd_seekable::writer> zstd;
+  std::vector<uint8_t> xz_buf = std::vector<uint8_t>(1 << 16);
+
+  void xz_code(lzma_action action)
+  {
+    lzma_ret ret;
+    do {
+      xz.next_out = xz_buf.data();
+      xz.avail_out = xz_buf.size();
+      ret = lzma_code(&xz, action);
+      if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
+        fprintf(stderr, "xz compression failed with code %d\n", ret);
+        exit(1);
+      }
+      file.write(reinterpret_cast<const char*>(xz_buf.data()), xz_buf.size() - xz.avail_out);
+    } while (xz.avail_in > 0 || xz.avail_out == 0 || (action == LZMA_FINISH && ret != LZMA_STREAM_END));
+  }
+
+  static bool ends_with(const std::string& str, const std::string& suffix)
+  {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+  }
+
+public:
+  const bool is_zstd;
+  const int level;
+
+  output_file(const std::string& fname, int compression_level) : is_zstd(ends_with(fname, ".zst")), level(compression_level)
+  {
+    if (fname.empty() || fname == "-") {
+      raw = stdout;
+      return;
+    }
+
+    file.open(fname, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      perror(fname.c_str());
+      exit(1);
+    }
+
+    if (is_zstd) {
+      zstd = std::make_unique<champsim::zstd_seekable::writer>(file, level < 0 ? 19 : level, chunk_records * sizeof(trace_instr_format));
+    } else if (ends_with(fname, ".xz")) {
+      // the blocks of the stream are compressed on several threads, and their sizes are recorded so that they can be decompressed in parallel
+      lzma_mt options = {};
+      options.threads = num_threads;
+      options.block_size = chunk_records * sizeof(trace_instr_format);
+      options.preset = level < 0 ? LZMA_PRESET_DEFAULT : static_cast<uint32_t>(level);
+      options.check = LZMA_CHECK_CRC64;
+      if (lzma_stream_encoder_mt(&xz, &options) != LZMA_OK) {
+        fprintf(stderr, "couldn't initialize xz compression\n");
+        exit(1);
+      }
+      is_xz = true;
+    }
+  }
+
+  ~output_file() { close(); }
+
+  // write the converted records of a chunk, or the frame they were compressed into
+
+  void write(const std::vector<char>& data, std::size_t decompressed_size)
+  {
+    if (zstd) {
+      zstd->append_frame(data, decompressed_size);
+    } else if (is_xz) {
+      xz.next_in = reinterpret_cast<const uint8_t*>(data.data());
+      xz.avail_in = data.size();
+      xz_code(LZMA_RUN);
+    } else if (raw) {
+      fwrite(data.data(), 1, data.size(), raw);
+    } else {
+      file.write(data.data(), data.size());
+    }
+  }
+
+  void close()
+  {
+    if (zstd) {
+      zstd->close();
+      zstd.reset();
+    }
+    if (is_xz) {
+      xz_code(LZMA_FINISH);
+      lzma_end(&xz);
+      is_xz = false;
+    }
+    if (raw)
+      fflush(raw);
+    if (file.is_open())
+      file.close();
+  }
+};
+
+int convert_parallel(const std::string& output_name, int level)
+{
+  preprocess_file_parallel();
+
+  struct converted {
+    std::vector<char> data; // compressed, if the output is zstd
+    std::size_t size = 0;   // the size of the records before they were compressed
+    std::size_t records = 0;
+    long long int counts[OPTYPE_MAX] = {};
+  };
+
+  output_file out{output_name, level};
+  long long int n = 0;
+  for_each_chunk(
+      [&out](const chunk& c) {
+        converted retval;
+        retval.records = c.records;
+        retval.data.reserve(c.records * sizeof(trace_instr_format));
+        trace t;
+        for (const unsigned char *p = c.bytes.data(), *end = p + c.bytes.size(); t.read(p, end);) {
+          OpType op = classify(t);
+          retval.counts[op]++;
+          auto ct = convert(t, op);
+          auto bytes = reinterpret_cast<const char*>(&ct);
+          retval.data.insert(retval.data.end(), bytes, bytes + sizeof(ct));
+        }
+        retval.size = retval.data.size();
+        if (out.is_zstd)
+          retval.data = champsim::zstd_seekable::compress_frame(retval.data.data(), retval.data.size(), out.level < 0 ? 19 : out.level);
+        return retval;
+      },
+      [&](converted result) {
+        out.write(result.data, result.size);
+        for (int i = 0; i < OPTYPE_MAX; i++)
+          counts[i] += result.counts[i];
+        if ((n + result.records) / 10000000 != n / 10000000) {
+          fprintf(stderr, "%lld instructions\n", n + result.records);
+          fflush(stderr);
+        }
+        n += result.records;
+      });
+  out.close();
+
+  fprintf(stderr, "converted %lld instructions\n", n);
+  for (int i = 2; i < OPTYPE_MAX; i++) {
+    if (counts[i])
+      fprintf(stderr, "%s %lld %f%%\n", branch_names[i], counts[i], 100 * counts[i] / (double)n);
+  }
+  return 0;
+}
+
+// summarize the trace without converting it
+
+int print_statistics(void)
+{
+  const char* class_names[] = {"ALU", "LOAD", "STORE", "CONDBRANCH", "UNCONDDIRECTBRANCH", "UNCONDINDIRECTBRANCH", "FP", "SLOWALU", "UNDEF"};
+
+  struct statistics {
+    long long int classes[undefInstClass + 1] = {};
+    long long int branches[OPTYPE_MAX] = {};
+    long long int taken = 0;
+    std::unordered_set<UINT64> code_pages, data_pages, data_blocks;
+  };
+
+  statistics total;
+  for_each_chunk(
+      [](const chunk& c) {
+        statistics retval;
+        trace t;
+        for (const unsigned char *p = c.bytes.data(), *end = p + c.bytes.size(); t.read(p, end);) {
+          retval.classes[std::min(t.type, undefInstClass)]++;
+          if (is_branch(t.type)) {
+            retval.branches[classify(t)]++;
+            retval.taken += t.taken ? 1 : 0;
+          }
+          retval.code_pages.insert(t.PC >> 12);
+          if (t.type == loadInstClass || t.type == storeInstClass) {
+            retval.data_pages.insert(t.EA >> 12);
+            retval.data_blocks.insert(t.EA >> 6);
+          }
+        }
+        return retval;
+      },
+      [&total](statistics result) {
+        for (int i = 0; i <= undefInstClass; i++)
+          total.classes[i] += result.classes[i];
+        for (int i = 0; i < OPTYPE_MAX; i++)
+          total.branches[i] += result.branches[i];
+        total.taken += result.taken;
+        total.code_pages.insert(result.code_pages.begin(), result.code_pages.end());
+        total.data_pages.insert(result.data_pages.begin(), result.data_pages.end());
+        total.data_blocks.insert(result.data_blocks.begin(), result.data_blocks.end());
+      });
+
+  long long int n = 0;
+  for (auto count : total.classes)
+    n += count;
+  long long int num_branches = total.classes[condBranchInstClass] + total.classes[uncondDirectBranchInstClass] + total.classes[uncondIndirectBranchInstClass];
+
+  printf("%lld instructions\n", n);
+  printf("\ninstruction mix\n");
+  for (int i = 0; i <= undefInstClass; i++)
+    if (total.classes[i])
+      printf("  %-22s %14lld %8.3f%%\n", class_names[i], total.classes[i], 100 * total.classes[i] / (double)n);
+
+  printf("\nbranch mix\n");
+  for (int i = 2; i < OPTYPE_MAX; i++)
+    if (total.branches[i])
+      printf("  %-28s %14lld %8.3f%%\n", branch_names[i], total.branches[i], 100 * total.branches[i] / (double)num_branches);
+  if (num_branches)
+    printf("  %-28s %14lld %8.3f%%\n", "taken", total.taken, 100 * total.taken / (double)num_branches);
+
+  printf("\nmemory footprint\n");
+  printf("  %-22s %14zu %10zu KiB\n", "code pages", total.code_pages.size(), total.code_pages.size() * 4);
+  printf("  %-22s %14zu %10zu KiB\n", "data pages", total.data_pages.size(), total.data_pages.size() * 4);
+  printf("  %-22s %14zu %10zu KiB\n", "data blocks", total.data_blocks.size(), total.data_blocks.size() * 64 / 1024);
+  return 0;
+}
+
+void usage(const char* name)
+{
+  fprintf(stderr, "Usage: %s [-v] [-j THREADS] [-o OUTPUT] [-l LEVEL] [-c RECORDS] [-s] [TRACE]\n", name);
+  fprintf(stderr, "  -v          print the disassembly of the trace to standard error\n");
+  fprintf(stderr, "  -j THREADS  convert on this many threads (default: the number of processors)\n");
+  fprintf(stderr, "  -o OUTPUT   write to a file instead of standard output, compressed if it ends in .xz or .zst\n");
+  fprintf(stderr, "  -l LEVEL    the compression level\n");
+  fprintf(stderr, "  -c RECORDS  the number of records in each chunk (default %zu)\n", chunk_records);
+  fprintf(stderr, "  -s          print statistics of the trace instead of converting it\n");
+}
+
 int main(int argc, char** argv)
 {
   trace t;
@@ -361,13 +951,43 @@ int main(int argc, char** argv)
 
   strcpy(tracefilename, "-");
 
+  std::string output_name;
+  int level = -1;
+  bool statistics = false;
+  bool parallel = false;
+
   for (int i = 1; i < argc; i++) {
     if (!strcmp(argv[i], "-v"))
       verbose = true;
-    else
+    else if (!strcmp(argv[i], "-s"))
+      statistics = parallel = true;
+    else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+      num_threads = atoi(argv[++i]);
+      parallel = true;
+    } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+      output_name = argv[++i];
+      parallel = true;
+    } else if (!strcmp(argv[i], "-l") && i + 1 < argc)
+      level = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+      chunk_records = std::max(strtoull(argv[++i], nullptr, 10), 1ull);
+    else if (!strcmp(argv[i], "-h")) {
+      usage(argv[0]);
+      return 0;
+    } else
       strcpy(tracefilename, argv[i]);
   }
 
+  if (parallel) {
+    if (verbose) {
+      fprintf(stderr, "-v cannot be combined with -j, -o, or -s\n");
+      return 1;
+    }
+    if (num_threads == 0)
+      num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    return statistics ? print_statistics() : convert_parallel(output_name, level);
+  }
+
   preprocess_file();
 
   // open the trace file
@@ -410,171 +1030,14 @@ int main(int argc, char** argv)
 
     if (!good)
       break;
-    trace_instr_format ct;
-    ct.ip = t.PC;
-    ct.is_branch = false;
-    // we are going to figure out the op type
-
-    OpType c = OPTYPE_OP;
-
-    // if this is a branch then do more stuff; we don't care about non-branches
-
-    if (is_branch(t.type)) {
-      ct.is_branch = true;
-
-      // if this is a conditional branch then it's direct and we're done figuring out the type
 
-      if (t.type == condBranchInstClass) {
-        c = OPTYPE_JMP_DIRECT_COND;
-      } else {
-
-        // this is some other kind of branch. it should have a non-zero target
-
-        assert(t.target);
-
-        // on ARM, calls link the return address in register X30. let's see if this
-        // instruction is doing that; if so, it's a call or wants us to believe it is
-
-        if (t.num_output_regs == 1 && t.output_reg_names[0] == 30) {
-
-          // is it indirect?
-
-          if (t.type == uncondIndirectBranchInstClass)
-            c = OPTYPE_CALL_INDIRECT_UNCOND;
-          else
-            c = OPTYPE_CALL_DIRECT_UNCOND;
-        } else {
-          // no X30? then it's just an unconditional jump
-          // is it indirect?
-
-          if (t.type == uncondIndirectBranchInstClass)
-            c = OPTYPE_JMP_INDIRECT_UNCOND;
-          else
-            c = OPTYPE_JMP_DIRECT_UNCOND;
-        }
-
-        // on ARM, returns are an indirect jump to X30. let's see if we're doing this
-
-        if (t.num_input_regs == 1)
-          if (t.input_reg_names[0] == 30) {
+    // we are going to figure out the op type
 
-            // yes. it's a return.
+    OpType c = classify(t);
+    counts[c]++;
 
-            c = OPTYPE_RET_UNCOND;
-          }
-      }
-      counts[c]++;
-
-      // OK now make a branch instruction out of this bad boy
-
-      memset(ct.destination_registers, 0, sizeof(ct.destination_registers));
-      memset(ct.source_registers, 0, sizeof(ct.source_registers));
-      memset(ct.destination_memory, 0, sizeof(ct.destination_memory));
-      memset(ct.source_memory, 0, sizeof(ct.source_memory));
-      switch (c) {
-      case OPTYPE_JMP_DIRECT_UNCOND:
-        // writes IP only
-        ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
-        ct.branch_taken = t.taken;
-        break;
-      case OPTYPE_JMP_DIRECT_COND:
-        ct.branch_taken = t.taken;
-        // reads FLAGS, writes IP
-        ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
-        // turns out pin records conditional direct branches as also reading IP. whatever.
-        ct.source_registers[0] = champsim::REG_INSTRUCTION_POINTER;
-        ct.source_registers[1] = champsim::REG_FLAGS;
-        break;
-      case OPTYPE_CALL_INDIRECT_UNCOND:
-        ct.branch_taken = true;
-        // reads something else, reads IP, reads SP, writes SP, writes IP
-        ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
-        ct.destination_registers[1] = champsim::REG_STACK_POINTER;
-        ct.source_registers[0] = champsim::REG_INSTRUCTION_POINTER;
-        ct.source_registers[1] = champsim::REG_STACK_POINTER;
-        ct.source_registers[2] = ::REG_AX;
-        break;
-      case OPTYPE_CALL_DIRECT_UNCOND:
-        ct.branch_taken = true;
-        // reads IP, reads SP, writes SP, writes IP
-        ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
-        ct.destination_registers[1] = champsim::REG_STACK_POINTER;
-        ct.source_registers[0] = champsim::REG_INSTRUCTION_POINTER;
-        ct.source_registers[1] = champsim::REG_STACK_POINTER;
-        break;
-      case OPTYPE_JMP_INDIRECT_UNCOND:
-        ct.branch_taken = true;
-        // reads something else, writes IP
-        ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
-        ct.source_registers[0] = ::REG_AX;
-        break;
-      case OPTYPE_RET_UNCOND:
-        ct.branch_taken = true;
-        // reads SP, writes SP, writes IP
-        ct.source_registers[0] = champsim::REG_STACK_POINTER;
-        ct.destination_registers[0] = champsim::REG_INSTRUCTION_POINTER;
-        ct.destination_registers[1] = champsim::REG_STACK_POINTER;
-        break;
-      default:
-        assert(0);
-      }
-      fwrite(&ct, sizeof(ct), 1, stdout); // write a branch trace
-    } else {
-      memset(ct.destination_registers, 0, sizeof(ct.destination_registers));
-      memset(ct.source_registers, 0, sizeof(ct.source_registers));
-      memset(ct.destination_memory, 0, sizeof(ct.destination_memory));
-      memset(ct.source_memory, 0, sizeof(ct.source_memory));
-      counts[OPTYPE_OP]++;
-      if (t.num_input_regs > NUM_INSTR_SOURCES)
-        t.num_input_regs = NUM_INSTR_SOURCES;
-      if (t.num_output_regs == 0) {
-        t.num_output_regs = 1;
-        t.output_reg_names[0] = 0;
-      }
-      // for (int a=0; a<t.num_output_regs; a++) {
-      for (int a = 0; a < 1; a++) {
-        int x = t.output_reg_names[a];
-        if (x == champsim::REG_INSTRUCTION_POINTER)
-          x = 64;
-        if (x == champsim::REG_STACK_POINTER)
-          x = 65;
-        if (x == champsim::REG_FLAGS)
-          x = 66;
-        if (x == 0)
-          x = 67;
-        ct.destination_registers[a] = x;
-        for (int i = 0; i < t.num_input_regs; i++) {
-          int x = t.input_reg_names[i];
-          if (x == champsim::REG_INSTRUCTION_POINTER)
-            x = 64;
-          if (x == champsim::REG_STACK_POINTER)
-            x = 65;
-          if (x == champsim::REG_FLAGS)
-            x = 66;
-          if (x == 0)
-            x = 67;
-          ct.source_registers[i] = x;
-        }
-        switch (t.type) {
-        case loadInstClass:
-          ct.source_memory[0] = transform(t.EA);
-          break;
-        case storeInstClass:
-          ct.destination_memory[0] = transform(t.EA);
-          break;
-        case aluInstClass:
-        case fpInstClass:
-        case slowAluInstClass:
-          break;
-        case uncondDirectBranchInstClass:
-        case condBranchInstClass:
-        case uncondIndirectBranchInstClass:
-        case undefInstClass:
-          assert(0);
-        }
-        fwrite(&ct, sizeof(ct), 1, stdout); // write a non-branch trace
-      }
-    }
+    trace_instr_format ct = convert(t, c);
+    fwrite(&ct, sizeof(ct), 1, stdout);
 
     // for fun, update the register values
 
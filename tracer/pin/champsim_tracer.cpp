@@ -17,37 +17,51 @@
 /*! @file
  *  This is an example of the PIN tool that demonstrates some basic PIN APIs
  *  and could serve as the starting point for developing your first PIN tool
+ *
+ *  Each application thread is traced into its own file. Instructions are
+ *  collected in a buffer for each thread, and full buffers are handed to
+ *  internal writer threads, which compress them as they are written.
  */
 
+#include <algorithm>
+#include <deque>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <vector>
+
+#ifndef CHAMPSIM_TRACER_NO_COMPRESSION
+#include <lzma.h>
+#include <zstd.h>
+#endif
 
 #include "../../inc/trace_instruction.h"
 #include "pin.H"
 
 using trace_instr_format_t = input_instr;
 
-/* ================================================================== */
-// Global variables
-/* ================================================================== */
-
-UINT64 instrCount = 0;
-
-std::ofstream outfile;
-
-trace_instr_format_t curr_instr;
-
 /* ===================================================================== */
 // Command line switches
 /* ===================================================================== */
 KNOB<std::string> KnobOutputFile(KNOB_MODE_WRITEONCE, "pintool", "o", "champsim.trace", "specify file name for Champsim tracer output");
 
-KNOB<UINT64> KnobSkipInstructions(KNOB_MODE_WRITEONCE, "pintool", "s", "0", "How many instructions to skip before tracing begins");
+KNOB<UINT64> KnobSkipInstructions(KNOB_MODE_WRITEONCE, "pintool", "s", "0", "How many instructions of each thread to skip before tracing begins");
+
+KNOB<UINT64> KnobTraceInstructions(KNOB_MODE_WRITEONCE, "pintool", "t", "1000000", "How many instructions of each thread to trace");
+
+KNOB<std::string> KnobRoiStart(KNOB_MODE_WRITEONCE, "pintool", "roi_start", "",
+                               "Begin counting instructions when this function is first called, rather than at the start of the program");
+
+KNOB<std::string> KnobRoiEnd(KNOB_MODE_WRITEONCE, "pintool", "roi_end", "", "Stop tracing when this function is first called");
 
-KNOB<UINT64> KnobTraceInstructions(KNOB_MODE_WRITEONCE, "pintool", "t", "1000000", "How many instructions to trace");
+KNOB<INT32> KnobCompressionLevel(KNOB_MODE_WRITEONCE, "pintool", "l", "-1", "The compression level, or -1 for the default of the format");
+
+KNOB<UINT32> KnobWriters(KNOB_MODE_WRITEONCE, "pintool", "w", "1", "How many internal threads compress and write the traces");
+
+KNOB<UINT32> KnobBufferSize(KNOB_MODE_WRITEONCE, "pintool", "b", "16384", "How many instructions each thread collects before they are written");
 
 /* ===================================================================== */
 // Utilities
@@ -58,10 +72,11 @@ KNOB<UINT64> KnobTraceInstructions(KNOB_MODE_WRITEONCE, "pintool", "t", "1000000
  */
 INT32 Usage()
 {
-  std::cerr << "This tool creates a register and memory access trace" << std::endl
-            << "Specify the output trace file with -o" << std::endl
+  std::cerr << "This tool creates a register and memory access trace of each thread" << std::endl
+            << "Specify the output trace file with -o. A suffix of .xz or .zst compresses the trace." << std::endl
             << "Specify the number of instructions to skip before tracing with -s" << std::endl
             << "Specify the number of instructions to trace with -t" << std::endl
+            << "Specify the functions that begin and end the region of interest with -roi_start and -roi_end" << std::endl
             << std::endl;
 
   std::cerr << KNOB_BASE::StringKnobSummary() << std::endl;
@@ -69,43 +84,405 @@ INT32 Usage()
   return -1;
 }
 
+VOID Fail(const std::string& msg)
+{
+  std::cerr << "champsim_tracer: " << msg << std::endl;
+  PIN_ExitProcess(1);
+}
+
+/* ===================================================================== */
+// Trace files
+/* ===================================================================== */
+
+/*!
+ * A destination for the bytes of one trace.
+ * Each is written by a single thread at a time.
+ */
+class trace_output
+{
+public:
+  virtual ~trace_output() = default;
+  virtual VOID write(const char* data, std::size_t size) = 0;
+  virtual VOID close() = 0;
+};
+
+class raw_output final : public trace_output
+{
+  std::ofstream out;
+
+public:
+  explicit raw_output(const std::string& fname) : out(fname.c_str(), std::ios_base::binary | std::ios_base::trunc)
+  {
+    if (!out)
+      Fail("Couldn't open output trace file " + fname);
+  }
+
+  VOID write(const char* data, std::size_t size) override { out.write(data, static_cast<std::streamsize>(size)); }
+  VOID close() override { out.close(); }
+};
+
+#ifndef CHAMPSIM_TRACER_NO_COMPRESSION
+constexpr std::size_t COMPRESSED_CHUNK_SIZE = 1 << 16;
+
+class xz_output final : public trace_output
+{
+  std::ofstream out;
+  lzma_stream strm = LZMA_STREAM_INIT;
+  std::vector<uint8_t> chunk = std::vector<uint8_t>(COMPRESSED_CHUNK_SIZE);
+
+  VOID code(lzma_action action)
+  {
+    lzma_ret ret;
+    do {
+      strm.next_out = chunk.data();
+      strm.avail_out = chunk.size();
+      ret = lzma_code(&strm, action);
+      if (ret != LZMA_OK && ret != LZMA_STREAM_END)
+        Fail("xz compression failed with code " + decstr(static_cast<INT32>(ret)));
+      out.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size() - strm.avail_out));
+    } while (strm.avail_in > 0 || strm.avail_out == 0 || (action == LZMA_FINISH && ret != LZMA_STREAM_END));
+  }
+
+public:
+  xz_output(const std::string& fname, INT32 level) : out(fname.c_str(), std::ios_base::binary | std::ios_base::trunc)
+  {
+    if (!out)
+      Fail("Couldn't open output trace file " + fname);
+    if (lzma_easy_encoder(&strm, level < 0 ? LZMA_PRESET_DEFAULT : static_cast<uint32_t>(level), LZMA_CHECK_CRC64) != LZMA_OK)
+      Fail("Couldn't initialize xz compression for " + fname);
+  }
+
+  ~xz_output() override { lzma_end(&strm); }
+
+  VOID write(const char* data, std::size_t size) override
+  {
+    strm.next_in = reinterpret_cast<const uint8_t*>(data);
+    strm.avail_in = size;
+    code(LZMA_RUN);
+  }
+
+  VOID close() override
+  {
+    code(LZMA_FINISH);
+    out.close();
+  }
+};
+
+class zstd_output final : public trace_output
+{
+  std::ofstream out;
+  ZSTD_CCtx* ctx = ZSTD_createCCtx();
+  std::vector<char> chunk = std::vector<char>(COMPRESSED_CHUNK_SIZE);
+
+  VOID code(const char* data, std::size_t size, ZSTD_EndDirective mode)
+  {
+    ZSTD_inBuffer in{data, size, 0};
+    std::size_t remaining;
+    do {
+      ZSTD_outBuffer buf{chunk.data(), chunk.size(), 0};
+      remaining = ZSTD_compressStream2(ctx, &buf, &in, mode);
+      if (ZSTD_isError(remaining))
+        Fail(std::string{"zstd compression failed: "} + ZSTD_getErrorName(remaining));
+      out.write(chunk.data(), static_cast<std::streamsize>(buf.pos));
+    } while (in.pos < in.size || (mode == ZSTD_e_end && remaining > 0));
+  }
+
+public:
+  zstd_output(const std::string& fname, INT32 level) : out(fname.c_str(), std::ios_base::binary | std::ios_base::trunc)
+  {
+    if (!out)
+      Fail("Couldn't open output trace file " + fname);
+    if (ctx == nullptr)
+      Fail("Couldn't initialize zstd compression for " + fname);
+    if (level >= 0)
+      ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, level);
+  }
+
+  ~zstd_output() override { ZSTD_freeCCtx(ctx); }
+
+  VOID write(const char* data, std::size_t size) override { code(data, size, ZSTD_e_continue); }
+
+  VOID close() override
+  {
+    code(nullptr, 0, ZSTD_e_end);
+    out.close();
+  }
+};
+#endif
+
+BOOL EndsWith(const std::string& str, const std::string& suffix)
+{
+  return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/*!
+ * The trace of the first thread is named by -o. Those of later threads have
+ * the thread number inserted before the compression suffix, so that
+ * trace.champsim.xz becomes trace.champsim.1.xz
+ */
+std::unique_ptr<trace_output> OpenOutput(THREADID tid)
+{
+  std::string base = KnobOutputFile.Value();
+  std::string suffix = "";
+  for (std::string compressed : {".xz", ".zst"}) {
+    if (EndsWith(base, compressed)) {
+      base.erase(base.size() - compressed.size());
+      suffix = compressed;
+    }
+  }
+
+  std::string fname = base + (tid == 0 ? "" : "." + decstr(tid)) + suffix;
+#ifndef CHAMPSIM_TRACER_NO_COMPRESSION
+  if (suffix == ".xz")
+    return std::unique_ptr<trace_output>{new xz_output{fname, KnobCompressionLevel.Value()}};
+  if (suffix == ".zst")
+    return std::unique_ptr<trace_output>{new zstd_output{fname, KnobCompressionLevel.Value()}};
+#else
+  if (!suffix.empty())
+    Fail("This tracer was built without compression. Remove the suffix " + suffix + " from the output file.");
+#endif
+  return std::unique_ptr<trace_output>{new raw_output{fname}};
+}
+
+/* ===================================================================== */
+// Writer threads
+/* ===================================================================== */
+
+struct pending_buffer {
+  trace_output* output;
+  std::vector<trace_instr_format_t> records;
+  BOOL last; // close the output after these records
+};
+
+/*!
+ * The outputs of each application thread are always given to the same
+ * writer, so that their buffers are written in order.
+ */
+struct writer {
+  PIN_MUTEX lock;
+  PIN_SEMAPHORE ready;
+  std::deque<pending_buffer> queue;
+  PIN_THREAD_UID uid;
+  BOOL running = FALSE;
+  BOOL stopping = FALSE;
+};
+
+// Limit the memory held by buffers that have not yet been written
+constexpr std::size_t MAX_PENDING_BUFFERS = 16;
+
+std::deque<writer> writers;
+
+VOID WriteBuffer(pending_buffer& item)
+{
+  item.output->write(reinterpret_cast<const char*>(item.records.data()), item.records.size() * sizeof(trace_instr_format_t));
+  if (item.last)
+    item.output->close();
+}
+
+VOID WriterMain(VOID* arg)
+{
+  auto& w = *static_cast<writer*>(arg);
+  BOOL stop = FALSE;
+  while (!stop) {
+    PIN_SemaphoreWait(&w.ready);
+
+    PIN_MutexLock(&w.lock);
+    std::deque<pending_buffer> work;
+    std::swap(work, w.queue);
+    PIN_SemaphoreClear(&w.ready);
+    stop = w.stopping;
+    PIN_MutexUnlock(&w.lock);
+
+    for (auto& item : work)
+      WriteBuffer(item);
+  }
+}
+
+/*!
+ * Give a buffer to a writer. Once the writers have stopped, at the end of
+ * the program, the buffer is written by the calling thread.
+ */
+VOID Submit(writer& w, pending_buffer item)
+{
+  PIN_MutexLock(&w.lock);
+  while (w.running && w.queue.size() >= MAX_PENDING_BUFFERS) {
+    PIN_MutexUnlock(&w.lock);
+    PIN_Sleep(1);
+    PIN_MutexLock(&w.lock);
+  }
+
+  if (w.running) {
+    w.queue.push_back(std::move(item));
+    PIN_SemaphoreSet(&w.ready);
+    PIN_MutexUnlock(&w.lock);
+  } else {
+    PIN_MutexUnlock(&w.lock);
+    WriteBuffer(item);
+  }
+}
+
+VOID StartWriters()
+{
+  for (UINT32 i = 0; i < std::max<UINT32>(KnobWriters.Value(), 1); ++i) {
+    writers.emplace_back();
+    auto& w = writers.back();
+    PIN_MutexInit(&w.lock);
+    PIN_SemaphoreInit(&w.ready);
+    if (PIN_SpawnInternalThread(WriterMain, &w, 0, &w.uid) == INVALID_THREADID)
+      Fail("Couldn't start a writer thread");
+    w.running = TRUE;
+  }
+}
+
+/*!
+ * Internal threads must finish before the application exits, so the
+ * writers are stopped when Pin prepares to finish. Any buffers that remain
+ * in their queues are written here.
+ */
+VOID PrepareForFini(VOID* v)
+{
+  for (auto& w : writers) {
+    PIN_MutexLock(&w.lock);
+    w.stopping = TRUE;
+    PIN_SemaphoreSet(&w.ready);
+    PIN_MutexUnlock(&w.lock);
+  }
+
+  for (auto& w : writers) {
+    PIN_WaitForThreadTermination(w.uid, PIN_INFINITE_TIMEOUT, nullptr);
+
+    PIN_MutexLock(&w.lock);
+    w.running = FALSE;
+    for (auto& item : w.queue)
+      WriteBuffer(item);
+    w.queue.clear();
+    PIN_MutexUnlock(&w.lock);
+  }
+}
+
+/* ===================================================================== */
+// Thread state
+/* ===================================================================== */
+
+struct thread_data {
+  trace_instr_format_t curr_instr = {};
+  UINT64 instrCount = 0;
+  std::vector<trace_instr_format_t> buffer;
+  trace_output* output;
+  writer* out_writer;
+};
+
+// The thread data is kept in a register reserved for the tool, since it is needed by every analysis routine
+REG thread_data_reg;
+
+// The threads that have not yet finished, whose traces must be closed at exit
+PIN_MUTEX live_threads_lock;
+std::vector<thread_data*> live_threads;
+
+// The outputs outlive their threads, since their last buffers may still be queued
+std::vector<std::unique_ptr<trace_output>> outputs;
+
+// The region of interest may be delimited by calls to functions
+volatile BOOL roi_started = TRUE;
+volatile BOOL roi_ended = FALSE;
+
+VOID FlushBuffer(thread_data* td, BOOL last)
+{
+  std::vector<trace_instr_format_t> records;
+  std::swap(records, td->buffer);
+  td->buffer.reserve(KnobBufferSize.Value());
+  Submit(*td->out_writer, {td->output, std::move(records), last});
+}
+
+VOID ThreadStart(THREADID tid, CONTEXT* ctxt, INT32 flags, VOID* v)
+{
+  auto td = new thread_data{};
+  td->buffer.reserve(KnobBufferSize.Value());
+  td->out_writer = &writers.at(tid % writers.size());
+  PIN_SetContextReg(ctxt, thread_data_reg, reinterpret_cast<ADDRINT>(td));
+
+  PIN_MutexLock(&live_threads_lock);
+  outputs.push_back(OpenOutput(tid));
+  td->output = outputs.back().get();
+  live_threads.push_back(td);
+  PIN_MutexUnlock(&live_threads_lock);
+}
+
+VOID ThreadFini(THREADID tid, const CONTEXT* ctxt, INT32 code, VOID* v)
+{
+  auto td = reinterpret_cast<thread_data*>(PIN_GetContextReg(ctxt, thread_data_reg));
+
+  PIN_MutexLock(&live_threads_lock);
+  live_threads.erase(std::remove(live_threads.begin(), live_threads.end(), td), live_threads.end());
+  PIN_MutexUnlock(&live_threads_lock);
+
+  FlushBuffer(td, TRUE);
+  delete td;
+}
+
 /* ===================================================================== */
 // Analysis routines
 /* ===================================================================== */
 
-void ResetCurrentInstruction(VOID* ip)
+void ResetCurrentInstruction(thread_data* td, VOID* ip)
 {
-  curr_instr = {};
-  curr_instr.ip = (unsigned long long int)ip;
+  td->curr_instr = {};
+  td->curr_instr.ip = (unsigned long long int)ip;
 }
 
-BOOL ShouldWrite()
+BOOL ShouldWrite(thread_data* td)
 {
-  ++instrCount;
-  return (instrCount > KnobSkipInstructions.Value()) && (instrCount <= (KnobTraceInstructions.Value() + KnobSkipInstructions.Value()));
+  if (!roi_started || roi_ended)
+    return false;
+  ++td->instrCount;
+  return (td->instrCount > KnobSkipInstructions.Value()) && (td->instrCount <= (KnobTraceInstructions.Value() + KnobSkipInstructions.Value()));
 }
 
-void WriteCurrentInstruction()
+void WriteCurrentInstruction(thread_data* td)
 {
-  typename decltype(outfile)::char_type buf[sizeof(trace_instr_format_t)];
-  std::memcpy(buf, &curr_instr, sizeof(trace_instr_format_t));
-  outfile.write(buf, sizeof(trace_instr_format_t));
+  td->buffer.push_back(td->curr_instr);
+  if (td->buffer.size() >= KnobBufferSize.Value())
+    FlushBuffer(td, FALSE);
 }
 
-void BranchOrNot(UINT32 taken)
+void BranchOrNot(thread_data* td, UINT32 taken)
 {
-  curr_instr.is_branch = 1;
-  curr_instr.branch_taken = taken;
+  td->curr_instr.is_branch = 1;
+  td->curr_instr.branch_taken = taken;
 }
 
-template <typename T>
-void WriteToSet(T* begin, T* end, UINT32 r)
+template <typename T, typename U>
+void WriteToSet(T* begin, T* end, U r)
 {
   auto set_end = std::find(begin, end, 0);
   auto found_reg = std::find(begin, set_end, r); // check to see if this register is already in the list
   *found_reg = r;
 }
 
+void WriteSourceRegister(thread_data* td, UINT32 r)
+{
+  WriteToSet(std::begin(td->curr_instr.source_registers), std::end(td->curr_instr.source_registers), static_cast<unsigned char>(r));
+}
+
+void WriteDestinationRegister(thread_data* td, UINT32 r)
+{
+  WriteToSet(std::begin(td->curr_instr.destination_registers), std::end(td->curr_instr.destination_registers), static_cast<unsigned char>(r));
+}
+
+void WriteSourceMemory(thread_data* td, ADDRINT addr)
+{
+  WriteToSet(std::begin(td->curr_instr.source_memory), std::end(td->curr_instr.source_memory), static_cast<unsigned long long int>(addr));
+}
+
+void WriteDestinationMemory(thread_data* td, ADDRINT addr)
+{
+  WriteToSet(std::begin(td->curr_instr.destination_memory), std::end(td->curr_instr.destination_memory), static_cast<unsigned long long int>(addr));
+}
+
+void BeginRegion() { roi_started = TRUE; }
+
+void EndRegion() { roi_ended = TRUE; }
+
 /* ===================================================================== */
 // Instrumentation callbacks
 /* ===================================================================== */
@@ -114,26 +491,24 @@ void WriteToSet(T* begin, T* end, UINT32 r)
 VOID Instruction(INS ins, VOID* v)
 {
   // begin each instruction with this function
-  INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)ResetCurrentInstruction, IARG_INST_PTR, IARG_END);
+  INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)ResetCurrentInstruction, IARG_REG_VALUE, thread_data_reg, IARG_INST_PTR, IARG_END);
 
   // instrument branch instructions
   if (INS_IsBranch(ins))
-    INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)BranchOrNot, IARG_BRANCH_TAKEN, IARG_END);
+    INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)BranchOrNot, IARG_REG_VALUE, thread_data_reg, IARG_BRANCH_TAKEN, IARG_END);
 
   // instrument register reads
   UINT32 readRegCount = INS_MaxNumRRegs(ins);
   for (UINT32 i = 0; i < readRegCount; i++) {
     UINT32 regNum = INS_RegR(ins, i);
-    INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)WriteToSet<unsigned char>, IARG_PTR, curr_instr.source_registers, IARG_PTR,
-                   curr_instr.source_registers + NUM_INSTR_SOURCES, IARG_UINT32, regNum, IARG_END);
+    INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)WriteSourceRegister, IARG_REG_VALUE, thread_data_reg, IARG_UINT32, regNum, IARG_END);
   }
 
   // instrument register writes
   UINT32 writeRegCount = INS_MaxNumWRegs(ins);
   for (UINT32 i = 0; i < writeRegCount; i++) {
     UINT32 regNum = INS_RegW(ins, i);
-    INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)WriteToSet<unsigned char>, IARG_PTR, curr_instr.destination_registers, IARG_PTR,
-                   curr_instr.destination_registers + NUM_INSTR_DESTINATIONS, IARG_UINT32, regNum, IARG_END);
+    INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)WriteDestinationRegister, IARG_REG_VALUE, thread_data_reg, IARG_UINT32, regNum, IARG_END);
   }
 
   // instrument memory reads and writes
@@ -142,26 +517,54 @@ VOID Instruction(INS ins, VOID* v)
   // Iterate over each memory operand of the instruction.
   for (UINT32 memOp = 0; memOp < memOperands; memOp++) {
     if (INS_MemoryOperandIsRead(ins, memOp))
-      INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)WriteToSet<unsigned long long int>, IARG_PTR, curr_instr.source_memory, IARG_PTR,
-                     curr_instr.source_memory + NUM_INSTR_SOURCES, IARG_MEMORYOP_EA, memOp, IARG_END);
+      INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)WriteSourceMemory, IARG_REG_VALUE, thread_data_reg, IARG_MEMORYOP_EA, memOp, IARG_END);
     if (INS_MemoryOperandIsWritten(ins, memOp))
-      INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)WriteToSet<unsigned long long int>, IARG_PTR, curr_instr.destination_memory, IARG_PTR,
-                     curr_instr.destination_memory + NUM_INSTR_DESTINATIONS, IARG_MEMORYOP_EA, memOp, IARG_END);
+      INS_InsertCall(ins, IPOINT_BEFORE, (AFUNPTR)WriteDestinationMemory, IARG_REG_VALUE, thread_data_reg, IARG_MEMORYOP_EA, memOp, IARG_END);
   }
 
   // finalize each instruction with this function
-  INS_InsertIfCall(ins, IPOINT_BEFORE, (AFUNPTR)ShouldWrite, IARG_END);
-  INS_InsertThenCall(ins, IPOINT_BEFORE, (AFUNPTR)WriteCurrentInstruction, IARG_END);
+  INS_InsertIfCall(ins, IPOINT_BEFORE, (AFUNPTR)ShouldWrite, IARG_REG_VALUE, thread_data_reg, IARG_END);
+  INS_InsertThenCall(ins, IPOINT_BEFORE, (AFUNPTR)WriteCurrentInstruction, IARG_REG_VALUE, thread_data_reg, IARG_END);
+}
+
+VOID InstrumentRoutine(IMG img, const std::string& name, AFUNPTR fn)
+{
+  if (name.empty())
+    return;
+
+  RTN rtn = RTN_FindByName(img, name.c_str());
+  if (RTN_Valid(rtn)) {
+    RTN_Open(rtn);
+    RTN_InsertCall(rtn, IPOINT_BEFORE, fn, IARG_END);
+    RTN_Close(rtn);
+  }
+}
+
+// Is called for every image, and instruments the functions that delimit the region of interest
+VOID Image(IMG img, VOID* v)
+{
+  InstrumentRoutine(img, KnobRoiStart.Value(), (AFUNPTR)BeginRegion);
+  InstrumentRoutine(img, KnobRoiEnd.Value(), (AFUNPTR)EndRegion);
 }
 
 /*!
- * Print out analysis results.
+ * Close the traces of the threads that were still running when the application exited.
  * This function is called when the application exits.
  * @param[in]   code            exit code of the application
  * @param[in]   v               value specified by the tool in the
  *                              PIN_AddFiniFunction function call
  */
-VOID Fini(INT32 code, VOID* v) { outfile.close(); }
+VOID Fini(INT32 code, VOID* v)
+{
+  PIN_MutexLock(&live_threads_lock);
+  for (auto td : live_threads) {
+    FlushBuffer(td, TRUE);
+    delete td;
+  }
+  live_threads.clear();
+  outputs.clear();
+  PIN_MutexUnlock(&live_threads_lock);
+}
 
 /*!
  * The main procedure of the tool.
@@ -172,21 +575,35 @@ VOID Fini(INT32 code, VOID* v) { outfile.close(); }
  */
 int main(int argc, char* argv[])
 {
+  // Symbols are needed to find the functions that delimit the region of interest
+  PIN_InitSymbols();
+
   // Initialize PIN library. Print help message if -h(elp) is specified
   // in the command line or the command line is invalid
   if (PIN_Init(argc, argv))
     return Usage();
 
-  outfile.open(KnobOutputFile.Value().c_str(), std::ios_base::binary | std::ios_base::trunc);
-  if (!outfile) {
-    std::cout << "Couldn't open output trace file. Exiting." << std::endl;
+  thread_data_reg = PIN_ClaimToolRegister();
+  if (!REG_valid(thread_data_reg)) {
+    std::cout << "Couldn't reserve a register for the thread data. Exiting." << std::endl;
     exit(1);
   }
 
+  PIN_MutexInit(&live_threads_lock);
+  roi_started = KnobRoiStart.Value().empty();
+  StartWriters();
+
   // Register function to be called to instrument instructions
   INS_AddInstrumentFunction(Instruction, 0);
+  if (!KnobRoiStart.Value().empty() || !KnobRoiEnd.Value().empty())
+    IMG_AddInstrumentFunction(Image, 0);
+
+  // Register functions to be called when threads begin and end
+  PIN_AddThreadStartFunction(ThreadStart, 0);
+  PIN_AddThreadFiniFunction(ThreadFini, 0);
 
-  // Register function to be called when the application exits
+  // Register functions to be called when the application exits
+  PIN_AddPrepareForFiniFunction(PrepareForFini, 0);
   PIN_AddFiniFunction(Fini, 0);
 
   // Start the program, never returns
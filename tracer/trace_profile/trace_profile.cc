@@ -0,0 +1,178 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "../../inc/trace_profile.h"
+
+namespace
+{
+const std::array<std::string, NOT_BRANCH> branch_names{"BRANCH_DIRECT_JUMP", "BRANCH_INDIRECT",      "BRANCH_CONDITIONAL", "BRANCH_DIRECT_CALL",
+                                                       "BRANCH_INDIRECT_CALL", "BRANCH_RETURN", "BRANCH_OTHER"};
+
+void usage(const char* name)
+{
+  std::cerr << "Usage: " << name << " [options] TRACE...\n";
+  std::cerr << "  -o FILE       write the JSON profiles to a file instead of standard output\n";
+  std::cerr << "  -j JOBS       profile this many traces at once (default 1)\n";
+  std::cerr << "  -n COUNT      profile only the first COUNT instructions of each trace\n";
+  std::cerr << "  -r RATE       track the reuse of this fraction of blocks and pages (default 1)\n";
+  std::cerr << "  -i COUNT      sample the footprint every COUNT instructions (default 1000000)\n";
+  std::cerr << "  -b BYTES      the size of a block (default 64)\n";
+  std::cerr << "  -p BYTES      the size of a page (default 4096)\n";
+  std::cerr << "  -c            the traces are in the cloudsuite format\n";
+}
+
+nlohmann::json to_json(const champsim::trace_profile::reuse_histogram& hist)
+{
+  std::vector<nlohmann::json> buckets;
+  for (std::size_t k = 0; k < std::size(hist.buckets); ++k) {
+    buckets.push_back(nlohmann::json{{"less than", uint64_t{1} << k}, {"accesses", hist.buckets.at(k)}});
+  }
+  return nlohmann::json{{"accesses", hist.accesses()}, {"cold", hist.cold}, {"buckets", buckets}};
+}
+
+nlohmann::json to_json(const std::map<int64_t, uint64_t>& strides)
+{
+  std::vector<nlohmann::json> retval;
+  for (auto [stride, count] : strides) {
+    retval.push_back(nlohmann::json{{"stride", stride}, {"count", count}});
+  }
+  return retval;
+}
+
+nlohmann::json to_json(const std::string& trace, const champsim::trace_profile::profile& prof)
+{
+  std::vector<nlohmann::json> footprint;
+  for (const auto& sample : prof.footprint) {
+    footprint.push_back(nlohmann::json{{"instructions", sample.instructions},
+                                       {"code blocks", sample.code_blocks},
+                                       {"data blocks", sample.data_blocks},
+                                       {"data pages", sample.data_pages},
+                                       {"working set", sample.working_set}});
+  }
+
+  std::vector<nlohmann::json> ip_strides;
+  for (const auto& entry : prof.strides_by_ip) {
+    ip_strides.push_back(nlohmann::json{{"ip", entry.ip}, {"accesses", entry.accesses}, {"strides", to_json(entry.strides)}});
+  }
+
+  // Strides that occur once are usually noise, and would dominate the output
+  std::map<int64_t, uint64_t> common_strides;
+  std::copy_if(std::begin(prof.strides), std::end(prof.strides), std::inserter(common_strides, std::end(common_strides)),
+               [](const auto& entry) { return entry.second > 1; });
+
+  std::map<std::string, nlohmann::json> branch_types;
+  for (std::size_t i = 0; i < std::size(branch_names); ++i) {
+    if (prof.branches.count.at(i) > 0) {
+      branch_types.emplace(branch_names.at(i), nlohmann::json{{"count", prof.branches.count.at(i)}, {"taken", prof.branches.taken.at(i)}});
+    }
+  }
+
+  return nlohmann::json{{"trace", trace},
+                        {"instructions", prof.instructions},
+                        {"loads", prof.loads},
+                        {"stores", prof.stores},
+                        {"block reuse", to_json(prof.block_reuse)},
+                        {"page reuse", to_json(prof.page_reuse)},
+                        {"footprint", footprint},
+                        {"strides", to_json(common_strides)},
+                        {"ip strides", ip_strides},
+                        {"branches",
+                         nlohmann::json{{"types", branch_types},
+                                        {"static branches", prof.branches.static_branches},
+                                        {"biased conditional", prof.branches.biased_conditional}}}};
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  champsim::trace_profile::options opts;
+  std::size_t jobs = 1;
+  bool is_cloudsuite = false;
+  std::string output_name;
+  std::vector<std::string> traces;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    if (arg == "-o" && i + 1 < argc) {
+      output_name = argv[++i];
+    } else if (arg == "-j" && i + 1 < argc) {
+      jobs = std::max<std::size_t>(std::strtoull(argv[++i], nullptr, 10), 1);
+    } else if (arg == "-n" && i + 1 < argc) {
+      opts.max_instructions = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-r" && i + 1 < argc) {
+      opts.sample_rate = std::atof(argv[++i]);
+    } else if (arg == "-i" && i + 1 < argc) {
+      opts.footprint_interval = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-b" && i + 1 < argc) {
+      opts.block_size = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-p" && i + 1 < argc) {
+      opts.page_size = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-c") {
+      is_cloudsuite = true;
+    } else if (arg == "-h" || arg == "--help") {
+      usage(argv[0]);
+      return EXIT_SUCCESS;
+    } else {
+      traces.push_back(arg);
+    }
+  }
+
+  auto is_power_of_two = [](uint64_t x) { return x > 0 && (x & (x - 1)) == 0; };
+  if (std::empty(traces) || !is_power_of_two(opts.block_size) || !is_power_of_two(opts.page_size)) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // Each trace is profiled on its own set of threads, and the profiles are collected in the order of the traces
+  std::vector<nlohmann::json> profiles;
+  std::deque<std::future<nlohmann::json>> in_flight;
+  for (const auto& trace : traces) {
+    if (std::size(in_flight) >= jobs) {
+      profiles.push_back(in_flight.front().get());
+      in_flight.pop_front();
+    }
+    in_flight.push_back(std::async(std::launch::async, [&opts, is_cloudsuite, trace] {
+      std::cerr << "Profiling " << trace << "\n";
+      return to_json(trace, champsim::trace_profile::run(get_tracereader(trace, 0, is_cloudsuite, false), opts));
+    }));
+  }
+  for (auto& result : in_flight) {
+    profiles.push_back(result.get());
+  }
+
+  if (output_name.empty()) {
+    std::cout << nlohmann::json(profiles).dump(2) << std::endl;
+  } else {
+    std::ofstream out{output_name};
+    out << nlohmann::json(profiles).dump(2) << std::endl;
+    if (!out) {
+      std::cerr << "Could not write " << output_name << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../../inc/inf_stream.h"
+#include "../../inc/zstd_seekable.h"
+
+namespace
+{
+void usage(const char* name)
+{
+  std::cerr << "Usage: " << name << " [-l LEVEL] [-f FRAME_SIZE] INPUT.xz OUTPUT.zst\n";
+  std::cerr << "  -l LEVEL       the zstd compression level (default 19)\n";
+  std::cerr << "  -f FRAME_SIZE  the decompressed size of each frame, in bytes (default " << champsim::zstd_seekable::writer::default_frame_size << ")\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  int level = 19;
+  std::size_t frame_size = champsim::zstd_seekable::writer::default_frame_size;
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    if (arg == "-l" && i + 1 < argc) {
+      level = std::atoi(argv[++i]);
+    } else if (arg == "-f" && i + 1 < argc) {
+      frame_size = std::strtoull(argv[++i], nullptr, 10);
+    } else {
+      files.push_back(arg);
+    }
+  }
+
+  if (std::size(files) != 2) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream in_file{files.at(0), std::ios::binary};
+  if (!in_file) {
+    std::cerr << "Could not open " << files.at(0) << "\n";
+    return EXIT_FAILURE;
+  }
+  std::ofstream out_file{files.at(1), std::ios::binary};
+  if (!out_file) {
+    std::cerr << "Could not open " << files.at(1) << "\n";
+    return EXIT_FAILURE;
+  }
+
+  champsim::inf_istream<champsim::decomp_tags::lzma_mt_tag_t<>> in{std::move(in_file)};
+  champsim::zstd_seekable::writer out{out_file, level, frame_size};
+
+  std::array<char, 1 << 16> buf;
+  do {
+    in.read(std::data(buf), std::size(buf));
+    out.write(std::data(buf), in.gcount());
+  } while (!in.eof());
+  out.close();
+
+  return out_file ? EXIT_SUCCESS : EXIT_FAILURE;
+}